@@ -212,6 +212,23 @@ if (UNIX)
       endif (NOT SYSTEM_LIBDECOR_FOUND)
     endif (OPTION_USE_SYSTEM_LIBDECOR)
   endif (OPTION_USE_WAYLAND)
+  option (OPTION_USE_HEADLESS "use the headless (in-memory) display driver" OFF)
+  if (OPTION_USE_HEADLESS)
+    if (OPTION_USE_WAYLAND)
+      message (FATAL_ERROR "OPTION_USE_HEADLESS and OPTION_USE_WAYLAND are mutually exclusive")
+    endif (OPTION_USE_WAYLAND)
+    if (NOT FREETYPE_PATH OR NOT LIB_freetype OR NOT LIB_fontconfig)
+      message (FATAL_ERROR "OPTION_USE_HEADLESS requires the freetype and fontconfig libraries")
+    endif (NOT FREETYPE_PATH OR NOT LIB_freetype OR NOT LIB_fontconfig)
+    set (FLTK_USE_HEADLESS 1)
+    unset (OPTION_USE_XRENDER CACHE)
+    unset (OPTION_USE_XINERAMA CACHE)
+    unset (OPTION_USE_XFT CACHE)
+    unset (OPTION_USE_XCURSOR CACHE)
+    unset (OPTION_USE_XFIXES CACHE)
+    unset (OPTION_USE_PANGO CACHE)
+    unset (OPTION_USE_GL CACHE)
+  endif (OPTION_USE_HEADLESS)
 endif (UNIX)
 
 if (WIN32)
@@ -234,7 +251,7 @@ endif (APPLE)
 
 # find X11 libraries and headers
 set (PATH_TO_XLIBS)
-if ((NOT APPLE OR OPTION_APPLE_X11) AND NOT WIN32 AND NOT OPTION_USE_WAYLAND)
+if ((NOT APPLE OR OPTION_APPLE_X11) AND NOT WIN32 AND NOT OPTION_USE_WAYLAND AND NOT OPTION_USE_HEADLESS)
   include (FindX11)
   if (X11_FOUND)
     set (FLTK_USE_X11 1)
@@ -244,7 +261,7 @@ if ((NOT APPLE OR OPTION_APPLE_X11) AND NOT WIN32 AND NOT OPTION_USE_WAYLAND)
     endif (X11_Xext_FOUND)
     get_filename_component (PATH_TO_XLIBS ${X11_X11_LIB} PATH)
   endif (X11_FOUND)
-endif ((NOT APPLE OR OPTION_APPLE_X11) AND NOT WIN32 AND NOT OPTION_USE_WAYLAND)
+endif ((NOT APPLE OR OPTION_APPLE_X11) AND NOT WIN32 AND NOT OPTION_USE_WAYLAND AND NOT OPTION_USE_HEADLESS)
 
 if (OPTION_APPLE_X11)
   if (NOT(${CMAKE_SYSTEM_VERSION} VERSION_LESS 17.0.0)) # a.k.a. macOS version ≥ 10.13
@@ -378,12 +395,19 @@ if (OPTION_USE_SVG)
   set (FLTK_USE_SVG 1)
 endif (OPTION_USE_SVG)
 
+#######################################################################
+option (OPTION_USE_TRACING "record timing traces of event handling and drawing (Fl_Trace)" OFF)
+
+if (OPTION_USE_TRACING)
+  set (FLTK_USE_TRACING 1)
+endif (OPTION_USE_TRACING)
+
 #######################################################################
 set (HAVE_GL LIB_GL OR LIB_MesaGL)
 
-if (HAVE_GL)
+if (HAVE_GL AND NOT OPTION_USE_HEADLESS)
    option (OPTION_USE_GL "use OpenGL" ON)
-endif (HAVE_GL)
+endif (HAVE_GL AND NOT OPTION_USE_HEADLESS)
 
 if (OPTION_USE_GL)
   if (OPTION_APPLE_X11)
@@ -48,6 +48,8 @@ elseif (OPTION_USE_WAYLAND)
   if (OPTION_USE_SYSTEM_LIBDECOR)
     list (APPEND FLTK_LDLIBS "-ldecor-0")
   endif (OPTION_USE_SYSTEM_LIBDECOR)
+elseif (OPTION_USE_HEADLESS)
+  list (APPEND FLTK_LDLIBS -lfreetype -lm)
 else ()
   list (APPEND FLTK_LDLIBS -lm)
 endif (WIN32)
@@ -111,6 +111,14 @@ typedef struct HGLRC__ *GLContext;
    struct dirent {char d_name[1];};
 #endif
 
+#elif defined(FLTK_USE_HEADLESS)
+typedef struct fl_headless_buffer *Fl_Offscreen; /**< an offscreen drawing buffer */
+typedef struct flHeadlessRegion* Fl_Region;
+typedef int FL_SOCKET; /**< socket or file descriptor */
+typedef void *GLContext;
+#include <sys/types.h>
+#include <dirent.h>
+
 #elif defined(FLTK_USE_WAYLAND)
 typedef struct fl_wld_buffer *Fl_Offscreen; /**< an offscreen drawing buffer */
 typedef struct flCairoRegion* Fl_Region;
@@ -148,6 +148,7 @@ public:
   void write_code2() {}
   void open();
   virtual const char *type_name() {return "data";}
+  const char *filename() const {return filename_;}
   void write_properties();
   void read_property(const char *);
   int pixmapID() { return 49; }
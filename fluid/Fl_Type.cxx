@@ -379,8 +379,13 @@ void Fl_Type::add(Fl_Type *p, Strategy strategy) {
   Fl_Type *q; // insert 'this' before q
   int newlevel;
   if (p) {
-    // find the last node that is a child or grandchild of p
-    for (q = p->next; q && q->level > p->level; q = q->next) {/*empty*/}
+    // find the last node that is a child or grandchild of p; when reading a
+    // file, that is the last node in the list, so check this first
+    for (q = last; q && q != p; q = q->parent) {/*empty*/}
+    if (q == p)
+      q = 0;
+    else
+      for (q = p->next; q && q->level > p->level; q = q->next) {/*empty*/}
     newlevel = p->level+1;
   } else {
     q = 0;
@@ -632,22 +637,32 @@ void Fl_Type::write_properties() {
 }
 
 void Fl_Type::read_property(const char *c) {
-  if (!strcmp(c,"label"))
-    label(read_word());
-  else if (!strcmp(c,"user_data"))
-    user_data(read_word());
-  else if (!strcmp(c,"user_data_type"))
-    user_data_type(read_word());
-  else if (!strcmp(c,"callback"))
-    callback(read_word());
-  else if (!strcmp(c,"comment"))
-    comment(read_word());
-  else if (!strcmp(c,"open"))
-    open_ = 1;
-  else if (!strcmp(c,"selected"))
-    select(this,1);
-  else
-    read_error("Unknown property \"%s\"", c);
+  switch (property_id(c)) {
+    case kPropLabel:
+      label(read_word());
+      break;
+    case kPropUserData:
+      user_data(read_word());
+      break;
+    case kPropUserDataType:
+      user_data_type(read_word());
+      break;
+    case kPropCallback:
+      callback(read_word());
+      break;
+    case kPropComment:
+      comment(read_word());
+      break;
+    case kPropOpen:
+      open_ = 1;
+      break;
+    case kPropSelected:
+      select(this,1);
+      break;
+    default:
+      read_error("Unknown property \"%s\"", c);
+      break;
+  }
 }
 
 int Fl_Type::read_fdesign(const char*, const char*) {return 0;}
@@ -2694,145 +2694,190 @@ void Fl_Widget_Type::write_properties() {
 
 void Fl_Widget_Type::read_property(const char *c) {
   int x,y,w,h; Fl_Font f; int s; Fl_Color cc;
-  if (!strcmp(c,"private")) {
-    public_ = 0;
-  } else if (!strcmp(c,"protected")) {
-    public_ = 2;
-  } else if (!strcmp(c,"xywh")) {
-    if (sscanf(read_word(),"%d %d %d %d",&x,&y,&w,&h) == 4) {
-      x += pasteoffset;
-      y += pasteoffset;
-      // FIXME temporary change!
-      if (read_version>=2.0 && o->parent() && o->parent()!=o->window()) {
-        x += o->parent()->x();
-        y += o->parent()->y();
-      }
-      o->resize(x,y,w,h);
-    }
-  } else if (!strcmp(c,"tooltip")) {
-    tooltip(read_word());
-  } else if (!strcmp(c,"image")) {
-    image_name(read_word());
-  } else if (!strcmp(c,"deimage")) {
-    inactive_name(read_word());
-  } else if (!strcmp(c,"type")) {
-    if (is_spinner())
-      ((Fl_Spinner*)o)->type(item_number(subtypes(), read_word()));
-    else
-      o->type(item_number(subtypes(), read_word()));
-  } else if (!strcmp(c,"box")) {
-    const char* value = read_word();
-    if ((x = boxnumber(value))) {
-      if (x == ZERO_ENTRY) x = 0;
-      o->box((Fl_Boxtype)x);
-    } else if (sscanf(value,"%d",&x) == 1) o->box((Fl_Boxtype)x);
-  } else if (is_button() && !strcmp(c,"down_box")) {
-    const char* value = read_word();
-    if ((x = boxnumber(value))) {
-      if (x == ZERO_ENTRY) x = 0;
-      ((Fl_Button*)o)->down_box((Fl_Boxtype)x);
-    }
-  } else if (!strcmp(type_name(), "Fl_Input_Choice") && !strcmp(c,"down_box")) {
-    const char* value = read_word();
-    if ((x = boxnumber(value))) {
-      if (x == ZERO_ENTRY) x = 0;
-      ((Fl_Input_Choice*)o)->down_box((Fl_Boxtype)x);
-    }
-  } else if (is_menu_button() && !strcmp(c,"down_box")) {
-    const char* value = read_word();
-    if ((x = boxnumber(value))) {
-      if (x == ZERO_ENTRY) x = 0;
-      ((Fl_Menu_*)o)->down_box((Fl_Boxtype)x);
-    }
-  } else if (is_button() && !strcmp(c,"value")) {
-    const char* value = read_word();
-    ((Fl_Button*)o)->value(atoi(value));
-  } else if (!strcmp(c,"color")) {
-    const char *cw = read_word();
-    if (cw[0]=='0' && cw[1]=='x') {
-      sscanf(cw,"0x%x",&x);
-      o->color(x);
-    } else {
-      int n = sscanf(cw,"%d %d",&x,&y);
-      if (n == 2) { // back compatibility...
-        if (x != 47) o->color(x);
-        o->selection_color(y);
+  switch (property_id(c)) {
+    case kPropPrivate:
+      public_ = 0;
+      return;
+    case kPropProtected:
+      public_ = 2;
+      return;
+    case kPropXywh:
+      if (sscanf(read_word(),"%d %d %d %d",&x,&y,&w,&h) == 4) {
+        x += pasteoffset;
+        y += pasteoffset;
+        // FIXME temporary change!
+        if (read_version>=2.0 && o->parent() && o->parent()!=o->window()) {
+          x += o->parent()->x();
+          y += o->parent()->y();
+        }
+        o->resize(x,y,w,h);
+      }
+      return;
+    case kPropTooltip:
+      tooltip(read_word());
+      return;
+    case kPropImage:
+      image_name(read_word());
+      return;
+    case kPropDeimage:
+      inactive_name(read_word());
+      return;
+    case kPropType:
+      if (is_spinner())
+        ((Fl_Spinner*)o)->type(item_number(subtypes(), read_word()));
+      else
+        o->type(item_number(subtypes(), read_word()));
+      return;
+    case kPropBox: {
+      const char* value = read_word();
+      if ((x = boxnumber(value))) {
+        if (x == ZERO_ENTRY) x = 0;
+        o->box((Fl_Boxtype)x);
+      } else if (sscanf(value,"%d",&x) == 1) o->box((Fl_Boxtype)x);
+      return; }
+    case kPropDownBox:
+      if (is_button()) {
+        const char* value = read_word();
+        if ((x = boxnumber(value))) {
+          if (x == ZERO_ENTRY) x = 0;
+          ((Fl_Button*)o)->down_box((Fl_Boxtype)x);
+        }
+        return;
+      } else if (!strcmp(type_name(), "Fl_Input_Choice")) {
+        const char* value = read_word();
+        if ((x = boxnumber(value))) {
+          if (x == ZERO_ENTRY) x = 0;
+          ((Fl_Input_Choice*)o)->down_box((Fl_Boxtype)x);
+        }
+        return;
+      } else if (is_menu_button()) {
+        const char* value = read_word();
+        if ((x = boxnumber(value))) {
+          if (x == ZERO_ENTRY) x = 0;
+          ((Fl_Menu_*)o)->down_box((Fl_Boxtype)x);
+        }
+        return;
+      }
+      break;
+    case kPropValue:
+      if (is_button()) {
+        const char* value = read_word();
+        ((Fl_Button*)o)->value(atoi(value));
       } else {
+        if (is_valuator()) ((Fl_Valuator*)o)->value(strtod(read_word(),0));
+        if (is_spinner()) ((Fl_Spinner*)o)->value(strtod(read_word(),0));
+      }
+      return;
+    case kPropColor: {
+      const char *cw = read_word();
+      if (cw[0]=='0' && cw[1]=='x') {
+        sscanf(cw,"0x%x",&x);
         o->color(x);
+      } else {
+        int n = sscanf(cw,"%d %d",&x,&y);
+        if (n == 2) { // back compatibility...
+          if (x != 47) o->color(x);
+          o->selection_color(y);
+        } else {
+          o->color(x);
+        }
       }
-    }
-  } else if (!strcmp(c,"selection_color")) {
-    if (sscanf(read_word(),"%d",&x)) o->selection_color(x);
-  } else if (!strcmp(c,"labeltype")) {
-    c = read_word();
-    if (!strcmp(c,"image")) {
-      Fluid_Image *i = Fluid_Image::find(label());
-      if (!i) read_error("Image file '%s' not found", label());
-      else setimage(i);
-      image_name(label());
-      label("");
-    } else {
-      o->labeltype((Fl_Labeltype)item_number(labeltypemenu,c));
-    }
-  } else if (!strcmp(c,"labelfont")) {
-    if (sscanf(read_word(),"%d",&x) == 1) o->labelfont(x);
-  } else if (!strcmp(c,"labelsize")) {
-    if (sscanf(read_word(),"%d",&x) == 1) o->labelsize(x);
-  } else if (!strcmp(c,"labelcolor")) {
-    if (sscanf(read_word(),"%d",&x) == 1) o->labelcolor(x);
-  } else if (!strcmp(c,"align")) {
-    if (sscanf(read_word(),"%d",&x) == 1) o->align(x);
-  } else if (!strcmp(c,"when")) {
-    if (sscanf(read_word(),"%d",&x) == 1) o->when(x);
-  } else if (!strcmp(c,"minimum")) {
-    if (is_valuator()) ((Fl_Valuator*)o)->minimum(strtod(read_word(),0));
-    if (is_spinner()) ((Fl_Spinner*)o)->minimum(strtod(read_word(),0));
-  } else if (!strcmp(c,"maximum")) {
-    if (is_valuator()) ((Fl_Valuator*)o)->maximum(strtod(read_word(),0));
-    if (is_spinner()) ((Fl_Spinner*)o)->maximum(strtod(read_word(),0));
-  } else if (!strcmp(c,"step")) {
-    if (is_valuator()) ((Fl_Valuator*)o)->step(strtod(read_word(),0));
-    if (is_spinner()) ((Fl_Spinner*)o)->step(strtod(read_word(),0));
-  } else if (!strcmp(c,"value")) {
-    if (is_valuator()) ((Fl_Valuator*)o)->value(strtod(read_word(),0));
-    if (is_spinner()) ((Fl_Spinner*)o)->value(strtod(read_word(),0));
-  } else if ((!strcmp(c,"slider_size")||!strcmp(c,"size"))&&is_valuator()==2) {
-    ((Fl_Slider*)o)->slider_size(strtod(read_word(),0));
-  } else if (!strcmp(c,"textfont")) {
-    if (sscanf(read_word(),"%d",&x) == 1) {f=(Fl_Font)x; textstuff(1,f,s,cc);}
-  } else if (!strcmp(c,"textsize")) {
-    if (sscanf(read_word(),"%d",&x) == 1) {s=x; textstuff(2,f,s,cc);}
-  } else if (!strcmp(c,"textcolor")) {
-    if (sscanf(read_word(),"%d",&x) == 1) {cc=(Fl_Color)x;textstuff(3,f,s,cc);}
-  } else if (!strcmp(c,"hide")) {
-    o->hide();
-  } else if (!strcmp(c,"deactivate")) {
-    o->deactivate();
-  } else if (!strcmp(c,"resizable")) {
-    resizable(1);
-  } else if (!strcmp(c,"hotspot") || !strcmp(c, "divider")) {
-    hotspot(1);
-  } else if (!strcmp(c,"class")) {
-    subclass(read_word());
-  } else if (!strcmp(c,"shortcut")) {
-    int shortcut = strtol(read_word(),0,0);
-    if (is_button()) ((Fl_Button*)o)->shortcut(shortcut);
-    else if (is_input()) ((Fl_Input_*)o)->shortcut(shortcut);
-    else if (is_value_input()) ((Fl_Value_Input*)o)->shortcut(shortcut);
-    else if (is_text_display()) ((Fl_Text_Display*)o)->shortcut(shortcut);
-  } else {
-    if (!strncmp(c,"code",4)) {
-      int n = atoi(c+4);
-      if (n >= 0 && n <= NUM_EXTRA_CODE) {
-        extra_code(n,read_word());
+      return; }
+    case kPropSelectionColor:
+      if (sscanf(read_word(),"%d",&x)) o->selection_color(x);
+      return;
+    case kPropLabeltype:
+      c = read_word();
+      if (!strcmp(c,"image")) {
+        Fluid_Image *i = Fluid_Image::find(label());
+        if (!i) read_error("Image file '%s' not found", label());
+        else setimage(i);
+        image_name(label());
+        label("");
+      } else {
+        o->labeltype((Fl_Labeltype)item_number(labeltypemenu,c));
+      }
+      return;
+    case kPropLabelfont:
+      if (sscanf(read_word(),"%d",&x) == 1) o->labelfont(x);
+      return;
+    case kPropLabelsize:
+      if (sscanf(read_word(),"%d",&x) == 1) o->labelsize(x);
+      return;
+    case kPropLabelcolor:
+      if (sscanf(read_word(),"%d",&x) == 1) o->labelcolor(x);
+      return;
+    case kPropAlign:
+      if (sscanf(read_word(),"%d",&x) == 1) o->align(x);
+      return;
+    case kPropWhen:
+      if (sscanf(read_word(),"%d",&x) == 1) o->when(x);
+      return;
+    case kPropMinimum:
+      if (is_valuator()) ((Fl_Valuator*)o)->minimum(strtod(read_word(),0));
+      if (is_spinner()) ((Fl_Spinner*)o)->minimum(strtod(read_word(),0));
+      return;
+    case kPropMaximum:
+      if (is_valuator()) ((Fl_Valuator*)o)->maximum(strtod(read_word(),0));
+      if (is_spinner()) ((Fl_Spinner*)o)->maximum(strtod(read_word(),0));
+      return;
+    case kPropStep:
+      if (is_valuator()) ((Fl_Valuator*)o)->step(strtod(read_word(),0));
+      if (is_spinner()) ((Fl_Spinner*)o)->step(strtod(read_word(),0));
+      return;
+    case kPropSliderSize:
+    case kPropSize:
+      if (is_valuator()==2) {
+        ((Fl_Slider*)o)->slider_size(strtod(read_word(),0));
         return;
       }
-    } else if (!strcmp(c,"extra_code")) {
+      break;
+    case kPropTextfont:
+      if (sscanf(read_word(),"%d",&x) == 1) {f=(Fl_Font)x; textstuff(1,f,s,cc);}
+      return;
+    case kPropTextsize:
+      if (sscanf(read_word(),"%d",&x) == 1) {s=x; textstuff(2,f,s,cc);}
+      return;
+    case kPropTextcolor:
+      if (sscanf(read_word(),"%d",&x) == 1) {cc=(Fl_Color)x;textstuff(3,f,s,cc);}
+      return;
+    case kPropHide:
+      o->hide();
+      return;
+    case kPropDeactivate:
+      o->deactivate();
+      return;
+    case kPropResizable:
+      resizable(1);
+      return;
+    case kPropHotspot:
+    case kPropDivider:
+      hotspot(1);
+      return;
+    case kPropClass:
+      subclass(read_word());
+      return;
+    case kPropShortcut: {
+      int shortcut = strtol(read_word(),0,0);
+      if (is_button()) ((Fl_Button*)o)->shortcut(shortcut);
+      else if (is_input()) ((Fl_Input_*)o)->shortcut(shortcut);
+      else if (is_value_input()) ((Fl_Value_Input*)o)->shortcut(shortcut);
+      else if (is_text_display()) ((Fl_Text_Display*)o)->shortcut(shortcut);
+      return; }
+    case kPropExtraCode:
       extra_code(0,read_word());
       return;
-    }
-    Fl_Type::read_property(c);
+    default:
+      if (!strncmp(c,"code",4)) {
+        int n = atoi(c+4);
+        if (n >= 0 && n <= NUM_EXTRA_CODE) {
+          extra_code(n,read_word());
+          return;
+        }
+      }
+      break;
   }
+  Fl_Type::read_property(c);
 }
 
 Fl_Menu_Item boxmenu1[] = {
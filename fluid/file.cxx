@@ -49,7 +49,17 @@
 // TODO: files vs. those that write to the .fl file which should be fixed.
 
 static FILE *fout;
-static FILE *fin;
+
+// When writing to memory, fout is NULL and the output grows in out_data.
+// out_data is freed and set to NULL if it can't grow, and the output is lost.
+static char *out_data;
+static int out_length, out_size;
+
+// The input is read as a whole into memory and parsed from there.
+// in_buffer is the memory allocated for a file, or NULL if the caller
+// provided the data.
+static char *in_buffer;
+static const char *in_data, *in_ptr, *in_end;
 
 static int needspace;
 static int lineno;
@@ -90,17 +100,64 @@ static int close_write() {
   return 1;
 }
 
+/**
+ Make sure that the memory output buffer can hold n more bytes.
+ \return 0 if the buffer is not available, it was freed if it could not grow
+ */
+static int reserve_output(int n) {
+  if (!out_data) return 0;
+  if (out_length + n > out_size) {
+    int size = 2 * out_size;
+    if (out_length + n > size) size = out_length + n;
+    char *data = (char*)realloc(out_data, size);
+    if (!data) {
+      free(out_data);
+      out_data = NULL;
+      out_length = out_size = 0;
+      return 0;
+    }
+    out_data = data;
+    out_size = size;
+  }
+  return 1;
+}
+
+/**
+ Write a single character to the .fl file or to the memory buffer.
+ */
+static void write_char(int c) {
+  if (fout) {
+    putc(c, fout);
+  } else if (reserve_output(1)) {
+    out_data[out_length++] = (char)c;
+  }
+}
+
+/**
+ Write a C string to the .fl file or to the memory buffer.
+ */
+static void write_text(const char *t) {
+  if (fout) {
+    fputs(t, fout);
+  } else {
+    int n = (int)strlen(t);
+    if (!reserve_output(n)) return;
+    memcpy(out_data + out_length, t, n);
+    out_length += n;
+  }
+}
+
 /**
  Write a string to the .fl file, quoting characters if necessary.
  */
 void write_word(const char *w) {
-  if (needspace) putc(' ', fout);
+  if (needspace) write_char(' ');
   needspace = 1;
-  if (!w || !*w) {fprintf(fout,"{}"); return;}
+  if (!w || !*w) {write_text("{}"); return;}
   const char *p;
   // see if it is a single word:
   for (p = w; is_id(*p); p++) ;
-  if (!*p) {fprintf(fout,"%s",w); return;}
+  if (!*p) {write_text(w); return;}
   // see if there are matching braces:
   int n = 0;
   for (p = w; *p; p++) {
@@ -109,7 +166,7 @@ void write_word(const char *w) {
   }
   int mismatched = (n != 0);
   // write out brace-quoted string:
-  putc('{', fout);
+  write_char('{');
   for (; *w; w++) {
     switch (*w) {
     case '{':
@@ -117,12 +174,12 @@ void write_word(const char *w) {
       if (!mismatched) break;
     case '\\':
     case '#':
-      putc('\\',fout);
+      write_char('\\');
       break;
     }
-    putc(*w,fout);
+    write_char(*w);
   }
-  putc('}', fout);
+  write_char('}');
 }
 
 /**
@@ -132,10 +189,26 @@ void write_word(const char *w) {
  */
 void write_string(const char *format, ...) {
   va_list args;
-  va_start(args, format);
-  if (needspace && *format != '\n') fputc(' ',fout);
-  vfprintf(fout, format, args);
-  va_end(args);
+  if (needspace && *format != '\n') write_char(' ');
+  if (fout) {
+    va_start(args, format);
+    vfprintf(fout, format, args);
+    va_end(args);
+  } else if (reserve_output(256)) {
+    va_start(args, format);
+    int n = vsnprintf(out_data + out_length, out_size - out_length, format, args);
+    va_end(args);
+    if (n >= out_size - out_length) { // did not fit, format again
+      if (reserve_output(n + 1)) {
+        va_start(args, format);
+        vsnprintf(out_data + out_length, out_size - out_length, format, args);
+        va_end(args);
+      } else {
+        n = 0;
+      }
+    }
+    if (n > 0) out_length += n;
+  }
   needspace = !isspace(format[strlen(format)-1] & 255);
 }
 
@@ -143,8 +216,8 @@ void write_string(const char *format, ...) {
  Start a new line in the .fl file and indent it for a given nesting level.
  */
 void write_indent(int n) {
-  fputc('\n',fout);
-  while (n--) {fputc(' ',fout); fputc(' ',fout);}
+  write_char('\n');
+  while (n--) {write_char(' '); write_char(' ');}
   needspace = 0;
 }
 
@@ -152,8 +225,8 @@ void write_indent(int n) {
  Write a '{' to the .fl file at the given indenting level.
  */
 void write_open(int) {
-  if (needspace) fputc(' ',fout);
-  fputc('{',fout);
+  if (needspace) write_char(' ');
+  write_char('{');
   needspace = 0;
 }
 
@@ -162,7 +235,7 @@ void write_open(int) {
  */
 void write_close(int n) {
   if (needspace) write_indent(n);
-  fputc('}',fout);
+  write_char('}');
   needspace = 1;
 }
 
@@ -172,16 +245,39 @@ void write_close(int n) {
 
 /**
  Open an .fl file for reading.
+ The complete file is read into memory in large blocks.
  \param[in] s filename, if NULL, read from stdin instead
  \return 0 if the operation failed, 1 if it succeeded
  */
 static int open_read(const char *s) {
   lineno = 1;
-  if (!s) {fin = stdin; fname = "stdin"; return 1;}
-  FILE *f = fl_fopen(s,"r");
-  if (!f) return 0;
-  fin = f;
-  fname = s;
+  FILE *f;
+  if (!s) {
+    f = stdin;
+    fname = "stdin";
+  } else {
+    f = fl_fopen(s,"r");
+    if (!f) return 0;
+    fname = s;
+  }
+  size_t size = 64 * 1024, length = 0, n;
+  in_buffer = (char*)malloc(size);
+  while ((n = fread(in_buffer + length, 1, size - length, f)) > 0) {
+    length += n;
+    if (length == size) {
+      size *= 2;
+      in_buffer = (char*)realloc(in_buffer, size);
+    }
+  }
+  int ok = !ferror(f);
+  if (f != stdin && fclose(f)) ok = 0;
+  if (!ok) {
+    free(in_buffer);
+    in_buffer = NULL;
+    return 0;
+  }
+  in_data = in_ptr = in_buffer;
+  in_end = in_buffer + length;
   return 1;
 }
 
@@ -190,14 +286,35 @@ static int open_read(const char *s) {
  \return 0 if the operation failed, 1 if it succeeded
  */
 static int close_read() {
-  if (fin != stdin) {
-    int x = fclose(fin);
-    fin = 0;
-    return x >= 0;
-  }
+  free(in_buffer);
+  in_buffer = NULL;
+  in_data = in_ptr = in_end = 0;
   return 1;
 }
 
+/**
+ Read the next character of the .fl file.
+ \return the character as an unsigned char, or -1 at the end of the file
+ */
+static inline int read_char() {
+  return (in_ptr < in_end) ? (unsigned char)*in_ptr++ : -1;
+}
+
+/**
+ Push back the character that was just read.
+ */
+static inline void unread_char(int x) {
+  if (x >= 0) in_ptr--;
+}
+
+/**
+ Skip the rest of the current line.
+ */
+static void skip_line() {
+  const char *e = (const char*)memchr(in_ptr, '\n', in_end - in_ptr);
+  in_ptr = e ? e + 1 : in_end;
+}
+
 /**
  Display an error while reading the file.
  If the .fl file isn't opened for reading, pop up an FLTK dialog, otherwise
@@ -207,7 +324,7 @@ static int close_read() {
 void read_error(const char *format, ...) {
   va_list args;
   va_start(args, format);
-  if (!fin) {
+  if (!in_data) {
     char buffer[1024];
     vsnprintf(buffer, sizeof(buffer), format, args);
     fl_message("%s", buffer);
@@ -236,7 +353,7 @@ static int hexdigit(int x) {
  */
 static int read_quoted() {      // read whatever character is after a \ .
   int c,d,x;
-  switch(c = fgetc(fin)) {
+  switch(c = read_char()) {
   case '\n': lineno++; return -1;
   case 'a' : return('\a');
   case 'b' : return('\b');
@@ -247,9 +364,9 @@ static int read_quoted() {      // read whatever character is after a \ .
   case 'v' : return('\v');
   case 'x' :    /* read hex */
     for (c=x=0; x<3; x++) {
-      int ch = fgetc(fin);
+      int ch = read_char();
       d = hexdigit(ch);
-      if (d > 15) {ungetc(ch,fin); break;}
+      if (d > 15) {unread_char(ch); break;}
       c = (c<<4)+d;
     }
     break;
@@ -257,9 +374,9 @@ static int read_quoted() {      // read whatever character is after a \ .
     if (c<'0' || c>'7') break;
     c -= '0';
     for (x=0; x<2; x++) {
-      int ch = fgetc(fin);
+      int ch = read_char();
       d = hexdigit(ch);
-      if (d>7) {ungetc(ch,fin); break;}
+      if (d>7) {unread_char(ch); break;}
       c = (c<<3)+d;
     }
     break;
@@ -303,11 +420,11 @@ const char *read_word(int wantbrace) {
 
   // skip all the whitespace before it:
   for (;;) {
-    x = getc(fin);
-    if (x < 0 && feof(fin)) {   // eof
+    x = read_char();
+    if (x < 0) {   // eof
       return 0;
     } else if (x == '#') {      // comment
-      do x = getc(fin); while (x >= 0 && x != '\n');
+      skip_line();
       lineno++;
       continue;
     } else if (x == '\n') {
@@ -325,10 +442,21 @@ const char *read_word(int wantbrace) {
     int length = 0;
     int nesting = 0;
     for (;;) {
-      x = getc(fin);
+      // copy all characters up to the next one that needs attention at once
+      const char *run = in_ptr;
+      while (in_ptr < in_end && *in_ptr != '}' && *in_ptr != '{' && *in_ptr != '\n' &&
+             *in_ptr != '\\' && *in_ptr != '#')
+        in_ptr++;
+      if (in_ptr > run) {
+        int n = (int)(in_ptr - run);
+        expand_buffer(length + n);
+        memcpy(buffer + length, run, n);
+        length += n;
+      }
+      x = read_char();
       if (x<0) {read_error("Missing '}'"); break;}
       else if (x == '#') { // embedded comment
-        do x = getc(fin); while (x >= 0 && x != '\n');
+        skip_line();
         lineno++;
         continue;
       } else if (x == '\n') lineno++;
@@ -355,26 +483,110 @@ const char *read_word(int wantbrace) {
       if (x == '\\') {x = read_quoted(); if (x<0) continue;}
       else if (x<0 || isspace(x & 255) || x=='{' || x=='}' || x=='#') break;
       buffer[length++] = x;
-      expand_buffer(length);
-      x = getc(fin);
+      // copy the following plain characters at once
+      const char *run = in_ptr;
+      while (in_ptr < in_end && !isspace(*in_ptr & 255) && *in_ptr != '{' &&
+             *in_ptr != '}' && *in_ptr != '#' && *in_ptr != '\\')
+        in_ptr++;
+      int n = (int)(in_ptr - run);
+      expand_buffer(length + n);
+      memcpy(buffer + length, run, n);
+      length += n;
+      x = read_char();
     }
-    ungetc(x, fin);
+    unread_char(x);
     buffer[length] = 0;
     return buffer;
 
   }
 }
 
+/**
+ The property names that property_id() recognizes.
+ */
+static const struct {
+  const char *name;
+  Property_Id id;
+} property_names[] = {
+  { "label", kPropLabel },
+  { "user_data", kPropUserData },
+  { "user_data_type", kPropUserDataType },
+  { "callback", kPropCallback },
+  { "comment", kPropComment },
+  { "open", kPropOpen },
+  { "selected", kPropSelected },
+  { "private", kPropPrivate },
+  { "protected", kPropProtected },
+  { "xywh", kPropXywh },
+  { "tooltip", kPropTooltip },
+  { "image", kPropImage },
+  { "deimage", kPropDeimage },
+  { "type", kPropType },
+  { "box", kPropBox },
+  { "down_box", kPropDownBox },
+  { "value", kPropValue },
+  { "color", kPropColor },
+  { "selection_color", kPropSelectionColor },
+  { "labeltype", kPropLabeltype },
+  { "labelfont", kPropLabelfont },
+  { "labelsize", kPropLabelsize },
+  { "labelcolor", kPropLabelcolor },
+  { "align", kPropAlign },
+  { "when", kPropWhen },
+  { "minimum", kPropMinimum },
+  { "maximum", kPropMaximum },
+  { "step", kPropStep },
+  { "slider_size", kPropSliderSize },
+  { "size", kPropSize },
+  { "textfont", kPropTextfont },
+  { "textsize", kPropTextsize },
+  { "textcolor", kPropTextcolor },
+  { "hide", kPropHide },
+  { "deactivate", kPropDeactivate },
+  { "resizable", kPropResizable },
+  { "hotspot", kPropHotspot },
+  { "divider", kPropDivider },
+  { "class", kPropClass },
+  { "shortcut", kPropShortcut },
+  { "extra_code", kPropExtraCode }
+};
+
+// FNV-1a hash with a seed that maps all property names to different
+// slots of a table of 128 entries
+static unsigned property_hash(const char *name) {
+  unsigned h = 2166138023U;
+  while (*name) h = (h ^ (unsigned char)*name++) * 16777619U;
+  return h >> 25;
+}
+
+/**
+ Find the identifier of a property name.
+ The names are found with a perfect hash table: the hash of a name gives
+ the only table entry that it needs to be compared to.
+ \param[in] name a property name as returned by read_word()
+ \return the property identifier, or kPropUnknown
+ */
+Property_Id property_id(const char *name) {
+  static signed char slot[128];
+  static int initialized = 0;
+  if (!initialized) {
+    memset(slot, -1, sizeof(slot));
+    for (int i = 0; i < int(sizeof(property_names) / sizeof(property_names[0])); i++)
+      slot[property_hash(property_names[i].name)] = (signed char)i;
+    initialized = 1;
+  }
+  int i = slot[property_hash(name)];
+  if (i >= 0 && !strcmp(property_names[i].name, name)) return property_names[i].id;
+  return kPropUnknown;
+}
+
 ////////////////////////////////////////////////////////////////
 
 /**
- Write an .fl design description file.
- \param[in] filename create this file, and if it exists, overwrite it
- \param[in] selected_only write only the selected nodes in the widget_tree. This
-    is used to implement copy and paste.
+ Write the design description to the file or buffer opened for writing.
  */
-int write_file(const char *filename, int selected_only) {
-  if (!open_write(filename)) return 0;
+static void write_project(int selected_only) {
+  needspace = 0;
   write_string("# data file for the Fltk User Interface Designer (fluid)\n"
                "version %.4f",FL_VERSION);
   if(!include_H_from_C)
@@ -437,9 +649,44 @@ int write_file(const char *filename, int selected_only) {
       p = p->next;
     }
   }
+}
+
+/**
+ Write an .fl design description file.
+ \param[in] filename create this file, and if it exists, overwrite it
+ \param[in] selected_only write only the selected nodes in the widget_tree. This
+    is used to implement copy and paste.
+ */
+int write_file(const char *filename, int selected_only) {
+  if (!open_write(filename)) return 0;
+  write_project(selected_only);
   return close_write();
 }
 
+/**
+ Write the .fl design description of the whole project into memory.
+ This creates the same text as write_file() without any file system access.
+ \param[out] length the number of bytes written
+ \return a buffer allocated with malloc() that the caller must free(),
+    it is not terminated by a null character, or NULL if there was not
+    enough memory
+ */
+char *write_file_to_memory(int &length) {
+  FILE *saved_fout = fout;
+  fout = NULL;
+  out_size = 16 * 1024;
+  out_length = 0;
+  out_data = (char*)malloc(out_size);
+  if (!out_data) out_size = 0;
+  write_project(0);
+  char *data = out_data;
+  length = out_length;
+  out_data = NULL;
+  out_length = out_size = 0;
+  fout = saved_fout;
+  return data;
+}
+
 ////////////////////////////////////////////////////////////////
 // read all the objects out of the input file:
 
@@ -633,18 +880,14 @@ static void read_children(Fl_Type *p, int paste, Strategy strategy, char skip_op
 }
 
 /**
- Read a .fl design file.
- \param[in] filename read this file
- \param[in] merge if this is set, merge the file into an existing design
+ Read a design from the file or buffer opened for reading.
+ \param[in] merge if this is set, merge the design into an existing design
     at Fl_Type::current
  \param[in] strategy add new nodes after current or as last child
- \return 0 if the operation failed, 1 if it succeeded
  */
-int read_file(const char *filename, int merge, Strategy strategy) {
+static void read_project(int merge, Strategy strategy) {
   Fl_Type *o;
   read_version = 0.0;
-  if (!open_read(filename))
-    return 0;
   if (merge)
     deselect();
   else
@@ -662,6 +905,37 @@ int read_file(const char *filename, int merge, Strategy strategy) {
     }
   selection_changed(Fl_Type::current);
   shell_settings_read();
+}
+
+/**
+ Read a .fl design file.
+ \param[in] filename read this file
+ \param[in] merge if this is set, merge the file into an existing design
+    at Fl_Type::current
+ \param[in] strategy add new nodes after current or as last child
+ \return 0 if the operation failed, 1 if it succeeded
+ */
+int read_file(const char *filename, int merge, Strategy strategy) {
+  if (!open_read(filename))
+    return 0;
+  read_project(merge, strategy);
+  return close_read();
+}
+
+/**
+ Read a .fl design description from memory, replacing the current design.
+ \param[in] data the text created by write_file_to_memory()
+ \param[in] length the number of bytes in data
+ \return 0 if the operation failed, 1 if it succeeded
+ */
+int read_file_from_memory(const char *data, int length) {
+  if (!data) return 0;
+  lineno = 1;
+  fname = "undo buffer";
+  in_buffer = NULL;
+  in_data = in_ptr = data;
+  in_end = data + length;
+  read_project(0, kAddAsLastChild);
   return close_read();
 }
 
@@ -673,8 +947,8 @@ static int read_fdesign_line(const char*& name, const char*& value) {
   int x;
   // find a colon:
   for (;;) {
-    x = getc(fin);
-    if (x < 0 && feof(fin)) return 0;
+    x = read_char();
+    if (x < 0) return 0;
     if (x == '\n') {length = 0; continue;} // no colon this line...
     if (!isspace(x & 255)) {
       buffer[length++] = x;
@@ -687,8 +961,8 @@ static int read_fdesign_line(const char*& name, const char*& value) {
 
   // skip to start of value:
   for (;;) {
-    x = getc(fin);
-    if ((x < 0 && feof(fin)) || x == '\n' || !isspace(x & 255)) break;
+    x = read_char();
+    if ((x < 0) || x == '\n' || !isspace(x & 255)) break;
   }
 
   // read the value:
@@ -697,7 +971,7 @@ static int read_fdesign_line(const char*& name, const char*& value) {
     else if (x == '\n') break;
     buffer[length++] = x;
     expand_buffer(length);
-    x = getc(fin);
+    x = read_char();
   }
   buffer[length] = 0;
   name = buffer;
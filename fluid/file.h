@@ -31,12 +31,33 @@ void write_indent(int n);
 void write_open(int);
 void write_close(int n);
 
+/**
+ Property names of nodes in .fl files, see property_id().
+ */
+enum Property_Id {
+  kPropUnknown = 0,
+  // Fl_Type
+  kPropLabel, kPropUserData, kPropUserDataType, kPropCallback, kPropComment,
+  kPropOpen, kPropSelected,
+  // Fl_Widget_Type
+  kPropPrivate, kPropProtected, kPropXywh, kPropTooltip, kPropImage,
+  kPropDeimage, kPropType, kPropBox, kPropDownBox, kPropValue, kPropColor,
+  kPropSelectionColor, kPropLabeltype, kPropLabelfont, kPropLabelsize,
+  kPropLabelcolor, kPropAlign, kPropWhen, kPropMinimum, kPropMaximum,
+  kPropStep, kPropSliderSize, kPropSize, kPropTextfont, kPropTextsize,
+  kPropTextcolor, kPropHide, kPropDeactivate, kPropResizable, kPropHotspot,
+  kPropDivider, kPropClass, kPropShortcut, kPropExtraCode
+};
+
 void read_error(const char *format, ...);
 const char *read_word(int wantbrace = 0);
+Property_Id property_id(const char *name);
 
 int write_file(const char *, int selected_only = 0);
+char *write_file_to_memory(int &length);
 
 int read_file(const char *, int merge, Strategy strategy=kAddAsLastChild);
+int read_file_from_memory(const char *data, int length);
 void read_fdesign();
 
 #endif // _FLUID_FILE_H
@@ -1,7 +1,7 @@
 //
 // FLUID main entry for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2021 by Bill Spitzak and others.
+// Copyright 1998-2022 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -46,6 +46,14 @@
 #include <locale.h>     // setlocale()..
 #include "../src/flstring.h"
 
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#  include <process.h>  // _spawnv()
+#  include <windows.h>  // WaitForMultipleObjects()
+#else
+#  include <sys/wait.h>
+#  include <unistd.h>
+#endif
+
 extern "C"
 {
 #if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
@@ -163,6 +171,12 @@ int compile_strings = 0;        // fluic -cs
 /// Set, if Fluid runs in batch mode, and no user interface is activated.
 int batch_mode = 0;             // if set (-c, -u) don't open display
 
+/// Number of design files that are compiled at the same time in batch mode (-j)
+static int batch_jobs = 1;
+
+/// If set, design files are only compiled if their content hash changed (-hashes)
+static const char *batch_hash_file = NULL;
+
 /// If set, commandline overrides header file name in .fl file.
 int header_file_set = 0;
 
@@ -881,6 +895,25 @@ void new_from_template_cb(Fl_Widget *w, void *v) {
   undo_clear();
 }
 
+/**
+ Get the names of the source code and header files of the current design.
+ \param[out] cname, hname buffers of FL_PATH_MAX bytes for the file names
+ */
+static void code_file_names(char *cname, char *hname) {
+  if (*code_file_name == '.' && strchr(code_file_name, '/') == NULL) {
+    strlcpy(cname, fl_filename_name(filename), FL_PATH_MAX);
+    fl_filename_setext(cname, FL_PATH_MAX, code_file_name);
+  } else {
+    strlcpy(cname, code_file_name, FL_PATH_MAX);
+  }
+  if (*header_file_name == '.' && strchr(header_file_name, '/') == NULL) {
+    strlcpy(hname, fl_filename_name(filename), FL_PATH_MAX);
+    fl_filename_setext(hname, FL_PATH_MAX, header_file_name);
+  } else {
+    strlcpy(hname, header_file_name, FL_PATH_MAX);
+  }
+}
+
 /**
  Generate the C++ source and header filenames and write those files.
 
@@ -906,18 +939,7 @@ int write_code_files() {
   char hname[FL_PATH_MAX];
   strlcpy(i18n_program, fl_filename_name(filename), sizeof(i18n_program));
   fl_filename_setext(i18n_program, sizeof(i18n_program), "");
-  if (*code_file_name == '.' && strchr(code_file_name, '/') == NULL) {
-    strlcpy(cname, fl_filename_name(filename), sizeof(cname));
-    fl_filename_setext(cname, sizeof(cname), code_file_name);
-  } else {
-    strlcpy(cname, code_file_name, sizeof(cname));
-  }
-  if (*header_file_name == '.' && strchr(header_file_name, '/') == NULL) {
-    strlcpy(hname, fl_filename_name(filename), sizeof(hname));
-    fl_filename_setext(hname, sizeof(hname), header_file_name);
-  } else {
-    strlcpy(hname, header_file_name, sizeof(hname));
-  }
+  code_file_names(cname, hname);
   if (!batch_mode) goto_source_dir();
   int x = write_code(cname,hname);
   if (!batch_mode) leave_source_dir();
@@ -1661,9 +1683,14 @@ void set_modflag(int mf, int mfc) {
 
     char mod_star = modflag ? '*' : ' ';
     char mod_c_star = modflag_c ? '*' : ' ';
-    snprintf(title, sizeof(title), "%s%c  %s%c",
+    char new_title[FL_PATH_MAX];
+    snprintf(new_title, sizeof(new_title), "%s%c  %s%c",
              basename, mod_star, code_ext, mod_c_star);
-    main_window->label(title);
+    // reading a file sets the flag for every node, don't retitle each time
+    if (main_window->label() != title || strcmp(new_title, title)) {
+      strlcpy(title, new_title, sizeof(title));
+      main_window->label(title);
+    }
   }
   // if the UI was modified in any way, update the Source View panel
   if (sourceview_panel && sourceview_panel->visible() && sv_autorefresh->value())
@@ -1792,6 +1819,407 @@ void update_sourceview_timer(void*)
   update_sourceview_cb(0,0);
 }
 
+// ---- Batch compilation of many design files
+
+// Size of a line of the hash file
+#define HASH_RECORD_SIZE (FL_PATH_MAX * 12)
+
+/**
+ Add a file to a 64 bit FNV-1a hash.
+ \return 0 if the file can't be read, 1 if successful
+ */
+static int hash_file(unsigned long long &h, const char *name) {
+  FILE *f = fl_fopen(name, "rb");
+  if (!f) return 0;
+  unsigned char buffer[8192];
+  size_t n;
+  while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+    for (size_t k = 0; k < n; k++)
+      h = (h ^ buffer[k]) * 1099511628211ULL;
+  }
+  fclose(f);
+  return 1;
+}
+
+/**
+ Add a string and its terminating null character to a 64 bit FNV-1a hash.
+ */
+static void hash_string(unsigned long long &h, const char *s) {
+  do {
+    h = (h ^ (unsigned char)*s) * 1099511628211ULL;
+  } while (*s++);
+}
+
+/**
+ Compute the content hash of a design file and of the files it uses.
+ The hash covers the content of the design file, the names and contents of
+ the image and data files that are copied into the generated code, and the
+ command line options that change the generated code.
+ \param[in] fl the design file name, which must be the current file name
+    (see set_filename())
+ \param[in] refs the names of the files used by the design separated by tabs,
+    relative to the directory of the design file, see design_references()
+ \param[out] hash a buffer of at least 17 bytes for the hash in hexadecimal
+ \return 0 if the design file can't be read, 1 if successful
+ */
+static int design_hash(const char *fl, const char *refs, char *hash) {
+  unsigned long long h = 14695981039346656037ULL;
+  char options[FL_PATH_MAX * 2 + 40];
+  snprintf(options, sizeof(options), "%.4f %d %s %s", FL_VERSION, compile_strings,
+           code_file_set ? code_file_name : "", header_file_set ? header_file_name : "");
+  hash_string(h, options);
+  if (!hash_file(h, fl)) return 0;
+  goto_source_dir();
+  while (*refs) {
+    char name[FL_PATH_MAX];
+    size_t n = strcspn(refs, "\t");
+    if (n >= sizeof(name)) n = sizeof(name) - 1;
+    memcpy(name, refs, n);
+    name[n] = 0;
+    refs += n;
+    if (*refs) refs++;
+    hash_string(h, name);
+    // a missing file changes the hash like a file without content
+    hash_string(h, hash_file(h, name) ? "" : "?");
+  }
+  leave_source_dir();
+  snprintf(hash, 17, "%08x%08x", (unsigned)(h >> 32), (unsigned)h);
+  return 1;
+}
+
+/**
+ Collect the names of the image and data files that the current design
+ copies into the generated code.
+ \param[out] refs the names separated by tabs, each name only once
+ \param[in] size the size of the buffer refs
+ \return 0 if the names don't fit into the buffer, 1 if successful
+ */
+static int design_references(char *refs, int size) {
+  refs[0] = 0;
+  int length = 0;
+  for (Fl_Type *t = Fl_Type::first; t; t = t->next) {
+    const char *names[2] = { NULL, NULL };
+    if (t->is_widget()) {
+      names[0] = ((Fl_Widget_Type*)t)->image_name();
+      names[1] = ((Fl_Widget_Type*)t)->inactive_name();
+    } else if (!strcmp(t->type_name(), "data")) {
+      names[0] = ((Fl_Data_Type*)t)->filename();
+    }
+    for (int k = 0; k < 2; k++) {
+      const char *name = names[k];
+      if (!name || !*name || strchr(name, '\t')) continue;
+      int n = (int)strlen(name);
+      const char *p = refs;
+      while ((p = strstr(p, name)) != NULL) { // skip names found before
+        if ((p == refs || p[-1] == '\t') && (p[n] == 0 || p[n] == '\t')) break;
+        p++;
+      }
+      if (p) continue;
+      if (length + n + 2 > size) return 0;
+      if (length) refs[length++] = '\t';
+      strcpy(refs + length, name);
+      length += n;
+    }
+  }
+  return 1;
+}
+
+/**
+ Split a line of the hash file into its fields.
+ Each line contains the hash, the design file name, the names of the source
+ code and header files, and the names of the files the design uses, which
+ are all separated by tabs.
+ \param[in] line the line, the trailing newline is removed
+ \param[out] field the first four fields, and the names of the files the
+    design uses in field[4]
+ \return 0 if the line is not a valid record
+ */
+static int split_hash_record(char *line, char *field[5]) {
+  int n = 0;
+  field[n++] = line;
+  field[4] = (char*)"";
+  for (char *p = line; *p; p++) {
+    if (*p == '\n' || *p == '\r') { *p = 0; break; }
+    if (*p == '\t' && n < 5) {
+      *p = 0;
+      field[n++] = p + 1;
+    }
+  }
+  return n >= 4;
+}
+
+/**
+ Check if the code files of a design are up to date.
+ This is the case if the last record for the design in the hash file has the
+ same hash as the design file and the files it uses, and if the code files of
+ that record exist.
+ */
+static int design_is_up_to_date(const char *fl) {
+  FILE *f = fl_fopen(batch_hash_file, "r");
+  if (!f) return 0;
+  char line[HASH_RECORD_SIZE], last[HASH_RECORD_SIZE], *field[5];
+  last[0] = 0;
+  while (fgets(line, sizeof(line), f)) {
+    char record[HASH_RECORD_SIZE];
+    strlcpy(record, line, sizeof(record));
+    if (split_hash_record(line, field) && !strcmp(field[1], fl))
+      strlcpy(last, record, sizeof(last));
+  }
+  fclose(f);
+  char hash[17];
+  return split_hash_record(last, field) &&
+         design_hash(fl, field[4], hash) && !strcmp(field[0], hash) &&
+         fl_access(field[2], 0) == 0 && fl_access(field[3], 0) == 0;
+}
+
+/**
+ Append the hash of a design that was compiled to the hash file.
+ As each record is written at once to the end of the file, design files can
+ be compiled by parallel processes. Nothing is written if the design uses
+ too many files for a record, so it is always compiled.
+ */
+static void record_design_hash(const char *fl) {
+  char hash[17], cname[FL_PATH_MAX], hname[FL_PATH_MAX];
+  char refs[HASH_RECORD_SIZE - FL_PATH_MAX * 4];
+  if (!design_references(refs, sizeof(refs))) return;
+  if (!design_hash(fl, refs, hash)) return;
+  code_file_names(cname, hname);
+  FILE *f = fl_fopen(batch_hash_file, "a");
+  if (!f) {
+    fprintf(stderr, "%s : %s\n", batch_hash_file, strerror(errno));
+    return;
+  }
+  if (*refs)
+    fprintf(f, "%s\t%s\t%s\t%s\t%s\n", hash, fl, cname, hname, refs);
+  else
+    fprintf(f, "%s\t%s\t%s\t%s\n", hash, fl, cname, hname);
+  fclose(f);
+}
+
+/**
+ Rewrite the hash file with only the last record of every design.
+ */
+static void compact_hash_file() {
+  FILE *f = fl_fopen(batch_hash_file, "r");
+  if (!f) return;
+  char line[HASH_RECORD_SIZE], *field[5];
+  char **records = NULL;
+  int count = 0, alloc = 0;
+  while (fgets(line, sizeof(line), f)) {
+    char record[sizeof(line)];
+    strlcpy(record, line, sizeof(record));
+    if (!split_hash_record(line, field)) continue;
+    int k;
+    for (k = 0; k < count; k++) { // replace the previous record of this design
+      const char *name = strchr(records[k], '\t') + 1;
+      size_t n = strlen(field[1]);
+      if (!strncmp(name, field[1], n) && name[n] == '\t') break;
+    }
+    if (k == count) {
+      if (count == alloc) {
+        alloc = alloc ? 2 * alloc : 64;
+        records = (char**)realloc(records, alloc * sizeof(char*));
+      }
+      count++;
+    } else {
+      free(records[k]);
+    }
+    records[k] = fl_strdup(record);
+  }
+  fclose(f);
+  f = fl_fopen(batch_hash_file, "w");
+  for (int k = 0; k < count; k++) {
+    if (f) fputs(records[k], f);
+    free(records[k]);
+  }
+  if (f) fclose(f);
+  free(records);
+}
+
+/**
+ Read a design file and write its code files and strings.
+ This does what `fluid -c` does for a single design file.
+ \return 0 if successful, 1 if the design file can't be read
+ */
+static int compile_design(const char *c) {
+  set_filename(c);
+  if (compile_file && !update_file && batch_hash_file && design_is_up_to_date(c))
+    return 0;
+  undo_suspend();
+  if (!read_file(c, 0)) {
+    fprintf(stderr,"%s : %s\n", c, strerror(errno));
+    return 1;
+  }
+  undo_resume();
+  if (update_file)              // fluid -u
+    write_file(c, 0);
+  if (compile_file) {           // fluid -c[s]
+    if (compile_strings)
+      write_strings_cb(0, 0);
+    write_cb(0, 0);
+    if (!update_file && batch_hash_file)
+      record_design_hash(c);
+  }
+  return 0;
+}
+
+/**
+ Add the design files given on the command line to a list.
+ An argument starting with '@' names a response file that contains one
+ design file name per line.
+ */
+static void add_design_files(const char *arg, char **&files, int &count, int &alloc) {
+  char line[FL_PATH_MAX];
+  FILE *f = NULL;
+  if (*arg == '@') {
+    f = fl_fopen(arg + 1, "r");
+    if (!f) {
+      fprintf(stderr, "%s : %s\n", arg + 1, strerror(errno));
+      return;
+    }
+  }
+  for (;;) {
+    const char *name = arg;
+    if (f) {
+      if (!fgets(line, sizeof(line), f)) break;
+      char *e = line + strlen(line);
+      while (e > line && isspace(e[-1] & 255)) *--e = 0;
+      name = line;
+      while (isspace(*name & 255)) name++;
+      if (!*name || *name == '#') continue;
+    }
+    if (count == alloc) {
+      alloc = alloc ? 2 * alloc : 64;
+      files = (char**)realloc(files, alloc * sizeof(char*));
+    }
+    files[count++] = fl_strdup(name);
+    if (!f) break;
+  }
+  if (f) fclose(f);
+}
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+
+// Quote an argument for _spawnv() if it contains spaces.
+// Quoted arguments are allocated and must be freed if they differ from arg.
+static const char *spawn_arg(const char *arg) {
+  if (!strchr(arg, ' ') && !strchr(arg, '\t')) return arg;
+  size_t n = strlen(arg) + 3;
+  char *quoted = (char*)malloc(n);
+  snprintf(quoted, n, "\"%s\"", arg);
+  return quoted;
+}
+
+// Start a FLUID process that compiles a single design file
+static intptr_t spawn_compile_design(const char *program, const char *fl) {
+  const char *args[12], *given[12];
+  int n = 0;
+  given[n] = program; args[n] = spawn_arg(program); n++;
+  if (update_file) { given[n] = args[n] = "-u"; n++; }
+  if (compile_file) { given[n] = args[n] = compile_strings ? "-cs" : "-c"; n++; }
+  if (code_file_set) {
+    given[n] = args[n] = "-o"; n++;
+    given[n] = code_file_name; args[n] = spawn_arg(code_file_name); n++;
+  }
+  if (header_file_set) {
+    given[n] = args[n] = "-h"; n++;
+    given[n] = header_file_name; args[n] = spawn_arg(header_file_name); n++;
+  }
+  if (batch_hash_file) {
+    given[n] = args[n] = "-hashes"; n++;
+    given[n] = batch_hash_file; args[n] = spawn_arg(batch_hash_file); n++;
+  }
+  given[n] = fl; args[n] = spawn_arg(fl); n++;
+  args[n] = NULL;
+  intptr_t proc = _spawnv(_P_NOWAIT, program, args);
+  for (int k = 0; k < n; k++)
+    if (args[k] != given[k]) free((void*)args[k]);
+  return proc;
+}
+
+#endif // _WIN32 && !__CYGWIN__
+
+/**
+ Compile many design files, running up to \c batch_jobs processes at once.
+
+ FLUID keeps the design in global variables, so every design file is read
+ and compiled by its own process. On POSIX systems, that process is forked
+ from this one after the command line and the preferences were handled.
+
+ \param[in] program the name of the FLUID executable
+ \param[in] n, args the design files and response files to compile
+ \return 0 if all files were compiled, 1 otherwise
+ */
+static int batch_compile(const char *program, int n, char **args) {
+  char **files = NULL;
+  int count = 0, alloc = 0;
+  for (int k = 0; k < n; k++)
+    add_design_files(args[k], files, count, alloc);
+  int failed = 0, running = 0, next = 0;
+  fflush(stdout);
+  fflush(stderr);
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  // WaitForMultipleObjects() can't wait for more processes at once
+  if (batch_jobs > MAXIMUM_WAIT_OBJECTS) batch_jobs = MAXIMUM_WAIT_OBJECTS;
+  HANDLE procs[MAXIMUM_WAIT_OBJECTS];
+  while (next < count || running > 0) {
+    if (next < count && running < batch_jobs) {
+      intptr_t proc = spawn_compile_design(program, files[next]);
+      if (proc == -1) {
+        fprintf(stderr, "%s : %s\n", files[next], strerror(errno));
+        failed++;
+      } else {
+        procs[running++] = (HANDLE)proc;
+      }
+      next++;
+      continue;
+    }
+    // wait for whichever process finishes first
+    DWORD ret = WaitForMultipleObjects(running, procs, FALSE, INFINITE);
+    if (ret >= WAIT_OBJECT_0 + running) {
+      fprintf(stderr, "fluid: can't wait for child processes\n");
+      failed += running + count - next;
+      for (int k = 0; k < running; k++) CloseHandle(procs[k]);
+      break;
+    }
+    int k = ret - WAIT_OBJECT_0;
+    DWORD status = 1;
+    if (!GetExitCodeProcess(procs[k], &status) || status) failed++;
+    CloseHandle(procs[k]);
+    procs[k] = procs[--running];
+  }
+#else
+  (void)program;
+  while (next < count || running > 0) {
+    if (next < count && running < batch_jobs) {
+      pid_t pid = fork();
+      if (pid == 0) {
+        int status = compile_design(files[next]);
+        fflush(stdout);
+        fflush(stderr);
+        _exit(status);
+      }
+      if (pid < 0) {
+        fprintf(stderr, "%s : %s\n", files[next], strerror(errno));
+        failed++;
+      } else {
+        running++;
+      }
+      next++;
+      continue;
+    }
+    int status;
+    if (wait(&status) < 0) break;
+    running--;
+    if (!WIFEXITED(status) || WEXITSTATUS(status)) failed++;
+  }
+#endif
+  if (batch_hash_file) compact_hash_file();
+  for (int k = 0; k < count; k++) free(files[k]);
+  free(files);
+  return failed ? 1 : 0;
+}
+
 // ---- Main program entry point
 
 /**
@@ -1818,6 +2246,17 @@ static int arg(int argc, char** argv, int& i) {
     i += 2;
     return 2;
   }
+  if (argv[i][1] == 'j' && !argv[i][2] && i+1 < argc) {
+    batch_jobs = atoi(argv[i+1]);
+    if (batch_jobs < 1) batch_jobs = 1;
+    i += 2;
+    return 2;
+  }
+  if (strcmp(argv[i], "-hashes") == 0 && i+1 < argc) {
+    batch_hash_file = argv[i+1];
+    i += 2;
+    return 2;
+  }
   return 0;
 }
 
@@ -1868,14 +2307,19 @@ int main(int argc,char **argv) {
   setlocale(LC_ALL, "");      // enable multilanguage errors in file chooser
   setlocale(LC_NUMERIC, "C"); // make sure numeric values are written correctly
 
-  if (!Fl::args(argc,argv,i,arg) || i < argc-1) {
+  if (!Fl::args(argc,argv,i,arg) || (i < argc-1 && !batch_mode) || (batch_mode && i >= argc)) {
     static const char *msg =
       "usage: %s <switches> name.fl\n"
+      "       %s <-u|-c|-cs> <switches> name.fl|@list ...\n"
       " -u : update .fl file and exit (may be combined with '-c' or '-cs')\n"
       " -c : write .cxx and .h and exit\n"
       " -cs : write .cxx and .h and strings and exit\n"
       " -o <name> : .cxx output filename, or extension if <name> starts with '.'\n"
       " -h <name> : .h output filename, or extension if <name> starts with '.'\n"
+      " -j <n> : compile up to n .fl files at the same time\n"
+      " -hashes <file> : with '-c' or '-cs', skip .fl files that did not change\n"
+      "                  since they were compiled, using content hashes in <file>\n"
+      " @list : read the names of .fl files from the file list, one per line\n"
       " -d : enable internal debugging\n";
 #ifdef _MSC_VER
     fl_message("%s\n", msg);
@@ -1891,45 +2335,32 @@ int main(int argc,char **argv) {
 
   make_main_window();
 
+  if (batch_mode) {
+    if (i < argc-1 || *c == '@')
+      return batch_compile(argv[0], argc - i, argv + i);
+    return compile_design(c);
+  }
+
   if (c) set_filename(c);
-  if (!batch_mode) {
 #ifdef __APPLE__
-    fl_open_callback(apple_open_cb);
+  fl_open_callback(apple_open_cb);
 #endif // __APPLE__
-    Fl::visual((Fl_Mode)(FL_DOUBLE|FL_INDEX));
-    Fl_File_Icon::load_system_icons();
-    main_window->callback(exit_cb);
-    position_window(main_window,"main_window_pos", 1, 10, 30, WINWIDTH, WINHEIGHT );
-    main_window->show(argc,argv);
-    toggle_widgetbin_cb(0,0);
-    toggle_sourceview_cb(0,0);
-    if (!c && openlast_button->value() && absolute_history[0][0]) {
-      // Open previous file when no file specified...
-      open_history_cb(0, absolute_history[0]);
-    }
+  Fl::visual((Fl_Mode)(FL_DOUBLE|FL_INDEX));
+  Fl_File_Icon::load_system_icons();
+  main_window->callback(exit_cb);
+  position_window(main_window,"main_window_pos", 1, 10, 30, WINWIDTH, WINHEIGHT );
+  main_window->show(argc,argv);
+  toggle_widgetbin_cb(0,0);
+  toggle_sourceview_cb(0,0);
+  if (!c && openlast_button->value() && absolute_history[0][0]) {
+    // Open previous file when no file specified...
+    open_history_cb(0, absolute_history[0]);
   }
   undo_suspend();
-  if (c && !read_file(c,0)) {
-    if (batch_mode) {
-      fprintf(stderr,"%s : %s\n", c, strerror(errno));
-      exit(1);
-    }
+  if (c && !read_file(c,0))
     fl_message("Can't read %s: %s", c, strerror(errno));
-  }
   undo_resume();
 
-  if (update_file) {            // fluid -u
-    write_file(c,0);
-    if (!compile_file)
-      exit(0);
-  }
-
-  if (compile_file) {           // fluid -c[s]
-    if (compile_strings)
-      write_strings_cb(0,0);
-    write_cb(0,0);
-    exit(0);
-  }
   set_modflag(0);
   undo_clear();
 #ifndef _WIN32
@@ -1,7 +1,7 @@
 //
 // FLUID undo support for the Fast Light Tool Kit (FLTK).
 //
-// Copyright 1998-2021 by Bill Spitzak and others.
+// Copyright 1998-2022 by Bill Spitzak and others.
 //
 // This library is free software. Distribution and use rights are outlined in
 // the file "COPYING" which should have been included with this file.  If this
@@ -15,6 +15,7 @@
 //
 
 #include "undo.h"
+#include "undo_history.h"
 
 #include "fluid.h"
 #include "file.h"
@@ -26,6 +27,7 @@
 #include <FL/Fl_Menu_Bar.H>
 #include <FL/filename.H>
 #include "../src/flstring.h"
+#include <stdlib.h>
 
 #if defined(_WIN32) && !defined(__CYGWIN__)
 #  include <io.h>
@@ -37,10 +39,12 @@
 
 
 //
-// This file implements an undo system using temporary files; ideally
-// we'd like to do this in memory, however the current data structures
-// and design aren't well-suited...  Instead, we save and restore
-// checkpoint files.
+// This file implements an undo system. Every checkpoint saves the design in
+// .fl format, and undo or redo reads the design back. The history is kept in
+// memory by Undo_History: we keep the text of a single level, and for every pair of
+// neighbouring levels only the bytes that differ between them. As most edits
+// change a single widget, this is a small fraction of the design. If the
+// history can't be kept in memory, we save and restore checkpoint files.
 //
 
 
@@ -50,6 +54,10 @@ int undo_max = 0;                       // Maximum undo level used
 int undo_save = -1;                     // Last undo level that was saved
 static int undo_paused = 0;             // Undo checkpointing paused?
 
+static int undo_in_memory = 1;          // History in memory or in files?
+
+// The history in memory, which forgets the oldest levels beyond 32 MB
+static Undo_History undo_history(32 * 1024 * 1024);
 
 // Return the undo filename.
 // The filename is constructed in a static internal buffer and
@@ -71,6 +79,68 @@ static char *undo_filename(int level) {
   return undo_path;
 }
 
+// Forget the oldest levels until the history fits into its memory budget
+static void undo_trim_memory() {
+  int n = undo_history.trim();
+  if (!n) return;
+  undo_current -= n;
+  undo_last -= n;
+  if (undo_save >= n) undo_save -= n;
+  else undo_save = -1;
+}
+
+// Write the text of undo_history to the checkpoint file of its level
+static int undo_write_text_file() {
+  FILE *f = fl_fopen(undo_filename(undo_history.text_level()), "wb");
+  if (!f) return 0;
+  size_t length = undo_history.text_length();
+  int ok = (fwrite(undo_history.text(), 1, length, f) == length);
+  if (fclose(f)) ok = 0;
+  return ok;
+}
+
+// Continue the history with checkpoint files. The levels that are in memory
+// are written to files first.
+static void undo_use_files() {
+  undo_max = undo_current;
+  int level = undo_history.text_level();
+  if (level >= 0) {
+    // the levels that can be restored by undo...
+    for (int i = level; i >= 0 && undo_history.go_to(i) && undo_write_text_file(); i--) { }
+    // ... and by redo
+    for (int i = level + 1; i < undo_history.levels() && undo_history.go_to(i) && undo_write_text_file(); i++) {
+      if (i > undo_max) undo_max = i;
+    }
+  }
+  undo_history.clear();
+  undo_in_memory = 0;
+}
+
+// Save the current design as the given undo level. The history continues
+// in files if the design can't be kept in memory.
+static int undo_write_level(int level) {
+  if (undo_in_memory) {
+    int length;
+    char *text = write_file_to_memory(length);
+    if (text && size_t(length) < undo_history.budget() / 2) {
+      if (undo_history.store(level, text, length)) return 1;
+    } else {
+      free(text);
+    }
+    undo_use_files();
+  }
+  return write_file(undo_filename(level));
+}
+
+// Replace the current design with the given undo level
+static int undo_read_level(int level) {
+  if (undo_in_memory) {
+    if (!undo_history.go_to(level)) return 0;
+    return read_file_from_memory(undo_history.text(), undo_history.text_length());
+  }
+  return read_file(undo_filename(level), 0);
+}
+
 
 // Redo menu callback
 void redo_cb(Fl_Widget *, void *) {
@@ -80,7 +150,7 @@ void redo_cb(Fl_Widget *, void *) {
   if (undo_current >= undo_last) return;
 
   undo_suspend();
-  if (!read_file(undo_filename(undo_current + 1), 0)) {
+  if (!undo_read_level(undo_current + 1)) {
     // Unable to read checkpoint file, don't redo...
     widget_browser->rebuild();
     undo_resume();
@@ -106,14 +176,14 @@ void undo_cb(Fl_Widget *, void *) {
   if (undo_current <= 0) return;
 
   if (undo_current == undo_last) {
-    write_file(undo_filename(undo_current));
+    undo_write_level(undo_current);
   }
 
   undo_suspend();
   // Undo first deletes all widgets which resets the widget_tree browser.
   // Save the current scroll position, so we don't scroll back to 0 at undo.
   if (widget_browser) widget_browser->save_scroll_position();
-  if (!read_file(undo_filename(undo_current - 1), 0)) {
+  if (!undo_read_level(undo_current - 1)) {
     // Unable to read checkpoint file, don't undo...
     widget_browser->rebuild();
     undo_resume();
@@ -137,19 +207,19 @@ void undo_cb(Fl_Widget *, void *) {
 
 // Save current file to undo buffer
 void undo_checkpoint() {
-  int undo_item = main_menubar->find_index(undo_cb);
-  int redo_item = main_menubar->find_index(redo_cb);
   //  printf("undo_checkpoint(): undo_current=%d, undo_paused=%d, modflag=%d\n",
   //         undo_current, undo_paused, modflag);
 
   // Don't checkpoint if undo_suspend() has been called...
   if (undo_paused) return;
 
-  // Save the current UI to a checkpoint file...
-  const char *filename = undo_filename(undo_current);
-  if (!write_file(filename)) {
+  int undo_item = main_menubar->find_index(undo_cb);
+  int redo_item = main_menubar->find_index(redo_cb);
+
+  // Save the current UI to a checkpoint...
+  if (!undo_write_level(undo_current)) {
     // Don't attempt to do undo stuff if we can't write a checkpoint file...
-    perror(filename);
+    perror(undo_filename(undo_current));
     return;
   }
 
@@ -160,7 +230,8 @@ void undo_checkpoint() {
   // Update the current undo level...
   undo_current ++;
   undo_last = undo_current;
-  if (undo_current > undo_max) undo_max = undo_current;
+  if (undo_in_memory) undo_trim_memory();
+  else if (undo_current > undo_max) undo_max = undo_current;
 
   // Enable the Undo and disable the Redo menu items...
   Main_Menu[undo_item].activate();
@@ -171,10 +242,14 @@ void undo_checkpoint() {
 void undo_clear() {
   int undo_item = main_menubar->find_index(undo_cb);
   int redo_item = main_menubar->find_index(redo_cb);
-  // Remove old checkpoint files...
-  for (int i = 0; i <= undo_max; i ++) {
-    fl_unlink(undo_filename(i));
+  // Remove old checkpoint files and free the history in memory...
+  if (!undo_in_memory) {
+    for (int i = 0; i <= undo_max; i ++) {
+      fl_unlink(undo_filename(i));
+    }
   }
+  undo_history.clear();
+  undo_in_memory = 1;
 
   // Reset current, last, and save indices...
   undo_current = undo_last = undo_max = 0;
@@ -0,0 +1,167 @@
+//
+// FLUID undo history for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include "undo_history.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// The difference between the text of a level and of the next level:
+// both texts start with the same prefix bytes and end with the same suffix
+// bytes, before and after are the bytes in between.
+struct Undo_History::Delta {
+  int prefix, suffix;
+  int before_length, after_length;
+  char *before, *after;
+};
+
+Undo_History::Undo_History(size_t budget)
+: deltas_(0), num_deltas_(0), alloc_deltas_(0),
+  text_(0), text_length_(0), text_size_(0), text_level_(-1),
+  delta_memory_(0), budget_(budget)
+{
+}
+
+Undo_History::~Undo_History() {
+  clear();
+}
+
+// Free the memory of a delta
+void Undo_History::free_delta(Delta &d) {
+  delta_memory_ -= d.before_length + d.after_length + sizeof(Delta);
+  free(d.before);
+  free(d.after);
+  d.before = d.after = 0;
+}
+
+// Store the difference between text a and text b in delta d
+int Undo_History::make_delta(Delta &d, const char *a, int na, const char *b, int nb) {
+  int prefix = 0, suffix = 0;
+  while (prefix < na && prefix < nb && a[prefix] == b[prefix]) prefix++;
+  while (suffix < na - prefix && suffix < nb - prefix &&
+         a[na - suffix - 1] == b[nb - suffix - 1]) suffix++;
+  d.prefix = prefix;
+  d.suffix = suffix;
+  d.before_length = na - prefix - suffix;
+  d.after_length = nb - prefix - suffix;
+  d.before = (char*)malloc(d.before_length + 1);
+  d.after = (char*)malloc(d.after_length + 1);
+  if (!d.before || !d.after) {
+    free(d.before);
+    free(d.after);
+    d.before = d.after = 0;
+    return 0;
+  }
+  memcpy(d.before, a + prefix, d.before_length);
+  memcpy(d.after, b + prefix, d.after_length);
+  delta_memory_ += d.before_length + d.after_length + sizeof(Delta);
+  return 1;
+}
+
+// Apply delta d to text_, forward from level n to n+1, or backward
+int Undo_History::apply_delta(const Delta &d, int forward) {
+  int old_middle = forward ? d.before_length : d.after_length;
+  int new_middle = forward ? d.after_length : d.before_length;
+  int length = d.prefix + new_middle + d.suffix;
+  if (length > text_size_) {
+    char *text = (char*)realloc(text_, length);
+    if (!text) return 0;
+    text_ = text;
+    text_size_ = length;
+  }
+  memmove(text_ + d.prefix + new_middle, text_ + d.prefix + old_middle, d.suffix);
+  memcpy(text_ + d.prefix, forward ? d.after : d.before, new_middle);
+  text_length_ = length;
+  return 1;
+}
+
+// Free the whole history
+void Undo_History::clear() {
+  while (num_deltas_ > 0) free_delta(deltas_[--num_deltas_]);
+  free(deltas_);
+  deltas_ = 0;
+  alloc_deltas_ = 0;
+  free(text_);
+  text_ = 0;
+  text_length_ = text_size_ = 0;
+  text_level_ = -1;
+  delta_memory_ = 0;
+}
+
+// Change text() into the text of the given level
+int Undo_History::go_to(int level) {
+  if (text_level_ < 0 || level < 0 || level > num_deltas_) return 0;
+  while (text_level_ > level) {
+    if (!apply_delta(deltas_[text_level_ - 1], 0)) return 0;
+    text_level_--;
+  }
+  while (text_level_ < level) {
+    if (!apply_delta(deltas_[text_level_], 1)) return 0;
+    text_level_++;
+  }
+  return 1;
+}
+
+// Make the text, allocated with malloc(), the content of the given level,
+// which must be 0 or at most one more than the last level of the history.
+// All levels after it are forgotten. The text is freed if the level can't
+// be stored.
+int Undo_History::store(int level, char *text, int length) {
+  if (level > 0 && !go_to(level - 1)) { // the history has a gap
+    free(text);
+    return 0;
+  }
+  // Forget this level and the levels after it
+  while (num_deltas_ > 0 && num_deltas_ >= level) free_delta(deltas_[--num_deltas_]);
+  if (level > 0) {
+    if (num_deltas_ >= alloc_deltas_) {
+      int n = alloc_deltas_ ? 2 * alloc_deltas_ : 64;
+      Delta *deltas = (Delta*)realloc(deltas_, n * sizeof(Delta));
+      if (!deltas) {
+        free(text);
+        return 0;
+      }
+      deltas_ = deltas;
+      alloc_deltas_ = n;
+    }
+    if (!make_delta(deltas_[num_deltas_], text_, text_length_, text, length)) {
+      free(text);
+      return 0;
+    }
+    num_deltas_++;
+  }
+  free(text_);
+  text_ = text;
+  text_length_ = text_size_ = length;
+  text_level_ = level;
+  return 1;
+}
+
+// Forget the oldest levels until the history fits into its memory budget,
+// keeping the level of text() and the one before it. The remaining levels
+// are numbered from 0 again. Returns the number of levels forgotten.
+int Undo_History::trim() {
+  int n = 0;
+  while (memory() > budget_ && n < num_deltas_ - 1 && n < text_level_ - 1) {
+    free_delta(deltas_[n]);
+    n++;
+  }
+  if (!n) return 0;
+  num_deltas_ -= n;
+  memmove(deltas_, deltas_ + n, num_deltas_ * sizeof(Delta));
+  text_level_ -= n;
+  return n;
+}
@@ -0,0 +1,57 @@
+//
+// FLUID undo history for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#ifndef undo_history_h
+#define undo_history_h
+
+#include <stddef.h>
+
+// The texts of consecutive undo levels, kept in memory as the text of a
+// single level and, for every pair of neighbouring levels, only the bytes
+// that differ between them.
+class Undo_History {
+  struct Delta;
+  Delta *deltas_;               // deltas_[n] leads from level n to n+1
+  int num_deltas_;              // Number of levels minus one
+  int alloc_deltas_;            // Allocated size of deltas_
+  char *text_;                  // Text of the design at text_level_
+  int text_length_;             // Length of text_
+  int text_size_;               // Allocated size of text_
+  int text_level_;              // Level of text_, -1 if none
+  size_t delta_memory_;         // Bytes used by all deltas
+  size_t budget_;               // Memory used before trim() forgets levels
+  void free_delta(Delta &d);
+  int make_delta(Delta &d, const char *a, int na, const char *b, int nb);
+  int apply_delta(const Delta &d, int forward);
+public:
+  Undo_History(size_t budget);
+  ~Undo_History();
+  void clear();
+  int store(int level, char *text, int length);
+  int go_to(int level);
+  int trim();
+  // Number of levels in the history, which are numbered from 0
+  int levels() const { return text_level_ < 0 ? 0 : num_deltas_ + 1; }
+  // The text of level text_level(), as set by store() and go_to()
+  const char *text() const { return text_; }
+  int text_length() const { return text_length_; }
+  int text_level() const { return text_level_; }
+  // Bytes used by the history
+  size_t memory() const { return delta_memory_ + text_length_; }
+  size_t budget() const { return budget_; }
+};
+
+#endif // !undo_history_h
@@ -24,6 +24,8 @@
 #include "Fl_Window_Driver.H"
 #include "Fl_System_Driver.H"
 #include "Fl_Timeout.h"
+#include "Fl_Frame_Scheduler.h"
+#include "fl_trace.h"
 #include <FL/Fl_Window.H>
 #include <FL/Fl_Tooltip.H>
 #include <FL/fl_draw.H>
@@ -644,7 +646,9 @@ void Fl::redraw() {
   Causes all the windows that need it to be redrawn and graphics forced
   out through the pipes.
 
-  This is what wait() does before looking for events.
+  This is what wait() does before looking for events, unless a frame
+  rate limit set with Fl::max_fps(double) delays drawing to the next frame.
+  An explicit call of Fl::flush() draws all damaged windows immediately.
 
   Note: in multi-threaded applications you should only call Fl::flush()
   from the main thread. If a child thread needs to trigger a redraw event,
@@ -653,14 +657,23 @@ void Fl::redraw() {
 */
 void Fl::flush() {
   if (damage()) {
+    FL_TRACE_START(t);
+    double start = Fl_Frame_Scheduler::now();
+    int drawn = 0;
     damage_ = 0;
     for (Fl_X* i = Fl_X::first; i; i = i->next) {
       Fl_Window* wi = i->w;
       if (Fl_Window_Driver::driver(wi)->wait_for_expose_value) {damage_ = 1; continue;}
+      // the event loop waits until the display has shown the last frame:
+      if (Fl_Frame_Scheduler::scheduled && wi->damage() &&
+          Fl_Window_Driver::driver(wi)->frame_pending()) {damage_ = 1; continue;}
       if (!wi->visible_r()) continue;
       if (wi->damage()) {
+        FL_TRACE_START(tw);
         Fl_Window_Driver::driver(wi)->flush();
+        FL_TRACE_TYPE(tw, *wi, "flush", "damage", wi->damage());
         wi->clear_damage();
+        drawn = 1;
       }
       // destroy damage regions for windows that don't use them:
       if (i->region) {
@@ -668,8 +681,12 @@ void Fl::flush() {
         i->region = 0;
       }
     }
+    if (drawn) Fl_Frame_Scheduler::frame_drawn(start);
+    FL_TRACE(t, "Fl::flush", "frame", "drawn", drawn);
   }
+  FL_TRACE_START(tc);
   screen_driver()->flush();
+  FL_TRACE(tc, "screen flush", "commit", 0, 0);
 }
 
 
@@ -1151,11 +1168,15 @@ Fl_Event_Dispatch Fl::event_dispatch()
  */
 int Fl::handle(int e, Fl_Window* window)
 {
+  FL_TRACE_START(t);
+  int ret;
   if (e_dispatch) {
-    return e_dispatch(e, window);
+    ret = e_dispatch(e, window);
   } else {
-    return handle_(e, window);
+    ret = handle_(e, window);
   }
+  FL_TRACE(t, "Fl::handle", "handle", "event", e);
+  return ret;
 }
 
 
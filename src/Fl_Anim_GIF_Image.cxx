@@ -0,0 +1,353 @@
+//
+// Fl_Anim_GIF_Image routines.
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl.H>
+#include <FL/Fl_Anim_GIF_Image.H>
+#include <FL/Fl_RGB_Image.H>
+#include <FL/Fl_Widget.H>
+#include "Fl_Image_Reader.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// A frame of the GIF, with its compressed data, and its image once decoded
+struct Fl_Anim_GIF_Image::Frame {
+  GIF_FRAME gif;        // data and color_table are owned
+  Fl_RGB_Image *image;  // the composed logical screen, if in the cache
+};
+
+// A color_average() or desaturate() call, applied to each decoded frame
+struct Fl_Anim_GIF_Image::Effect {
+  int desaturate;
+  Fl_Color color;
+  float i;
+};
+
+size_t Fl_Anim_GIF_Image::cache_size_ = 32 * 1024 * 1024;
+
+/**
+ This constructor loads all frames of an animated GIF image from the given file.
+
+ Use Fl_Image::fail() to check if the image failed to load, like for
+ Fl_GIF_Image. A GIF file with a single image is loaded as an animation of
+ one frame.
+
+ \param[in] filename a full path and name pointing to a GIF image file.
+ */
+Fl_Anim_GIF_Image::Fl_Anim_GIF_Image(const char *filename) {
+  init_();
+  Fl_Image_Reader rdr;
+  if (rdr.open(filename) == -1) {
+    Fl::error("Fl_Anim_GIF_Image: Unable to open %s!", filename);
+    ld(ERR_FILE_ACCESS);
+    return;
+  }
+  load_(rdr);
+}
+
+/**
+ This constructor loads all frames of an animated GIF image from memory.
+
+ \param[in] imagename  A name given to this image or NULL
+ \param[in] data       Pointer to the start of the GIF image in memory.
+ \param[in] length     Length of the GIF image in memory.
+ */
+Fl_Anim_GIF_Image::Fl_Anim_GIF_Image(const char *imagename, const unsigned char *data,
+                                     const size_t length) {
+  init_();
+  Fl_Image_Reader rdr;
+  if (rdr.open(imagename, data, length) == -1) {
+    ld(ERR_FILE_ACCESS);
+    return;
+  }
+  load_(rdr);
+}
+
+/** Stops the animation and frees all frames. */
+Fl_Anim_GIF_Image::~Fl_Anim_GIF_Image() {
+  stop();
+  for (int i = 0; i < frames_count_; i++) {
+    free((void *)frames_[i].gif.data);
+    delete[] frames_[i].gif.color_table;
+    delete frames_[i].image;
+  }
+  free(frames_);
+  delete[] screen_;
+  delete[] previous_;
+  delete uncached_;
+  free(effects_);
+}
+
+// Initializes an animation without frames
+void Fl_Anim_GIF_Image::init_() {
+  frames_ = 0;
+  frames_count_ = frames_alloc_ = 0;
+  loop_count_ = -1;
+  current_ = 0;
+  composed_ = -1;
+  screen_ = previous_ = 0;
+  uncached_ = 0;
+  cached_bytes_ = 0;
+  widget_ = 0;
+  playing_ = 0;
+  loops_ = 0;
+  speed_ = 1.0;
+  effects_ = 0;
+  effects_count_ = 0;
+}
+
+// Reads the frames; the logical screen is allocated when a frame is drawn
+void Fl_Anim_GIF_Image::load_(Fl_Image_Reader &rdr) {
+  load_gif_(rdr, 1);
+  if (!frames_count_)
+    return; // load_gif_() has set the error
+
+  int W = frames_[0].gif.screen_w, H = frames_[0].gif.screen_h;
+  if (W <= 0 || H <= 0) { // no logical screen: use the area of all frames
+    for (int i = 0; i < frames_count_; i++) {
+      const GIF_FRAME &f = frames_[i].gif;
+      if (f.x + f.w > W) W = f.x + f.w;
+      if (f.y + f.h > H) H = f.y + f.h;
+    }
+  }
+  if (W <= 0 || H <= 0 || ((size_t)W) * H * 4 > Fl_RGB_Image::max_size()) {
+    ld(ERR_FORMAT);
+    return;
+  }
+  loop_count_ = frames_[0].gif.loop_count;
+  w(W);
+  h(H);
+  d(1);
+  ld(0);
+}
+
+// Keeps a copy of each frame found by load_gif_()
+int Fl_Anim_GIF_Image::on_frame_(const GIF_FRAME &frame) {
+  if (frames_count_ == frames_alloc_) {
+    frames_alloc_ = frames_alloc_ ? 2 * frames_alloc_ : 16;
+    frames_ = (Frame *)realloc(frames_, frames_alloc_ * sizeof(Frame));
+  }
+  Frame &f = frames_[frames_count_++];
+  f.gif = frame;
+  uchar *data = (uchar *)malloc(frame.length ? frame.length : 1);
+  memcpy(data, frame.data, frame.length);
+  f.gif.data = data;
+  // indexes outside the color table are black
+  uchar *colors = new uchar[3 * 256];
+  memset(colors, 0, 3 * 256);
+  memcpy(colors, frame.color_table, 3 * frame.colors);
+  f.gif.color_table = colors;
+  f.image = 0;
+  return 1;
+}
+
+// Draws frame n over the logical screen, which must hold the frames
+// before n, and keeps the result in the cache, or in uncached_ if it is
+// the current frame and the cache is full. Then disposes of the frame.
+void Fl_Anim_GIF_Image::compose_(int n) {
+  const GIF_FRAME &f = frames_[n].gif;
+  const int W = data_w(), H = data_h();
+  const size_t size = (size_t)W * H * 4;
+
+  if (f.dispose == 3) {
+    if (!previous_) previous_ = new uchar[size];
+    memcpy(previous_, screen_, size);
+  }
+
+  if (f.w > 0 && f.h > 0) {
+    uchar *pixels = new uchar[(size_t)f.w * f.h];
+    decode_frame_(f, pixels);
+    const uchar *src = pixels;
+    for (int y = 0; y < f.h; y++, src += f.w) {
+      if (f.y + y >= H) break;
+      uchar *dst = screen_ + ((size_t)(f.y + y) * W + f.x) * 4;
+      for (int x = 0; x < f.w && f.x + x < W; x++, dst += 4) {
+        int c = src[x];
+        if (c == f.transparent) continue;
+        dst[0] = f.color_table[3 * c];
+        dst[1] = f.color_table[3 * c + 1];
+        dst[2] = f.color_table[3 * c + 2];
+        dst[3] = 255;
+      }
+    }
+    delete[] pixels;
+  }
+
+  int cache = (cached_bytes_ + size <= cache_size_);
+  if (!frames_[n].image && (cache || n == current_)) {
+    uchar *copy = new uchar[size];
+    memcpy(copy, screen_, size);
+    Fl_RGB_Image *img = new Fl_RGB_Image(copy, W, H, 4);
+    img->alloc_array = 1;
+    apply_effects_(img, 0);
+    if (cache) {
+      frames_[n].image = img;
+      cached_bytes_ += size;
+    } else {
+      delete uncached_;
+      uncached_ = img;
+    }
+  }
+
+  if (f.dispose == 2) {         // restore to background: transparent
+    for (int y = f.y; y < f.y + f.h && y < H; y++) {
+      if (f.x < W)
+        memset(screen_ + ((size_t)y * W + f.x) * 4, 0, 4 * (f.x + f.w <= W ? f.w : W - f.x));
+    }
+  } else if (f.dispose == 3) {  // restore to previous
+    memcpy(screen_, previous_, size);
+  }
+  composed_ = n;
+}
+
+// Returns the image of frame n, decoding the frames before it as needed
+Fl_RGB_Image *Fl_Anim_GIF_Image::frame_image_(int n) {
+  if (n < 0 || n >= frames_count_ || fail()) return 0;
+  if (frames_[n].image) return frames_[n].image;
+  if (n == current_ && uncached_) return uncached_;
+  const size_t size = (size_t)data_w() * data_h() * 4;
+  if (!screen_) screen_ = new uchar[size];
+  if (n <= composed_ || composed_ < 0) { // start again from the first frame
+    memset(screen_, 0, size);
+    composed_ = -1;
+  }
+  while (composed_ < n) compose_(composed_ + 1);
+  return frames_[n].image ? frames_[n].image : uncached_;
+}
+
+// Applies the effects from index first on to a new frame image
+void Fl_Anim_GIF_Image::apply_effects_(Fl_RGB_Image *img, int first) const {
+  for (int i = first; i < effects_count_; i++) {
+    if (effects_[i].desaturate)
+      img->desaturate();
+    else
+      img->color_average(effects_[i].color, effects_[i].i);
+  }
+}
+
+/**
+ Sets the current frame, and redraws widget().
+ \param[in] n the index of the frame, starting with 0
+ */
+void Fl_Anim_GIF_Image::frame(int n) {
+  if (n < 0 || n >= frames_count_ || n == current_) return;
+  delete uncached_; // the image of the previous frame, if it was not cached
+  uncached_ = 0;
+  current_ = n;
+  if (widget_) widget_->redraw();
+}
+
+/**
+ Returns the time frame \p n is shown, in seconds, at speed 1.0.
+ Delays below 0.02 s are 0.1 s, like in web browsers.
+ */
+double Fl_Anim_GIF_Image::delay(int n) const {
+  if (n < 0 || n >= frames_count_) return 0.0;
+  int d = frames_[n].gif.delay;
+  return d < 2 ? 0.1 : d / 100.0;
+}
+
+/**
+ Starts playing the animation from the current frame.
+ The animation stops by itself after the number of loops stored in the GIF.
+ */
+void Fl_Anim_GIF_Image::start() {
+  if (frames_count_ < 2 || playing_) return;
+  playing_ = 1;
+  loops_ = 0;
+  Fl::add_timeout(delay(current_) / speed_, animate_, this);
+}
+
+/** Stops playing the animation, the current frame stays. */
+void Fl_Anim_GIF_Image::stop() {
+  Fl::remove_timeout(animate_, this);
+  playing_ = 0;
+}
+
+// Shows the next frame
+void Fl_Anim_GIF_Image::animate_(void *data) {
+  Fl_Anim_GIF_Image *anim = (Fl_Anim_GIF_Image *)data;
+  int n = anim->current_ + 1;
+  if (n >= anim->frames_count_) {
+    if (anim->loop_count_ < 0 || (anim->loop_count_ > 0 && anim->loops_ >= anim->loop_count_)) {
+      anim->playing_ = 0;
+      return;
+    }
+    anim->loops_++;
+    n = 0;
+  }
+  anim->frame(n);
+  Fl::repeat_timeout(anim->delay(n) / anim->speed_, animate_, data);
+}
+
+/**
+ Returns an Fl_RGB_Image of the current frame, scaled to \p W x \p H.
+ */
+Fl_Image *Fl_Anim_GIF_Image::copy(int W, int H) const {
+  Fl_RGB_Image *img = ((Fl_Anim_GIF_Image *)this)->frame_image_(current_);
+  if (!img) return new Fl_RGB_Image((const uchar *)0, 0, 0);
+  return img->copy(W, H);
+}
+
+/**
+ Blends all frames with a color, see Fl_Image::color_average().
+ */
+void Fl_Anim_GIF_Image::color_average(Fl_Color c, float i) {
+  effects_ = (Effect *)realloc(effects_, (effects_count_ + 1) * sizeof(Effect));
+  Effect &e = effects_[effects_count_++];
+  e.desaturate = 0;
+  e.color = c;
+  e.i = i;
+  for (int n = 0; n < frames_count_; n++)
+    if (frames_[n].image) apply_effects_(frames_[n].image, effects_count_ - 1);
+  if (uncached_) apply_effects_(uncached_, effects_count_ - 1);
+}
+
+/**
+ Converts all frames to grayscale, see Fl_Image::desaturate().
+ */
+void Fl_Anim_GIF_Image::desaturate() {
+  effects_ = (Effect *)realloc(effects_, (effects_count_ + 1) * sizeof(Effect));
+  Effect &e = effects_[effects_count_++];
+  e.desaturate = 1;
+  e.color = 0;
+  e.i = 0.0f;
+  for (int n = 0; n < frames_count_; n++)
+    if (frames_[n].image) apply_effects_(frames_[n].image, effects_count_ - 1);
+  if (uncached_) apply_effects_(uncached_, effects_count_ - 1);
+}
+
+/**
+ Draws the current frame, decoding it if needed.
+ */
+void Fl_Anim_GIF_Image::draw(int X, int Y, int W, int H, int cx, int cy) {
+  Fl_RGB_Image *img = frame_image_(current_);
+  if (!img) return;
+  if (img->w() != w() || img->h() != h())
+    img->scale(w(), h(), 0, 1);
+  img->draw(X, Y, W, H, cx, cy);
+}
+
+/**
+ Releases the drawing resources of all frames. The decoded frames stay
+ in the cache.
+ */
+void Fl_Anim_GIF_Image::uncache() {
+  Fl_GIF_Image::uncache();
+  for (int n = 0; n < frames_count_; n++)
+    if (frames_[n].image) frames_[n].image->uncache();
+  if (uncached_) uncached_->uncache();
+}
@@ -144,6 +144,7 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
         temp,             // Temporary color
         align,            // Alignment bytes
         dataSize,         // number of bytes in image data set
+        row_bytes,        // number of bytes in an uncompressed row
         row_order,        // 1 = normal;  -1 = flipped row order
         start_y,          // Beginning Y
         end_y;            // Ending Y
@@ -151,6 +152,7 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
   uchar bit,              // Bit in image
         byte;             // Byte in image
   uchar *ptr;             // Pointer into pixels
+  const uchar *row;       // Row of image data
   uchar colormap[256][3]; // Colormap
   uchar havemask;         // Single bit mask follows image data
   int   use_5_6_5;        // Use 5:6:5 for R:G:B channels in 16 bit images
@@ -289,70 +291,65 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
     end_y   = height;
   }
 
+  // Uncompressed rows are read whole, aligned to 32 bits
+  row_bytes = ((width * depth + 31) / 32) * 4;
+
   for (y = start_y; y != end_y; y += row_order) {
     ptr = (uchar *)array + y * width * bDepth;
 
     switch (depth)
     {
       case 1 : // Bitmap
-        for (x = width, bit = 128; x > 0; x --) {
-          if (bit == 128) byte = rdr.read_byte();
-
-          if (byte & bit) {
-            *ptr++ = colormap[1][2];
-            *ptr++ = colormap[1][1];
-            *ptr++ = colormap[1][0];
-          } else {
-            *ptr++ = colormap[0][2];
-            *ptr++ = colormap[0][1];
-            *ptr++ = colormap[0][0];
-          }
-
-          if (bit > 1)
-            bit >>= 1;
-          else
-            bit = 128;
-        }
-
-        // Read remaining bytes to align to 32 bits...
-        for (temp = (width + 7) / 8; temp & 3; temp ++) {
-          rdr.read_byte();
+        if ((row = rdr.read_span(row_bytes)) == NULL)
+          break;
+        for (x = 0; x < width; x ++) {
+          const uchar *c = colormap[(row[x >> 3] >> (7 - (x & 7))) & 1];
+          *ptr++ = c[2];
+          *ptr++ = c[1];
+          *ptr++ = c[0];
         }
         break;
 
       case 4 : // 16-color
+        if (compression != BI_RLE4) {
+          if ((row = rdr.read_span(compression ? (width + 1) / 2 : row_bytes)) == NULL)
+            break;
+          for (x = 0; x < width; x ++) {
+            const uchar *c = colormap[(x & 1) ? (row[x >> 1] & 15) : (row[x >> 1] >> 4)];
+            *ptr++ = c[2];
+            *ptr++ = c[1];
+            *ptr++ = c[0];
+          }
+          break;
+        }
+
         for (x = width, bit = 0xf0; x > 0; x --) {
           // Get a new repcount as needed...
           if (repcount == 0) {
-            if (compression != BI_RLE4) {
-              repcount = 2;
-              color = -1;
-            } else {
-              while (align > 0) {
-                align --;
-                rdr.read_byte();
-              }
+            while (align > 0) {
+              align --;
+              rdr.read_byte();
+            }
 
+            if ((repcount = rdr.read_byte()) == 0) {
               if ((repcount = rdr.read_byte()) == 0) {
-                if ((repcount = rdr.read_byte()) == 0) {
-                  // End of line...
-                  x ++;
-                  continue;
-                } else if (repcount == 1) {
-                  // End of image...
-                  break;
-                } else if (repcount == 2) {
-                  // Delta...
-                  repcount = rdr.read_byte() * rdr.read_byte() * width;
-                  color = 0;
-                } else {
-                  // Absolute...
-                  color = -1;
-                  align = ((4 - (repcount & 3)) / 2) & 1;
-                }
+                // End of line...
+                x ++;
+                continue;
+              } else if (repcount == 1) {
+                // End of image...
+                break;
+              } else if (repcount == 2) {
+                // Delta...
+                repcount = rdr.read_byte() * rdr.read_byte() * width;
+                color = 0;
               } else {
-                color = rdr.read_byte();
+                // Absolute...
+                color = -1;
+                align = ((4 - (repcount & 3)) / 2) & 1;
               }
+            } else {
+              color = rdr.read_byte();
             }
           }
 
@@ -381,24 +378,23 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
           }
 
         }
-        CHECK_ERROR
+        break;
 
-        if (!compression) {
-          // Read remaining bytes to align to 32 bits...
-          for (temp = (width + 1) / 2; temp & 3; temp ++) {
-            rdr.read_byte();
+      case 8 : // 256-color
+        if (compression != BI_RLE8) {
+          if ((row = rdr.read_span(compression ? width : row_bytes)) == NULL)
+            break;
+          for (x = 0; x < width; x ++, ptr += bDepth) {
+            const uchar *c = colormap[row[x]];
+            ptr[0] = c[2];
+            ptr[1] = c[1];
+            ptr[2] = c[0];
           }
+          break;
         }
-        break;
 
-      case 8 : // 256-color
         for (x = width; x > 0; x --) {
           // Get a new repcount as needed...
-          if (compression != BI_RLE8) {
-            repcount = 1;
-            color = -1;
-          }
-
           if (repcount == 0) {
             while (align > 0) {
               align --;
@@ -441,18 +437,13 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
           *ptr++ = colormap[temp][0];
           if (havemask) ptr++;
         }
-
-        if (!compression) {
-          // Read remaining bytes to align to 32 bits...
-          for (temp = width; temp & 3; temp ++) {
-            rdr.read_byte();
-          }
-        }
         break;
 
       case 16 : // 16-bit 5:5:5 or 5:6:5 RGB
-        for (x = width; x > 0; x --, ptr += bDepth) {
-          uchar b = rdr.read_byte(), a = rdr.read_byte() ;
+        if ((row = rdr.read_span(row_bytes)) == NULL)
+          break;
+        for (x = width; x > 0; x --, ptr += bDepth, row += 2) {
+          uchar b = row[0], a = row[1];
           if (use_5_6_5) {
             ptr[2] = (uchar)(( b << 3 ) & 0xf8);
             ptr[1] = (uchar)(((a << 5) & 0xe0) | ((b >> 3) & 0x1c));
@@ -463,32 +454,26 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
             ptr[0] = (uchar)((a<<1) & 0xf8);
           }
         }
-
-        // Read remaining bytes to align to 32 bits...
-        for (temp = width * 2; temp & 3; temp ++) {
-          rdr.read_byte();
-        }
         break;
 
       case 24 : // 24-bit RGB
-        for (x = width; x > 0; x --, ptr += bDepth) {
-          ptr[2] = rdr.read_byte();
-          ptr[1] = rdr.read_byte();
-          ptr[0] = rdr.read_byte();
-        }
-
-        // Read remaining bytes to align to 32 bits...
-        for (temp = width * 3; temp & 3; temp ++) {
-          rdr.read_byte();
+        if ((row = rdr.read_span(row_bytes)) == NULL)
+          break;
+        for (x = width; x > 0; x --, ptr += bDepth, row += 3) {
+          ptr[2] = row[0];
+          ptr[1] = row[1];
+          ptr[0] = row[2];
         }
         break;
 
       case 32 : // 32-bit RGBA
-        for (x = width; x > 0; x --, ptr += bDepth) {
-          ptr[2] = rdr.read_byte();
-          ptr[1] = rdr.read_byte();
-          ptr[0] = rdr.read_byte();
-          ptr[3] = rdr.read_byte();
+        if ((row = rdr.read_span(row_bytes)) == NULL)
+          break;
+        for (x = width; x > 0; x --, ptr += bDepth, row += 4) {
+          ptr[2] = row[0];
+          ptr[1] = row[1];
+          ptr[0] = row[2];
+          ptr[3] = row[3];
         }
         break;
     }
@@ -496,22 +481,17 @@ void Fl_BMP_Image::load_bmp_(Fl_Image_Reader &rdr)
   }
 
   if (havemask) {
+    row_bytes = ((width + 31) / 32) * 4;
     for (y = height - 1; y >= 0; y --) {
+      if ((row = rdr.read_span(row_bytes)) == NULL)
+        break;
       ptr = (uchar *)array + y * width * bDepth + 3;
-      for (x = width, bit = 128; x > 0; x --, ptr += bDepth) {
-        if (bit == 128) byte = rdr.read_byte();
-        if (byte & bit)
+      for (x = 0; x < width; x ++, ptr += bDepth) {
+        if ((row[x >> 3] >> (7 - (x & 7))) & 1)
           *ptr = 0;
         else
           *ptr = 255;
-        if (bit > 1)
-          bit >>= 1;
-        else
-          bit = 128;
       }
-      // Read remaining bytes to align to 32 bits...
-      for (temp = (width + 7) / 8; temp & 3; temp ++)
-        rdr.read_byte();
     }
   }
 
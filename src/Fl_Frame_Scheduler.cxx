@@ -0,0 +1,149 @@
+//
+// Frame scheduler for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include "Fl_Frame_Scheduler.h"
+#include "Fl_System_Driver.H"
+#include "Fl_Screen_Driver.H"
+
+/**
+  \file Fl_Frame_Scheduler.cxx
+*/
+
+// static class variables
+
+double Fl_Frame_Scheduler::max_fps_ = 0.0;
+double Fl_Frame_Scheduler::last_frame_ = 0.0;
+int Fl_Frame_Scheduler::deferred_ = 0;
+int Fl_Frame_Scheduler::frames_ = 0;
+int Fl_Frame_Scheduler::deferrals_ = 0;
+double Fl_Frame_Scheduler::total_time_ = 0.0;
+double Fl_Frame_Scheduler::max_time_ = 0.0;
+int Fl_Frame_Scheduler::scheduled = 0;
+
+double Fl_Frame_Scheduler::now() {
+  time_t sec;
+  int usec;
+  Fl::system_driver()->gettime(&sec, &usec);
+  return double(sec) + usec / 1000000.;
+}
+
+// Wakes the event loop up, which then draws the frame
+void Fl_Frame_Scheduler::frame_timeout(void *) {
+  deferred_ = 0;
+}
+
+void Fl_Frame_Scheduler::flush() {
+  if (max_fps_ > 0.0 && Fl::damage()) {
+    double delay = last_frame_ + 1.0 / max_fps_ - now();
+    if (delay > 1.0 / max_fps_) // the clock was set back
+      delay = 0.0;
+    if (delay > 0.0) {
+      deferrals_++;
+      if (!deferred_) {
+        deferred_ = 1;
+        Fl::add_timeout(delay, frame_timeout);
+      }
+      Fl::screen_driver()->flush();
+      return;
+    }
+  }
+  scheduled = (max_fps_ > 0.0);
+  Fl::flush();
+  scheduled = 0;
+}
+
+void Fl_Frame_Scheduler::frame_drawn(double start) {
+  double t = now() - start;
+  if (t < 0.0) t = 0.0;
+  last_frame_ = start;
+  frames_++;
+  total_time_ += t;
+  if (t > max_time_) max_time_ = t;
+}
+
+/**
+  Limits how often the event loop draws the windows.
+
+  By default the event loop draws all damaged windows whenever it has
+  handled all pending events, so that a burst of redraw() calls, for
+  instance from Fl::awake() callbacks of a thread that delivers data, can
+  draw the windows many times per display frame.
+
+  With a limit, the event loop draws the windows at most \p fps times per
+  second. The damage of all redraw() calls between two frames is drawn
+  at once. Choose the refresh rate of the display to draw once per display
+  frame, or a lower rate to save processing time. On platforms that report
+  when the display has shown a frame of a window (Wayland), the event loop
+  also waits for that before it draws the window again.
+
+  The limit does not apply to explicit calls of Fl::flush(), which always
+  draw all damaged windows at once. Use Fl::flush() to present an urgent
+  change immediately; the next frame then follows one interval later.
+
+  \param[in] fps  maximum number of frames per second, 0 for no limit
+
+  \see Fl::frame_stats()
+  \since 1.4.0
+*/
+void Fl::max_fps(double fps) {
+  Fl_Frame_Scheduler::max_fps_ = fps > 0.0 ? fps : 0.0;
+  if (Fl_Frame_Scheduler::deferred_) { // draw the pending frame now
+    Fl::remove_timeout(Fl_Frame_Scheduler::frame_timeout);
+    Fl_Frame_Scheduler::deferred_ = 0;
+  }
+}
+
+/**
+  Returns the maximum number of frames per second, or 0 for no limit.
+  \see Fl::max_fps(double)
+  \since 1.4.0
+*/
+double Fl::max_fps() {
+  return Fl_Frame_Scheduler::max_fps_;
+}
+
+/**
+  Returns statistics about the frames drawn.
+
+  A frame is a call of Fl::flush(), by the event loop or by the program,
+  that drew at least one window. Any of the pointers may be NULL.
+
+  \param[out] frames    number of frames
+  \param[out] total     total time spent drawing these frames in seconds
+  \param[out] max       time spent drawing the slowest frame in seconds
+  \param[out] deferred  number of times the event loop moved drawing to
+                        the next frame because of Fl::max_fps()
+
+  \see Fl::reset_frame_stats()
+  \since 1.4.0
+*/
+void Fl::frame_stats(int *frames, double *total, double *max, int *deferred) {
+  if (frames) *frames = Fl_Frame_Scheduler::frames_;
+  if (total) *total = Fl_Frame_Scheduler::total_time_;
+  if (max) *max = Fl_Frame_Scheduler::max_time_;
+  if (deferred) *deferred = Fl_Frame_Scheduler::deferrals_;
+}
+
+/**
+  Resets the statistics returned by Fl::frame_stats() to zero.
+  \since 1.4.0
+*/
+void Fl::reset_frame_stats() {
+  Fl_Frame_Scheduler::frames_ = 0;
+  Fl_Frame_Scheduler::deferrals_ = 0;
+  Fl_Frame_Scheduler::total_time_ = 0.0;
+  Fl_Frame_Scheduler::max_time_ = 0.0;
+}
@@ -0,0 +1,79 @@
+//
+// Frame scheduler header file for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#ifndef _src_Fl_Frame_Scheduler_h_
+#define _src_Fl_Frame_Scheduler_h_
+
+#include <FL/Fl.H>
+
+/** \file
+  Fl_Frame_Scheduler handling.
+
+  This file contains the implementations of:
+
+  - Fl::max_fps()
+  - Fl::frame_stats()
+  - Fl::reset_frame_stats()
+
+  and related methods of class Fl_Frame_Scheduler.
+*/
+
+/**
+  Class Fl_Frame_Scheduler decides when the event loop draws the windows.
+
+  The platform drivers call flush() instead of Fl::flush() when the event
+  loop goes idle. Without a frame rate limit (the default) this calls
+  Fl::flush(). With a limit, it draws the windows at most once per frame
+  interval: damage from redraw() calls within an interval is collected,
+  and a timeout wakes the event loop up to draw it at the next frame.
+  Windows whose last frame the display has not shown yet (see
+  Fl_Window_Driver::frame_pending()) are drawn later.
+
+  Fl::flush() reports each frame it draws to frame_drawn(), so that an
+  explicit Fl::flush() counts as a frame and starts a new interval.
+*/
+class Fl_Frame_Scheduler {
+
+  static double max_fps_;       // frame rate limit, 0 = none
+  static double last_frame_;    // start time of the last frame
+  static int deferred_;         // 1 if the frame timeout is pending
+  static int frames_;           // number of frames drawn
+  static int deferrals_;        // number of flushes moved to a later frame
+  static double total_time_;    // total time spent drawing frames
+  static double max_time_;      // time spent drawing the slowest frame
+
+  static void frame_timeout(void *);
+
+public:
+  // 1 while the event loop draws a frame
+  static int scheduled;
+
+  // Returns the current time in seconds
+  static double now();
+
+  // Draws the windows, called by the event loop instead of Fl::flush()
+  static void flush();
+
+  // Returns whether damage waits for the next frame
+  static int deferred() { return deferred_; }
+
+  // Records a frame drawn by Fl::flush() that started at the given time
+  static void frame_drawn(double start);
+
+  friend class Fl;
+};
+
+#endif // _src_Fl_Frame_Scheduler_h_
@@ -94,10 +94,12 @@ static int gif_error(Fl_Image_Reader &rdr, int line, uchar *Image) {
   This macro is used to check for end of file (EOF) or other read errors.
   In case of a read error or EOF an error message is issued and the image
   loading is terminated with error code ERR_FORMAT.
+  The macro frees the LZW data buffer (Data) of load_gif_() as well.
   This calls gif_error (see above) to avoid code duplication.
 */
 #define CHECK_ERROR \
   if (gif_error(rdr, __LINE__, Image)) { \
+    free(Data); \
     ld(ERR_FORMAT); \
     return; \
   }
@@ -205,17 +207,200 @@ Fl_GIF_Image::Fl_GIF_Image(const char *imagename, const unsigned char *data) :
   }
 }
 
+/*
+  This constructor creates an empty image, for subclasses that call
+  load_gif_() themselves.
+*/
+Fl_GIF_Image::Fl_GIF_Image() :
+  Fl_Pixmap((char *const*)0)
+{
+}
+
+/*
+  This helper function reads the data sub-blocks that follow into buf,
+  growing it as needed, until the block terminator or the end of the data.
+  It returns the number of data bytes read.
+*/
+static size_t read_sub_blocks(Fl_Image_Reader &rdr, uchar *&buf, size_t &bufsize) {
+  size_t n = 0;
+  for (;;) {
+    int blocklen = rdr.read_byte();
+    if (rdr.error() || blocklen == 0)
+      return n;
+    if (n + blocklen > bufsize) {
+      bufsize = bufsize ? 2 * bufsize : 4096;
+      buf = (uchar *)realloc(buf, bufsize);
+    }
+    n += rdr.read(buf + n, blocklen);
+    if (rdr.error())
+      return n;
+  }
+}
+
+/*
+  This function decodes LZW compressed GIF data into npixels color indexes,
+  in the order of the data. Codes are read from the buffer through a bit
+  accumulator, and each string is written directly in its place in the image,
+  last character first, using the length stored for each code.
+  It sets count to the number of pixels decoded, and returns 1 if the end
+  code was found, or if the image is complete and another code follows,
+  0 if the data ended before, and -1 if an invalid code was found.
+*/
+static int lzw_decode(const uchar *src, size_t length, int MinCodeSize,
+                      uchar *Image, size_t npixels, size_t &count) {
+  // tables used by LZW decompressor:
+  unsigned short Prefix[4096];  // code of the string without its last character
+  unsigned short Length[4096];  // length of the string
+  uchar Suffix[4096];           // last character of the string
+  uchar First[4096];            // first character of the string
+
+  count = 0;
+  if (MinCodeSize < 1 || MinCodeSize > 11)
+    return -1;
+
+  const int ClearCode = (1 << MinCodeSize);
+  const int EOFCode = ClearCode + 1;
+  for (int i = 0; i < ClearCode; i++) {
+    Prefix[i] = 0;
+    Length[i] = 1;
+    Suffix[i] = First[i] = (uchar)i;
+  }
+  int CodeSize = MinCodeSize + 1;
+  int ReadMask = (1 << CodeSize) - 1;
+  int FreeCode = ClearCode + 2;
+  int OldCode = -1;
+
+  const uchar *end = src + length;
+  unsigned int bits = 0; // bits read but not used yet
+  int nbits = 0;         // number of these bits
+  uchar *p = Image;
+  uchar *eoi = Image + npixels;
+  int ret = 1;
+
+  while (p < eoi) {
+    // Fetch the next code from the raster data stream. The codes can be
+    // any length from 3 to 12 bits, packed into 8-bit bytes.
+    while (nbits < CodeSize) {
+      if (src >= end) {
+        ret = 0;
+        goto done;
+      }
+      bits |= (unsigned int)(*src++) << nbits;
+      nbits += 8;
+    }
+    int CurCode = bits & ReadMask;
+    bits >>= CodeSize;
+    nbits -= CodeSize;
+
+    if (CurCode == ClearCode) {
+      CodeSize = MinCodeSize + 1;
+      ReadMask = (1 << CodeSize) - 1;
+      FreeCode = ClearCode + 2;
+      OldCode = -1;
+      continue;
+    }
+
+    if (CurCode == EOFCode)
+      break;
+
+    int code, len;
+    if (CurCode < FreeCode) {
+      code = CurCode;
+      len = Length[code];
+    } else if (CurCode == FreeCode && OldCode >= 0) {
+      code = OldCode;           // the string of OldCode and its first character
+      len = Length[code] + 1;
+    } else {
+      ret = -1;
+      break;
+    }
+
+    // write the string from its end, ignoring the excess beyond the image
+    uchar *q = p + len;
+    if (code != CurCode) {
+      --q;
+      if (q < eoi) *q = First[code];
+    }
+    for (int c = code; q > p; c = Prefix[c]) {
+      --q;
+      if (q < eoi) *q = Suffix[c];
+    }
+    p = (len < eoi - p) ? p + len : eoi;
+
+    if (OldCode >= 0 && FreeCode < 4096) {
+      Prefix[FreeCode] = (unsigned short)OldCode;
+      Suffix[FreeCode] = First[code];
+      First[FreeCode] = First[OldCode];
+      Length[FreeCode] = Length[OldCode] + 1;
+      FreeCode++;
+      if (FreeCode > ReadMask && CodeSize < 12) {
+        CodeSize++;
+        ReadMask = (1 << CodeSize) - 1;
+      }
+    }
+    OldCode = CurCode;
+  }
+
+  // a complete image is still truncated if the data ends before the next
+  // code, which should be the end code
+  if (ret == 1 && p >= eoi && (size_t)(end - src) * 8 + nbits < (size_t)CodeSize)
+    ret = 0;
+
+done:
+  count = p - Image;
+  return ret;
+}
+
+/*
+  This method decodes the LZW data of a frame into frame.w * frame.h color
+  indexes, one byte per pixel, in rows from top to bottom. Pixels missing
+  from the data are set to the transparent index, or to 0.
+  It returns 1 if the data was complete, 0 if it was truncated, and -1 if
+  invalid data was found.
+*/
+int Fl_GIF_Image::decode_frame_(const GIF_FRAME &frame, uchar *pixels) {
+  size_t npixels = (size_t)frame.w * frame.h;
+  size_t count;
+  int ret = lzw_decode(frame.data, frame.length, frame.code_size, pixels, npixels, count);
+  if (count < npixels)
+    memset(pixels + count, frame.transparent >= 0 ? frame.transparent : 0, npixels - count);
+
+  if (frame.interlace && frame.h > 1) {
+    // rows are stored every 8th from row 0, every 8th from row 4,
+    // every 4th from row 2, then every 2nd from row 1
+    static const int start[4] = { 0, 4, 2, 1 };
+    static const int step[4]  = { 8, 8, 4, 2 };
+    uchar *rows = new uchar[npixels];
+    memcpy(rows, pixels, npixels);
+    const uchar *row = rows;
+    for (int pass = 0; pass < 4; pass++) {
+      for (int y = start[pass]; y < frame.h; y += step[pass]) {
+        memcpy(pixels + (size_t)y * frame.w, row, frame.w);
+        row += frame.w;
+      }
+    }
+    delete[] rows;
+  }
+  return ret;
+}
+
 /*
   This method reads GIF image data and creates an RGB or RGBA image. The GIF
   format supports only 1 bit for alpha. The final image data is stored in
   a modified XPM format (Fl_GIF_Image is a subclass of Fl_Pixmap).
   To avoid code duplication, we use an Fl_Image_Reader that reads data from
   either a file or from memory.
+
+  If anim is not 0, the image is not created. Instead, on_frame_() is called
+  for each image of the GIF data, so that subclasses can decode all images of
+  an animated GIF.
 */
-void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
+void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr, int anim)
 {
   char **new_data;      // Data array
   uchar *Image = 0L;    // internal temporary image data array
+  uchar *Data = 0L;     // LZW data of the current frame
+  size_t DataSize = 0;  // allocated size of Data
   w(0); h(0);
 
   // printf("\nFl_GIF_Image::load_gif_ : %s\n", rdr.name());
@@ -231,18 +416,18 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
       Fl::warning("%s is version %c%c%c.",rdr.name(),b[3],b[4],b[5]);
   }
 
-  int Width = rdr.read_word();
-  int Height = rdr.read_word();
+  int ScreenWidth = rdr.read_word();
+  int ScreenHeight = rdr.read_word();
 
   uchar ch = rdr.read_byte();
   CHECK_ERROR
   char HasColormap = ((ch & 0x80) != 0);
-  int BitsPerPixel = (ch & 7) + 1;
-  int ColorMapSize;
+  int GlobalBitsPerPixel = (ch & 7) + 1;
+  int GlobalColorMapSize;
   if (HasColormap) {
-    ColorMapSize = 2 << (ch & 7);
+    GlobalColorMapSize = 2 << (ch & 7);
   } else {
-    ColorMapSize = 0;
+    GlobalColorMapSize = 0;
   }
   // int OriginalResolution = ((ch>>4)&7)+1;
   // int SortedTable = (ch&8)!=0;
@@ -251,26 +436,33 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
   CHECK_ERROR
 
   // Read in global colormap:
+  uchar GlobalColors[3*256]; // RGB triplets
+  if (HasColormap)
+    rdr.read(GlobalColors, 3*GlobalColorMapSize);
+  CHECK_ERROR
+
+  // Values of the Graphic Control Extension, for the next image
   uchar transparent_pixel = 0;
   char has_transparent = 0;
-  uchar Red[256], Green[256], Blue[256]; /* color map */
-  if (HasColormap) {
-    for (int i=0; i < ColorMapSize; i++) {
-      Red[i] = rdr.read_byte();
-      Green[i] = rdr.read_byte();
-      Blue[i] = rdr.read_byte();
-    }
-  }
-  CHECK_ERROR
+  int delay = 0;
+  int dispose = 0;
+
+  int loop_count = -1;  // from the Netscape Application Extension
+  int frames = 0;       // number of images passed to on_frame_()
 
-  int CodeSize;         /* Code size, init from GIF header, increases... */
-  char Interlace;
+  GIF_FRAME frame;      // the image found
+  uchar Colors[3*256];  // its color table
+  int ColorMapSize = 0;
+  int BitsPerPixel = 0;
+  int truncated = 0;    // its data ends with the GIF data
 
   // Main parser loop: parse "blocks" until an image is found or error
 
   for (;;) {
 
     int i = rdr.read_byte();
+    if (frames && rdr.error()) // animation without trailer
+      break;
     CHECK_ERROR
     int blocklen;
 
@@ -282,14 +474,28 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
       if (ch == 0xF9 && blocklen == 4) {      // Graphic Control Extension
         // printf("Graphic Control Extension at offset %ld\n", rdr.tell()-2);
         char bits = rdr.read_byte();          // Packed Fields
-        rdr.read_word();                      // Delay Time
+        delay = rdr.read_word();              // Delay Time
         transparent_pixel = rdr.read_byte();  // Transparent Color Index
         blocklen = rdr.read_byte();           // Block Terminator (must be zero)
         CHECK_ERROR
         if (bits & 1) has_transparent = 1;
+        dispose = (bits >> 2) & 7;            // Disposal Method
       }
       else if (ch == 0xFF) {                  // Application Extension
         // printf("Application Extension at offset %ld, length = %d\n", rdr.tell()-3, blocklen);
+        if (blocklen == 11) {
+          char id[11];
+          for (int k = 0; k < 11; k++) id[k] = rdr.read_byte();
+          blocklen = rdr.read_byte();
+          CHECK_ERROR
+          if ((!memcmp(id, "NETSCAPE2.0", 11) || !memcmp(id, "ANIMEXTS1.0", 11)) && blocklen == 3) {
+            int sub_id = rdr.read_byte();     // 1: Loop Count
+            int loops = rdr.read_word();
+            blocklen = rdr.read_byte();
+            CHECK_ERROR
+            if (sub_id == 1) loop_count = loops;
+          }
+        }
         ; // skip data
       }
       else if (ch == 0xFE) {                  // Comment Extension
@@ -307,31 +513,94 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
       }
     } else if (i == 0x2c) {       // an image: Image Descriptor follows
       // printf("Image Descriptor at offset %ld\n", rdr.tell());
-      rdr.read_word();          // Image Left Position
-      rdr.read_word();          // Image Top Position
-      Width = rdr.read_word();  // Image Width
-      Height = rdr.read_word(); // Image Height
-      ch = rdr.read_byte();     // Packed Fields
+      frame.x = rdr.read_word();  // Image Left Position
+      frame.y = rdr.read_word();  // Image Top Position
+      frame.w = rdr.read_word();  // Image Width
+      frame.h = rdr.read_word();  // Image Height
+      ch = rdr.read_byte();       // Packed Fields
       CHECK_ERROR
-      Interlace = ((ch & 0x40) != 0);
+      frame.interlace = ((ch & 0x40) != 0);
+      BitsPerPixel = GlobalBitsPerPixel;
+      ColorMapSize = GlobalColorMapSize;
+      memcpy(Colors, GlobalColors, 3*ColorMapSize);
       if (ch & 0x80) {          // image has local color table
         // printf("Local Color Table at offset %ld\n", rdr.tell());
         BitsPerPixel = (ch & 7) + 1;
         ColorMapSize = 2 << (ch & 7);
-        for (i=0; i < ColorMapSize; i++) {
-          Red[i] = rdr.read_byte();
-          Green[i] = rdr.read_byte();
-          Blue[i] = rdr.read_byte();
-        }
+        rdr.read(Colors, 3*ColorMapSize);
       }
       CHECK_ERROR
-      break; // okay, this is the image we want
+
+      // read image data
+
+      // printf("Image Data at offset %ld\n", rdr.tell());
+
+      int CodeSize = rdr.read_byte() + 1; // LZW Minimum Code Size
+      CHECK_ERROR
+
+      if (BitsPerPixel >= CodeSize) { // Workaround for broken GIF files...
+        BitsPerPixel = CodeSize - 1;
+        ColorMapSize = 1 << BitsPerPixel;
+      }
+
+      // Fix images w/o color table. The standard allows this and lets the
+      // decoder choose a default color table. The standard recommends the
+      // first two color table entries should be black and white.
+
+      if (ColorMapSize == 0) { // no global and no local color table
+        Fl::warning("%s does not have a color table, using default.\n", rdr.name());
+        BitsPerPixel = CodeSize - 1;
+        ColorMapSize = 1 << BitsPerPixel;
+        Colors[0] = Colors[1] = Colors[2] = 0;    // black
+        Colors[3] = Colors[4] = Colors[5] = 255;  // white
+        for (int k = 2; k < ColorMapSize; k++) {
+          Colors[3*k] = Colors[3*k+1] = Colors[3*k+2] = (uchar)(255 * k / (ColorMapSize - 1));
+        }
+      }
+
+      // Fix transparent pixel index outside ColorMap (Issue #271)
+      if (has_transparent && transparent_pixel >= ColorMapSize) {
+        for (int k = ColorMapSize; k <= transparent_pixel; k++)
+          Colors[3*k] = Colors[3*k+1] = Colors[3*k+2] = 0xff; // white (color is irrelevant)
+        ColorMapSize = transparent_pixel + 1;
+      }
+
+      // now read the LZW compressed image data, without the block counts
+
+      frame.length = read_sub_blocks(rdr, Data, DataSize);
+      truncated = rdr.error();
+
+      frame.screen_w = ScreenWidth;
+      frame.screen_h = ScreenHeight;
+      frame.loop_count = loop_count;
+      frame.delay = delay;
+      frame.dispose = dispose;
+      frame.transparent = has_transparent ? transparent_pixel : -1;
+      frame.code_size = CodeSize - 1;
+      frame.colors = ColorMapSize;
+      frame.color_table = Colors;
+      frame.data = Data;
+
+      if (!anim)
+        break; // okay, this is the image we want
+
+      frames++;
+      if (!on_frame_(frame) || truncated)
+        break;
+      has_transparent = 0;
+      delay = 0;
+      dispose = 0;
+      continue;   // the data sub-blocks have been read
     } else if (i == 0x3b) {       // Trailer (end of GIF data)
       // printf("Trailer found at offset %ld\n", rdr.tell());
+      if (frames)
+        break;
       Fl::error("%s: no image data found.", rdr.name());
       ld(ERR_NO_IMAGE); // this GIF file is "empty" (no image)
       return;           // terminate
     } else {
+      if (frames)         // keep the images found so far
+        break;
       Fl::error("%s: unknown GIF code 0x%02x at offset %ld", rdr.name(), i, rdr.tell()-1);
       ld(ERR_FORMAT); // broken file
       return;         // terminate
@@ -346,175 +615,23 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
     // printf("End of data (sub)blocks at offset %ld\n", rdr.tell());
   }
 
-  // read image data
-
-  // printf("Image Data at offset %ld\n", rdr.tell());
-
-  CodeSize = rdr.read_byte() + 1; // LZW Minimum Code Size
-  CHECK_ERROR
-
-  if (BitsPerPixel >= CodeSize) { // Workaround for broken GIF files...
-    BitsPerPixel = CodeSize - 1;
-    ColorMapSize = 1 << BitsPerPixel;
+  if (anim) {
+    free(Data);
+    return;
   }
 
-  // Fix images w/o color table. The standard allows this and lets the
-  // decoder choose a default color table. The standard recommends the
-  // first two color table entries should be black and white.
-
-  if (ColorMapSize == 0) { // no global and no local color table
-    Fl::warning("%s does not have a color table, using default.\n", rdr.name());
-    BitsPerPixel = CodeSize - 1;
-    ColorMapSize = 1 << BitsPerPixel;
-    Red[0] = Green[0] = Blue[0] = 0;    // black
-    Red[1] = Green[1] = Blue[1] = 255;  // white
-    for (int i = 2; i < ColorMapSize; i++) {
-      Red[i] = Green[i] = Blue[i] = (uchar)(255 * i / (ColorMapSize - 1));
-    }
-  }
-
-  // Fix transparent pixel index outside ColorMap (Issue #271)
-  if (has_transparent && transparent_pixel >= ColorMapSize) {
-    for (int k = ColorMapSize; k <= transparent_pixel; k++)
-      Red[k] = Green[k] = Blue[k] = 0xff; // white (color is irrelevant)
-    ColorMapSize = transparent_pixel + 1;
-  }
-
-#if (0) // TEST/DEBUG: fill color table to maximum size
-  for (int i = ColorMapSize; i < 256; i++) {
-    Red[i] = Green[i] = Blue[i] = 0; // black
-  }
-#endif
-
-  CHECK_ERROR
-
-  // now read the LZW compressed image data
-
+  const int Width = frame.w;
+  const int Height = frame.h;
   Image = new uchar[Width*Height];
 
-  int YC = 0, Pass = 0; /* Used to de-interlace the picture */
-  uchar *p = Image;
-  uchar *eol = p+Width;
-
-  int InitCodeSize = CodeSize;
-  int ClearCode = (1 << (CodeSize-1));
-  int EOFCode = ClearCode + 1;
-  int FirstFree = ClearCode + 2;
-  int FinChar = 0;
-  int ReadMask = (1<<CodeSize) - 1;
-  int FreeCode = FirstFree;
-  int OldCode = ClearCode;
-
-  // tables used by LZW decompressor:
-  short int Prefix[4096];
-  uchar Suffix[4096];
-
-  int blocklen = rdr.read_byte();
-  uchar thisbyte = rdr.read_byte(); blocklen--;
-  CHECK_ERROR
-  int frombit = 0;
-
-  // loop to read LZW compressed image data
-
-  for (;;) {
-
-    /* Fetch the next code from the raster data stream.  The codes can be
-     * any length from 3 to 12 bits, packed into 8-bit bytes, so we have to
-     * maintain our location as a pointer and a bit offset.
-     * In addition, GIF adds totally useless and annoying block counts
-     * that must be correctly skipped over. */
-    int CurCode = thisbyte;
-    if (frombit+CodeSize > 7) {
-      if (blocklen <= 0) {
-        blocklen = rdr.read_byte();
-        CHECK_ERROR
-        if (blocklen <= 0) break;
-      }
-      thisbyte = rdr.read_byte(); blocklen--;
-      CHECK_ERROR
-      CurCode |= thisbyte<<8;
-    }
-    if (frombit+CodeSize > 15) {
-      if (blocklen <= 0) {
-        blocklen = rdr.read_byte();
-        CHECK_ERROR
-        if (blocklen <= 0) break;
-      }
-      thisbyte = rdr.read_byte(); blocklen--;
-      CHECK_ERROR
-      CurCode |= thisbyte<<16;
-    }
-    CurCode = (CurCode>>frombit)&ReadMask;
-    frombit = (frombit+CodeSize)%8;
-
-    if (CurCode == ClearCode) {
-      CodeSize = InitCodeSize;
-      ReadMask = (1<<CodeSize) - 1;
-      FreeCode = FirstFree;
-      OldCode = ClearCode;
-      continue;
-    }
-
-    if (CurCode == EOFCode)
-      break;
-
-    uchar OutCode[4097]; // temporary array for reversing codes
-    uchar *tp = OutCode;
-    int i;
-    if (CurCode < FreeCode) {
-      i = CurCode;
-    } else if (CurCode == FreeCode) {
-      *tp++ = (uchar)FinChar;
-      i = OldCode;
-    } else {
-      Fl::error("Fl_GIF_Image: %s - LZW Barf at offset %ld", rdr.name(), rdr.tell());
-      break;
-    }
-
-    while (i >= ColorMapSize) {
-      if (i < FreeCode) {
-        *tp++ = Suffix[i];
-        i = Prefix[i];
-      } else { // FIXME - should never happen (?)
-        Fl::error("Fl_GIF_Image: %s - i(%d) >= FreeCode (%d) at offset %ld",
-                  rdr.name(), i, FreeCode, rdr.tell());
-        // NOTREACHED
-        i = FreeCode - 1; // fix broken index ???
-        break;
-      }
-    }
-    *tp++ = FinChar = i;
-    do {
-      *p++ = *--tp;
-      if (p >= eol) {
-        if (!Interlace) YC++;
-        else switch (Pass) {
-          case 0: YC += 8; if (YC >= Height) {Pass++; YC = 4;} break;
-          case 1: YC += 8; if (YC >= Height) {Pass++; YC = 2;} break;
-          case 2: YC += 4; if (YC >= Height) {Pass++; YC = 1;} break;
-          case 3: YC += 2; break;
-        }
-        if (YC>=Height) YC=0; /* cheap bug fix when excess data */
-        p = Image + YC*Width;
-        eol = p+Width;
-      }
-    } while (tp > OutCode);
-
-    if (OldCode != ClearCode) {
-      if (FreeCode < 4096) {
-        Prefix[FreeCode] = (short)OldCode;
-        Suffix[FreeCode] = FinChar;
-        FreeCode++;
-      }
-      if (FreeCode > ReadMask) {
-        if (CodeSize < 12) {
-          CodeSize++;
-          ReadMask = (1 << CodeSize) - 1;
-        }
-      }
-    }
-    OldCode = CurCode;
+  int ret = decode_frame_(frame, Image);
+  free(Data);
+  Data = 0L;
+  if (ret == 0 && truncated) {
+    CHECK_ERROR
   }
+  if (ret < 0)
+    Fl::error("Fl_GIF_Image: %s - LZW Barf at offset %ld", rdr.name(), rdr.tell());
 
   // We are done reading the image, now convert to xpm
 
@@ -526,6 +643,7 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
   new_data = new char*[Height+2];
 
   // transparent pixel must be zero, swap if it isn't:
+  uchar *p;
   if (has_transparent && transparent_pixel != 0) {
     // swap transparent pixel with zero
     p = Image+Width*Height;
@@ -533,27 +651,27 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
       if (*p==transparent_pixel) *p = 0;
       else if (!*p) *p = transparent_pixel;
     }
-    uchar t;
-    t                        = Red[0];
-    Red[0]                   = Red[transparent_pixel];
-    Red[transparent_pixel]   = t;
-
-    t                        = Green[0];
-    Green[0]                 = Green[transparent_pixel];
-    Green[transparent_pixel] = t;
-
-    t                        = Blue[0];
-    Blue[0]                  = Blue[transparent_pixel];
-    Blue[transparent_pixel]  = t;
+    for (int k = 0; k < 3; k++) {
+      uchar t                         = Colors[k];
+      Colors[k]                       = Colors[3*transparent_pixel+k];
+      Colors[3*transparent_pixel+k]   = t;
+    }
   }
 
   // find out what colors are actually used:
   uchar used[256]; uchar remap[256];
   int i;
-  for (i = 0; i < ColorMapSize; i++) used[i] = 0;
+  for (i = 0; i < 256; i++) used[i] = 0;
   p = Image+Width*Height;
   while (p-- > Image) used[*p] = 1;
 
+  // color indexes outside the color table are black
+  for (i = ColorMapSize; i < 256; i++) if (used[i]) {
+    for (int k = ColorMapSize; k <= i; k++)
+      Colors[3*k] = Colors[3*k+1] = Colors[3*k+2] = 0;
+    ColorMapSize = i + 1;
+  }
+
   // remap them to start with printing characters:
   int base = has_transparent && used[0] ? ' ' : ' '+1;
   int numcolors = 0;
@@ -562,19 +680,19 @@ void Fl_GIF_Image::load_gif_(Fl_Image_Reader &rdr)
     numcolors++;
   }
 
-  // write the first line of xpm data (use suffix as temp array):
-  int length = sprintf((char*)(Suffix),
-                       "%d %d %d %d",Width,Height,-numcolors,1);
+  // write the first line of xpm data:
+  char header[64];
+  int length = sprintf(header, "%d %d %d %d",Width,Height,-numcolors,1);
   new_data[0] = new char[length+1];
-  strcpy(new_data[0], (char*)Suffix);
+  strcpy(new_data[0], header);
 
   // write the colormap
   new_data[1] = (char*)(p = new uchar[4*numcolors]);
   for (i = 0; i < ColorMapSize; i++) if (used[i]) {
     *p++ = remap[i];
-    *p++ = Red[i];
-    *p++ = Green[i];
-    *p++ = Blue[i];
+    *p++ = Colors[3*i];
+    *p++ = Colors[3*i+1];
+    *p++ = Colors[3*i+2];
   }
 
   // remap the image data:
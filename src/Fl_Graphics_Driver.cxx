@@ -30,6 +30,7 @@
 #include <FL/math.h>
 #include <FL/platform.H>
 #include <stdlib.h>
+#include <string.h> // memcmp(), memcpy()
 
 FL_EXPORT Fl_Graphics_Driver *fl_graphics_driver; // the current driver of graphics operations
 
@@ -52,11 +53,13 @@ Fl_Graphics_Driver::Fl_Graphics_Driver()
   scale_ = 1;
   p_size = 0;
   xpoint = NULL;
+  width_cache_ = NULL;
 };
 
 /** Destructor */
 Fl_Graphics_Driver::~Fl_Graphics_Driver() {
   if (xpoint) free(xpoint);
+  free(width_cache_);
 }
 
 
@@ -601,6 +604,123 @@ double Fl_Graphics_Driver::width(unsigned int c) {
   return width(buf, fl_utf8encode (c, buf));
 }
 
+
+unsigned Fl_Graphics_Driver::font_changes_ = 0;
+
+// Memoized string widths of a graphics driver
+struct Fl_Graphics_Driver::Width_Cache {
+  enum { SLOTS = 1024, MAX_LENGTH = 48, FONTS = 8 };
+  struct Entry { // the width of a string
+    Fl_Font_Descriptor *font;
+    float scale;
+    unsigned hash;
+    int length;
+    double width;
+    char text[MAX_LENGTH];
+  };
+  struct Ascii_Widths { // the widths of the printable ASCII characters of a font
+    Fl_Font_Descriptor *font;
+    float scale;
+    double width[0x7f - 0x20];
+  };
+  unsigned font_changes;
+  unsigned long hits, misses, sums;
+  Ascii_Widths ascii[FONTS];
+  Entry entries[SLOTS];
+};
+
+
+/** Compute the width of the first \p n bytes of the string \p str if drawn with current font.
+ This is what fl_width(const char*, int) does. Widths of strings of up to 48 bytes are remembered
+ in a table of 1024 entries, so computing again the width of a recently measured string in the
+ same font is fast. If has_additive_text_width() is true, the width of a string of printable
+ ASCII characters is computed as the sum of the remembered widths of its characters.
+ */
+double Fl_Graphics_Driver::cached_width(const char *str, int n) {
+  Fl_Font_Descriptor *fd = font_descriptor();
+  if (!fd || !str || n <= 0) return width(str, n);
+  if (!width_cache_ || width_cache_->font_changes != font_changes_) {
+    Width_Cache *c = (Width_Cache*)calloc(1, sizeof(Width_Cache));
+    c->font_changes = font_changes_;
+    if (width_cache_) { // keep the statistics
+      c->hits = width_cache_->hits;
+      c->misses = width_cache_->misses;
+      c->sums = width_cache_->sums;
+      free(width_cache_);
+    }
+    width_cache_ = c;
+  }
+  Width_Cache *c = width_cache_;
+  float s = scale();
+  if (has_additive_text_width()) {
+    int i = 0;
+    while (i < n && str[i] >= 0x20 && str[i] < 0x7f) i++;
+    if (i == n) { // printable ASCII only
+      Width_Cache::Ascii_Widths *a = c->ascii + ((fl_uintptr_t)fd / sizeof(void*)) % Width_Cache::FONTS;
+      if (a->font != fd || a->scale != s) {
+        a->font = fd;
+        a->scale = s;
+        for (i = 0; i < 0x7f - 0x20; i++) a->width[i] = -1;
+      }
+      double w = 0;
+      for (i = 0; i < n; i++) {
+        double *cw = a->width + (str[i] - 0x20);
+        if (*cw < 0) *cw = width((unsigned)str[i]);
+        w += *cw;
+      }
+      c->sums++;
+      return w;
+    }
+  }
+  if (n > Width_Cache::MAX_LENGTH) return width(str, n);
+  unsigned hash = 2166136261U; // FNV-1a
+  for (int i = 0; i < n; i++) hash = (hash ^ (uchar)str[i]) * 16777619U;
+  hash = (hash ^ (unsigned)((fl_uintptr_t)fd / sizeof(void*))) * 16777619U;
+  Width_Cache::Entry *e = c->entries + hash % Width_Cache::SLOTS;
+  if (e->font == fd && e->scale == s && e->hash == hash && e->length == n && !memcmp(e->text, str, n)) {
+    c->hits++;
+    return e->width;
+  }
+  c->misses++;
+  double w = width(str, n);
+  if (w >= 0) {
+    e->font = fd;
+    e->scale = s;
+    e->hash = hash;
+    e->length = n;
+    e->width = w;
+    memcpy(e->text, str, n);
+  }
+  return w;
+}
+
+
+/** Returns whether the width of any string is the sum of the widths of its characters.
+ This is true when the driver does not apply kerning nor ligatures to text.
+ The default implementation returns 0.
+ */
+int Fl_Graphics_Driver::has_additive_text_width() { return 0; }
+
+
+/** Gives statistics of cached_width().
+ \param[out] hits number of widths found in the table of recent strings
+ \param[out] misses number of widths computed and added to that table
+ \param[out] sums number of widths computed as the sum of character widths
+ */
+void Fl_Graphics_Driver::width_cache_stats(unsigned long &hits, unsigned long &misses, unsigned long &sums) {
+  hits = (width_cache_ ? width_cache_->hits : 0);
+  misses = (width_cache_ ? width_cache_->misses : 0);
+  sums = (width_cache_ ? width_cache_->sums : 0);
+}
+
+
+/** Makes all drivers forget the widths remembered by cached_width().
+ This is called when fonts are changed by Fl::set_font().
+ */
+void Fl_Graphics_Driver::reset_width_caches() {
+  font_changes_++;
+}
+
 /** Return the current line height */
 int Fl_Graphics_Driver::height() { return size(); }
 
@@ -22,10 +22,13 @@
 
 #include <FL/Fl_Group.H>
 #include "Fl_Window_Driver.H"
+#include "fl_trace.h"
 #include <FL/Fl_Rect.H>
 #include <FL/fl_draw.H>
 
 #include <stdlib.h> // malloc etc.
+#include <string.h> // memmove()
+#include <math.h>   // sqrt()
 
 Fl_Group* Fl_Group::current_;
 
@@ -46,11 +49,27 @@ Fl_Widget*const* Fl_Group::array() const {
   Searches the child array for the widget and returns the index.
 
   Returns children() if the widget is NULL or not found.
+
+  The search starts at the index the widget got when it was added to the
+  group, and moves outwards from there. Adding or removing other children
+  moves a child by a few places at most in the common case, and remove()
+  updates the index of the child that takes the place of the removed one,
+  so this usually takes constant time, even when the children are removed
+  or deleted first to last.
 */
 int Fl_Group::find(const Fl_Widget* o) const {
+  if (!o || !children_) return children_;
   Fl_Widget*const* a = array();
-  int i; for (i=0; i < children_; i++) if (*a++ == o) break;
-  return i;
+  int i = o->index_;
+  if (i < 0 || i >= children_) i = children_ - 1;
+  for (int d = 0; ; d++) {
+    if (i + d < children_) {
+      if (a[i + d] == o) return i + d;
+    } else if (i - d < 0) {
+      return children_;
+    }
+    if (d && i - d >= 0 && a[i - d] == o) return i - d;
+  }
 }
 
 // Some (* which? *) compilers / toolchains can't export the static
@@ -142,11 +161,233 @@ static int navkey() {
   return 0;
 }
 
+////////////////////////////////////////////////////////////////
+// Spatial index of the children of a group, see spatial_index(int)
+
+// Groups with fewer children look at all of them
+#define SPATIAL_INDEX_MIN_CHILDREN 32
+// Children overlapping more cells are looked at for every query
+#define SPATIAL_INDEX_MAX_CELLS 16
+// Lists of children found by a query are allocated if they are longer
+#define SPATIAL_INDEX_BUFFER_SIZE 64
+
+// A uniform grid of cells, with the indices of the children overlapping
+// each cell in ascending order. It is rebuilt by the first query after
+// it became invalid.
+class Fl_Group_Spatial_Index {
+  int x_, y_;           // position of the first cell
+  int cell_;            // width and height of a cell
+  int cols_, rows_;     // number of cells
+  int *starts_;         // first entry in items_ of each cell, and the end
+  int *items_;          // children overlapping each cell
+  int *always_;         // children that are looked at for every query:
+  int nalways_;         // too big for the grid, empty, or outside labels
+  int *big_;            // children that are too big for the grid, ascending
+  int nbig_;
+  void clear();
+  void build(const Fl_Group *g);
+  int cells(int X, int Y, int W, int H, int &c0, int &r0, int &c1, int &r1) const;
+public:
+  int valid;            // 0 if the grid must be rebuilt
+  Fl_Group_Spatial_Index() : starts_(0), items_(0), always_(0), big_(0), valid(0) {}
+  ~Fl_Group_Spatial_Index() { clear(); }
+  Fl_Widget **find(const Fl_Group *g, int X, int Y, int &n, Fl_Widget **buffer);
+  Fl_Widget **find_clipped(const Fl_Group *g, int &n, Fl_Widget **buffer);
+};
+
+void Fl_Group_Spatial_Index::clear() {
+  free(starts_); starts_ = 0;
+  free(items_); items_ = 0;
+  free(always_); always_ = 0;
+  free(big_); big_ = 0;
+  nalways_ = nbig_ = 0;
+  cols_ = rows_ = 0;
+}
+
+// Computes the range of cells overlapping a rectangle, returns 0 if
+// there are none
+int Fl_Group_Spatial_Index::cells(int X, int Y, int W, int H,
+                                  int &c0, int &r0, int &c1, int &r1) const {
+  if (W <= 0 || H <= 0) return 0;
+  X -= x_; Y -= y_;
+  if (X + W <= 0 || Y + H <= 0 || X >= cols_*cell_ || Y >= rows_*cell_) return 0;
+  c0 = X < 0 ? 0 : X / cell_;
+  r0 = Y < 0 ? 0 : Y / cell_;
+  c1 = (X + W - 1) / cell_; if (c1 >= cols_) c1 = cols_ - 1;
+  r1 = (Y + H - 1) / cell_; if (r1 >= rows_) r1 = rows_ - 1;
+  return 1;
+}
+
+void Fl_Group_Spatial_Index::build(const Fl_Group *g) {
+  clear();
+  int n = g->children();
+  Fl_Widget*const* a = g->array();
+  always_ = (int*)malloc(n * sizeof(int));
+  big_ = (int*)malloc(n * sizeof(int));
+  // the grid covers the children with a size, with about one child per cell
+  int L = 0, T = 0, R = 0, B = 0, count = 0, i;
+  for (i = 0; i < n; i++) {
+    Fl_Widget *o = a[i];
+    if (o->w() <= 0 || o->h() <= 0) continue;
+    if (!count || o->x() < L) L = o->x();
+    if (!count || o->y() < T) T = o->y();
+    if (!count || o->x() + o->w() > R) R = o->x() + o->w();
+    if (!count || o->y() + o->h() > B) B = o->y() + o->h();
+    count++;
+  }
+  x_ = L; y_ = T;
+  cell_ = count ? (int)sqrt((double)(R - L) * (B - T) / count) : 1;
+  if (cell_ < 1) cell_ = 1;
+  for (;;) {
+    cols_ = (R - L + cell_ - 1) / cell_;
+    rows_ = (B - T + cell_ - 1) / cell_;
+    if ((double)cols_ * rows_ <= 4.0 * count + 64) break;
+    cell_ *= 2;
+  }
+  int ncells = cols_ * rows_;
+  starts_ = (int*)calloc(ncells + 1, sizeof(int));
+  // count the children of each cell, then let starts_ point to the end
+  // of each cell and fill the cells backwards
+  int c0, r0, c1, r1, c, r, total = 0;
+  for (i = 0; i < n; i++) {
+    Fl_Widget *o = a[i];
+    Fl_Align al = o->align();
+    if (!cells(o->x(), o->y(), o->w(), o->h(), c0, r0, c1, r1) ||
+        ((al & 15) && !(al & FL_ALIGN_INSIDE))) {
+      always_[nalways_++] = i;
+      continue;
+    }
+    if ((c1 - c0 + 1) * (r1 - r0 + 1) > SPATIAL_INDEX_MAX_CELLS) {
+      always_[nalways_++] = i;
+      big_[nbig_++] = i;
+      continue;
+    }
+    for (r = r0; r <= r1; r++)
+      for (c = c0; c <= c1; c++) starts_[r * cols_ + c]++;
+  }
+  for (c = 0; c < ncells; c++) { total += starts_[c]; starts_[c] = total; }
+  starts_[ncells] = total;
+  items_ = (int*)malloc((total ? total : 1) * sizeof(int));
+  for (i = n; i--;) {
+    Fl_Widget *o = a[i];
+    Fl_Align al = o->align();
+    if (!cells(o->x(), o->y(), o->w(), o->h(), c0, r0, c1, r1) ||
+        ((al & 15) && !(al & FL_ALIGN_INSIDE)) ||
+        (c1 - c0 + 1) * (r1 - r0 + 1) > SPATIAL_INDEX_MAX_CELLS) continue;
+    for (r = r0; r <= r1; r++)
+      for (c = c0; c <= c1; c++) items_[--starts_[r * cols_ + c]] = i;
+  }
+  valid = 1;
+}
+
+// Returns the children that may contain the point X, Y in the order of
+// the group and their number in n, or NULL if all children must be looked
+// at. The children are stored in buffer, which holds SPATIAL_INDEX_BUFFER_SIZE
+// widgets, or in an allocated array if there are more.
+Fl_Widget **Fl_Group_Spatial_Index::find(const Fl_Group *g, int X, int Y, int &n,
+                                         Fl_Widget **buffer) {
+  if (g->children() < SPATIAL_INDEX_MIN_CHILDREN) return 0;
+  if (!valid) build(g);
+  Fl_Widget*const* a = g->array();
+  const int *p = big_, *pe = big_ + nbig_, *q = 0, *qe = 0;
+  int c0, r0, c1, r1;
+  if (cells(X, Y, 1, 1, c0, r0, c1, r1)) {
+    q = items_ + starts_[r0 * cols_ + c0];
+    qe = items_ + starts_[r0 * cols_ + c0 + 1];
+  }
+  int size = nbig_ + int(qe - q);
+  Fl_Widget **list = buffer;
+  if (size > SPATIAL_INDEX_BUFFER_SIZE)
+    list = (Fl_Widget**)malloc(size * sizeof(Fl_Widget*));
+  // merge the big children and the children of the cell
+  n = 0;
+  while (p < pe || q < qe) {
+    if (q >= qe || (p < pe && *p < *q)) list[n++] = a[*p++];
+    else list[n++] = a[*q++];
+  }
+  return list;
+}
+
+static int compare_indices(const void *a, const void *b) {
+  return *(const int*)a - *(const int*)b;
+}
+
+// Returns the children that may be inside the clip region in the order
+// of the group and their number in n, or NULL if all children must be
+// looked at. The children are stored like those found by find().
+Fl_Widget **Fl_Group_Spatial_Index::find_clipped(const Fl_Group *g, int &n,
+                                                 Fl_Widget **buffer) {
+  if (g->children() < SPATIAL_INDEX_MIN_CHILDREN) return 0;
+  if (!valid) build(g);
+  int X, Y, W, H, c0, r0, c1, r1, r, i, size = nalways_;
+  fl_clip_box(x_, y_, cols_ * cell_, rows_ * cell_, X, Y, W, H);
+  int incells = cells(X, Y, W, H, c0, r0, c1, r1);
+  if (incells) {
+    // drawing most of the group is faster without the grid
+    if ((c1 - c0 + 1) * (r1 - r0 + 1) * 2 > cols_ * rows_) return 0;
+    for (r = r0; r <= r1; r++)
+      size += starts_[r * cols_ + c1 + 1] - starts_[r * cols_ + c0];
+  }
+  int local[SPATIAL_INDEX_BUFFER_SIZE];
+  int *indices = local;
+  if (size > SPATIAL_INDEX_BUFFER_SIZE)
+    indices = (int*)malloc(size * sizeof(int));
+  n = 0;
+  if (incells) {
+    for (r = r0; r <= r1; r++) {
+      for (i = starts_[r * cols_ + c0]; i < starts_[r * cols_ + c1 + 1]; i++)
+        indices[n++] = items_[i];
+    }
+  }
+  for (i = 0; i < nalways_; i++) indices[n++] = always_[i];
+  // sort them and remove the children found in several cells
+  qsort(indices, n, sizeof(int), compare_indices);
+  Fl_Widget*const* a = g->array();
+  int m = 0;
+  for (i = 0; i < n; i++)
+    if (!i || indices[i] != indices[i - 1]) m++;
+  Fl_Widget **list = buffer;
+  if (m > SPATIAL_INDEX_BUFFER_SIZE)
+    list = (Fl_Widget**)malloc(m * sizeof(Fl_Widget*));
+  m = 0;
+  for (i = 0; i < n; i++)
+    if (!i || indices[i] != indices[i - 1]) list[m++] = a[indices[i]];
+  if (indices != local) free(indices);
+  n = m;
+  return list;
+}
+
+// Holds the children of a group that a query of its spatial index
+// returned, in the order of the group. Short lists are kept in buffer_,
+// so that most events don't allocate memory.
+class Fl_Group_Children {
+  Fl_Widget **list_;
+  Fl_Widget *buffer_[SPATIAL_INDEX_BUFFER_SIZE];
+public:
+  Fl_Group_Children() : list_(0) {}
+  ~Fl_Group_Children() { if (list_ != buffer_) free(list_); }
+  // Replaces a and n by the children that may contain X, Y
+  void find(const Fl_Group *g, Fl_Group_Spatial_Index *index, int X, int Y,
+            Fl_Widget*const* &a, int &n) {
+    if (index && (list_ = index->find(g, X, Y, n, buffer_)) != 0) a = list_;
+  }
+  // Replaces a and n by the children that may be inside the clip region
+  void find_clipped(const Fl_Group *g, Fl_Group_Spatial_Index *index,
+                    Fl_Widget*const* &a, int &n) {
+    if (index && (list_ = index->find_clipped(g, n, buffer_)) != 0) a = list_;
+  }
+};
+
+void Fl_Group::invalidate_spatial_index_() {
+  if (spatial_index_) spatial_index_->valid = 0;
+}
+
 int Fl_Group::handle(int event) {
 
   Fl_Widget*const* a = array();
-  int i;
+  int i, n = children();
   Fl_Widget* o;
+  Fl_Group_Children below; // the children below the pointer, if indexed
 
   switch (event) {
 
@@ -188,7 +429,8 @@ int Fl_Group::handle(int event) {
 
   case FL_ENTER:
   case FL_MOVE:
-    for (i = children(); i--;) {
+    below.find(this, spatial_index_, Fl::event_x(), Fl::event_y(), a, n);
+    for (i = n; i--;) {
       o = a[i];
       if (o->visible() && Fl::event_inside(o)) {
         if (o->contains(Fl::belowmouse())) {
@@ -204,7 +446,8 @@ int Fl_Group::handle(int event) {
 
   case FL_DND_ENTER:
   case FL_DND_DRAG:
-    for (i = children(); i--;) {
+    below.find(this, spatial_index_, Fl::event_x(), Fl::event_y(), a, n);
+    for (i = n; i--;) {
       o = a[i];
       if (o->takesevents() && Fl::event_inside(o)) {
         if (o->contains(Fl::belowmouse())) {
@@ -219,7 +462,8 @@ int Fl_Group::handle(int event) {
     return 0;
 
   case FL_PUSH:
-    for (i = children(); i--;) {
+    below.find(this, spatial_index_, Fl::event_x(), Fl::event_y(), a, n);
+    for (i = n; i--;) {
       o = a[i];
       if (o->takesevents() && Fl::event_inside(o)) {
         Fl_Widget_Tracker wp(o);
@@ -237,7 +481,8 @@ int Fl_Group::handle(int event) {
     if (o == this) return 0;
     else if (o) send(o,event);
     else {
-      for (i = children(); i--;) {
+      below.find(this, spatial_index_, Fl::event_x(), Fl::event_y(), a, n);
+      for (i = n; i--;) {
         o = a[i];
         if (o->takesevents() && Fl::event_inside(o)) {
           if (send(o,event)) return 1;
@@ -357,6 +602,7 @@ Fl_Group::Fl_Group(int X,int Y,int W,int H,const char *l)
   resizable_ = this;
   bounds_ = 0; // this is allocated when first resize() is done
   sizes_ = 0; // see bounds_ (FLTK 1.3 compatibility)
+  spatial_index_ = 0; // see spatial_index(int)
 
   // Subclasses may want to construct child objects as part of their
   // constructor, so make sure they are add()'d to this object.
@@ -444,6 +690,7 @@ Fl_Group::~Fl_Group() {
   if (current_ == this)
     end();
   clear();
+  delete spatial_index_;
 }
 
 /**
@@ -474,13 +721,58 @@ void Fl_Group::insert(Fl_Widget &o, int index) {
     if (!(children_ & (children_-1))) // double number of children
       array_ = (Fl_Widget**)realloc((void*)array_,
                                     2*children_*sizeof(Fl_Widget*));
-    int j; for (j = children_; j > index; j--) array_[j] = array_[j-1];
-    array_[j] = &o;
+    if (index > children_) index = children_;
+    memmove(array_ + index + 1, array_ + index, (children_ - index) * sizeof(Fl_Widget*));
+    array_[index] = &o;
   }
+  o.index_ = index < children_ ? index : children_;
   children_++;
   init_sizes();
 }
 
+/**
+  Adds \p n widgets to the end of the group.
+
+  This does the same as calling add(Fl_Widget&) for each widget in turn,
+  but the array of children grows only once, and init_sizes() is called
+  only once. Use this to fill a group with many children.
+
+  The widgets are removed from their current groups (if any) first.
+  The array must not contain a widget twice.
+
+  \param[in] widgets  array of the widgets to add
+  \param[in] n        number of widgets in the array
+
+  \since 1.4.0
+*/
+void Fl_Group::add(Fl_Widget*const* widgets, int n) {
+  int i;
+  for (i = 0; i < n; i++)
+    if (widgets[i]->parent()) widgets[i]->parent()->remove(*widgets[i]);
+  if (n <= 0) return;
+  int total = children_ + n;
+  if (total == 1) { // use array pointer to point at single child
+    add(*widgets[0]);
+    return;
+  }
+  int size = 2; // like insert(), use the next power of two
+  while (size < total) size *= 2;
+  if (children_ <= 1) {
+    Fl_Widget* t = child1_;
+    array_ = (Fl_Widget**)malloc(size*sizeof(Fl_Widget*));
+    if (children_) array_[0] = t;
+  } else {
+    array_ = (Fl_Widget**)realloc((void*)array_, size*sizeof(Fl_Widget*));
+  }
+  for (i = 0; i < n; i++) {
+    Fl_Widget* o = widgets[i];
+    o->parent_ = this;
+    o->index_ = children_;
+    array_[children_++] = o;
+  }
+  init_sizes();
+}
+
 /**
   The widget is removed from its current group (if any) and then added
   to the end of this group.
@@ -512,8 +804,11 @@ void Fl_Group::remove(int index) {
     Fl_Widget *t = array_[!index];
     free((void*)array_);
     child1_ = t;
+    t->index_ = 0;
   } else if (children_ > 1) { // delete from array
-    for (; index < children_; index++) array_[index] = array_[index+1];
+    memmove(array_ + index, array_ + index + 1, (children_ - index) * sizeof(Fl_Widget*));
+    // the next child is the one most likely to be removed next
+    if (index < children_) array_[index]->index_ = index;
   }
   init_sizes();
 }
@@ -606,6 +901,41 @@ void Fl_Group::init_sizes() {
   bounds_ = 0;
   delete[] sizes_;      // FLTK 1.3 compatibility
   sizes_ = 0;           // FLTK 1.3 compatibility
+  invalidate_spatial_index_();
+}
+
+/**
+  Enables or disables a spatial index of the children of the group.
+
+  By default the group looks at all of its children to find the children
+  below the mouse pointer and the children that must be drawn. This is
+  fast enough for most groups, but not for groups with many thousand
+  children, for instance a grid of indicators.
+
+  The spatial index sorts the children into a grid of cells of about the
+  size of a child. With the index, the group only looks at the children in
+  the cell below the pointer for FL_ENTER, FL_MOVE, FL_PUSH, FL_DRAG,
+  FL_RELEASE, FL_DND_ENTER and FL_DND_DRAG events, and draw_children()
+  only looks at the children in the cells inside the current clip region.
+  Events are sent and children are drawn exactly as without the index.
+  Groups with fewer than 32 children do not use the index.
+
+  The index is built when it is first needed, and again after a child
+  has been added, removed or resized, or init_sizes() has been called.
+  If you change the position, size, or label alignment of a child without
+  calling its resize() method, call init_sizes().
+
+  \param[in] on  1 to enable, 0 to disable the index (default)
+
+  \since 1.4.0
+*/
+void Fl_Group::spatial_index(int on) {
+  if (!on) {
+    delete spatial_index_;
+    spatial_index_ = 0;
+  } else if (!spatial_index_) {
+    spatial_index_ = new Fl_Group_Spatial_Index;
+  }
 }
 
 /**
@@ -816,6 +1146,8 @@ void Fl_Group::resize(int X, int Y, int W, int H) {
 */
 void Fl_Group::draw_children() {
   Fl_Widget*const* a = array();
+  int n = children_;
+  Fl_Group_Children clipped; // the children inside the clip region, if indexed
 
   if (clip_children()) {
     fl_push_clip(x() + Fl::box_dx(box()),
@@ -824,14 +1156,15 @@ void Fl_Group::draw_children() {
                  h() - Fl::box_dh(box()));
   }
 
+  clipped.find_clipped(this, spatial_index_, a, n);
   if (damage() & ~FL_DAMAGE_CHILD) { // redraw the entire thing:
-    for (int i=children_; i--;) {
+    for (int i=n; i--;) {
       Fl_Widget& o = **a++;
       draw_child(o);
       draw_outside_label(o);
     }
   } else {      // only redraw the children that need it:
-    for (int i=children_; i--;) update_child(**a++);
+    for (int i=n; i--;) update_child(**a++);
   }
 
   if (clip_children()) fl_pop_clip();
@@ -856,7 +1189,9 @@ void Fl_Group::draw() {
 void Fl_Group::update_child(Fl_Widget& widget) const {
   if (widget.damage() && widget.visible() && widget.type() < FL_WINDOW &&
       fl_not_clipped(widget.x(), widget.y(), widget.w(), widget.h())) {
+    FL_TRACE_START(t);
     widget.draw();
+    FL_TRACE_TYPE(t, widget, "draw", "damage", widget.damage());
     widget.clear_damage();
   }
 }
@@ -871,7 +1206,9 @@ void Fl_Group::draw_child(Fl_Widget& widget) const {
   if (widget.visible() && widget.type() < FL_WINDOW &&
       fl_not_clipped(widget.x(), widget.y(), widget.w(), widget.h())) {
     widget.clear_damage(FL_DAMAGE_ALL);
+    FL_TRACE_START(t);
     widget.draw();
+    FL_TRACE_TYPE(t, widget, "draw", "damage", widget.damage());
     widget.clear_damage();
   }
 }
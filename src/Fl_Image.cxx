@@ -21,6 +21,7 @@
 #include <FL/Fl_Menu_Item.H>
 #include <FL/Fl_Image.H>
 #include "flstring.h"
+#include "fl_scale_image.h"
 
 void fl_restore_clip(); // from fl_rect.cxx
 
@@ -32,6 +33,8 @@ Fl_RGB_Scaling Fl_Image::RGB_scaling_ = FL_RGB_SCALING_NEAREST;
 
 Fl_RGB_Scaling Fl_Image::scaling_algorithm_ = FL_RGB_SCALING_BILINEAR;
 
+int Fl_Image::RGB_scaling_threads_ = 0;
+
 /**
  The constructor creates an empty image with the specified
  width, height, and depth. The width and height are in pixels.
@@ -243,6 +246,9 @@ Fl_Image::measure(const Fl_Label *lo,           // I - Label
 
 /** Sets the RGB image scaling method used for copy(int, int).
     Applies to all RGB images, defaults to FL_RGB_SCALING_NEAREST.
+    FL_RGB_SCALING_AREA is best to reduce images by large factors;
+    images enlarged in both directions are scaled with FL_RGB_SCALING_BILINEAR.
+    \see RGB_scaling_threads(int)
 */
 void Fl_Image::RGB_scaling(Fl_RGB_Scaling method) {
   RGB_scaling_ = method;
@@ -253,6 +259,24 @@ Fl_RGB_Scaling Fl_Image::RGB_scaling() {
   return RGB_scaling_;
 }
 
+/** Sets the maximum number of threads that scale an RGB image at the same time.
+ Fl_RGB_Image::copy(int, int) cuts large images in bands of lines scaled
+ by separate threads with the FL_RGB_SCALING_BILINEAR and FL_RGB_SCALING_AREA
+ methods. The default value 0 uses one thread per processor, 1 scales
+ images in the calling thread only.
+ \version 1.4.0
+ */
+void Fl_Image::RGB_scaling_threads(int n) {
+  RGB_scaling_threads_ = (n < 0 ? 0 : n);
+}
+
+/** Returns the maximum number of threads that scale an RGB image at the same time.
+ \see RGB_scaling_threads(int)
+ */
+int Fl_Image::RGB_scaling_threads() {
+  return RGB_scaling_threads_;
+}
+
 /** Sets the drawing size of the image.
  This function controls the values returned by member functions w() and h()
  which in turn control how the image is drawn: the full image data (whose size
@@ -499,67 +523,8 @@ Fl_Image *Fl_RGB_Image::copy(int W, int H) const {
       }
     }
   } else {
-    // Bilinear scaling (FL_RGB_SCALING_BILINEAR)
-    const float xscale = (data_w() - 1) / (float) W;
-    const float yscale = (data_h() - 1) / (float) H;
-    for (dy = 0; dy < H; dy++) {
-      float oldy = dy * yscale;
-      if (oldy >= data_h())
-        oldy = float(data_h() - 1);
-      const float yfract = oldy - (unsigned) oldy;
-
-      for (dx = 0; dx < W; dx++) {
-        new_ptr = new_array + dy * W * d() + dx * d();
-
-        float oldx = dx * xscale;
-        if (oldx >= data_w())
-          oldx = float(data_w() - 1);
-        const float xfract = oldx - (unsigned) oldx;
-
-        const unsigned leftx = (unsigned)oldx;
-        const unsigned lefty = (unsigned)oldy;
-        const unsigned rightx = (unsigned)(oldx + 1 >= data_w() ? oldx : oldx + 1);
-        const unsigned righty = (unsigned)oldy;
-        const unsigned dleftx = (unsigned)oldx;
-        const unsigned dlefty = (unsigned)(oldy + 1 >= data_h() ? oldy : oldy + 1);
-        const unsigned drightx = (unsigned)rightx;
-        const unsigned drighty = (unsigned)dlefty;
-
-        uchar left[4], right[4], downleft[4], downright[4];
-        memcpy(left, array + lefty * line_d + leftx * d(), d());
-        memcpy(right, array + righty * line_d + rightx * d(), d());
-        memcpy(downleft, array + dlefty * line_d + dleftx * d(), d());
-        memcpy(downright, array + drighty * line_d + drightx * d(), d());
-
-        int i;
-        if (d() == 4) {
-          for (i = 0; i < 3; i++) {
-            left[i] = (uchar)(left[i] * left[3] / 255.0f);
-            right[i] = (uchar)(right[i] * right[3] / 255.0f);
-            downleft[i] = (uchar)(downleft[i] * downleft[3] / 255.0f);
-            downright[i] = (uchar)(downright[i] * downright[3] / 255.0f);
-          }
-        }
-
-        const float leftf = 1 - xfract;
-        const float rightf = xfract;
-        const float upf = 1 - yfract;
-        const float downf = yfract;
-
-        for (i = 0; i < d(); i++) {
-          new_ptr[i] = (uchar)((left[i] * leftf +
-                   right[i] * rightf) * upf +
-                   (downleft[i] * leftf +
-                   downright[i] * rightf) * downf);
-        }
-
-        if (d() == 4 && new_ptr[3]) {
-          for (i = 0; i < 3; i++) {
-            new_ptr[i] = (uchar)(new_ptr[i] / (new_ptr[3] / 255.0f));
-          }
-        }
-      }
-    }
+    // Bilinear scaling or area averaging, maybe in several threads
+    fl_scale_image(array, data_w(), data_h(), d(), line_d, new_array, W, H, Fl_Image::RGB_scaling());
   }
 
   return new_image;
@@ -0,0 +1,123 @@
+//
+// Incremental image decoder for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl_Image_Decoder.H>
+#include <FL/Fl_Widget.H>
+#include <FL/Fl.H>
+
+#include <string.h>
+
+/** Creates an empty decoder. */
+Fl_Image_Decoder::Fl_Image_Decoder()
+: Fl_RGB_Image(0, 0, 0)
+{
+  widget_ = 0;
+  callback_ = 0;
+  callback_data_ = 0;
+  pass_ = 0;
+  rows_ = 0;
+  changed_ = 0;
+  complete_ = 0;
+  error_ = 0;
+}
+
+/** Frees the image and the data not decoded yet. */
+Fl_Image_Decoder::~Fl_Image_Decoder() {
+}
+
+/**
+ Decodes the next \p n bytes of the image data.
+
+ The new rows are stored in the image, then the widget is redrawn and the
+ callback is called if there are any.
+ \return 0, or the error that stopped decoding, which fail() returns too.
+ Data written after the image is complete or after an error is ignored.
+ */
+int Fl_Image_Decoder::write(const void *data, size_t n) {
+  if (error_) return error_;
+  if (complete_ || !n) return 0;
+  int err = decode_((const unsigned char *)data, n);
+  if (err) failed_(err);
+  notify_();
+  return error_;
+}
+
+/**
+ Tells the decoder that all image data has been written.
+
+ If the data ended before the end of the image, the decoder fails with
+ ERR_FORMAT and frees the partly decoded image, whatever the image format.
+ \return 0 if the image is complete, otherwise the error, which fail() returns too.
+ */
+int Fl_Image_Decoder::close() {
+  if (error_ || complete_) return error_;
+  int err = decode_(NULL, 0);
+  if (!err && !complete_) err = ERR_FORMAT; // truncated image
+  if (err) failed_(err);
+  notify_();
+  return error_;
+}
+
+/**
+ Allocates the W x H pixels of depth D of the image, initially all 0.
+ Decoders call this once they know the image size.
+ \return 0, or ERR_FORMAT if the image is larger than Fl_RGB_Image::max_size()
+ */
+int Fl_Image_Decoder::allocate_(int W, int H, int D) {
+  if (W <= 0 || H <= 0 || D <= 0 || ((size_t)W) * H * D > max_size()) return ERR_FORMAT;
+  size_t size = ((size_t)W) * H * D;
+  uchar *pixels = new uchar[size];
+  memset(pixels, 0, size);
+  if (alloc_array) delete[] (uchar *)array;
+  array = pixels;
+  alloc_array = 1;
+  w(W); h(H); d(D); ld(0);
+  changed_ = 1;
+  return 0;
+}
+
+/** Records that the first \p rows rows of pass \p pass are decoded. */
+void Fl_Image_Decoder::decoded_(int pass, int rows) {
+  pass_ = pass;
+  rows_ = rows;
+  changed_ = 1;
+}
+
+/** Records that the whole image is decoded. */
+void Fl_Image_Decoder::completed_() {
+  complete_ = 1;
+  rows_ = h();
+  changed_ = 1;
+}
+
+// Frees the image after an error
+void Fl_Image_Decoder::failed_(int err) {
+  error_ = err;
+  if (alloc_array) delete[] (uchar *)array;
+  array = 0;
+  alloc_array = 0;
+  w(0); h(0); d(0); ld(err);
+  changed_ = 1;
+}
+
+// Makes the next drawing use the new pixels and tells the widget and the callback
+void Fl_Image_Decoder::notify_() {
+  if (!changed_) return;
+  changed_ = 0;
+  uncache();
+  if (widget_) widget_->redraw();
+  if (callback_) callback_(this, callback_data_);
+}
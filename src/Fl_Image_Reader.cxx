@@ -26,6 +26,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#endif
+
 /*
   This internal (undocumented) class reads data chunks from a file or from
   memory in LSB-first byte order.
@@ -34,10 +40,27 @@
   duplication and may be extended to be used in similar cases. Future
   options might be to read data in MSB-first byte order or to add more
   methods.
+
+  Files are read in blocks into a buffer. Large files are mapped into
+  memory instead where the platform supports it. Either way the bytes
+  available are between data_ and end_, so that read_byte() is inline and
+  decoders can get whole rows with read_span() instead of reading byte by
+  byte.
+
+  Note: if a mapped file is truncated by another process while it is read,
+  touching the pages past its new end raises SIGBUS, which a buffered read
+  would report as EOF. Small files, which gain little from mapping, are
+  therefore always read through the buffer.
 */
 
+// size of the blocks read from files that are not mapped
+static const size_t block_size = 65536;
+
+// files of at least this size are mapped into memory if possible
+static const size_t map_threshold = 4 * 1024 * 1024;
+
 // Initialize the reader to access the file system, filename is copied
-// and stored.
+// and stored. Large files are mapped into memory if possible.
 int Fl_Image_Reader::open(const char *filename) {
   if (!filename)
     return -1;
@@ -45,6 +68,28 @@ int Fl_Image_Reader::open(const char *filename) {
   if ((file_ = fl_fopen(filename, "rb")) == NULL) {
     return -1;
   }
+#ifndef _WIN32
+  struct stat st;
+  if (fstat(fileno(file_), &st) == 0 && S_ISREG(st.st_mode) &&
+      (unsigned long long)st.st_size >= map_threshold &&
+      (unsigned long long)st.st_size <= (size_t)-1) {
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fileno(file_), 0);
+    if (map != MAP_FAILED) {
+      fclose(file_);
+      file_ = 0L;
+      map_ = map;
+      map_size_ = (size_t)st.st_size;
+      start_ = data_ = (const unsigned char *)map;
+      end_ = start_ + map_size_;
+      is_data_ = 1;
+      return 0;
+    }
+  }
+#endif
+  buffer_size_ = block_size;
+  buffer_ = (unsigned char *)malloc(buffer_size_);
+  start_ = data_ = end_ = buffer_;
+  buffer_pos_ = 0;
   is_file_ = 1;
   return 0;
 }
@@ -73,6 +118,7 @@ int Fl_Image_Reader::open(const char *imagename, const unsigned char *data) {
     name_ = fl_strdup(imagename);
   if (data) {
     start_ = data_ = data;
+    end_ = (const unsigned char *)(-1L); // unlimited
     is_data_ = 1;
     return 0;
   }
@@ -84,29 +130,57 @@ Fl_Image_Reader::~Fl_Image_Reader() {
   if (is_file_ && file_) {
     fclose(file_);
   }
+#ifndef _WIN32
+  if (map_)
+    munmap(map_, map_size_);
+#endif
+  free(buffer_);
   if (name_)
     free(name_);
 }
 
-// Read a single byte from memory or a file
-uchar Fl_Image_Reader::read_byte() {
+// Read at least n bytes into the buffer of a file that is not mapped,
+// after the bytes not used yet. Returns the number of bytes available,
+// which is less than n at EOF or after a read error.
+size_t Fl_Image_Reader::fill_(size_t n) {
+  size_t avail = end_ - data_;
+  if (avail >= n || error_)
+    return avail;
+  // move the bytes not used yet to the start of the buffer
+  buffer_pos_ += long(data_ - buffer_);
+  memmove(buffer_, data_, avail);
+  if (n > buffer_size_) {
+    while (buffer_size_ < n) buffer_size_ *= 2;
+    buffer_ = (unsigned char *)realloc(buffer_, buffer_size_);
+  }
+  start_ = data_ = buffer_;
+  end_ = buffer_ + avail;
+  while (avail < n) {
+    size_t ret = fread(buffer_ + avail, 1, buffer_size_ - avail, file_);
+    if (ret == 0)
+      break;
+    avail += ret;
+    end_ = buffer_ + avail;
+  }
+  return avail;
+}
+
+// Get the next byte when data_ has reached end_: refill the buffer
+// of a file, or set the EOF or error status
+uchar Fl_Image_Reader::fill_byte_() {
   if (error()) // don't read after read error or EOF
     return 0;
   if (is_file_) {
-    int ret = getc(file_);
-    if (ret < 0) {
-      if (feof(file_))
-        error_ = 1;
-      else if (ferror(file_))
-        error_ = 2;
-      else
-        error_ = 3; // unknown error
-      return 0;
-    }
-    return ret;
-  } else if (is_data_) {
-    if (data_ < end_)
+    if (fill_(1) > 0)
       return *data_++;
+    if (feof(file_))
+      error_ = 1;
+    else if (ferror(file_))
+      error_ = 2;
+    else
+      error_ = 3; // unknown error
+    return 0;
+  } else if (is_data_) {
     error_ = 1; // EOF
     return 0;
   }
@@ -114,6 +188,55 @@ uchar Fl_Image_Reader::read_byte() {
   return 0;
 }
 
+// Read n bytes into buf. Returns the number of bytes read, which is less
+// than n at EOF or after a read error (the error status is set).
+size_t Fl_Image_Reader::read(unsigned char *buf, size_t n) {
+  size_t done = 0;
+  while (done < n) {
+    size_t avail = end_ - data_;
+    if (avail == 0) {
+      if (is_file_ && !error() && n - done >= buffer_size_) {
+        // large reads go straight to the destination
+        size_t ret = fread(buf + done, 1, n - done, file_);
+        buffer_pos_ += long(data_ - buffer_) + long(ret);
+        start_ = data_ = end_ = buffer_;
+        done += ret;
+        if (ret > 0)
+          continue;
+      }
+      buf[done] = fill_byte_();
+      if (error())
+        break;
+      done++;
+      continue;
+    }
+    if (avail > n - done)
+      avail = n - done;
+    memcpy(buf + done, data_, avail);
+    data_ += avail;
+    done += avail;
+  }
+  return done;
+}
+
+// Return a pointer to the next n bytes, which are valid until the next
+// read or seek, and move past them. Returns NULL at EOF or after a read
+// error, and sets the error status.
+const unsigned char *Fl_Image_Reader::read_span(size_t n) {
+  if (error())
+    return 0L;
+  if ((size_t)(end_ - data_) < n) {
+    if (!is_file_ || fill_(n) < n) {
+      data_ = end_;
+      fill_byte_(); // sets the error status
+      return 0L;
+    }
+  }
+  const unsigned char *span = data_;
+  data_ += n;
+  return span;
+}
+
 // Read a 16-bit unsigned integer, LSB-first
 unsigned short Fl_Image_Reader::read_word() {
   unsigned char b0, b1; // Bytes from file or memory
@@ -144,15 +267,25 @@ unsigned int Fl_Image_Reader::read_dword() {
 void Fl_Image_Reader::seek(unsigned int n) {
   error_ = 0;
   if (is_file_) {
+    if ((long)n >= buffer_pos_ && (long)n <= buffer_pos_ + long(end_ - buffer_)) {
+      data_ = buffer_ + (n - buffer_pos_); // inside the buffer
+      return;
+    }
+    start_ = data_ = end_ = buffer_;
     int ret = fseek(file_, n, SEEK_SET);
-    if (ret < 0)
+    if (ret < 0) {
       error_ = 2; // read / position error
+      return;
+    }
+    buffer_pos_ = n;
     return;
   } else if (is_data_) {
-    if (start_ + n <= end_)
+    if (start_ + n <= end_) {
       data_ = start_ + n;
-    else
+    } else {
+      data_ = end_;
       error_ = 2; // read / position error
+    }
     return;
   }
   // unknown mode (not initialized ?)
@@ -162,12 +295,11 @@ void Fl_Image_Reader::seek(unsigned int n) {
 // Get the current read position as a byte offset from the
 // beginning of the file or the original start address in memory.
 // This method does neither affect the error flag nor is it affected
-// by the current error status. If reading from a file, this may
-// return -1 or any error code from ftell().
+// by the current error status.
 
 long Fl_Image_Reader::tell() const {
   if (is_file_) {
-    return ftell(file_);
+    return buffer_pos_ + long(data_ - buffer_);
   } else if (is_data_) {
     return long(data_ - start_);
   }
@@ -22,12 +22,18 @@
   duplication and may be extended to be used in similar cases. Future
   options might be to read data in MSB-first byte order or to add more
   methods.
+
+  Files are mapped into memory where the platform supports it, otherwise
+  they are read in blocks into a buffer. Either way the bytes available
+  are between data_ and end_, so that read_byte() is inline and decoders
+  can get whole rows with read_span() instead of reading byte by byte.
 */
 
 #ifndef FL_IMAGE_READER_H
 #define FL_IMAGE_READER_H
 
 #include <stdio.h>
+#include <stddef.h> // size_t
 
 class Fl_Image_Reader {
 public:
@@ -38,9 +44,14 @@ public:
     , file_(0L)
     , data_(0L)
     , start_(0L)
-    , end_((const unsigned char *)(-1L))
+    , end_(0L)
     , name_(0L)
-    , error_(0) {}
+    , error_(0)
+    , buffer_(0L)
+    , buffer_size_(0)
+    , buffer_pos_(0)
+    , map_(0L)
+    , map_size_(0) {}
 
   // Initialize the reader to access the file system, filename is copied
   // and stored.
@@ -55,7 +66,19 @@ public:
   ~Fl_Image_Reader();
 
   // Read a single byte from memory or a file
-  unsigned char read_byte();
+  unsigned char read_byte() {
+    if (data_ < end_)
+      return *data_++;
+    return fill_byte_();
+  }
+
+  // Read n bytes into buf, return the number of bytes read, which is
+  // less than n at EOF or after an error
+  size_t read(unsigned char *buf, size_t n);
+
+  // Return a pointer to the next n bytes and skip them, or NULL at EOF or
+  // after an error. The bytes are valid until the next read or seek.
+  const unsigned char *read_span(size_t n);
 
   // Read a 16-bit unsigned integer, LSB-first
   unsigned short read_word();
@@ -84,17 +107,22 @@ public:
   void skip(unsigned int n) { seek(tell() + n); }
 
 private:
-  // open() sets this if we read from a file
+  // refill the buffer, and return its first byte, or set the error
+  unsigned char fill_byte_();
+  // fill the buffer with at least n bytes if possible, return the number available
+  size_t fill_(size_t n);
+
+  // open() sets this if we read from a file through buffer_
   char is_file_;
-  // open() sets this if we read from memory
+  // open() sets this if we read from memory, or from a file mapped in memory
   char is_data_;
   // a pointer to the opened file
   FILE *file_;
-  // a pointer to the current byte in memory
+  // a pointer to the current byte in memory or in buffer_
   const unsigned char *data_;
-  // a pointer to the start of the image data
+  // a pointer to the start of the image data, or to buffer_
   const unsigned char *start_;
-  // a pointer to the end of image data if reading from memory, otherwise undefined
+  // a pointer to the end of image data in memory or in buffer_
   // note: currently (const unsigned char *)(-1L) if end of memory is not available
   // ... which means "unlimited"
   const unsigned char *end_;
@@ -102,6 +130,14 @@ private:
   char *name_;
   // a flag to store EOF or error status
   int error_;
+  // the data read from the file but not used yet, when the file is not mapped
+  unsigned char *buffer_;
+  size_t buffer_size_;
+  // the file offset of buffer_[0]
+  long buffer_pos_;
+  // the file mapped in memory
+  void *map_;
+  size_t map_size_;
 };
 
 #endif // FL_IMAGE_READER_H
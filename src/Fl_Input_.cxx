@@ -142,6 +142,130 @@ double Fl_Input_::expandpos(
   return fl_width(buf, n);
 }
 
+/** \internal
+  Finds the start of each displayed line that is not known yet.
+
+  A displayed line ends where expand() stops: at a newline, at a space
+  or tab where the text is wrapped, or when the expanded text fills the
+  buffer. The newline or space that ends a line is not part of the next
+  line.
+
+  The line starts are kept between calls. replace() marks the range of
+  text that changed, and only the lines of the paragraphs in this range
+  are expanded again. All lines are found again if the font, the input
+  type or the wrap width changed, or if a new value was set.
+
+  The current font must be set with setfont().
+*/
+void Fl_Input_::update_lines() const {
+  int type = input_type() | (wrap() ? FL_INPUT_WRAP : 0);
+  int wrap_w = wrap() ? w() - Fl::box_dw(box()) : 0;
+  if (nlines_ && (lines_font_ != textfont() || lines_fontsize_ != textsize() ||
+                  lines_type_ != type || lines_wrap_w_ != wrap_w))
+    nlines_ = 0;
+  int ps = 0, pe = size_, i0 = 0, i1 = 0;
+  if (!nlines_) {
+    lines_font_ = textfont();
+    lines_fontsize_ = textsize();
+    lines_type_ = type;
+    lines_wrap_w_ = wrap_w;
+  } else if (lines_dirty_start_ < 0) {
+    return;
+  } else {
+    if (input_type() == FL_MULTILINE_INPUT) {
+      // the lines of other paragraphs did not change
+      ps = lines_dirty_start_;
+      pe = lines_dirty_end_;
+      while (ps > 0 && value_[ps-1] != '\n') ps--;
+      while (pe < size_ && value_[pe] != '\n') pe++;
+    }
+    i0 = line_index(ps);        // ps is a line start
+    i1 = line_index(pe)+1;
+  }
+  lines_dirty_start_ = -1;
+
+  // expand the lines from ps up to the end of the paragraph at pe:
+  int n = 0, alloc = 64;
+  int* starts = (int*)malloc(alloc*sizeof(int));
+  char buf[MAXBUF];
+  for (const char* p = value_+ps; ; ) {
+    if (n == alloc) {
+      alloc *= 2;
+      starts = (int*)realloc(starts, alloc*sizeof(int));
+    }
+    starts[n++] = (int) (p-value_);
+    const char* e = expand(p, buf);
+    if (e >= value_+size_) break;
+    if (*e == '\n' || *e == ' ') e++;
+    if (e-value_ > pe) break;
+    p = e;
+  }
+
+  // replace the old line starts of these paragraphs:
+  int count = nlines_ - (i1-i0) + n;
+  if (count > lines_alloc_) {
+    lines_alloc_ = count + count/2 + 16;
+    line_starts_ = (int*)realloc(line_starts_, lines_alloc_*sizeof(int));
+    line_widths_ = (int*)realloc(line_widths_, lines_alloc_*sizeof(int));
+  }
+  memmove(line_starts_+i0+n, line_starts_+i1, (nlines_-i1)*sizeof(int));
+  memmove(line_widths_+i0+n, line_widths_+i1, (nlines_-i1)*sizeof(int));
+  memcpy(line_starts_+i0, starts, n*sizeof(int));
+  for (int i = 0; i < n; i++) line_widths_[i0+i] = -1;
+  nlines_ = count;
+  free(starts);
+}
+
+/** \internal
+  Returns the index of the displayed line containing a position.
+
+  If \p pos is both the end of a line and the start of the next one,
+  this returns the next one. update_lines() must have been called.
+
+  \param [in] pos index into the text
+  \return line index from 0 to the number of lines - 1
+*/
+int Fl_Input_::line_index(int pos) const {
+  int a = 0, b = nlines_;
+  while (b-a > 1) {
+    int m = (a+b)/2;
+    if (line_starts_[m] <= pos) a = m; else b = m;
+  }
+  return a;
+}
+
+/** \internal
+  Updates the line starts after a change of the text.
+
+  The line starts in the changed text are removed, the following ones
+  are moved, and the changed text is marked for update_lines().
+
+  \param [in] b, e range of the text that was replaced
+  \param [in] ilen number of bytes that replaced it
+*/
+void Fl_Input_::lines_modified(int b, int e, int ilen) {
+  if (!nlines_) return;
+  int delta = ilen - (e-b);
+  int i = line_index(b)+1, j = i;
+  while (j < nlines_ && line_starts_[j] <= e) j++;
+  for (; j < nlines_; i++, j++) {
+    line_starts_[i] = line_starts_[j] + delta;
+    line_widths_[i] = line_widths_[j];
+  }
+  nlines_ = i;
+  if (lines_dirty_start_ < 0) {
+    lines_dirty_start_ = b;
+    lines_dirty_end_ = b+ilen;
+  } else {
+    if (lines_dirty_start_ > b)
+      lines_dirty_start_ = b;
+    if (lines_dirty_end_ >= e)
+      lines_dirty_end_ += delta;
+    else
+      lines_dirty_end_ = b+ilen;
+  }
+}
+
 ////////////////////////////////////////////////////////////////
 
 /** \internal
@@ -229,41 +353,36 @@ void Fl_Input_::drawtext(int X, int Y, int W, int H) {
   }
 
   setfont();
+  update_lines();
   const char *p, *e;
   char buf[MAXBUF];
 
-  // count how many lines and put the last one into the buffer:
-  // And figure out where the cursor is:
+  // figure out where the cursor is:
   int height = fl_height();
   int threshold = height/2;
-  int lines;
   int curx, cury;
-  for (p=value(), curx=cury=lines=0; ;) {
-    e = expand(p, buf);
-    if (position() >= p-value() && position() <= e-value()) {
-      curx = int(expandpos(p, value()+position(), buf, 0)+.5);
-      if (Fl::focus()==this && !was_up_down) up_down_pos = curx;
-      cury = lines*height;
-      int newscroll = xscroll_;
-      if (curx > newscroll+W-threshold) {
-        // figure out scrolling so there is space after the cursor:
-        newscroll = curx+threshold-W;
-        // figure out the furthest left we ever want to scroll:
-        int ex = int(expandpos(p, e, buf, 0))+4-W;
-        // use minimum of both amounts:
-        if (ex < newscroll) newscroll = ex;
-      } else if (curx < newscroll+threshold) {
-        newscroll = curx-threshold;
-      }
-      if (newscroll < 0) newscroll = 0;
-      if (newscroll != xscroll_) {
-        xscroll_ = newscroll;
-        mu_p = 0; erase_cursor_only = 0;
-      }
-    }
-    lines++;
-    if (e >= value_+size_) break;
-    p = e+1;
+  int line = line_index(position());
+  p = value()+line_starts_[line];
+  e = expand(p, buf);
+  curx = int(expandpos(p, value()+position(), buf, 0)+.5);
+  if (Fl::focus()==this && !was_up_down) up_down_pos = curx;
+  cury = line*height;
+  int newscroll = xscroll_;
+  if (curx > newscroll+W-threshold) {
+    // figure out scrolling so there is space after the cursor:
+    newscroll = curx+threshold-W;
+    // figure out the furthest left we ever want to scroll:
+    if (line_widths_[line] < 0) line_widths_[line] = int(expandpos(p, e, buf, 0));
+    int ex = line_widths_[line]+4-W;
+    // use minimum of both amounts:
+    if (ex < newscroll) newscroll = ex;
+  } else if (curx < newscroll+threshold) {
+    newscroll = curx-threshold;
+  }
+  if (newscroll < 0) newscroll = 0;
+  if (newscroll != xscroll_) {
+    xscroll_ = newscroll;
+    mu_p = 0; erase_cursor_only = 0;
   }
 
   // adjust the scrolling:
@@ -280,18 +399,17 @@ void Fl_Input_::drawtext(int X, int Y, int W, int H) {
   fl_push_clip(X, Y, W, H);
   Fl_Color tc = active_r() ? textcolor() : fl_inactive(textcolor());
 
-  p = value();
-  // visit each line and draw it:
+  // visit each visible line and draw it:
   int desc = height-fl_descent();
   float xpos = (float)(X - xscroll_ + 1);
-  int ypos = -yscroll_;
+  line = yscroll_ > 0 ? yscroll_/height : 0;
+  if (line >= nlines_) line = nlines_-1;
+  int ypos = line*height-yscroll_;
   int ypos_cur = 0; //fix issue #270
   for (; ypos < H;) {
 
-    // re-expand line unless it is the last one calculated above:
-    if (lines>1) e = expand(p, buf);
-
-    if (ypos <= -height) goto CONTINUE; // clipped off top
+    p = value()+line_starts_[line];
+    e = expand(p, buf);
 
     if (do_mu) {        // for minimal update:
       const char* pp = value()+mu_p; // pointer to where minimal update starts
@@ -380,11 +498,8 @@ void Fl_Input_::drawtext(int X, int Y, int W, int H) {
       ypos_cur = ypos+height; //fix issue #270
     }
 
-  CONTINUE:
     ypos += height;
-    if (e >= value_+size_) break;
-    if (*e == '\n' || *e == ' ') e++;
-    p = e;
+    if (++line >= nlines_) break;
   }
 
   // for minimal update, erase all lines below last one if necessary:
@@ -465,18 +580,14 @@ int Fl_Input_::line_end(int i) const {
   if (input_type() != FL_MULTILINE_INPUT) return size();
 
   if (wrap()) {
-    // go to the start of the paragraph:
-    int j = i;
-    while (j > 0 && index(j-1) != '\n') j--;
-    // now measure lines until we get past i, end of that line is real eol:
+    // find the first displayed line that ends at or after i:
     setfont();
-    for (const char* p=value()+j; ;) {
-      char buf[MAXBUF];
-      p = expand(p, buf);
-      int k = (int) (p-value());
-      if (k >= i) return k;
-      p++;
-    }
+    update_lines();
+    char buf[MAXBUF];
+    int k = line_index(i);
+    if (k > 0 && line_starts_[k] == i &&
+        expand(value()+line_starts_[k-1], buf) >= value()+i) k--;
+    return (int) (expand(value()+line_starts_[k], buf)-value());
   } else {
     while (i < size() && index(i) != '\n') i++;
     return i;
@@ -494,18 +605,20 @@ int Fl_Input_::line_end(int i) const {
 */
 int Fl_Input_::line_start(int i) const {
   if (input_type() != FL_MULTILINE_INPUT) return 0;
-  int j = i;
-  while (j > 0 && index(j-1) != '\n') j--;
   if (wrap()) {
-    // now measure lines until we get past i, start of that line is real eol:
+    // find the first displayed line that ends at or after i:
     setfont();
-    for (const char* p=value()+j; ;) {
+    update_lines();
+    int k = line_index(i);
+    if (k > 0 && line_starts_[k] == i) {
       char buf[MAXBUF];
-      const char* e = expand(p, buf);
-      if ((int) (e-value()) >= i) return (int) (p-value());
-      p = e+1;
+      if (expand(value()+line_starts_[k-1], buf) >= value()+i) k--;
     }
-  } else return j;
+    return line_starts_[k];
+  }
+  int j = i;
+  while (j > 0 && index(j-1) != '\n') j--;
+  return j;
 }
 
 static int strict_word_start(const char *s, int i, int itype) {
@@ -530,22 +643,24 @@ void Fl_Input_::handle_mouse(int X, int Y, int /*W*/, int /*H*/, int drag) {
   was_up_down = 0;
   if (!size()) return;
   setfont();
+  update_lines();
 
   const char *p, *e;
   char buf[MAXBUF];
 
   int theline = (input_type()==FL_MULTILINE_INPUT) ?
     (Fl::event_y()-Y+yscroll_)/fl_height() : 0;
+  if (theline < 0) theline = 0;
+  if (theline >= nlines_) theline = nlines_-1;
 
   int newpos = 0;
-  for (p=value();; ) {
-    e = expand(p, buf);
-    theline--; if (theline < 0) break;
-    if (e >= value_+size_) break;
-    p = e+1;
-  }
+  p = value()+line_starts_[theline];
+  e = expand(p, buf);
+  if (line_widths_[theline] < 0) line_widths_[theline] = int(expandpos(p, e, buf, 0));
   const char *l, *r, *t; double f0 = Fl::event_x()-X+xscroll_;
-  for (l = p, r = e; l<r; ) {
+  if (Fl::event_x() > X-xscroll_+line_widths_[theline]) l = r = e; // right of the text
+  else l = p, r = e;
+  for (; l<r; ) {
     double f;
     int cw = fl_utf8len((char)l[0]);
     if (cw < 1) cw = 1;
@@ -833,17 +948,22 @@ int Fl_Input_::replace(int b, int e, const char* text, int ilen) {
   // we must count UTF-8 *characters* to determine whether we can insert
   // the full text or only a part of it (and how much this would be)
 
+  // (there are at least as many bytes as characters, so the text of a
+  // large widget need not be counted if the bytes fit)
+
   int nchars = 0;       // characters in value() - deleted + inserted
   const char *p = value_;
-  while (p < (char *)(value_+size_)) {
-    if (p == (char *)(value_+b)) { // skip removed part
-      p = (char *)(value_+e);
-      if (p >= (char *)(value_+size_)) break;
+  if (size_-(e-b)+ilen > maximum_size()) {
+    while (p < (char *)(value_+size_)) {
+      if (p == (char *)(value_+b)) { // skip removed part
+        p = (char *)(value_+e);
+        if (p >= (char *)(value_+size_)) break;
+      }
+      int ulen = fl_utf8len(*p);
+      if (ulen < 1) ulen = 1; // invalid UTF-8 character: count as 1
+      nchars++;
+      p += ulen;
     }
-    int ulen = fl_utf8len(*p);
-    if (ulen < 1) ulen = 1; // invalid UTF-8 character: count as 1
-    nchars++;
-    p += ulen;
   }
   int nlen = 0;         // length (in bytes) to be inserted
   p = text;
@@ -894,6 +1014,7 @@ int Fl_Input_::replace(int b, int e, const char* text, int ilen) {
     memcpy(buffer+b, text, ilen);
     size_ += ilen;
   }
+  lines_modified(b, e, ilen);
   undowidget = this;
   om = mark_;
   op = position_;
@@ -959,6 +1080,7 @@ int Fl_Input_::undo() {
     memmove(buffer+b, buffer+b+xlen, size_-xlen-b+1);
     size_ -= xlen;
   }
+  lines_modified(b1, b1+xlen, ilen);
 
   undocut = xlen;
   if (xlen) yankcut = xlen;
@@ -1148,6 +1270,12 @@ Fl_Input_::Fl_Input_(int X, int Y, int W, int H, const char* l)
   buffer  = 0;
   value_ = "";
   xscroll_ = yscroll_ = 0;
+  line_starts_ = line_widths_ = 0;
+  nlines_ = lines_alloc_ = 0;
+  lines_dirty_start_ = lines_dirty_end_ = -1;
+  lines_font_ = FL_HELVETICA;
+  lines_fontsize_ = 0;
+  lines_type_ = lines_wrap_w_ = 0;
   maximum_size_ = 32767;
   shortcut_ = 0;
   set_flag(SHORTCUT_LABEL);
@@ -1233,10 +1361,12 @@ int Fl_Input_::static_value(const char* str, int len) {
     }
     value_ = str;
     size_ = len;
+    nlines_ = 0;
   } else { // empty new value:
     if (!size_) return 0; // both old and new are empty.
     size_ = 0;
     value_ = "";
+    nlines_ = 0;
     xscroll_ = yscroll_ = 0;
     minimal_update(0);
   }
@@ -1319,6 +1449,8 @@ void Fl_Input_::resize(int X, int Y, int W, int H) {
 Fl_Input_::~Fl_Input_() {
   if (undowidget == this) undowidget = 0;
   if (bufsize) free((void*)buffer);
+  free(line_starts_);
+  free(line_widths_);
 }
 
 /** \internal
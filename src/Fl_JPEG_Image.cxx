@@ -26,12 +26,14 @@
 //
 
 #include <FL/Fl_JPEG_Image.H>
+#include <FL/Fl_JPEG_Decoder.H>
 #include <FL/Fl_Shared_Image.H>
 #include <FL/fl_utf8.h>
 #include <FL/Fl.H>
 #include <config.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
 
 
@@ -104,6 +106,30 @@ Fl_JPEG_Image::Fl_JPEG_Image(const char *filename)
   load_jpg_(filename, 0L, 0L);
 }
 
+/**
+ \brief The constructor loads the JPEG image from the given jpeg filename at a reduced size.
+
+ JPEG images can be decoded at 1/2, 1/4 or 1/8 of their size much faster,
+ and with less memory, than at full size. This constructor decodes the
+ image at the smallest of these scales that still gives an image of at
+ least \p W x \p H pixels, or at full size if there is none. Use copy(int, int)
+ to scale the result to the exact size needed, for instance for thumbnails.
+
+ A zero or negative \p W or \p H puts no limit on that direction.
+
+ \param[in] filename a full path and name pointing to a valid jpeg file.
+ \param[in] W, H the smallest size of the image needed
+
+ \see Fl_JPEG_Image::Fl_JPEG_Image(const char *filename)
+ \see Fl_Shared_Image::get_reduced(const char *name, int W, int H)
+ \version 1.4.0
+ */
+Fl_JPEG_Image::Fl_JPEG_Image(const char *filename, int W, int H)
+: Fl_RGB_Image(0,0,0)
+{
+  load_jpg_(filename, 0L, 0L, W, H);
+}
+
 /**
  \brief The constructor loads the JPEG image from memory.
 
@@ -209,9 +235,11 @@ static void jpeg_mem_src(j_decompress_ptr cinfo, const unsigned char *data)
  This method reads JPEG image data and creates an RGB or grayscale image.
  To avoid code duplication, we set filename if we want to read form a file or
  data to read from memory instead. Sharename can be set if the image is
- supposed to be added to teh Fl_Shared_Image list.
+ supposed to be added to teh Fl_Shared_Image list. If W or H is positive,
+ the image is decoded at a reduced scale that gives at least W x H pixels.
  */
-void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const unsigned char *data)
+void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const unsigned char *data,
+                              int W, int H)
 {
 #ifdef HAVE_LIBJPEG
   jpeg_decompress_struct  dinfo;    // Decompressor info
@@ -308,6 +336,21 @@ void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const
   dinfo.out_color_components = 3;
   dinfo.output_components    = 3;
 
+  // Let the decoder skip the DCT coefficients not needed for the smaller size
+  if (W > 0 || H > 0) {
+    for (unsigned denom = 8; denom > 1; denom /= 2) {
+      if ((W <= 0 || (dinfo.image_width + denom - 1) / denom >= (unsigned)W) &&
+          (H <= 0 || (dinfo.image_height + denom - 1) / denom >= (unsigned)H)) {
+        dinfo.scale_num   = 1;
+        dinfo.scale_denom = denom;
+        // reduced images are scaled again, so fast is precise enough
+        dinfo.dct_method          = JDCT_IFAST;
+        dinfo.do_fancy_upsampling = (boolean)FALSE;
+        break;
+      }
+    }
+  }
+
   jpeg_calc_output_dimensions(&dinfo);
 
   w(dinfo.output_width);
@@ -343,3 +386,220 @@ void Fl_JPEG_Image::load_jpg_(const char *filename, const char *sharename, const
   delete fp;
 #endif // HAVE_LIBJPEG
 }
+
+
+//
+// Fl_JPEG_Decoder - decodes JPEG data that arrives in pieces
+//
+
+#ifdef HAVE_LIBJPEG
+
+// The decompressor reads from a buffer holding the data not decoded yet.
+// When it runs out of data, the source suspends the decompressor, which
+// resumes where it stopped when more data has been written.
+struct Fl_JPEG_Decoder_State {
+  enum {                // the next decompressor call
+    HEADER,             // jpeg_read_header()
+    START,              // jpeg_start_decompress()
+    ROWS,               // jpeg_read_scanlines() of a single-scan image
+    CONSUME,            // jpeg_consume_input() until a scan is complete
+    OUTPUT_START,       // jpeg_start_output() of a progressive image
+    OUTPUT_ROWS,        // jpeg_read_scanlines() of a progressive image
+    OUTPUT_FINISH,      // jpeg_finish_output()
+    FINISH,             // jpeg_finish_decompress()
+    DONE
+  };
+  jpeg_decompress_struct dinfo;
+  fl_jpeg_error_mgr jerr;
+  jpeg_source_mgr src;
+  JOCTET *buffer;       // the data not decoded yet
+  size_t buffer_size;   // allocated size of buffer
+  size_t skip;          // bytes to skip in the data not written yet
+  int eof;              // all data has been written
+  int truncated;        // the data ended before the end of the image
+  int step;             // one of the enum values above
+  int pass;             // output pass of a progressive image
+
+  void append(const unsigned char *data, size_t n);
+  int run(Fl_JPEG_Decoder *decoder);
+};
+
+extern "C" {
+
+  static void decoder_init_source(j_decompress_ptr) {
+  }
+
+  static boolean decoder_fill_input_buffer(j_decompress_ptr cinfo) {
+    Fl_JPEG_Decoder_State *state = (Fl_JPEG_Decoder_State *)cinfo->client_data;
+    if (!state->eof) return FALSE; // suspend until more data is written
+    // the data is truncated: insert an end marker like libjpeg's own sources,
+    // so that the decompressor ends instead of waiting forever, and remember
+    // that the image is incomplete
+    static const JOCTET eoi[2] = { 0xFF, JPEG_EOI };
+    state->truncated = 1;
+    state->src.next_input_byte = eoi;
+    state->src.bytes_in_buffer = 2;
+    return TRUE;
+  }
+
+  static void decoder_skip_input_data(j_decompress_ptr cinfo, long num_bytes) {
+    Fl_JPEG_Decoder_State *state = (Fl_JPEG_Decoder_State *)cinfo->client_data;
+    if (num_bytes <= 0) return;
+    if ((size_t)num_bytes > state->src.bytes_in_buffer) {
+      state->skip += num_bytes - state->src.bytes_in_buffer;
+      num_bytes = (long)state->src.bytes_in_buffer;
+    }
+    state->src.next_input_byte += num_bytes;
+    state->src.bytes_in_buffer -= num_bytes;
+  }
+
+  static void decoder_term_source(j_decompress_ptr) {
+  }
+
+} // extern "C"
+
+// Adds new data after the data the decompressor has not read yet
+void Fl_JPEG_Decoder_State::append(const unsigned char *data, size_t n) {
+  size_t skipped = skip < n ? skip : n;
+  skip -= skipped;
+  data += skipped;
+  n -= skipped;
+  size_t left = src.bytes_in_buffer;
+  if (left && src.next_input_byte != buffer)
+    memmove(buffer, src.next_input_byte, left);
+  if (left + n > buffer_size) {
+    buffer_size = left + n > 2 * buffer_size ? left + n : 2 * buffer_size;
+    buffer = (JOCTET *)realloc(buffer, buffer_size);
+  }
+  memcpy(buffer + left, data, n);
+  src.next_input_byte = buffer;
+  src.bytes_in_buffer = left + n;
+}
+
+// Decodes as much of the image as the data written so far allows.
+// Any libjpeg error longjmp()s to the caller's setjmp().
+int Fl_JPEG_Decoder_State::run(Fl_JPEG_Decoder *decoder) {
+  for (;;) {
+    switch (step) {
+      case HEADER:
+        if (jpeg_read_header(&dinfo, TRUE) == JPEG_SUSPENDED) return 0;
+        dinfo.quantize_colors      = (boolean)FALSE;
+        dinfo.out_color_space      = JCS_RGB;
+        dinfo.out_color_components = 3;
+        dinfo.output_components    = 3;
+        // show each scan of a progressive image when it is complete
+        dinfo.buffered_image = jpeg_has_multiple_scans(&dinfo);
+        jpeg_calc_output_dimensions(&dinfo);
+        if (decoder->allocate_(dinfo.output_width, dinfo.output_height, dinfo.output_components))
+          return Fl_Image::ERR_FORMAT;
+        step = START;
+        break;
+      case START:
+        if (!jpeg_start_decompress(&dinfo)) return 0;
+        step = dinfo.buffered_image ? CONSUME : ROWS;
+        break;
+      case CONSUME: {
+        int ret;
+        do {
+          ret = jpeg_consume_input(&dinfo);
+        } while (ret != JPEG_SUSPENDED && ret != JPEG_REACHED_EOI);
+        // a scan is complete when the next one has started
+        int scans = dinfo.input_scan_number - (jpeg_input_complete(&dinfo) ? 0 : 1);
+        if (scans <= dinfo.output_scan_number) return 0;
+        step = OUTPUT_START;
+        break;
+      }
+      case OUTPUT_START:
+        if (!jpeg_start_output(&dinfo, dinfo.input_scan_number)) return 0;
+        step = OUTPUT_ROWS;
+        break;
+      case ROWS:
+      case OUTPUT_ROWS: {
+        const JDIMENSION first = dinfo.output_scanline;
+        while (dinfo.output_scanline < dinfo.output_height) {
+          JSAMPROW row = (JSAMPROW)(decoder->array +
+                                    (size_t)dinfo.output_scanline * dinfo.output_width *
+                                    dinfo.output_components);
+          if (jpeg_read_scanlines(&dinfo, &row, 1) != 1) break;
+        }
+        if (dinfo.output_scanline > first) decoder->decoded_(pass, dinfo.output_scanline);
+        if (dinfo.output_scanline < dinfo.output_height) return 0;
+        step = (step == ROWS) ? FINISH : OUTPUT_FINISH;
+        break;
+      }
+      case OUTPUT_FINISH:
+        if (!jpeg_finish_output(&dinfo)) return 0;
+        if (jpeg_input_complete(&dinfo) && dinfo.output_scan_number >= dinfo.input_scan_number) {
+          step = FINISH;
+        } else {
+          pass++;
+          step = CONSUME;
+        }
+        break;
+      case FINISH:
+        if (!jpeg_finish_decompress(&dinfo)) return 0;
+        if (truncated) return Fl_Image::ERR_FORMAT;
+        decoder->completed_();
+        step = DONE;
+        break;
+      default: // DONE
+        return 0;
+    }
+  }
+}
+
+#endif // HAVE_LIBJPEG
+
+/** Creates a decoder waiting for the first bytes of JPEG data. */
+Fl_JPEG_Decoder::Fl_JPEG_Decoder() {
+  state_ = 0;
+#ifdef HAVE_LIBJPEG
+  state_ = new Fl_JPEG_Decoder_State;
+  jpeg_decompress_struct &dinfo = state_->dinfo;
+  dinfo.err                         = jpeg_std_error((jpeg_error_mgr *)&state_->jerr);
+  state_->jerr.pub_.error_exit      = fl_jpeg_error_handler;
+  state_->jerr.pub_.output_message  = fl_jpeg_output_handler;
+  jpeg_create_decompress(&dinfo);
+  dinfo.client_data = state_;
+  state_->src.init_source           = decoder_init_source;
+  state_->src.fill_input_buffer     = decoder_fill_input_buffer;
+  state_->src.skip_input_data       = decoder_skip_input_data;
+  state_->src.resync_to_restart     = jpeg_resync_to_restart;
+  state_->src.term_source           = decoder_term_source;
+  state_->src.next_input_byte       = NULL;
+  state_->src.bytes_in_buffer       = 0;
+  dinfo.src = &state_->src;
+  state_->buffer = NULL;
+  state_->buffer_size = 0;
+  state_->skip = 0;
+  state_->eof = 0;
+  state_->truncated = 0;
+  state_->step = Fl_JPEG_Decoder_State::HEADER;
+  state_->pass = 0;
+#endif // HAVE_LIBJPEG
+}
+
+/** Frees the image and the decoder. */
+Fl_JPEG_Decoder::~Fl_JPEG_Decoder() {
+#ifdef HAVE_LIBJPEG
+  jpeg_destroy_decompress(&state_->dinfo);
+  free(state_->buffer);
+  delete state_;
+#endif // HAVE_LIBJPEG
+}
+
+int Fl_JPEG_Decoder::decode_(const unsigned char *data, size_t n) {
+#ifdef HAVE_LIBJPEG
+  if (data)
+    state_->append(data, n);
+  else
+    state_->eof = 1;
+  if (setjmp(state_->jerr.errhand_)) {
+    Fl::warning("JPEG data is too large or contains errors!\n");
+    return ERR_FORMAT;
+  }
+  return state_->run(this);
+#else
+  return ERR_FORMAT;
+#endif // HAVE_LIBJPEG
+}
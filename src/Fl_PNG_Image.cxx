@@ -30,6 +30,7 @@
 #include <FL/Fl.H>
 #include "Fl_System_Driver.H"
 #include <FL/Fl_PNG_Image.H>
+#include <FL/Fl_PNG_Decoder.H>
 #include <FL/Fl_Shared_Image.H>
 #include <FL/fl_utf8.h>
 
@@ -235,3 +236,114 @@ void Fl_PNG_Image::load_png_(const char *name_png, const unsigned char *buffer_p
   delete fp;
 #endif // HAVE_LIBPNG && HAVE_LIBZ
 }
+
+
+//
+// Fl_PNG_Decoder - decodes PNG data that arrives in pieces
+//
+#if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
+
+// The libpng progressive reader, called back for the header and for each row
+struct Fl_PNG_Decoder_State {
+  png_structp pp;
+  png_infop info;
+  Fl_PNG_Decoder *decoder;
+
+  void header() {
+    int channels;
+    if (png_get_color_type(pp, info) == PNG_COLOR_TYPE_PALETTE)
+      png_set_expand(pp);
+    if (png_get_color_type(pp, info) & PNG_COLOR_MASK_COLOR)
+      channels = 3;
+    else
+      channels = 1;
+    int num_trans = 0;
+    png_get_tRNS(pp, info, 0, &num_trans, 0);
+    if ((png_get_color_type(pp, info) & PNG_COLOR_MASK_ALPHA) || (num_trans != 0))
+      channels ++;
+    if (png_get_bit_depth(pp, info) < 8) {
+      png_set_packing(pp);
+      png_set_expand(pp);
+    } else if (png_get_bit_depth(pp, info) == 16)
+      png_set_strip_16(pp);
+#  if defined(HAVE_PNG_GET_VALID) && defined(HAVE_PNG_SET_TRNS_TO_ALPHA)
+    if (png_get_valid(pp, info, PNG_INFO_tRNS))
+      png_set_tRNS_to_alpha(pp);
+#  endif // HAVE_PNG_GET_VALID && HAVE_PNG_SET_TRNS_TO_ALPHA
+    png_set_interlace_handling(pp);
+    png_read_update_info(pp, info);
+    if (decoder->allocate_((int)png_get_image_width(pp, info),
+                           (int)png_get_image_height(pp, info), channels))
+      png_error(pp, "Image too large");
+  }
+
+  void row(png_bytep new_row, png_uint_32 row_num, int pass) {
+    if (!new_row || (int)row_num >= decoder->h()) return; // unchanged row of an interlaced image
+    uchar *row = (uchar *)decoder->array + (size_t)row_num * decoder->w() * decoder->d();
+    png_progressive_combine_row(pp, row, new_row);
+    if (decoder->d() == 4) Fl::system_driver()->png_extra_rgba_processing(row, decoder->w(), 1);
+    decoder->decoded_(pass, row_num + 1);
+  }
+
+  void end() {
+    decoder->completed_();
+  }
+};
+
+extern "C" {
+  static void png_decoder_header(png_structp pp, png_infop) {
+    ((Fl_PNG_Decoder_State *)png_get_progressive_ptr(pp))->header();
+  }
+  static void png_decoder_row(png_structp pp, png_bytep new_row, png_uint_32 row_num, int pass) {
+    ((Fl_PNG_Decoder_State *)png_get_progressive_ptr(pp))->row(new_row, row_num, pass);
+  }
+  static void png_decoder_end(png_structp pp, png_infop) {
+    ((Fl_PNG_Decoder_State *)png_get_progressive_ptr(pp))->end();
+  }
+} // extern "C"
+
+#endif // HAVE_LIBPNG && HAVE_LIBZ
+
+/** Creates a decoder waiting for the first bytes of PNG data. */
+Fl_PNG_Decoder::Fl_PNG_Decoder() {
+  state_ = 0;
+#if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
+  png_structp pp = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  png_infop info = pp ? png_create_info_struct(pp) : 0;
+  if (!info) {
+    if (pp) png_destroy_read_struct(&pp, NULL, NULL);
+    Fl::warning("Cannot allocate memory to read PNG data.\n");
+    return;
+  }
+  state_ = new Fl_PNG_Decoder_State;
+  state_->pp = pp;
+  state_->info = info;
+  state_->decoder = this;
+  png_set_progressive_read_fn(pp, state_, png_decoder_header, png_decoder_row, png_decoder_end);
+#endif // HAVE_LIBPNG && HAVE_LIBZ
+}
+
+/** Frees the image and the decoder. */
+Fl_PNG_Decoder::~Fl_PNG_Decoder() {
+#if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
+  if (state_) {
+    png_destroy_read_struct(&state_->pp, &state_->info, NULL);
+    delete state_;
+  }
+#endif // HAVE_LIBPNG && HAVE_LIBZ
+}
+
+int Fl_PNG_Decoder::decode_(const unsigned char *data, size_t n) {
+#if defined(HAVE_LIBPNG) && defined(HAVE_LIBZ)
+  if (!state_) return ERR_FORMAT;
+  if (!data) return 0; // libpng calls the end callback when it reads IEND
+  if (setjmp(png_jmpbuf(state_->pp))) {
+    Fl::warning("PNG data is too large or contains errors!\n");
+    return ERR_FORMAT;
+  }
+  png_process_data(state_->pp, state_->info, (png_bytep)data, n);
+  return 0;
+#else
+  return ERR_FORMAT;
+#endif // HAVE_LIBPNG && HAVE_LIBZ
+}
@@ -37,6 +37,8 @@ int     Fl_Shared_Image::alloc_images_ = 0;     // Allocated shared images
 Fl_Shared_Handler *Fl_Shared_Image::handlers_ = 0;// Additional format handlers
 int     Fl_Shared_Image::num_handlers_ = 0;     // Number of format handlers
 int     Fl_Shared_Image::alloc_handlers_ = 0;   // Allocated format handlers
+int     Fl_Shared_Image::reduced_w_ = 0;        // Minimum size of the image get_reduced() loads
+int     Fl_Shared_Image::reduced_h_ = 0;
 
 
 //
@@ -381,6 +383,18 @@ void Fl_Shared_Image::uncache()
 
 
 
+// Returns the index of the first of the n images sorted by compare() that
+// has the given name, or of the first image after it if there is none
+static int first_image(Fl_Shared_Image **images, int n, const char *name) {
+  int lo = 0, hi = n;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (strcmp(images[mid]->name(), name) < 0) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
 /** Finds a shared image from its name and size specifications.
 
   This uses a binary search in the image cache.
@@ -399,6 +413,19 @@ Fl_Shared_Image* Fl_Shared_Image::find(const char *name, int W, int H) {
   Fl_Shared_Image       *key,           // Image key
                         **match;        // Matching image
 
+  if (!W) {
+    // the original image is anywhere among the images of that name,
+    // which are sorted by size
+    for (int i = first_image(images_, num_images_, name);
+         i < num_images_ && !strcmp(images_[i]->name(), name); i++) {
+      if (images_[i]->original_) {
+        images_[i]->refcount_ ++;
+        return images_[i];
+      }
+    }
+    return 0;
+  }
+
   if (num_images_) {
     key = new Fl_Shared_Image();
     key->name_ = new char[strlen(name) + 1];
@@ -481,6 +508,82 @@ Fl_Shared_Image* Fl_Shared_Image::get(const char *name, int W, int H) {
   return temp;
 }
 
+/**
+  Find or load an image of at least a given size, maybe decoded at a reduced size.
+
+  This is meant for thumbnails and previews of large images. If the
+  \b original image \p name is already loaded, it is returned. Otherwise,
+  if an image \p name with at least \p W x \p H pixels was loaded by
+  get_reduced() or resized by get(), the smallest of them is returned.
+  Otherwise the image is loaded from file \p name, and image handlers that can decode
+  their format at a reduced size do so, with at least \p W x \p H pixels.
+  JPEG images are decoded at 1/2, 1/4 or 1/8 of their size this way.
+  Use copy(int, int) to scale the result to the exact size needed.
+
+  The loaded image is added to the list of shared images with its own size,
+  but it is not marked \p original, so that get(name) still loads the
+  image at full size.
+
+  You should release() the image when you're done with it.
+
+  \param name name of the image
+  \param W, H the smallest size needed, 0 for no limit in a direction
+
+  \see reduced_size(int &W, int &H)
+  \see Fl_JPEG_Image::Fl_JPEG_Image(const char *filename, int W, int H)
+  \version 1.4.0
+*/
+Fl_Shared_Image *Fl_Shared_Image::get_reduced(const char *name, int W, int H) {
+  Fl_Shared_Image       *temp;          // Image
+  Fl_Shared_Image       *found;         // The same image loaded before
+
+  if ((temp = find(name)) != NULL) return temp;
+
+  // Look for the smallest image of that name that is big enough: the images
+  // of a name are sorted by width
+  for (int i = first_image(images_, num_images_, name);
+       i < num_images_ && !strcmp(images_[i]->name(), name); i++) {
+    temp = images_[i];
+    if (temp->data_w() >= W && temp->data_h() >= H) {
+      temp->refcount_ ++;
+      return temp;
+    }
+  }
+
+  reduced_w_ = W;
+  reduced_h_ = H;
+  temp = new Fl_Shared_Image(name);
+  reduced_w_ = 0;
+  reduced_h_ = 0;
+
+  if (!temp->image_) {
+    delete temp;
+    return NULL;
+  }
+  temp->original_ = 0;
+
+  // Keep one entry per name and size in the list
+  if ((found = find(name, temp->data_w(), temp->data_h())) != NULL) {
+    delete temp;
+    return found;
+  }
+  temp->add();
+  return temp;
+}
+
+/**
+  Returns the minimum size of the image get_reduced() is loading.
+  Image handlers (see add_handler()) can call this to decode their format
+  faster at a reduced size that is still at least \p W x \p H.
+  Both are 0 if the image must be loaded at full size, and one of them is 0
+  if there is no limit in that direction.
+  \version 1.4.0
+*/
+void Fl_Shared_Image::reduced_size(int &W, int &H) {
+  W = reduced_w_;
+  H = reduced_h_;
+}
+
 /** Builds a shared image from a pre-existing Fl_RGB_Image.
 
  \param[in] rgb         an Fl_RGB_Image used to build a new shared image.
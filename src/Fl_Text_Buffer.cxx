@@ -123,6 +123,11 @@ Fl_Text_Buffer::Fl_Text_Buffer(int requestedSize, int preferredGapSize)
   mPredeleteCbArgs = NULL;
   mCursorPosHint = 0;
   mCanUndo = 1;
+  mBatchLevel = 0;
+  mBatchStart = -1;
+  mBatchInserted = mBatchDeleted = 0;
+  mBatchText = NULL;
+  mBatchNotify = 0;
   input_file_was_transcoded = 0;
   transcoding_warning_action = def_transcoding_warning_action;
 }
@@ -134,6 +139,7 @@ Fl_Text_Buffer::Fl_Text_Buffer(int requestedSize, int preferredGapSize)
 Fl_Text_Buffer::~Fl_Text_Buffer()
 {
   free(mBuf);
+  free(mBatchText);
   if (mNModifyProcs != 0) {
     delete[]mModifyProcs;
     delete[]mCbArgs;
@@ -1387,8 +1393,17 @@ void Fl_Text_Buffer::replace_selection_(Fl_Text_Selection * sel,
  */
 void Fl_Text_Buffer::call_modify_callbacks(int pos, int nDeleted,
                                            int nInserted, int nRestyled,
-                                           const char *deletedText) const {
+                                           const char *deletedText) {
   IS_UTF8_ALIGNED2(this, pos)
+  if (mBatchLevel > 0) {
+    if (nInserted || nDeleted) // call_predelete_callbacks() extended the range
+      mBatchInserted += nInserted - nDeleted;
+    else if (nRestyled)
+      batch_extend_(pos, nRestyled, false);
+    else
+      mBatchNotify = 1;
+    return;
+  }
   for (int i = 0; i < mNModifyProcs; i++)
     (*mModifyProcs[i]) (pos, nInserted, nDeleted, nRestyled,
                         deletedText, mCbArgs[i]);
@@ -1399,12 +1414,112 @@ void Fl_Text_Buffer::call_modify_callbacks(int pos, int nDeleted,
  Call all callbacks.
  Unicode safe.
  */
-void Fl_Text_Buffer::call_predelete_callbacks(int pos, int nDeleted) const {
+void Fl_Text_Buffer::call_predelete_callbacks(int pos, int nDeleted) {
+  if (mBatchLevel > 0) {
+    batch_extend_(pos, nDeleted, true);
+    return;
+  }
   for (int i = 0; i < mNPredeleteProcs; i++)
     (*mPredeleteProcs[i]) (pos, nDeleted, mPredeleteCbArgs[i]);
 }
 
 
+/*
+ Modifications during a batch that are separated from the pending range
+ by more unchanged bytes than this are notified separately.
+ */
+static const int batch_merge_gap = 4096;
+
+
+/*
+ Extend the range of a batch to the n bytes at pos. With keepText, these
+ bytes are about to be modified and the text of the range before the batch
+ must be kept; otherwise they are only restyled.
+ The buffer holds the text before the modification.
+ */
+void Fl_Text_Buffer::batch_extend_(int pos, int n, bool keepText)
+{
+  IS_UTF8_ALIGNED2(this, pos)
+  if (mBatchStart >= 0) {
+    int start = min(mBatchStart, pos);
+    int end = max(mBatchStart + mBatchInserted, pos + n);
+    // don't copy a lot of unchanged text only to merge distant modifications
+    if (end - start - mBatchInserted - n > batch_merge_gap)
+      flush_batch_();
+  }
+  if (mBatchStart < 0) {
+    mBatchStart = pos;
+    mBatchInserted = mBatchDeleted = n;
+    mBatchText = keepText ? text_range(pos, pos + n) : NULL;
+    return;
+  }
+  if (keepText && !mBatchText) // the range was only restyled so far
+    mBatchText = text_range(mBatchStart, mBatchStart + mBatchInserted);
+  int start = min(mBatchStart, pos);
+  int end = max(mBatchStart + mBatchInserted, pos + n);
+  int before = mBatchStart - start;
+  int after = end - (mBatchStart + mBatchInserted);
+  if (mBatchText && (before || after)) {
+    // the bytes added to the range are unchanged since the batch started
+    char *t = (char *) malloc(before + mBatchDeleted + after + 1);
+    char *part = text_range(start, mBatchStart);
+    memcpy(t, part, before);
+    free(part);
+    memcpy(t + before, mBatchText, mBatchDeleted);
+    part = text_range(end - after, end);
+    memcpy(t + before + mBatchDeleted, part, after);
+    free(part);
+    t[before + mBatchDeleted + after] = '\0';
+    free(mBatchText);
+    mBatchText = t;
+  }
+  mBatchStart = start;
+  mBatchDeleted += before + after;
+  mBatchInserted = end - start;
+}
+
+
+/*
+ Call the modify callbacks for the range of a batch, if any.
+ */
+void Fl_Text_Buffer::flush_batch_()
+{
+  if (mBatchStart < 0)
+    return;
+  int pos = mBatchStart;
+  int nInserted = mBatchInserted, nDeleted = mBatchDeleted;
+  char *deletedText = mBatchText;
+  mBatchStart = -1;
+  mBatchText = NULL;
+  IS_UTF8_ALIGNED2(this, pos)
+  for (int i = 0; i < mNModifyProcs; i++) {
+    if (deletedText)
+      (*mModifyProcs[i]) (pos, nInserted, nDeleted, 0, deletedText, mCbArgs[i]);
+    else
+      (*mModifyProcs[i]) (pos, 0, 0, nInserted, NULL, mCbArgs[i]);
+  }
+  free(deletedText);
+}
+
+
+/**
+ Ends a batch of modifications started with begin_batch().
+
+ When the outermost batch ends, the modify callbacks are called for the
+ modifications that were not notified yet.
+ */
+void Fl_Text_Buffer::end_batch()
+{
+  if (mBatchLevel <= 0 || --mBatchLevel > 0)
+    return;
+  flush_batch_();
+  if (mBatchNotify) {
+    mBatchNotify = 0;
+    call_modify_callbacks(0, 0, 0, 0, 0);
+  }
+}
+
+
 /*
  Redisplay a new selected area.
  Unicode safe.
@@ -1412,7 +1527,7 @@ void Fl_Text_Buffer::call_predelete_callbacks(int pos, int nDeleted) const {
 void Fl_Text_Buffer::redisplay_selection(Fl_Text_Selection *
                                            oldSelection,
                                            Fl_Text_Selection *
-                                           newSelection) const
+                                           newSelection)
 {
   int oldStart, oldEnd, newStart, newEnd, ch1Start, ch1End, ch2Start,
   ch2End;
@@ -113,6 +113,7 @@ Fl_Text_Display::Fl_Text_Display(int X, int Y, int W, int H, const char* l)
   mNBufferLines = 0;
   mBuffer = NULL;
   mStyleBuffer = NULL;
+  mStyleRuns = NULL;
   mFirstChar = 0;
   mLastChar = 0;
   mContinuousWrap = 0;
@@ -133,6 +134,12 @@ Fl_Text_Display::Fl_Text_Display(int X, int Y, int W, int H, const char* l)
   mUnfinishedStyle = 0;
   mUnfinishedHighlightCB = 0;
   mHighlightCBArg = 0;
+  mStyleTokenizer = 0;
+  mStyleTokenizerArg = 0;
+  mNStyleLines = mStyleLinesSize = 0;
+  mStyleLineStarts = mStyleLineStates = 0;
+  mRestyleStart = -1;
+  mRestyleEnd = 0;
   mMaxsize = 0;
   mSuppressResync = 0;
   mNLinesDeleted = 0;
@@ -206,6 +213,7 @@ Fl_Text_Display::~Fl_Text_Display() {
     mBuffer->remove_predelete_callback(buffer_predelete_cb, this);
   }
   if (mLineStarts) delete[] mLineStarts;
+  clear_style_tokenizer();
   if (linenumber_format_) {
     free((void*)linenumber_format_);
     linenumber_format_ = 0;
@@ -428,7 +436,9 @@ void Fl_Text_Display::highlight_data(Fl_Text_Buffer *styleBuffer,
                                      int nStyles, char unfinishedStyle,
                                      Unfinished_Style_Cb unfinishedHighlightCB,
                                      void *cbArg ) {
+  clear_style_tokenizer();
   mStyleBuffer = styleBuffer;
+  mStyleRuns = 0;
   mStyleTable = styleTable;
   mNStyles = nStyles;
   mUnfinishedStyle = unfinishedStyle;
@@ -442,6 +452,322 @@ void Fl_Text_Display::highlight_data(Fl_Text_Buffer *styleBuffer,
 
 
 
+/**
+ \brief Attach run-length encoded highlight information to the text display.
+
+ This works like highlight_data(Fl_Text_Buffer*, const Style_Table_Entry*, int, char, Unfinished_Style_Cb, void*),
+ but the style of each text byte is taken from \p styleRuns instead of a
+ style buffer. The runs follow the modifications of the text buffer
+ themselves, and need memory for each change of style instead of each
+ byte of text. Looking up the style of a position takes logarithmic time
+ in the number of runs.
+
+ The runs and the style table are managed by the caller. Call
+ redisplay_range() after changing the styles of some text. The modify
+ callbacks of a text buffer are called in the reverse order of their
+ addition, so create the runs after the text buffer was given to the
+ display to have them updated before the display.
+
+ \param styleRuns the styles of the text buffer, or NULL to remove the
+   highlight information
+ \param styleTable a list of styles indexed by the style bytes
+ \param nStyles number of styles in the style table
+ \see Fl_Text_Style_Runs, style_runs()
+ */
+void Fl_Text_Display::highlight_data(Fl_Text_Style_Runs *styleRuns,
+                                     const Style_Table_Entry *styleTable,
+                                     int nStyles) {
+  clear_style_tokenizer();
+  mStyleBuffer = 0;
+  mStyleRuns = styleRuns;
+  mStyleTable = styleTable;
+  mNStyles = nStyles;
+  mUnfinishedStyle = 0;
+  mUnfinishedHighlightCB = 0;
+  mHighlightCBArg = 0;
+  mColumnScale = 0;
+  damage(FL_DAMAGE_EXPOSE);
+}
+
+
+
+/*
+ Number of bytes given to the style tokenizer in each idle callback.
+ */
+static const int restyle_chunk_size = 32768;
+
+
+/**
+ \brief Attach a style table and let the display compute the styles.
+
+ Like highlight_data(Fl_Text_Buffer*, const Style_Table_Entry*, int, char, Unfinished_Style_Cb, void*),
+ this displays the text with the styles in \p styleTable, but the display
+ stores the styles itself in an Fl_Text_Style_Runs, see style_runs().
+ The styles of each line are computed by \p tokenizer.
+
+ After a modification of the text buffer, only the modified lines are
+ given to the tokenizer, followed by the next lines until the state
+ returned for a line start is the same as before the modification. This
+ way, opening a comment restyles the following lines, but typing a word
+ restyles a single line. The display remembers the tokenizer state at the
+ start of every line for this purpose.
+
+ Lines that are visible are tokenized before they are drawn. All other
+ lines are tokenized in chunks in idle callbacks (see Fl::add_idle()).
+
+ The style bytes of text inserted into the buffer are set to the first
+ entry of the style table until the tokenizer has computed them.
+
+ \code
+ // Style 'A' is plain text, 'B' is a comment. The state is 1 inside a comment.
+ static int tokenize(const char *text, int length, char *style, int state, void *) {
+   for (int i = 0; i < length; i++) {
+     if (!state && text[i] == '/' && i+1 < length && text[i+1] == '*') state = 1;
+     style[i] = state ? 'B' : 'A';
+     if (state && i > 0 && text[i-1] == '*' && text[i] == '/') state = 0;
+   }
+   return state;
+ }
+ ...
+ display->highlight_data(styletable, 2, tokenize, 0);
+ \endcode
+
+ \param styleTable a list of styles indexed by the style bytes
+ \param nStyles number of styles in the style table
+ \param tokenizer computes the style bytes of one line
+ \param cbArg an optional argument for the tokenizer
+ \param initialState the tokenizer state at the start of the buffer
+ \see restyle(), restyle_pending()
+ */
+void Fl_Text_Display::highlight_data(const Style_Table_Entry *styleTable,
+                                     int nStyles, Style_Tokenizer_Cb tokenizer,
+                                     void *cbArg, int initialState) {
+  int length = mBuffer ? mBuffer->length() : 0;
+  // the runs follow the text through restyle_modified(), so that they
+  // are up to date when buffer_modified_cb() needs them
+  Fl_Text_Style_Runs *styleRuns = new Fl_Text_Style_Runs(0);
+  styleRuns->update(0, length, 0);
+  highlight_data(styleRuns, styleTable, nStyles);
+  mStyleTokenizer = tokenizer;
+  mStyleTokenizerArg = cbArg;
+  mStyleLinesSize = 256;
+  mStyleLineStarts = (int *)malloc(mStyleLinesSize * sizeof(int));
+  mStyleLineStates = (int *)malloc(mStyleLinesSize * sizeof(int));
+  mNStyleLines = 1;
+  mStyleLineStarts[0] = 0;
+  mStyleLineStates[0] = initialState;
+  restyle(0, length);
+}
+
+
+/**
+ \brief Tokenize the lines from \p start to \p end again.
+
+ Call this when the styles of these lines changed for another reason than
+ a modification of the text, e.g. because a list of keywords changed.
+ The following lines are tokenized as well until the tokenizer state at
+ a line start is unchanged. This has no effect unless a style tokenizer was
+ set with highlight_data(const Style_Table_Entry*, int, Style_Tokenizer_Cb, void*, int).
+
+ \param start, end byte range of the text buffer
+ */
+void Fl_Text_Display::restyle(int start, int end) {
+  if (!mStyleTokenizer || !mBuffer)
+    return;
+  int lineStart = mStyleLineStarts[style_line_index(start)];
+  if (mRestyleStart < 0) {
+    mRestyleStart = lineStart;
+    mRestyleEnd = end;
+  } else {
+    // the states after the old first line are not known to be right
+    if (lineStart < mRestyleStart)
+      end = max(end, mRestyleStart);
+    mRestyleStart = min(mRestyleStart, lineStart);
+    mRestyleEnd = max(mRestyleEnd, end);
+  }
+  if (!Fl::has_idle(restyle_idle_cb, this))
+    Fl::add_idle(restyle_idle_cb, this);
+  redisplay_range(lineStart, end);
+}
+
+
+/*
+ Returns the index of the last known line start at or before pos.
+ */
+int Fl_Text_Display::style_line_index(int pos) const {
+  int a = 0, b = mNStyleLines;
+  while (b - a > 1) {
+    int m = (a + b) / 2;
+    if (mStyleLineStarts[m] <= pos) a = m;
+    else b = m;
+  }
+  return a;
+}
+
+
+/*
+ Forgets the style tokenizer and deletes the style runs it fills.
+ */
+void Fl_Text_Display::clear_style_tokenizer() {
+  if (!mStyleTokenizer)
+    return;
+  Fl::remove_idle(restyle_idle_cb, this);
+  delete mStyleRuns;
+  mStyleRuns = 0;
+  mStyleTokenizer = 0;
+  free(mStyleLineStarts);
+  free(mStyleLineStates);
+  mStyleLineStarts = mStyleLineStates = 0;
+  mNStyleLines = mStyleLinesSize = 0;
+  mRestyleStart = -1;
+}
+
+
+/*
+ Keeps the style runs and the known line starts in step with a
+ modification of the text buffer, and marks the modified lines.
+ */
+void Fl_Text_Display::restyle_modified(int pos, int nInserted, int nDeleted) {
+  mStyleRuns->update(pos, nInserted, nDeleted);
+  mStyleRuns->set_style(pos, pos + nInserted, 'A');
+
+  // forget the line starts after a deleted newline, move the following ones
+  int first = style_line_index(pos) + 1;
+  int last = style_line_index(pos + nDeleted) + 1;
+  int delta = nInserted - nDeleted;
+  int i, j;
+  for (i = first, j = last; j < mNStyleLines; i++, j++) {
+    mStyleLineStarts[i] = mStyleLineStarts[j] + delta;
+    mStyleLineStates[i] = mStyleLineStates[j];
+  }
+  mNStyleLines = i;
+
+  if (mRestyleStart > pos)
+    mRestyleStart = max(pos + nInserted, mRestyleStart + delta);
+  if (mRestyleStart >= 0 && mRestyleEnd > pos)
+    mRestyleEnd = max(pos + nInserted, mRestyleEnd + delta);
+  restyle(pos, pos + nInserted);
+}
+
+
+/*
+ Tokenizes the lines from mRestyleStart on until the tokenizer state at a
+ line start after mRestyleEnd is unchanged, or until the start of a line
+ at or after limit. The newline before such a line start is unchanged, so
+ the line and all following lines keep their styles.
+ */
+void Fl_Text_Display::restyle_lines(int limit) {
+  if (!mStyleTokenizer || !mBuffer || mRestyleStart < 0)
+    return;
+  Fl_Text_Buffer *buf = mBuffer;
+  int length = buf->length();
+  int first = style_line_index(mRestyleStart);
+  int pos = mStyleLineStarts[first];
+  int state = mStyleLineStates[first];
+  int next = first + 1;         // first old line start not passed yet
+  int nNew = 0, newSize = 64;   // line starts found in this call
+  int *newStarts = (int *)malloc(newSize * sizeof(int));
+  int *newStates = (int *)malloc(newSize * sizeof(int));
+  bool done = false;
+
+  while (!done && pos < limit) {
+    if (pos >= length) {
+      done = true;
+      break;
+    }
+    int end = buf->line_end(min(pos + restyle_chunk_size, length));
+    if (end < length) end++;
+    char *text = buf->text_range(pos, end);
+    char *style = (char *)malloc(end - pos);
+    char *oldStyle = (char *)malloc(end - pos);
+    mStyleRuns->styles(pos, end, oldStyle);
+    int p = pos;
+    while (p < end) {
+      const char *nl = (const char *)memchr(text + (p - pos), '\n', end - p);
+      int lineEnd = nl ? (int)(nl - text) + pos + 1 : end;
+      state = mStyleTokenizer(text + (p - pos), lineEnd - p, style + (p - pos),
+                              state, mStyleTokenizerArg);
+      p = lineEnd;
+      if (!nl) {                // last line of the buffer
+        done = true;
+        break;
+      }
+      while (next < mNStyleLines && mStyleLineStarts[next] < p)
+        next++;
+      if (p > mRestyleEnd && next < mNStyleLines &&
+          mStyleLineStarts[next] == p && mStyleLineStates[next] == state) {
+        done = true;            // the following lines keep their styles
+        break;
+      }
+      if (nNew == newSize) {
+        newSize *= 2;
+        newStarts = (int *)realloc(newStarts, newSize * sizeof(int));
+        newStates = (int *)realloc(newStates, newSize * sizeof(int));
+      }
+      newStarts[nNew] = p;
+      newStates[nNew] = state;
+      nNew++;
+      if (p >= limit)
+        break;
+    }
+    // store and redisplay the styles that changed
+    int a = 0, b = p - pos;
+    while (a < b && style[a] == oldStyle[a]) a++;
+    while (b > a && style[b - 1] == oldStyle[b - 1]) b--;
+    if (a < b) {
+      mStyleRuns->set_styles(pos + a, style + a, b - a);
+      redisplay_range(pos + a, pos + b);
+    }
+    free(text);
+    free(style);
+    free(oldStyle);
+    pos = p;
+  }
+
+  // replace the old line starts up to pos by the new ones
+  if (pos >= length)
+    next = mNStyleLines;
+  else if (!done)
+    while (next < mNStyleLines && mStyleLineStarts[next] <= pos)
+      next++;
+  int n = first + 1 + nNew + (mNStyleLines - next);
+  if (n > mStyleLinesSize) {
+    while (n > mStyleLinesSize) mStyleLinesSize *= 2;
+    mStyleLineStarts = (int *)realloc(mStyleLineStarts, mStyleLinesSize * sizeof(int));
+    mStyleLineStates = (int *)realloc(mStyleLineStates, mStyleLinesSize * sizeof(int));
+  }
+  memmove(mStyleLineStarts + first + 1 + nNew, mStyleLineStarts + next,
+          (mNStyleLines - next) * sizeof(int));
+  memmove(mStyleLineStates + first + 1 + nNew, mStyleLineStates + next,
+          (mNStyleLines - next) * sizeof(int));
+  memcpy(mStyleLineStarts + first + 1, newStarts, nNew * sizeof(int));
+  memcpy(mStyleLineStates + first + 1, newStates, nNew * sizeof(int));
+  mNStyleLines = n;
+  free(newStarts);
+  free(newStates);
+
+  if (done) {
+    mRestyleStart = -1;
+    Fl::remove_idle(restyle_idle_cb, this);
+  } else {
+    mRestyleStart = pos;
+  }
+}
+
+
+/*
+ Tokenizes the next chunk of lines that were modified.
+ */
+void Fl_Text_Display::restyle_idle_cb(void *cbArg) {
+  Fl_Text_Display *textD = (Fl_Text_Display *)cbArg;
+  if (textD->mRestyleStart < 0)
+    Fl::remove_idle(restyle_idle_cb, textD);
+  else
+    textD->restyle_lines(textD->mRestyleStart + restyle_chunk_size);
+}
+
+
+
 /**
  \brief Find the longest line of all visible lines.
 
@@ -1693,6 +2019,10 @@ void Fl_Text_Display::buffer_modified_cb( int pos, int nInserted, int nDeleted,
   IS_UTF8_ALIGNED2(buf, pos)
   IS_UTF8_ALIGNED2(buf, oldFirstChar)
 
+  /* keep the styles in step with the text */
+  if (textD->mStyleTokenizer && (nInserted != 0 || nDeleted != 0))
+    textD->restyle_modified(pos, nInserted, nDeleted);
+
   /* buffer modification cancels vertical cursor motion column */
   if ( nInserted != 0 || nDeleted != 0 )
     textD->mCursorPreferredXPos = -1;
@@ -2597,7 +2927,7 @@ int Fl_Text_Display::position_style( int lineStartPos, int lineLen, int lineInde
   IS_UTF8_ALIGNED2(buffer(), lineStartPos)
 
   Fl_Text_Buffer * buf = mBuffer;
-  Fl_Text_Buffer *styleBuf = mStyleBuffer;
+  bool styled = mStyleBuffer || mStyleRuns;
   int pos, style = 0;
 
   if ( lineStartPos == -1 || buf == NULL )
@@ -2605,11 +2935,11 @@ int Fl_Text_Display::position_style( int lineStartPos, int lineLen, int lineInde
 
   pos = lineStartPos + min( lineIndex, lineLen );
 
-  if ( styleBuf && lineIndex==lineLen && lineLen>0) {
-    style = ( unsigned char ) styleBuf->byte_at( pos-1 );
+  if ( styled && lineIndex==lineLen && lineLen>0) {
+    style = style_at( pos-1 );
     if (style == mUnfinishedStyle && mUnfinishedHighlightCB) {
       (mUnfinishedHighlightCB)( pos, mHighlightCBArg);
-      style = (unsigned char) styleBuf->byte_at( pos);
+      style = style_at( pos );
     }
     int si = (style & STYLE_LOOKUP_MASK) - 'A';
     if (si < 0) si = 0;
@@ -2619,12 +2949,12 @@ int Fl_Text_Display::position_style( int lineStartPos, int lineLen, int lineInde
       style = FILL_MASK;
   } else if ( lineIndex >= lineLen ) {
     style = FILL_MASK;
-  } else if ( styleBuf != NULL ) {
-    style = ( unsigned char ) styleBuf->byte_at( pos );
+  } else if ( styled ) {
+    style = style_at( pos );
     if (style == mUnfinishedStyle && mUnfinishedHighlightCB) {
       /* encountered "unfinished" style, trigger parsing */
       (mUnfinishedHighlightCB)( pos, mHighlightCBArg);
-      style = (unsigned char) styleBuf->byte_at( pos);
+      style = style_at( pos );
     }
   }
   if (buf->primary_selection()->includes(pos))
@@ -3418,11 +3748,24 @@ void Fl_Text_Display::find_wrap_range(const char *deletedText, int pos,
     deletedTextBuf->insert(pos-countFrom, deletedText);
   deletedTextBuf->copy(buffer(), pos+nInserted, countTo, pos-countFrom+nDeleted);
   /* Note that we need to take into account an offset for the style buffer:
-   the deletedTextBuf can be out of sync with the style buffer. */
-  wrapped_line_counter(deletedTextBuf, 0, length, INT_MAX, true, countFrom,
-                       &retPos, &retLines, &retLineStart, &retLineEnd, false);
+   the deletedTextBuf can be out of sync with the style buffer.
+   The lines are counted one at a time like the inserted lines above,
+   so that both counts agree on the lines at the ends of the range. */
+  nLines = 0;
+  lineStart = 0;
+  for (;;) {
+    wrapped_line_counter(deletedTextBuf, lineStart, length, 1, true, countFrom,
+                         &retPos, &retLines, &retLineStart, &retLineEnd);
+    if (retPos >= length) {
+      if (retPos != retLineEnd)
+        nLines++;
+      break;
+    }
+    lineStart = retPos;
+    nLines++;
+  }
   delete deletedTextBuf;
-  *linesDeleted = retLines;
+  *linesDeleted = nLines;
   mSuppressResync = 0;
 }
 
@@ -3692,8 +4035,8 @@ double Fl_Text_Display::measure_proportional_character(const char *s, int xPix,
   }
 
   int charLen = fl_utf8len1(*s), style = 0;
-  if (mStyleBuffer) {
-    style = mStyleBuffer->byte_at(pos);
+  if (mStyleBuffer || mStyleRuns) {
+    style = style_at(pos);
   }
   return string_width(s, charLen, style);
 }
@@ -3902,6 +4245,10 @@ void Fl_Text_Display::draw(void) {
   update_child(*mVScrollBar);
   update_child(*mHScrollBar);
 
+  // compute the styles of the visible lines
+  if (mRestyleStart >= 0 && mRestyleStart <= mLastChar)
+    restyle_lines(mLastChar + 1);
+
   // draw all of the text
   if (damage() & (FL_DAMAGE_ALL | FL_DAMAGE_EXPOSE)) {
     //printf("drawing all text\n");
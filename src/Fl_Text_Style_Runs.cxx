@@ -0,0 +1,331 @@
+//
+// Run-length encoded text styles for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl_Text_Style_Runs.H>
+#include <FL/Fl_Text_Buffer.H>
+#include <stdlib.h>
+#include <string.h>
+
+
+/**
+ \brief Create the runs for the text of a buffer.
+
+ All text of \p buf gets the style \p style. If \p buf is NULL, the runs
+ cover no text, and the owner must call update() for every modification
+ of the text they describe.
+
+ The runs must be deleted before the text buffer.
+
+ \param buf the text buffer, or NULL
+ \param style the style of the text, and of the text inserted into an
+   empty buffer
+ */
+Fl_Text_Style_Runs::Fl_Text_Style_Runs(Fl_Text_Buffer *buf, char style) {
+  mBuffer = buf;
+  mLength = 0;
+  mDefaultStyle = style;
+  mRunCount = 0;
+  mSize = 16;
+  mGapStart = 0;
+  mGapEnd = mSize;
+  mStarts = (int *)malloc(mSize * sizeof(int));
+  mStyles = (char *)malloc(mSize);
+  mLastRun = 0;
+  if (mBuffer) {
+    update(0, mBuffer->length(), 0);
+    mBuffer->add_modify_callback(buffer_modified_cb, this);
+  }
+}
+
+
+/**
+ \brief Detach the runs from the text buffer and free them.
+ */
+Fl_Text_Style_Runs::~Fl_Text_Style_Runs() {
+  if (mBuffer)
+    mBuffer->remove_modify_callback(buffer_modified_cb, this);
+  free(mStarts);
+  free(mStyles);
+}
+
+
+/*
+ Returns the start of the run with the given index.
+ */
+int Fl_Text_Style_Runs::start_of(int index) const {
+  if (index < mGapStart)
+    return mStarts[index];
+  return mLength - mStarts[index + mGapEnd - mGapStart];
+}
+
+
+/*
+ Returns the style of the run with the given index.
+ */
+char Fl_Text_Style_Runs::style_of(int index) const {
+  if (index < mGapStart)
+    return mStyles[index];
+  return mStyles[index + mGapEnd - mGapStart];
+}
+
+
+/*
+ Returns the index of the run containing pos, which must be in the text.
+ The runs next to the run found by the last call are tried first.
+ */
+int Fl_Text_Style_Runs::find_run(int pos) const {
+  int i = mLastRun;
+  if (i < mRunCount && start_of(i) <= pos) {
+    if (i + 1 == mRunCount || pos < start_of(i + 1))
+      return i;
+    if (i + 2 == mRunCount || pos < start_of(i + 2))
+      return mLastRun = i + 1;
+  }
+  int a = 0, b = mRunCount;
+  while (b - a > 1) {
+    int m = (a + b) / 2;
+    if (start_of(m) <= pos) a = m;
+    else b = m;
+  }
+  return mLastRun = a;
+}
+
+
+/**
+ \brief Returns the style byte of a text position.
+
+ If the runs cover no text, this returns the style given to the constructor.
+
+ \param pos byte index into the text
+ \return style byte
+ */
+char Fl_Text_Style_Runs::style_at(int pos) const {
+  if (!mRunCount)
+    return mDefaultStyle;
+  return style_of(find_run(pos));
+}
+
+
+/**
+ \brief Returns the start of the run containing a text position.
+ \param pos byte index into the text
+ \return the first position with the style of \p pos
+ */
+int Fl_Text_Style_Runs::run_start(int pos) const {
+  if (!mRunCount)
+    return 0;
+  return start_of(find_run(pos));
+}
+
+
+/**
+ \brief Returns the end of the run containing a text position.
+ \param pos byte index into the text
+ \return the first position after \p pos with a different style, or length()
+ */
+int Fl_Text_Style_Runs::run_end(int pos) const {
+  if (!mRunCount)
+    return mLength;
+  int i = find_run(pos);
+  return i + 1 < mRunCount ? start_of(i + 1) : mLength;
+}
+
+
+/**
+ \brief Copies the style bytes of a range of text.
+
+ This is the equivalent of Fl_Text_Buffer::text_range() for a style buffer,
+ but does not allocate memory.
+
+ \param start, end byte range of the text
+ \param[out] style receives end - start bytes, it is not nul-terminated
+ */
+void Fl_Text_Style_Runs::styles(int start, int end, char *style) const {
+  if (start < 0) start = 0;
+  if (end > mLength) end = mLength;
+  if (start >= end)
+    return;
+  int i = find_run(start);
+  while (start < end) {
+    int e = i + 1 < mRunCount ? start_of(i + 1) : mLength;
+    if (e > end) e = end;
+    memset(style, style_of(i), e - start);
+    style += e - start;
+    start = e;
+    i++;
+  }
+}
+
+
+/*
+ Moves the gap in front of the run with the given index. Runs moving
+ from after the gap to before it get their start back, and vice versa.
+ */
+void Fl_Text_Style_Runs::move_gap(int index) {
+  int gap = mGapEnd - mGapStart;
+  if (index < mGapStart) {
+    for (int i = mGapStart - 1; i >= index; i--) {
+      mStarts[i + gap] = mLength - mStarts[i];
+      mStyles[i + gap] = mStyles[i];
+    }
+  } else {
+    for (int i = mGapStart; i < index; i++) {
+      mStarts[i] = mLength - mStarts[i + gap];
+      mStyles[i] = mStyles[i + gap];
+    }
+  }
+  mGapStart = index;
+  mGapEnd = index + gap;
+}
+
+
+/*
+ Adds a run at the gap, unless the run before the gap has the same style.
+ The gap must not be empty.
+ */
+void Fl_Text_Style_Runs::append_run(int start, char style) {
+  if (mGapStart > 0 && mStyles[mGapStart - 1] == style)
+    return;
+  mStarts[mGapStart] = start;
+  mStyles[mGapStart] = style;
+  mGapStart++;
+  mRunCount++;
+}
+
+
+/*
+ Replaces the bytes from start to end by newLength bytes. If nStyles is 1,
+ all new bytes get the style style[0], otherwise style holds the style of
+ each new byte.
+ */
+void Fl_Text_Style_Runs::replace_runs(int start, int end, int newLength,
+                                      const char *style, int nStyles) {
+  // find the runs overlapping the range and the parts of them that remain
+  int first = mRunCount, last = mRunCount;
+  int leftStart = start, rightEnd = end;
+  char leftStyle = 0, rightStyle = 0;
+  if (start < mLength) {
+    first = find_run(start);
+    leftStart = start_of(first);
+    leftStyle = style_of(first);
+  }
+  if (end < mLength) {
+    int i = find_run(end);
+    last = i + 1;
+    rightEnd = last < mRunCount ? start_of(last) : mLength;
+    rightStyle = style_of(i);
+  }
+
+  // remove them, and make room for the new runs
+  move_gap(last);
+  mRunCount -= last - first;
+  mGapStart = first;
+  int needed = (nStyles == 1 ? 1 : newLength) + 2;
+  if (mGapEnd - mGapStart < needed) {
+    int newSize = mSize * 2;
+    if (newSize < mRunCount + needed + 16)
+      newSize = mRunCount + needed + 16;
+    int nAfter = mSize - mGapEnd;
+    mStarts = (int *)realloc(mStarts, newSize * sizeof(int));
+    mStyles = (char *)realloc(mStyles, newSize);
+    memmove(mStarts + newSize - nAfter, mStarts + mGapEnd, nAfter * sizeof(int));
+    memmove(mStyles + newSize - nAfter, mStyles + mGapEnd, nAfter);
+    mGapEnd = newSize - nAfter;
+    mSize = newSize;
+  }
+
+  // the runs after the gap move with the end of the text
+  int delta = newLength - (end - start);
+  if (leftStart < start)
+    append_run(leftStart, leftStyle);
+  if (newLength > 0) {
+    if (nStyles == 1) {
+      append_run(start, style[0]);
+    } else {
+      for (int i = 0; i < newLength; i++)
+        append_run(start + i, style[i]);
+    }
+  }
+  if (end < rightEnd)
+    append_run(end + delta, rightStyle);
+  mLength += delta;
+  mLastRun = mGapStart > 0 ? mGapStart - 1 : 0;
+}
+
+
+/**
+ \brief Sets the style of a range of text.
+ \param start, end byte range of the text
+ \param style the new style byte
+ */
+void Fl_Text_Style_Runs::set_style(int start, int end, char style) {
+  if (start < 0) start = 0;
+  if (end > mLength) end = mLength;
+  if (start >= end)
+    return;
+  replace_runs(start, end, end - start, &style, 1);
+}
+
+
+/**
+ \brief Sets the styles of a range of text from an array of style bytes.
+
+ This is the equivalent of Fl_Text_Buffer::replace() for a style buffer.
+
+ \param start position of the first byte of the range
+ \param style one style byte for each text byte
+ \param n number of bytes in \p style
+ */
+void Fl_Text_Style_Runs::set_styles(int start, const char *style, int n) {
+  if (start < 0) {
+    style -= start;
+    n += start;
+    start = 0;
+  }
+  if (n > mLength - start)
+    n = mLength - start;
+  if (n <= 0)
+    return;
+  replace_runs(start, start + n, n, style, n);
+}
+
+
+/**
+ \brief Follows a modification of the text.
+
+ This is called automatically for modifications of the text buffer given
+ to the constructor. Inserted text gets the style of the byte before it,
+ or of the first byte of the text if it is inserted at the start.
+
+ \param pos position of the modification
+ \param nInserted number of inserted bytes
+ \param nDeleted number of deleted bytes
+ */
+void Fl_Text_Style_Runs::update(int pos, int nInserted, int nDeleted) {
+  char style = style_at(pos > 0 ? pos - 1 : 0);
+  replace_runs(pos, pos + nDeleted, nInserted, &style, 1);
+}
+
+
+/*
+ Keeps the runs in step with the text buffer.
+ */
+void Fl_Text_Style_Runs::buffer_modified_cb(int pos, int nInserted,
+                                            int nDeleted, int, const char *,
+                                            void *cbArg) {
+  if (nInserted || nDeleted)
+    ((Fl_Text_Style_Runs *)cbArg)->update(pos, nInserted, nDeleted);
+}
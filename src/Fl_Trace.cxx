@@ -0,0 +1,342 @@
+//
+// Tracing support for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include "fl_trace.h"
+
+int Fl_Trace::recording_ = 0;
+
+#if FLTK_USE_TRACING
+
+#include <FL/fl_utf8.h>
+#include "flstring.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#elif defined(__APPLE__)
+#  include <mach/mach_time.h>
+#else
+#  include <time.h>
+#endif
+
+#if defined(__GNUC__)
+#  include <cxxabi.h> // abi::__cxa_demangle()
+#endif
+
+// One traced phase
+struct Fl_Trace_Event {
+  volatile unsigned seq;  // index of the event + 1 once written, 0 while written
+  unsigned tid;           // id of the thread that recorded the event
+  double start;           // start time in microseconds
+  double duration;        // duration in microseconds
+  const char *name;       // name of the phase, or a type name
+  const char *category;
+  const char *arg_name;   // NULL if the phase has no argument
+  int arg;
+  int is_type;            // name is a type name of typeid()
+};
+
+static Fl_Trace_Event *ring = 0;    // the events, ring_size is a power of two
+static unsigned ring_size = 0;
+static volatile unsigned ring_count = 0; // events recorded since clear()
+static volatile unsigned thread_count = 0; // threads that recorded events
+
+// Variables of each thread, also when FLTK is built as a Windows DLL
+#if defined(_MSC_VER)
+#  define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#  define TRACE_THREAD_LOCAL __thread
+#endif
+
+// Increments v and returns its previous value
+static unsigned fetch_and_increment(volatile unsigned *v) {
+#if defined(_WIN32)
+  return (unsigned)InterlockedIncrement((LONG volatile *)v) - 1;
+#elif defined(__GNUC__)
+  return __sync_fetch_and_add(v, 1);
+#else
+  return (*v)++;
+#endif
+}
+
+// Makes the memory writes before it visible to other threads before the ones after it
+static void memory_barrier() {
+#if defined(_WIN32)
+  MemoryBarrier();
+#elif defined(__GNUC__)
+  __sync_synchronize();
+#endif
+}
+
+// Returns the id of the calling thread: 1 for the first thread that records
+// events, usually the one that called Fl_Trace::start(), 2 for the next one...
+static unsigned thread_id() {
+  static TRACE_THREAD_LOCAL unsigned id = 0;
+  if (!id) id = fetch_and_increment(&thread_count) + 1;
+  return id;
+}
+
+// Returns the next free slot of the ring buffer, marked as being written
+static Fl_Trace_Event &next_event(unsigned &seq) {
+  seq = fetch_and_increment(&ring_count) + 1;
+  Fl_Trace_Event &e = ring[(seq - 1) & (ring_size - 1)];
+  e.seq = 0;
+  memory_barrier();
+  return e;
+}
+
+// Marks event e of next_event() as written, so that write_json() writes it
+static void event_written(Fl_Trace_Event &e, unsigned seq) {
+  memory_barrier();
+  e.seq = seq;
+}
+
+/**
+  Returns 1 if tracing is compiled into the library, 0 otherwise.
+*/
+int Fl_Trace::available() {
+  return 1;
+}
+
+/**
+  Starts recording events.
+
+  The ring buffer holds the last \p capacity events, rounded up to a power
+  of two. If it has a different size, the events recorded so far are
+  discarded. Call this from the thread that runs the event loop.
+
+  \param[in] capacity  number of events kept, each takes about 56 bytes
+*/
+void Fl_Trace::start(int capacity) {
+  unsigned size = 1024;
+  while (size < (unsigned)capacity && size < 0x1000000) size *= 2;
+  if (size != ring_size) {
+    recording_ = 0;
+    free(ring);
+    ring = (Fl_Trace_Event *)calloc(size, sizeof(Fl_Trace_Event));
+    ring_size = ring ? size : 0;
+    ring_count = 0;
+  }
+  thread_id();
+  recording_ = (ring != 0);
+}
+
+/**
+  Stops recording events. The recorded events are kept.
+*/
+void Fl_Trace::stop() {
+  recording_ = 0;
+}
+
+/**
+  Discards all recorded events.
+*/
+void Fl_Trace::clear() {
+  ring_count = 0;
+  for (unsigned i = 0; i < ring_size; i++) ring[i].seq = 0;
+}
+
+/**
+  Returns the number of recorded events in the ring buffer.
+*/
+int Fl_Trace::events() {
+  return ring_count < ring_size ? (int)ring_count : (int)ring_size;
+}
+
+/**
+  Returns the time in microseconds since an arbitrary point in the past.
+
+  The clock is monotonic, so that durations are correct if the system time
+  is changed. Use this as the start time of record().
+*/
+double Fl_Trace::now() {
+#if defined(_WIN32)
+  static double scale = 0.0;
+  LARGE_INTEGER t;
+  if (scale == 0.0) {
+    QueryPerformanceFrequency(&t);
+    scale = 1000000.0 / (double)t.QuadPart;
+  }
+  QueryPerformanceCounter(&t);
+  return (double)t.QuadPart * scale;
+#elif defined(__APPLE__)
+  static double scale = 0.0;
+  if (scale == 0.0) {
+    mach_timebase_info_data_t info;
+    mach_timebase_info(&info);
+    scale = (double)info.numer / info.denom / 1000.0;
+  }
+  return (double)mach_absolute_time() * scale;
+#else
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000.0 + t.tv_nsec / 1000.0;
+#endif
+}
+
+/**
+  Records a phase that started at \p start and ends now.
+
+  Applications can use this to trace their own work along with FLTK's:
+  \code
+  double t = Fl_Trace::recording() ? Fl_Trace::now() : 0;
+  load_data();
+  if (t) Fl_Trace::record("load_data", "app", t);
+  \endcode
+
+  This can be called by any thread while tracing is started.
+
+  \param[in] name      name of the phase, a string that is never freed
+  \param[in] category  category of the phase, a string that is never freed
+  \param[in] start     start time of the phase returned by now()
+  \param[in] arg_name  name of the argument, or NULL
+  \param[in] arg       value of the argument
+*/
+void Fl_Trace::record(const char *name, const char *category, double start,
+                      const char *arg_name, int arg) {
+  double end = now();
+  if (!recording_) return;
+  unsigned seq;
+  Fl_Trace_Event &e = next_event(seq);
+  e.tid = thread_id();
+  e.start = start;
+  e.duration = end - start;
+  e.name = name;
+  e.category = category;
+  e.arg_name = arg_name;
+  e.arg = arg;
+  e.is_type = 0;
+  event_written(e, seq);
+}
+
+/**
+  Records a phase named after a type, that started at \p start and ends now.
+
+  This is record() for a name returned by typeid().name(), which
+  write_json() turns into a readable class name.
+*/
+void Fl_Trace::record_type(const char *type_name, const char *category, double start,
+                           const char *arg_name, int arg) {
+  double end = now();
+  if (!recording_) return;
+  unsigned seq;
+  Fl_Trace_Event &e = next_event(seq);
+  e.tid = thread_id();
+  e.start = start;
+  e.duration = end - start;
+  e.name = type_name;
+  e.category = category;
+  e.arg_name = arg_name;
+  e.arg = arg;
+  e.is_type = 1;
+  event_written(e, seq);
+}
+
+// Writes s as a JSON string
+static void write_string(FILE *f, const char *s) {
+  putc('"', f);
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') fprintf(f, "\\%c", *s);
+    else if ((unsigned char)*s < ' ') fprintf(f, "\\u%04x", *s);
+    else putc(*s, f);
+  }
+  putc('"', f);
+}
+
+// Writes the class name of a type name of typeid()
+static void write_type(FILE *f, const char *name) {
+#if defined(__GNUC__)
+  int status;
+  char *s = abi::__cxa_demangle(name, 0, 0, &status);
+  if (s) {
+    write_string(f, s);
+    free(s);
+    return;
+  }
+#endif
+  if (!strncmp(name, "class ", 6)) name += 6; // Visual C++
+  write_string(f, name);
+}
+
+// Copies the event of index i to e, returns 0 if it is not written yet
+// or if it was replaced while it was copied
+static int read_event(unsigned i, Fl_Trace_Event &e) {
+  const Fl_Trace_Event &slot = ring[i & (ring_size - 1)];
+  unsigned seq = slot.seq;
+  if (seq != i + 1) return 0;
+  memory_barrier();
+  e = slot;
+  memory_barrier();
+  return slot.seq == seq;
+}
+
+/**
+  Writes the recorded events to a file in the Chrome trace event format.
+
+  The events are written from the oldest to the most recent one. Time
+  stamps are in microseconds since the oldest event, and each thread has
+  a track of its own. Events that threads are recording while the file is
+  written are left out, so stop tracing first to write all events.
+
+  \param[in] filename  name of the file, UTF-8 encoded
+  \return 0 on success, -1 if the file cannot be written
+*/
+int Fl_Trace::write_json(const char *filename) {
+  FILE *f = fl_fopen(filename, "w");
+  if (!f) return -1;
+  unsigned n = events(), first = ring_count - n, i;
+  Fl_Trace_Event e;
+  double base = 0.0;
+  int written = 0;
+  for (i = 0; i < n; i++) {
+    if (read_event(first + i, e) && (!written++ || e.start < base)) base = e.start;
+  }
+  written = 0;
+  fputs("{\"traceEvents\":[", f);
+  for (i = 0; i < n; i++) {
+    if (!read_event(first + i, e)) continue;
+    fputs(written++ ? ",\n{\"name\":" : "\n{\"name\":", f);
+    if (e.is_type) write_type(f, e.name);
+    else write_string(f, e.name);
+    fputs(",\"cat\":", f);
+    write_string(f, e.category);
+    fprintf(f, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u",
+            e.start - base, e.duration, e.tid);
+    if (e.arg_name) {
+      fputs(",\"args\":{", f);
+      write_string(f, e.arg_name);
+      fprintf(f, ":%d}", e.arg);
+    }
+    putc('}', f);
+  }
+  fputs("\n],\"displayTimeUnit\":\"ms\"}\n", f);
+  return fclose(f) ? -1 : 0;
+}
+
+#else // FLTK_USE_TRACING
+
+int Fl_Trace::available() { return 0; }
+void Fl_Trace::start(int) {}
+void Fl_Trace::stop() {}
+void Fl_Trace::clear() {}
+int Fl_Trace::events() { return 0; }
+double Fl_Trace::now() { return 0.0; }
+void Fl_Trace::record(const char *, const char *, double, const char *, int) {}
+void Fl_Trace::record_type(const char *, const char *, double, const char *, int) {}
+int Fl_Trace::write_json(const char *) { return -1; }
+
+#endif // FLTK_USE_TRACING
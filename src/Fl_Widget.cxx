@@ -130,6 +130,7 @@ Fl_Widget::Fl_Widget(int X, int Y, int W, int H, const char* L) {
   when_          = FL_WHEN_RELEASE;
 
   parent_ = 0;
+  index_ = 0;
   if (Fl_Group::current()) Fl_Group::current()->add(this);
   if (!fl_graphics_driver) {
     // Make sure fl_graphics_driver is initialized. Important if we are called by a static initializer.
@@ -139,6 +140,10 @@ Fl_Widget::Fl_Widget(int X, int Y, int W, int H, const char* L) {
 
 void Fl_Widget::resize(int X, int Y, int W, int H) {
   x_ = X; y_ = Y; w_ = W; h_ = H;
+  // Fl_Value_Input makes itself the parent of its input field, so check that
+  // the parent really is a group before looking at its spatial index
+  Fl_Group *g = parent_ ? parent_->as_group() : 0;
+  if (g && g->spatial_index_) g->invalidate_spatial_index_();
 }
 
 // this is useful for parent widgets to call to resize children:
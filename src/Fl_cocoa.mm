@@ -24,6 +24,7 @@ extern "C" {
 #include "Fl_Window_Driver.H"
 #include "Fl_Screen_Driver.H"
 #include "Fl_Timeout.h"
+#include "Fl_Frame_Scheduler.h"
 #include <FL/Fl_Window.H>
 #include <FL/Fl_Tooltip.H>
 #include <FL/Fl_Printer.H>
@@ -783,7 +784,7 @@ double Fl_Darwin_System_Driver::wait(double time_to_wait)
   time_to_wait = Fl_System_Driver::wait(time_to_wait);
 
   if (fl_mac_os_version < 101100) NSDisableScreenUpdates(); // 10.3 Makes updates to all windows appear as a single event
-  Fl::flush();
+  Fl_Frame_Scheduler::flush();
   if (fl_mac_os_version < 101100) NSEnableScreenUpdates(); // 10.3
   if (Fl::idle) // 'idle' may have been set within flush()
     time_to_wait = 0.0;
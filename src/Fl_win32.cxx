@@ -55,6 +55,7 @@ void fl_cleanup_dc_list(void);
 #include "Fl_Window_Driver.H"
 #include "Fl_Screen_Driver.H"
 #include "Fl_Timeout.h"
+#include "Fl_Frame_Scheduler.h"
 #include "print_button.h"
 #include <FL/Fl_Graphics_Driver.H> // for fl_graphics_driver
 #include "drivers/WinAPI/Fl_WinAPI_Window_Driver.H"
@@ -452,7 +453,7 @@ double Fl_WinAPI_System_Driver::wait(double time_to_wait) {
     }
   }
 
-  if (Fl::idle || Fl::damage())
+  if (Fl::idle || (Fl::damage() && !Fl_Frame_Scheduler::deferred()))
     time_to_wait = 0.0;
 
   // if there are no more windows and this timer is set
@@ -515,7 +516,7 @@ double Fl_WinAPI_System_Driver::wait(double time_to_wait) {
     process_awake_handler_requests();
   }
 
-  Fl::flush();
+  Fl_Frame_Scheduler::flush();
 
   // This should return 0 if only timer events were handled:
   return 1;
@@ -43,6 +43,7 @@
 #  include "drivers/X11/Fl_X11_System_Driver.H"
 #  include "drivers/Xlib/Fl_Xlib_Graphics_Driver.H"
 #  include "print_button.h"
+#  include "fl_trace.h"
 #  include <unistd.h>
 #  include <time.h>
 #  include <sys/time.h>
@@ -104,7 +105,9 @@ static void do_queued_events() {
     XNextEvent(fl_display, &xevent);
     if (fl_send_system_handlers(&xevent))
       continue;
+    FL_TRACE_START(t);
     fl_handle(xevent);
+    FL_TRACE(t, "fl_handle", "event", "type", xevent.type);
   }
   // we send FL_LEAVE only if the mouse did not enter some other window:
   if (!in_a_window) Fl::handle(FL_LEAVE, 0);
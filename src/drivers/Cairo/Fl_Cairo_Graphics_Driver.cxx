@@ -22,6 +22,7 @@
 #if USE_PANGO
 
 #include "Fl_Cairo_Graphics_Driver.H"
+#include "Fl_Pango_Layout_Cache.H"
 #include <FL/platform.H>
 #include <FL/fl_draw.H>
 #include <cairo/cairo.h>
@@ -70,6 +71,8 @@ Fl_Cairo_Graphics_Driver::Fl_Cairo_Graphics_Driver() : Fl_Graphics_Driver() {
   cairo_ = NULL;
   pango_layout_ = NULL;
   pango_layout_cairo_ = NULL;
+  layout_cache_ = NULL;
+  layout_cache_fonts_ = font_changes_;
   dummy_cairo_ = NULL;
   linestyle_ = FL_SOLID;
   clip_ = NULL;
@@ -80,14 +83,18 @@ Fl_Cairo_Graphics_Driver::Fl_Cairo_Graphics_Driver() : Fl_Graphics_Driver() {
 }
 
 Fl_Cairo_Graphics_Driver::~Fl_Cairo_Graphics_Driver() {
+  delete layout_cache_;
   if (pango_layout_) g_object_unref(pango_layout_);
 }
 
+int Fl_Cairo_Graphics_Driver::font_changes_ = 0;
+
 const cairo_format_t Fl_Cairo_Graphics_Driver::cairo_format = CAIRO_FORMAT_ARGB32;
 
 
 void Fl_Cairo_Graphics_Driver::set_cairo(cairo_t *cr, float s) {
   if (dummy_cairo_) {
+    if (layout_cache_) layout_cache_->clear(); // these layouts share the context of pango_layout_
     g_object_unref(pango_layout_);
     pango_layout_ = NULL;
     cairo_destroy(dummy_cairo_);
@@ -1029,6 +1036,7 @@ void Fl_Cairo_Graphics_Driver::font_name(int num, const char *name) {
       Fl_Font_Descriptor* n = f->next; delete f; f = n;
     }
     s->first = 0;
+    font_changes_++; // cached layouts may refer to deleted font descriptions
   }
   s->name = name;
   s->fontname[0] = 0;
@@ -1136,6 +1144,10 @@ void Fl_Cairo_Graphics_Driver::font(Fl_Font fnum, Fl_Fontsize s) {
   } else if (pango_layout_cairo_ != cairo_) {
     pango_cairo_update_layout(cairo_, pango_layout_);
     pango_layout_cairo_ = cairo_;
+#if !PANGO_VERSION_CHECK(1,32,4)
+    // older Pango versions don't update layouts when their context changes
+    if (layout_cache_) layout_cache_->clear();
+#endif
   }
   if (s == 0) return;
   if (font() == fnum && size() == s) return;
@@ -1149,13 +1161,25 @@ void Fl_Cairo_Graphics_Driver::font(Fl_Font fnum, Fl_Fontsize s) {
 }
 
 
+// Returns a layout of str in the current font, shaped only once for repeated strings.
+// Cached layouts share the PangoContext of pango_layout_.
+PangoLayout *Fl_Cairo_Graphics_Driver::cached_layout_(const char *str, int n) {
+  if (!layout_cache_) layout_cache_ = new Fl_Pango_Layout_Cache();
+  if (layout_cache_fonts_ != font_changes_) {
+    layout_cache_->clear();
+    layout_cache_fonts_ = font_changes_;
+  }
+  return layout_cache_->layout(pango_layout_get_context(pango_layout_),
+                               ((Fl_Cairo_Font_Descriptor*)font_descriptor())->fontref, size(), str, n);
+}
+
+
 void Fl_Cairo_Graphics_Driver::draw(const char* str, int n, float x, float y) {
   if (!n) return;
   cairo_save(cairo_);
   // The -0.5 below makes underscores visible in Fl_Text_Display at scale = 1
   cairo_translate(cairo_, x, y - height() + descent() -0.5);
-  pango_layout_set_text(pango_layout_, str, n);
-  pango_cairo_show_layout(cairo_, pango_layout_);
+  pango_cairo_show_layout(cairo_, cached_layout_(str, n));
   cairo_restore(cairo_);
   surface_needs_commit();
 }
@@ -1221,9 +1245,8 @@ double Fl_Cairo_Graphics_Driver::width(unsigned int c) {
 
 
 void Fl_Cairo_Graphics_Driver::text_extents(const char* txt, int n, int& dx, int& dy, int& w, int& h) {
-  pango_layout_set_text(pango_layout_, txt, n);
   PangoRectangle ink_rect;
-  pango_layout_get_pixel_extents(pango_layout_, &ink_rect, NULL);
+  pango_layout_get_pixel_extents(cached_layout_(txt, n), &ink_rect, NULL);
   dx = ink_rect.x;
   dy = ink_rect.y - height() + descent();
   w = ink_rect.width;
@@ -0,0 +1,124 @@
+//
+// Cache of shaped Pango layouts for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <config.h>
+#if USE_PANGO
+
+#include "Fl_Pango_Layout_Cache.H"
+#include <FL/platform_types.h> // fl_intptr_t
+#include <stdlib.h>
+#include <string.h>
+
+
+Fl_Pango_Layout_Cache::Fl_Pango_Layout_Cache(int capacity) {
+  capacity_ = (capacity > 0 ? capacity : 1);
+  bucket_count_ = 64;
+  while (bucket_count_ < capacity_) bucket_count_ *= 2;
+  buckets_ = (Entry**)calloc(bucket_count_, sizeof(Entry*));
+  first_ = last_ = NULL;
+  count_ = 0;
+  hits_ = misses_ = 0;
+}
+
+
+Fl_Pango_Layout_Cache::~Fl_Pango_Layout_Cache() {
+  clear();
+  free(buckets_);
+}
+
+
+/** Removes all layouts from the cache.
+ This must be called when a font description used as key may have been freed.
+ */
+void Fl_Pango_Layout_Cache::clear() {
+  while (first_) {
+    Entry *e = first_;
+    first_ = e->next;
+    g_object_unref(e->layout);
+    free(e->text);
+    free(e);
+  }
+  last_ = NULL;
+  count_ = 0;
+  memset(buckets_, 0, bucket_count_ * sizeof(Entry*));
+}
+
+
+// Removes e from its hash bucket and from the LRU list
+void Fl_Pango_Layout_Cache::unlink_(Entry *e) {
+  Entry **p = buckets_ + (e->hash & (bucket_count_ - 1));
+  while (*p != e) p = &(*p)->hash_next;
+  *p = e->hash_next;
+  if (e->prev) e->prev->next = e->next;
+  else first_ = e->next;
+  if (e->next) e->next->prev = e->prev;
+  else last_ = e->prev;
+}
+
+
+/** Returns a layout of the n bytes of str using the given font description and size.
+ The returned layout belongs to the cache and remains valid until the next call
+ to layout() or clear(); its text and font description must not be changed.
+ */
+PangoLayout *Fl_Pango_Layout_Cache::layout(PangoContext *context, const PangoFontDescription *font,
+                                           int size, const char *str, int n) {
+  // FNV-1a hash of the text, the font and the size
+  unsigned hash = 2166136261U;
+  for (int i = 0; i < n; i++) hash = (hash ^ (unsigned char)str[i]) * 16777619U;
+  hash = (hash ^ (unsigned)(fl_intptr_t)font) * 16777619U;
+  hash = (hash ^ (unsigned)size) * 16777619U;
+  Entry *e;
+  for (e = buckets_[hash & (bucket_count_ - 1)]; e; e = e->hash_next) {
+    if (e->hash == hash && e->font == font && e->size == size && e->length == n &&
+        !memcmp(e->text, str, n)) break;
+  }
+  if (e) {
+    hits_++;
+    unlink_(e);
+  } else {
+    misses_++;
+    if (count_ >= capacity_) { // recycle the least recently used entry
+      e = last_;
+      unlink_(e);
+      free(e->text);
+    } else {
+      e = (Entry*)malloc(sizeof(Entry));
+      e->layout = pango_layout_new(context);
+      count_++;
+    }
+    e->font = font;
+    e->size = size;
+    e->hash = hash;
+    e->length = n;
+    e->text = (char*)malloc(n + 1);
+    memcpy(e->text, str, n);
+    e->text[n] = 0;
+    pango_layout_set_font_description(e->layout, font); // the layout keeps a copy of font
+    pango_layout_set_text(e->layout, str, n);
+  }
+  // insert e in its bucket and at the head of the LRU list
+  Entry **bucket = buckets_ + (hash & (bucket_count_ - 1));
+  e->hash_next = *bucket;
+  *bucket = e;
+  e->prev = NULL;
+  e->next = first_;
+  if (first_) first_->prev = e;
+  else last_ = e;
+  first_ = e;
+  return e->layout;
+}
+
+#endif // USE_PANGO
@@ -0,0 +1,590 @@
+//
+// Software rendering graphics driver of the headless platform for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2010-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <config.h>
+#include "Fl_Headless_Graphics_Driver.H"
+#include <FL/Fl.H>
+#include <FL/fl_draw.H>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+Fl_Headless_Graphics_Driver::Fl_Headless_Graphics_Driver() : Fl_Graphics_Driver() {
+  buffer_ = NULL;
+  rgb_ = 0;
+  clip_rects_ = NULL;
+  clip_count_ = clip_alloc_ = 0;
+  offset_x_ = offset_y_ = 0;
+  depth_ = 0;
+  line_width_ = 1;
+  dashes_[0] = 0;
+  dash_index_ = dash_left_ = 0;
+}
+
+
+Fl_Headless_Graphics_Driver::~Fl_Headless_Graphics_Driver() {
+  free(clip_rects_);
+}
+
+
+fl_headless_buffer *Fl_Headless_Graphics_Driver::create_buffer(int width, int height) {
+  fl_headless_buffer *buffer = (fl_headless_buffer*)malloc(sizeof(fl_headless_buffer));
+  if (width < 1) width = 1;
+  if (height < 1) height = 1;
+  buffer->width = width;
+  buffer->height = height;
+  buffer->pixels = (uint32_t*)calloc(size_t(width) * height, sizeof(uint32_t));
+  return buffer;
+}
+
+
+void Fl_Headless_Graphics_Driver::delete_buffer(fl_headless_buffer *buffer) {
+  if (!buffer) return;
+  free(buffer->pixels);
+  free(buffer);
+}
+
+
+void Fl_Headless_Graphics_Driver::set_buffer(fl_headless_buffer *buffer) {
+  buffer_ = buffer;
+  restore_clip();
+}
+
+
+void Fl_Headless_Graphics_Driver::translate_all(int dx, int dy) { // reversibly adds dx,dy to the offset between user and buffer coordinates
+  if (depth_ < FL_HEADLESS_TRANSLATION_STACK_SIZE) {
+    stack_x_[depth_] = offset_x_;
+    stack_y_[depth_] = offset_y_;
+    depth_++;
+  } else {
+    Fl::warning("%s: translate stack overflow!", "Fl_Headless_Graphics_Driver");
+  }
+  offset_x_ += dx;
+  offset_y_ += dy;
+  push_matrix();
+  translate(dx, dy);
+  restore_clip();
+}
+
+
+void Fl_Headless_Graphics_Driver::untranslate_all() { // undoes previous translate_all()
+  if (depth_ > 0) depth_--;
+  offset_x_ = stack_x_[depth_];
+  offset_y_ = stack_y_[depth_];
+  pop_matrix();
+  restore_clip();
+}
+
+
+// ----------------------------------------------------------------------------
+// Regions are unions of non-overlapping rectangles in user coordinates.
+
+static void region_append(flHeadlessRegion *r, int x, int y, int w, int h) {
+  r->rects = (flHeadlessRect*)realloc(r->rects, (r->count + 1) * sizeof(flHeadlessRect));
+  flHeadlessRect *rect = r->rects + r->count++;
+  rect->x = x; rect->y = y; rect->w = w; rect->h = h;
+}
+
+
+// Adds to region r the parts of rectangle a not covered by rectangles r->rects[from..end-1]
+static void region_add_uncovered(flHeadlessRegion *r, flHeadlessRect a, int from, int end) {
+  if (a.w <= 0 || a.h <= 0) return;
+  for (int i = from; i < end; i++) {
+    flHeadlessRect b = r->rects[i];
+    if (a.x >= b.x + b.w || b.x >= a.x + a.w || a.y >= b.y + b.h || b.y >= a.y + a.h) continue;
+    // split a into its parts outside b
+    int y0 = (a.y > b.y ? a.y : b.y);
+    int y1 = (a.y + a.h < b.y + b.h ? a.y + a.h : b.y + b.h);
+    flHeadlessRect part;
+    part.x = a.x; part.w = a.w;
+    part.y = a.y; part.h = y0 - a.y;
+    region_add_uncovered(r, part, i + 1, end); // above b
+    part.y = y1; part.h = a.y + a.h - y1;
+    region_add_uncovered(r, part, i + 1, end); // below b
+    part.y = y0; part.h = y1 - y0;
+    part.w = b.x - a.x;
+    region_add_uncovered(r, part, i + 1, end); // left of b
+    part.x = b.x + b.w; part.w = a.x + a.w - part.x;
+    region_add_uncovered(r, part, i + 1, end); // right of b
+    return;
+  }
+  region_append(r, a.x, a.y, a.w, a.h);
+}
+
+
+Fl_Region Fl_Headless_Graphics_Driver::XRectangleRegion(int x, int y, int w, int h) {
+  flHeadlessRegion *r = (flHeadlessRegion*)calloc(1, sizeof(flHeadlessRegion));
+  if (w > 0 && h > 0) region_append(r, x, y, w, h);
+  return r;
+}
+
+
+void Fl_Headless_Graphics_Driver::add_rectangle_to_region(Fl_Region r, int x, int y, int w, int h) {
+  flHeadlessRect a = {x, y, w, h};
+  region_add_uncovered(r, a, 0, r->count);
+}
+
+
+void Fl_Headless_Graphics_Driver::XDestroyRegion(Fl_Region r) {
+  if (r) {
+    free(r->rects);
+    free(r);
+  }
+}
+
+
+void Fl_Headless_Graphics_Driver::push_clip(int x, int y, int w, int h) {
+  Fl_Region r = XRectangleRegion(0, 0, 0, 0);
+  if (w > 0 && h > 0) {
+    Fl_Region current = rstack[rstackptr];
+    if (current) {
+      for (int i = 0; i < current->count; i++) {
+        flHeadlessRect *c = current->rects + i;
+        int X = (x > c->x ? x : c->x), Y = (y > c->y ? y : c->y);
+        int R = (x + w < c->x + c->w ? x + w : c->x + c->w);
+        int B = (y + h < c->y + c->h ? y + h : c->y + c->h);
+        if (R > X && B > Y) region_append(r, X, Y, R - X, B - Y);
+      }
+    } else {
+      region_append(r, x, y, w, h);
+    }
+  }
+  if (rstackptr < region_stack_max) rstack[++rstackptr] = r;
+  else Fl::warning("Fl_Headless_Graphics_Driver::push_clip: clip stack overflow!\n");
+  restore_clip();
+}
+
+
+int Fl_Headless_Graphics_Driver::clip_box(int x, int y, int w, int h, int &X, int &Y, int &W, int &H) {
+  X = x; Y = y; W = w; H = h;
+  Fl_Region r = rstack[rstackptr];
+  if (!r) return 0;
+  int left = x + w, top = y + h, right = x, bottom = y;
+  long area = 0;
+  for (int i = 0; i < r->count; i++) {
+    flHeadlessRect *c = r->rects + i;
+    int X1 = (x > c->x ? x : c->x), Y1 = (y > c->y ? y : c->y);
+    int R = (x + w < c->x + c->w ? x + w : c->x + c->w);
+    int B = (y + h < c->y + c->h ? y + h : c->y + c->h);
+    if (R <= X1 || B <= Y1) continue;
+    area += long(R - X1) * (B - Y1);
+    if (X1 < left) left = X1;
+    if (Y1 < top) top = Y1;
+    if (R > right) right = R;
+    if (B > bottom) bottom = B;
+  }
+  if (area == 0) { // completely outside
+    W = H = 0;
+    return 2;
+  }
+  if (area == long(w) * h) return 0; // completely inside
+  X = left; Y = top; W = right - left; H = bottom - top;
+  return 1;
+}
+
+
+int Fl_Headless_Graphics_Driver::not_clipped(int x, int y, int w, int h) {
+  Fl_Region r = rstack[rstackptr];
+  if (!r) return 1;
+  for (int i = 0; i < r->count; i++) {
+    flHeadlessRect *c = r->rects + i;
+    if (x < c->x + c->w && c->x < x + w && y < c->y + c->h && c->y < y + h) return 1;
+  }
+  return 0;
+}
+
+
+// Computes the clipping rectangles in buffer coordinates
+void Fl_Headless_Graphics_Driver::restore_clip() {
+  Fl_Graphics_Driver::restore_clip();
+  clip_count_ = 0;
+  if (!buffer_) return;
+  Fl_Region r = rstack[rstackptr];
+  int count = (r ? r->count : 1);
+  if (count > clip_alloc_) {
+    clip_alloc_ = count + 8;
+    clip_rects_ = (flHeadlessRect*)realloc(clip_rects_, clip_alloc_ * sizeof(flHeadlessRect));
+  }
+  for (int i = 0; i < count; i++) {
+    int x = 0, y = 0, R = buffer_->width, B = buffer_->height;
+    if (r) {
+      flHeadlessRect *c = r->rects + i;
+      if (c->x + offset_x_ > x) x = c->x + offset_x_;
+      if (c->y + offset_y_ > y) y = c->y + offset_y_;
+      if (c->x + c->w + offset_x_ < R) R = c->x + c->w + offset_x_;
+      if (c->y + c->h + offset_y_ < B) B = c->y + c->h + offset_y_;
+    }
+    if (R <= x || B <= y) continue;
+    flHeadlessRect *clip = clip_rects_ + clip_count_++;
+    clip->x = x; clip->y = y; clip->w = R - x; clip->h = B - y;
+  }
+}
+
+
+// ----------------------------------------------------------------------------
+// Rasterization; all coordinates are buffer coordinates.
+
+void Fl_Headless_Graphics_Driver::fill_rect_(int x, int y, int w, int h) {
+  for (int i = 0; i < clip_count_; i++) {
+    flHeadlessRect *c = clip_rects_ + i;
+    int X = (x > c->x ? x : c->x), Y = (y > c->y ? y : c->y);
+    int R = (x + w < c->x + c->w ? x + w : c->x + c->w);
+    int B = (y + h < c->y + c->h ? y + h : c->y + c->h);
+    if (R <= X || B <= Y) continue;
+    for (int j = Y; j < B; j++) {
+      uint32_t *p = buffer_->pixels + size_t(j) * buffer_->width + X;
+      for (uint32_t *end = p + (R - X); p < end; p++) *p = rgb_;
+    }
+  }
+}
+
+
+void Fl_Headless_Graphics_Driver::plot_(int x, int y) {
+  if (line_width_ > 1) {
+    fill_rect_(x - line_width_ / 2, y - line_width_ / 2, line_width_, line_width_);
+    return;
+  }
+  for (int i = 0; i < clip_count_; i++) {
+    flHeadlessRect *c = clip_rects_ + i;
+    if (x >= c->x && x < c->x + c->w && y >= c->y && y < c->y + c->h) {
+      buffer_->pixels[size_t(y) * buffer_->width + x] = rgb_;
+      return;
+    }
+  }
+}
+
+
+void Fl_Headless_Graphics_Driver::reset_dash_() {
+  dash_index_ = 0;
+  dash_left_ = dashes_[0];
+}
+
+
+bool Fl_Headless_Graphics_Driver::dash_on_() {
+  if (!dashes_[0]) return true;
+  bool on = !(dash_index_ & 1);
+  if (--dash_left_ <= 0) {
+    if (!dashes_[++dash_index_]) dash_index_ = 0;
+    dash_left_ = dashes_[dash_index_];
+  }
+  return on;
+}
+
+
+// Bresenham line including both end points
+void Fl_Headless_Graphics_Driver::draw_line_(int x, int y, int x1, int y1) {
+  if (!dashes_[0] && (x == x1 || y == y1)) {
+    int h = line_width_ / 2;
+    if (y == y1) fill_rect_((x < x1 ? x : x1), y - h, abs(x1 - x) + 1, line_width_);
+    else fill_rect_(x - h, (y < y1 ? y : y1), line_width_, abs(y1 - y) + 1);
+    return;
+  }
+  int dx = abs(x1 - x), sx = (x < x1 ? 1 : -1);
+  int dy = -abs(y1 - y), sy = (y < y1 ? 1 : -1);
+  int err = dx + dy;
+  for (;;) {
+    if (dash_on_()) plot_(x, y);
+    if (x == x1 && y == y1) break;
+    int e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x += sx; }
+    if (e2 <= dx) { err += dx; y += sy; }
+  }
+}
+
+
+static int compare_floats(const void *a, const void *b) {
+  float fa = *(const float*)a, fb = *(const float*)b;
+  return (fa < fb ? -1 : (fa > fb ? 1 : 0));
+}
+
+
+// Even-odd scanline fill of a polygon: a pixel is filled when its center is inside
+void Fl_Headless_Graphics_Driver::fill_polygon_(const XPOINT *p, int n) {
+  if (n < 3 || !clip_count_) return;
+  float ymin = p[0].y, ymax = p[0].y;
+  for (int i = 1; i < n; i++) {
+    if (p[i].y < ymin) ymin = p[i].y;
+    if (p[i].y > ymax) ymax = p[i].y;
+  }
+  int top = clip_rects_[0].y, bottom = clip_rects_[0].y + clip_rects_[0].h;
+  for (int i = 1; i < clip_count_; i++) {
+    if (clip_rects_[i].y < top) top = clip_rects_[i].y;
+    if (clip_rects_[i].y + clip_rects_[i].h > bottom) bottom = clip_rects_[i].y + clip_rects_[i].h;
+  }
+  int y0 = (int)ceilf(ymin - 0.5f), y1 = (int)ceilf(ymax - 0.5f);
+  if (y0 < top) y0 = top;
+  if (y1 > bottom) y1 = bottom;
+  float *xs = (float*)malloc(n * sizeof(float));
+  for (int y = y0; y < y1; y++) {
+    float yc = y + 0.5f;
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+      const XPOINT &a = p[i], &b = p[(i + 1) % n];
+      if ((a.y <= yc && yc < b.y) || (b.y <= yc && yc < a.y))
+        xs[count++] = a.x + (yc - a.y) * (b.x - a.x) / (b.y - a.y);
+    }
+    if (count > 2) qsort(xs, count, sizeof(float), compare_floats);
+    else if (count == 2 && xs[0] > xs[1]) { float t = xs[0]; xs[0] = xs[1]; xs[1] = t; }
+    for (int i = 0; i + 1 < count; i += 2) {
+      int left = (int)ceilf(xs[i] - 0.5f), right = (int)ceilf(xs[i + 1] - 0.5f);
+      if (right > left) fill_rect_(left, y, right - left, 1);
+    }
+  }
+  free(xs);
+}
+
+
+void Fl_Headless_Graphics_Driver::stroke_points_(const XPOINT *p, int n, bool close) {
+  reset_dash_();
+  if (n == 1) plot_(int(floorf(p[0].x + 0.5f)), int(floorf(p[0].y + 0.5f)));
+  for (int i = 0; i + 1 < n; i++) {
+    draw_line_(int(floorf(p[i].x + 0.5f)), int(floorf(p[i].y + 0.5f)),
+               int(floorf(p[i+1].x + 0.5f)), int(floorf(p[i+1].y + 0.5f)));
+  }
+  if (close && n > 2) {
+    draw_line_(int(floorf(p[n-1].x + 0.5f)), int(floorf(p[n-1].y + 0.5f)),
+               int(floorf(p[0].x + 0.5f)), int(floorf(p[0].y + 0.5f)));
+  }
+}
+
+
+// Computes points of an elliptic arc from angle a1 to a2 (in degrees, counter-clockwise);
+// the returned array must be freed by the caller.
+int Fl_Headless_Graphics_Driver::ellipse_points_(XPOINT *&p, double xc, double yc, double rx, double ry,
+                                                 double a1, double a2, bool with_center) {
+  int nseg = int(fabs(a2 - a1) / 360 * (rx + ry) * 1.5);
+  if (nseg < 8) nseg = 8;
+  if (nseg > 720) nseg = 720;
+  p = (XPOINT*)malloc((nseg + 2) * sizeof(XPOINT));
+  int n = 0;
+  for (int i = 0; i <= nseg; i++) {
+    double a = (a1 + (a2 - a1) * i / nseg) * M_PI / 180;
+    p[n].x = float(xc + rx * cos(a));
+    p[n].y = float(yc - ry * sin(a));
+    n++;
+  }
+  if (with_center) {
+    p[n].x = float(xc);
+    p[n].y = float(yc);
+    n++;
+  }
+  return n;
+}
+
+
+// ----------------------------------------------------------------------------
+// Drawing functions; all coordinates are user coordinates.
+
+void Fl_Headless_Graphics_Driver::point(int x, int y) {
+  int w = line_width_;
+  line_width_ = 1;
+  plot_(x + offset_x_, y + offset_y_);
+  line_width_ = w;
+}
+
+
+void Fl_Headless_Graphics_Driver::rect(int x, int y, int w, int h) {
+  if (w <= 0 || h <= 0) return;
+  x += offset_x_; y += offset_y_;
+  int r = x + w - 1, b = y + h - 1;
+  reset_dash_();
+  draw_line_(x, y, r, y);
+  draw_line_(r, y, r, b);
+  draw_line_(r, b, x, b);
+  draw_line_(x, b, x, y);
+}
+
+
+void Fl_Headless_Graphics_Driver::rectf(int x, int y, int w, int h) {
+  if (w <= 0 || h <= 0) return;
+  fill_rect_(x + offset_x_, y + offset_y_, w, h);
+}
+
+
+void Fl_Headless_Graphics_Driver::line(int x, int y, int x1, int y1) {
+  reset_dash_();
+  draw_line_(x + offset_x_, y + offset_y_, x1 + offset_x_, y1 + offset_y_);
+}
+
+
+void Fl_Headless_Graphics_Driver::xyline(int x, int y, int x1) {
+  reset_dash_();
+  draw_line_(x + offset_x_, y + offset_y_, x1 + offset_x_, y + offset_y_);
+}
+
+
+void Fl_Headless_Graphics_Driver::yxline(int x, int y, int y1) {
+  reset_dash_();
+  draw_line_(x + offset_x_, y + offset_y_, x + offset_x_, y1 + offset_y_);
+}
+
+
+void Fl_Headless_Graphics_Driver::polygon(int x0, int y0, int x1, int y1, int x2, int y2) {
+  XPOINT p[3] = { {float(x0 + offset_x_), float(y0 + offset_y_)},
+    {float(x1 + offset_x_), float(y1 + offset_y_)}, {float(x2 + offset_x_), float(y2 + offset_y_)} };
+  fill_polygon_(p, 3);
+}
+
+
+void Fl_Headless_Graphics_Driver::polygon(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3) {
+  XPOINT p[4] = { {float(x0 + offset_x_), float(y0 + offset_y_)},
+    {float(x1 + offset_x_), float(y1 + offset_y_)}, {float(x2 + offset_x_), float(y2 + offset_y_)},
+    {float(x3 + offset_x_), float(y3 + offset_y_)} };
+  fill_polygon_(p, 4);
+}
+
+
+void Fl_Headless_Graphics_Driver::line_style(int style, int width, char *dashes) {
+  line_width_ = (width > 1 ? width : 1);
+  int w = (line_width_ > 40 ? 40 : line_width_);
+  const char *pattern = NULL;
+  char buf[7];
+  if (dashes && *dashes) {
+    pattern = dashes;
+  } else {
+    switch (style & 0xff) {
+      case FL_DASH:
+        buf[0] = char(3 * w); buf[1] = char(w); buf[2] = 0;
+        pattern = buf;
+        break;
+      case FL_DOT:
+        buf[0] = char(w); buf[1] = char(w); buf[2] = 0;
+        pattern = buf;
+        break;
+      case FL_DASHDOT:
+        buf[0] = char(3 * w); buf[1] = buf[2] = buf[3] = char(w); buf[4] = 0;
+        pattern = buf;
+        break;
+      case FL_DASHDOTDOT:
+        buf[0] = char(3 * w); buf[1] = buf[2] = buf[3] = buf[4] = buf[5] = char(w); buf[6] = 0;
+        pattern = buf;
+        break;
+    }
+  }
+  int i = 0;
+  if (pattern) { // an odd number of lengths is repeated twice, as in X11
+    int l = (int)strlen(pattern);
+    if (l > 14) l = 14;
+    for (int k = 0; k < ((l & 1) ? 2 * l : l) && i < 15; k++) dashes_[i++] = pattern[k % l];
+  }
+  dashes_[i] = 0;
+}
+
+
+void Fl_Headless_Graphics_Driver::end_points() {
+  int w = line_width_;
+  line_width_ = 1;
+  for (int i = 0; i < n; i++) plot_(int(floorf(xpoint[i].x + 0.5f)), int(floorf(xpoint[i].y + 0.5f)));
+  line_width_ = w;
+}
+
+
+void Fl_Headless_Graphics_Driver::end_line() {
+  if (n < 2) {
+    end_points();
+    return;
+  }
+  stroke_points_(xpoint, n, false);
+}
+
+
+void Fl_Headless_Graphics_Driver::end_polygon() {
+  fixloop();
+  if (n < 3) {
+    end_line();
+    return;
+  }
+  fill_polygon_(xpoint, n);
+}
+
+
+void Fl_Headless_Graphics_Driver::end_complex_polygon() {
+  gap();
+  if (n < 3) {
+    end_line();
+    return;
+  }
+  fill_polygon_(xpoint, n);
+}
+
+
+void Fl_Headless_Graphics_Driver::circle(double x, double y, double r) {
+  double xt = transform_x(x, y);
+  double yt = transform_y(x, y);
+  double rx = r * (m.c ? sqrt(m.a*m.a + m.c*m.c) : fabs(m.a));
+  double ry = r * (m.b ? sqrt(m.b*m.b + m.d*m.d) : fabs(m.d));
+  XPOINT *p;
+  int count = ellipse_points_(p, xt, yt, rx, ry, 0, 360, false);
+  if (what == POLYGON) fill_polygon_(p, count);
+  else stroke_points_(p, count, true);
+  free(p);
+}
+
+
+void Fl_Headless_Graphics_Driver::arc(int x, int y, int w, int h, double a1, double a2) {
+  if (w <= 0 || h <= 0) return;
+  XPOINT *p;
+  int count = ellipse_points_(p, x + offset_x_ + (w - 1) / 2.0, y + offset_y_ + (h - 1) / 2.0,
+                              (w - 1) / 2.0, (h - 1) / 2.0, a1, a2, false);
+  stroke_points_(p, count, false);
+  free(p);
+}
+
+
+void Fl_Headless_Graphics_Driver::pie(int x, int y, int w, int h, double a1, double a2) {
+  if (w <= 0 || h <= 0) return;
+  XPOINT *p;
+  int count = ellipse_points_(p, x + offset_x_ + w / 2.0, y + offset_y_ + h / 2.0,
+                              w / 2.0, h / 2.0, a1, a2, fabs(a2 - a1) < 360);
+  fill_polygon_(p, count);
+  free(p);
+}
+
+
+void Fl_Headless_Graphics_Driver::copy_offscreen(int x, int y, int w, int h, Fl_Offscreen pixmap, int srcx, int srcy) {
+  x += offset_x_; y += offset_y_;
+  if (srcx < 0) { x -= srcx; w += srcx; srcx = 0; }
+  if (srcy < 0) { y -= srcy; h += srcy; srcy = 0; }
+  if (srcx + w > pixmap->width) w = pixmap->width - srcx;
+  if (srcy + h > pixmap->height) h = pixmap->height - srcy;
+  for (int i = 0; i < clip_count_; i++) {
+    flHeadlessRect *c = clip_rects_ + i;
+    int X = (x > c->x ? x : c->x), Y = (y > c->y ? y : c->y);
+    int R = (x + w < c->x + c->w ? x + w : c->x + c->w);
+    int B = (y + h < c->y + c->h ? y + h : c->y + c->h);
+    if (R <= X || B <= Y) continue;
+    for (int j = Y; j < B; j++) {
+      memmove(buffer_->pixels + size_t(j) * buffer_->width + X,
+              pixmap->pixels + size_t(j - y + srcy) * pixmap->width + (X - x + srcx),
+              (R - X) * sizeof(uint32_t));
+    }
+  }
+}
+
+
+void Fl_Headless_Graphics_Driver::color(Fl_Color c) {
+  Fl_Graphics_Driver::color(c);
+  uchar r, g, b;
+  Fl::get_color(c, r, g, b);
+  rgb_ = (uint32_t(r) << 16) | (uint32_t(g) << 8) | b;
+}
+
+
+void Fl_Headless_Graphics_Driver::color(uchar r, uchar g, uchar b) {
+  Fl_Graphics_Driver::color(fl_rgb_color(r, g, b));
+  rgb_ = (uint32_t(r) << 16) | (uint32_t(g) << 8) | b;
+}
@@ -0,0 +1,335 @@
+//
+// Text drawing code of the headless platform for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2010-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+/* Text is rendered by FreeType from the font files that fontconfig selects
+ for the fontconfig names of the fl_fonts table. Rendered glyphs of the basic
+ multilingual plane are cached in each font descriptor.
+ */
+
+#include <config.h>
+#include "Fl_Headless_Graphics_Driver.H"
+#include "../../Fl_Screen_Driver.H"
+#include <FL/Fl.H>
+#include <FL/fl_utf8.h>
+#include <FL/platform.H>
+#include <fontconfig/fontconfig.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+extern Fl_Fontdesc *fl_fonts;
+
+static FT_Library ft_library = NULL;
+
+
+Fl_Headless_Font_Descriptor::Fl_Headless_Font_Descriptor(const char* name, Fl_Fontsize size) :
+  Fl_Font_Descriptor(name, size) {
+  face = NULL;
+  memset(pages, 0, sizeof(pages));
+  if (!ft_library && FT_Init_FreeType(&ft_library)) ft_library = NULL;
+  static bool fc_ok = FcInit();
+  FcPattern *pattern = (fc_ok && ft_library ? FcNameParse((const FcChar8*)name) : NULL);
+  if (pattern) {
+    FcConfigSubstitute(NULL, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+    FcResult result;
+    FcPattern *match = FcFontMatch(NULL, pattern, &result);
+    FcChar8 *file;
+    int index = 0;
+    if (match && FcPatternGetString(match, FC_FILE, 0, &file) == FcResultMatch) {
+      FcPatternGetInteger(match, FC_INDEX, 0, &index);
+      if (FT_New_Face(ft_library, (const char*)file, index, &face)) face = NULL;
+    }
+    if (match) FcPatternDestroy(match);
+    FcPatternDestroy(pattern);
+  }
+  if (face && FT_Set_Pixel_Sizes(face, 0, size)) {
+    FT_Done_Face(face);
+    face = NULL;
+  }
+  if (face) {
+    ascent = short((face->size->metrics.ascender + 63) >> 6);
+    descent = short((-face->size->metrics.descender + 63) >> 6);
+    line_height = int((face->size->metrics.height + 63) >> 6);
+    if (line_height < ascent + descent) line_height = ascent + descent;
+    const glyph *g = get_glyph('x');
+    q_width = short(g ? g->advance : size / 2);
+  } else { // no font available: text is measured but not drawn
+    ascent = short(size * 0.8 + 0.5);
+    descent = short(size - ascent);
+    line_height = size + 2;
+    q_width = short(size * 0.6 + 0.5);
+  }
+}
+
+
+Fl_Headless_Font_Descriptor::~Fl_Headless_Font_Descriptor() {
+  for (int i = 0; i < 64; i++) {
+    if (!pages[i]) continue;
+    for (int j = 0; j < 1024; j++) {
+      if (pages[i][j]) {
+        free(pages[i][j]->bits);
+        delete pages[i][j];
+      }
+    }
+    delete[] pages[i];
+  }
+  if (face) FT_Done_Face(face);
+}
+
+
+// Returns the rendered glyph of character c, or NULL if no font is available
+const Fl_Headless_Font_Descriptor::glyph *Fl_Headless_Font_Descriptor::get_glyph(unsigned c) {
+  if (!face) return NULL;
+  bool cached = (c < 0x10000);
+  if (cached && pages[c >> 10] && pages[c >> 10][c & 0x3FF]) return pages[c >> 10][c & 0x3FF];
+  static glyph uncached = {0, 0, 0, 0, 0, NULL};
+  glyph *g = (cached ? new glyph : &uncached);
+  if (!cached) free(g->bits);
+  memset(g, 0, sizeof(glyph));
+  if (FT_Load_Char(face, c, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL) == 0) {
+    FT_GlyphSlot slot = face->glyph;
+    g->advance = int((slot->advance.x + 32) >> 6);
+    g->left = slot->bitmap_left;
+    g->top = slot->bitmap_top;
+    g->w = int(slot->bitmap.width);
+    g->h = int(slot->bitmap.rows);
+    if (g->w && g->h && slot->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY) {
+      g->bits = (unsigned char*)malloc(g->w * g->h);
+      for (int j = 0; j < g->h; j++)
+        memcpy(g->bits + j * g->w, slot->bitmap.buffer + j * slot->bitmap.pitch, g->w);
+    } else if (g->w && g->h && slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
+      g->bits = (unsigned char*)malloc(g->w * g->h);
+      for (int j = 0; j < g->h; j++) {
+        const unsigned char *row = slot->bitmap.buffer + j * slot->bitmap.pitch;
+        for (int i = 0; i < g->w; i++) g->bits[j * g->w + i] = ((row[i >> 3] >> (7 - (i & 7))) & 1) ? 255 : 0;
+      }
+    } else {
+      g->w = g->h = 0;
+    }
+  }
+  if (cached) {
+    if (!pages[c >> 10]) {
+      pages[c >> 10] = new glyph*[1024];
+      memset(pages[c >> 10], 0, 1024 * sizeof(glyph*));
+    }
+    pages[c >> 10][c & 0x3FF] = g;
+  }
+  return g;
+}
+
+
+static Fl_Font_Descriptor* find(Fl_Font fnum, Fl_Fontsize size) {
+  Fl_Fontdesc* s = fl_fonts + fnum;
+  if (!s->name) s = fl_fonts; // use 0 if fnum undefined
+  Fl_Font_Descriptor* f;
+  for (f = s->first; f; f = f->next)
+    if (f->size == size) return f;
+  f = new Fl_Headless_Font_Descriptor(s->name, size);
+  f->next = s->first;
+  s->first = f;
+  return f;
+}
+
+
+void Fl_Headless_Graphics_Driver::font(Fl_Font fnum, Fl_Fontsize s) {
+  if (s == 0) return;
+  if (font() == fnum && size() == s && font_descriptor()) return;
+  if (fnum == -1) {
+    Fl_Graphics_Driver::font(0, 0);
+    return;
+  }
+  Fl_Graphics_Driver::font(fnum, s);
+  font_descriptor( find(fnum, s) );
+}
+
+
+// Blends the coverage bitmap of glyph g with the pen at x,y (buffer coordinates)
+static void blend_glyph(fl_headless_buffer *buffer, const flHeadlessRect *clips, int count,
+                        const Fl_Headless_Font_Descriptor::glyph *g, int x, int y, uint32_t rgb) {
+  if (!g->bits) return;
+  int gx = x + g->left, gy = y - g->top;
+  unsigned cr = (rgb >> 16) & 0xff, cg = (rgb >> 8) & 0xff, cb = rgb & 0xff;
+  for (int i = 0; i < count; i++) {
+    const flHeadlessRect *c = clips + i;
+    int X = (gx > c->x ? gx : c->x), Y = (gy > c->y ? gy : c->y);
+    int R = (gx + g->w < c->x + c->w ? gx + g->w : c->x + c->w);
+    int B = (gy + g->h < c->y + c->h ? gy + g->h : c->y + c->h);
+    for (int row = Y; row < B; row++) {
+      uint32_t *p = buffer->pixels + size_t(row) * buffer->width;
+      const unsigned char *q = g->bits + (row - gy) * g->w - gx;
+      for (int col = X; col < R; col++) {
+        unsigned a = q[col];
+        if (!a) continue;
+        if (a == 255) {
+          p[col] = rgb;
+          continue;
+        }
+        uint32_t d = p[col];
+        unsigned r = (cr * a + ((d >> 16) & 0xff) * (255 - a) + 127) / 255;
+        unsigned gr = (cg * a + ((d >> 8) & 0xff) * (255 - a) + 127) / 255;
+        unsigned b = (cb * a + (d & 0xff) * (255 - a) + 127) / 255;
+        p[col] = (r << 16) | (gr << 8) | b;
+      }
+    }
+  }
+}
+
+
+// Draws n bytes of UTF-8 text with the pen starting at x,y (buffer coordinates)
+void Fl_Headless_Graphics_Driver::draw_glyphs_(const char *str, int n, int x, int y) {
+  Fl_Headless_Font_Descriptor *desc = (Fl_Headless_Font_Descriptor*)font_descriptor();
+  if (!desc || !desc->face || !buffer_) return;
+  const char *end = str + n;
+  while (str < end) {
+    int l;
+    unsigned c = fl_utf8decode(str, end, &l);
+    str += l;
+    const Fl_Headless_Font_Descriptor::glyph *g = desc->get_glyph(c);
+    if (!g) continue;
+    blend_glyph(buffer_, clip_rects_, clip_count_, g, x, y, rgb_);
+    x += g->advance;
+  }
+}
+
+
+void Fl_Headless_Graphics_Driver::draw(const char *str, int n, int x, int y) {
+  if (!font_descriptor()) font(FL_HELVETICA, FL_NORMAL_SIZE);
+  draw_glyphs_(str, n, x + offset_x_, y + offset_y_);
+}
+
+
+// Rotated glyphs are rendered by FreeType for each call, without caching
+void Fl_Headless_Graphics_Driver::draw_rotated_(int angle, const char *str, int n, int x, int y) {
+  Fl_Headless_Font_Descriptor *desc = (Fl_Headless_Font_Descriptor*)font_descriptor();
+  if (!desc || !desc->face || !buffer_) return;
+  double a = angle * M_PI / 180;
+  FT_Matrix matrix;
+  matrix.xx = (FT_Fixed)(cos(a) * 0x10000);
+  matrix.xy = (FT_Fixed)(sin(a) * 0x10000);
+  matrix.yx = (FT_Fixed)(-sin(a) * 0x10000);
+  matrix.yy = (FT_Fixed)(cos(a) * 0x10000);
+  FT_Vector pen = {0, 0};
+  const char *end = str + n;
+  while (str < end) {
+    int l;
+    unsigned c = fl_utf8decode(str, end, &l);
+    str += l;
+    FT_Set_Transform(desc->face, &matrix, &pen);
+    if (FT_Load_Char(desc->face, c, FT_LOAD_RENDER) == 0) {
+      FT_GlyphSlot slot = desc->face->glyph;
+      if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_GRAY) {
+        Fl_Headless_Font_Descriptor::glyph g;
+        g.left = slot->bitmap_left;
+        g.top = slot->bitmap_top;
+        g.w = int(slot->bitmap.width);
+        g.h = int(slot->bitmap.rows);
+        g.bits = (unsigned char*)malloc(g.w * g.h + 1);
+        for (int j = 0; j < g.h; j++)
+          memcpy(g.bits + j * g.w, slot->bitmap.buffer + j * slot->bitmap.pitch, g.w);
+        blend_glyph(buffer_, clip_rects_, clip_count_, &g, x, y, rgb_);
+        free(g.bits);
+      }
+      pen.x += slot->advance.x;
+      pen.y += slot->advance.y;
+    }
+  }
+  FT_Set_Transform(desc->face, NULL, NULL);
+}
+
+
+void Fl_Headless_Graphics_Driver::draw(int angle, const char *str, int n, int x, int y) {
+  if (!font_descriptor()) font(FL_HELVETICA, FL_NORMAL_SIZE);
+  if (angle == 0) draw_glyphs_(str, n, x + offset_x_, y + offset_y_);
+  else draw_rotated_(angle, str, n, x + offset_x_, y + offset_y_);
+}
+
+
+void Fl_Headless_Graphics_Driver::rtl_draw(const char *str, int n, int x, int y) {
+  int w = (int)width(str, n);
+  draw(str, n, x - w, y);
+}
+
+
+double Fl_Headless_Graphics_Driver::width(unsigned int c) {
+  if (!font_descriptor()) font(FL_HELVETICA, FL_NORMAL_SIZE);
+  Fl_Headless_Font_Descriptor *desc = (Fl_Headless_Font_Descriptor*)font_descriptor();
+  const Fl_Headless_Font_Descriptor::glyph *g = desc->get_glyph(c);
+  return g ? g->advance : desc->q_width;
+}
+
+
+double Fl_Headless_Graphics_Driver::width(const char *str, int n) {
+  if (!font_descriptor()) font(FL_HELVETICA, FL_NORMAL_SIZE);
+  const char *end = str + n;
+  double w = 0;
+  while (str < end) {
+    int l;
+    unsigned c = fl_utf8decode(str, end, &l);
+    str += l;
+    w += width(c);
+  }
+  return w;
+}
+
+
+void Fl_Headless_Graphics_Driver::text_extents(const char *str, int n, int &dx, int &dy, int &w, int &h) {
+  if (!font_descriptor()) font(FL_HELVETICA, FL_NORMAL_SIZE);
+  Fl_Headless_Font_Descriptor *desc = (Fl_Headless_Font_Descriptor*)font_descriptor();
+  const char *end = str + n;
+  int x = 0, left = 0, right = 0, top = 0, bottom = 0;
+  bool first = true;
+  while (str < end) {
+    int l;
+    unsigned c = fl_utf8decode(str, end, &l);
+    str += l;
+    const Fl_Headless_Font_Descriptor::glyph *g = desc->get_glyph(c);
+    if (!g) {
+      x += desc->q_width;
+      continue;
+    }
+    if (g->w && g->h) {
+      int gl = x + g->left, gr = gl + g->w, gt = -g->top, gb = gt + g->h;
+      if (first || gl < left) left = gl;
+      if (first || gr > right) right = gr;
+      if (first || gt < top) top = gt;
+      if (first || gb > bottom) bottom = gb;
+      first = false;
+    }
+    x += g->advance;
+  }
+  if (first) { // no inked glyph: use the font metrics
+    dx = 0; dy = -desc->ascent;
+    w = x; h = desc->ascent + desc->descent;
+    return;
+  }
+  dx = left; dy = top;
+  w = right - left; h = bottom - top;
+}
+
+
+int Fl_Headless_Graphics_Driver::height() {
+  if (!font_descriptor()) font(FL_HELVETICA, FL_NORMAL_SIZE);
+  return ((Fl_Headless_Font_Descriptor*)font_descriptor())->line_height;
+}
+
+
+int Fl_Headless_Graphics_Driver::descent() {
+  if (!font_descriptor()) font(FL_HELVETICA, FL_NORMAL_SIZE);
+  return font_descriptor()->descent;
+}
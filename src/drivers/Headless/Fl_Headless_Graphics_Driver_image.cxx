@@ -0,0 +1,233 @@
+//
+// Image drawing code of the headless platform for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2010-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <config.h>
+#include "Fl_Headless_Graphics_Driver.H"
+#include <FL/Fl_RGB_Image.H>
+#include <FL/Fl_Pixmap.H>
+#include <FL/Fl_Bitmap.H>
+#include <stdlib.h>
+#include <string.h>
+
+enum { OPAQUE_ROW = 0, ALPHA_ROW, MASK_ROW };
+
+// The cached form of all image types
+struct headless_cached_image {
+  int w, h;
+  int mode; // OPAQUE_ROW, ALPHA_ROW or MASK_ROW
+  uint32_t pixels[1]; // 0xAARRGGBB values, w * h of them
+};
+
+
+static headless_cached_image *new_cached_image(int w, int h, int mode) {
+  headless_cached_image *img = (headless_cached_image*)malloc(sizeof(headless_cached_image) +
+                                      (size_t(w) * h - 1) * sizeof(uint32_t));
+  img->w = w;
+  img->h = h;
+  img->mode = mode;
+  return img;
+}
+
+
+static inline uint32_t blend(uint32_t src, uint32_t dst, unsigned a) {
+  unsigned r = (((src >> 16) & 0xff) * a + ((dst >> 16) & 0xff) * (255 - a) + 127) / 255;
+  unsigned g = (((src >> 8) & 0xff) * a + ((dst >> 8) & 0xff) * (255 - a) + 127) / 255;
+  unsigned b = ((src & 0xff) * a + (dst & 0xff) * (255 - a) + 127) / 255;
+  return (r << 16) | (g << 8) | b;
+}
+
+
+// Writes w pixels of row in the buffer at x,y (buffer coordinates) respecting clipping
+void Fl_Headless_Graphics_Driver::put_row_(const uint32_t *row, int x, int y, int w, int mode) {
+  for (int i = 0; i < clip_count_; i++) {
+    flHeadlessRect *c = clip_rects_ + i;
+    if (y < c->y || y >= c->y + c->h) continue;
+    int X = (x > c->x ? x : c->x);
+    int R = (x + w < c->x + c->w ? x + w : c->x + c->w);
+    if (R <= X) continue;
+    uint32_t *p = buffer_->pixels + size_t(y) * buffer_->width + X;
+    const uint32_t *q = row + (X - x);
+    int count = R - X;
+    if (mode == OPAQUE_ROW) {
+      for (int k = 0; k < count; k++) p[k] = q[k] & 0xffffff;
+    } else {
+      for (int k = 0; k < count; k++) {
+        unsigned a = q[k] >> 24;
+        if (a == 0) continue;
+        uint32_t src = (mode == MASK_ROW ? rgb_ : q[k]);
+        p[k] = (a == 255 ? src & 0xffffff : blend(src, p[k], a));
+      }
+    }
+  }
+}
+
+
+// Converts one line of image data to 0x00RRGGBB pixels; pixel i is at src + i * D
+// and depths below 3 are gray levels
+static void convert_row(const uchar *src, int W, int D, bool mono, uint32_t *dst) {
+  if (mono || (D < 3 && D > -3)) {
+    for (int i = 0; i < W; i++, src += D) dst[i] = (uint32_t(src[0]) << 16) | (uint32_t(src[0]) << 8) | src[0];
+  } else {
+    for (int i = 0; i < W; i++, src += D) dst[i] = (uint32_t(src[0]) << 16) | (uint32_t(src[1]) << 8) | src[2];
+  }
+}
+
+
+void Fl_Headless_Graphics_Driver::draw_image_(const uchar *buf, Fl_Draw_Image_Cb cb, void *data,
+                                              int X, int Y, int W, int H, int D, int L, bool mono) {
+  if (W <= 0 || H <= 0) return;
+  X += offset_x_;
+  Y += offset_y_;
+  if (!L) L = W * (D < 0 ? -D : D);
+  uchar *line = (cb ? new uchar[W * (D < 0 ? -D : D)] : NULL);
+  uint32_t *row = new uint32_t[W];
+  for (int j = 0; j < H; j++) {
+    if (cb) {
+      cb(data, 0, j, W, line);
+      convert_row(line, W, (D < 0 ? -D : D), mono, row);
+    } else {
+      convert_row(buf + j * L, W, D, mono, row);
+    }
+    put_row_(row, X, Y + j, W, OPAQUE_ROW);
+  }
+  delete[] row;
+  delete[] line;
+}
+
+
+void Fl_Headless_Graphics_Driver::draw_image(const uchar *buf, int X, int Y, int W, int H, int D, int L) {
+  draw_image_(buf, NULL, NULL, X, Y, W, H, D, L, false);
+}
+
+
+void Fl_Headless_Graphics_Driver::draw_image_mono(const uchar *buf, int X, int Y, int W, int H, int D, int L) {
+  draw_image_(buf, NULL, NULL, X, Y, W, H, D, L, true);
+}
+
+
+void Fl_Headless_Graphics_Driver::draw_image(Fl_Draw_Image_Cb cb, void *data, int X, int Y, int W, int H, int D) {
+  draw_image_(NULL, cb, data, X, Y, W, H, D, 0, false);
+}
+
+
+void Fl_Headless_Graphics_Driver::draw_image_mono(Fl_Draw_Image_Cb cb, void *data, int X, int Y, int W, int H, int D) {
+  draw_image_(NULL, cb, data, X, Y, W, H, D, 0, true);
+}
+
+
+void Fl_Headless_Graphics_Driver::cache(Fl_RGB_Image *rgb) {
+  int w = rgb->data_w(), h = rgb->data_h(), d = rgb->d();
+  int ld = rgb->ld() ? rgb->ld() : w * d;
+  headless_cached_image *img = new_cached_image(w, h, (d == 2 || d == 4) ? ALPHA_ROW : OPAQUE_ROW);
+  const uchar *array = rgb->array;
+  for (int j = 0; j < h; j++) {
+    const uchar *src = array + j * ld;
+    uint32_t *dst = img->pixels + size_t(j) * w;
+    for (int i = 0; i < w; i++, src += d) {
+      uchar r, g, b, a = 255;
+      if (d >= 3) {
+        r = src[0]; g = src[1]; b = src[2];
+        if (d == 4) a = src[3];
+      } else {
+        r = g = b = src[0];
+        if (d == 2) a = src[1];
+      }
+      dst[i] = (uint32_t(a) << 24) | (uint32_t(r) << 16) | (uint32_t(g) << 8) | b;
+    }
+  }
+  *Fl_Graphics_Driver::id(rgb) = (fl_uintptr_t)img;
+  int *pw, *ph;
+  cache_w_h(rgb, pw, ph);
+  *pw = w;
+  *ph = h;
+}
+
+
+void Fl_Headless_Graphics_Driver::cache(Fl_Pixmap *pxm) {
+  Fl_RGB_Image *rgb = new Fl_RGB_Image(pxm);
+  cache(rgb);
+  *Fl_Graphics_Driver::id(pxm) = *Fl_Graphics_Driver::id(rgb);
+  *Fl_Graphics_Driver::id(rgb) = 0;
+  delete rgb;
+  int *pw, *ph;
+  cache_w_h(pxm, pw, ph);
+  *pw = pxm->data_w();
+  *ph = pxm->data_h();
+}
+
+
+void Fl_Headless_Graphics_Driver::cache(Fl_Bitmap *bm) {
+  int w = bm->data_w(), h = bm->data_h();
+  int bytes_per_row = (w + 7) / 8;
+  headless_cached_image *img = new_cached_image(w, h, MASK_ROW);
+  for (int j = 0; j < h; j++) {
+    const uchar *src = bm->array + j * bytes_per_row;
+    uint32_t *dst = img->pixels + size_t(j) * w;
+    for (int i = 0; i < w; i++) dst[i] = ((src[i >> 3] >> (i & 7)) & 1) ? 0xff000000 : 0;
+  }
+  *Fl_Graphics_Driver::id(bm) = (fl_uintptr_t)img;
+  int *pw, *ph;
+  cache_w_h(bm, pw, ph);
+  *pw = w;
+  *ph = h;
+}
+
+
+// Draws the W x H part at cx,cy of a cached image at X,Y
+void Fl_Headless_Graphics_Driver::draw_cached_(fl_uintptr_t id, int X, int Y, int W, int H, int cx, int cy) {
+  headless_cached_image *img = (headless_cached_image*)id;
+  if (!img) return;
+  if (cx < 0) { X -= cx; W += cx; cx = 0; }
+  if (cy < 0) { Y -= cy; H += cy; cy = 0; }
+  if (cx + W > img->w) W = img->w - cx;
+  if (cy + H > img->h) H = img->h - cy;
+  if (W <= 0 || H <= 0) return;
+  for (int j = 0; j < H; j++) {
+    put_row_(img->pixels + size_t(cy + j) * img->w + cx, X + offset_x_, Y + offset_y_ + j, W, img->mode);
+  }
+}
+
+
+void Fl_Headless_Graphics_Driver::draw_fixed(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy) {
+  draw_cached_(*Fl_Graphics_Driver::id(rgb), XP, YP, WP, HP, cx, cy);
+}
+
+
+void Fl_Headless_Graphics_Driver::draw_fixed(Fl_Pixmap *pxm, int XP, int YP, int WP, int HP, int cx, int cy) {
+  draw_cached_(*Fl_Graphics_Driver::id(pxm), XP, YP, WP, HP, cx, cy);
+}
+
+
+void Fl_Headless_Graphics_Driver::draw_fixed(Fl_Bitmap *bm, int XP, int YP, int WP, int HP, int cx, int cy) {
+  draw_cached_(*Fl_Graphics_Driver::id(bm), XP, YP, WP, HP, cx, cy);
+}
+
+
+void Fl_Headless_Graphics_Driver::uncache(Fl_RGB_Image *, fl_uintptr_t &id_, fl_uintptr_t &mask_) {
+  free((void*)id_);
+  id_ = 0;
+  mask_ = 0;
+}
+
+
+void Fl_Headless_Graphics_Driver::uncache_pixmap(fl_uintptr_t p) {
+  free((void*)p);
+}
+
+
+void Fl_Headless_Graphics_Driver::delete_bitmask(fl_uintptr_t bm) {
+  free((void*)bm);
+}
@@ -0,0 +1,74 @@
+//
+// Definition of the headless image surface driver for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2010-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <config.h>
+#include <FL/platform.H>
+#include "Fl_Headless_Graphics_Driver.H"
+#include "Fl_Headless_Image_Surface_Driver.H"
+
+
+Fl_Headless_Image_Surface_Driver::Fl_Headless_Image_Surface_Driver(int w, int h, int high_res, Fl_Offscreen off) : Fl_Image_Surface_Driver(w, h, high_res, off) {
+  pre_window = NULL;
+  if (!off) {
+    fl_open_display();
+    offscreen = Fl_Headless_Graphics_Driver::create_buffer(w, h);
+  }
+  driver(new Fl_Headless_Graphics_Driver());
+}
+
+
+Fl_Headless_Image_Surface_Driver::~Fl_Headless_Image_Surface_Driver() {
+  if (offscreen && !external_offscreen) Fl_Headless_Graphics_Driver::delete_buffer(offscreen);
+  delete driver();
+}
+
+
+void Fl_Headless_Image_Surface_Driver::set_current() {
+  Fl_Surface_Device::set_current();
+  ((Fl_Headless_Graphics_Driver*)fl_graphics_driver)->set_buffer(offscreen);
+  pre_window = fl_window;
+  fl_window = NULL;
+}
+
+
+void Fl_Headless_Image_Surface_Driver::end_current() {
+  fl_window = pre_window;
+}
+
+
+void Fl_Headless_Image_Surface_Driver::translate(int x, int y) {
+  ((Fl_Headless_Graphics_Driver*)driver())->translate_all(x, y);
+}
+
+
+void Fl_Headless_Image_Surface_Driver::untranslate() {
+  ((Fl_Headless_Graphics_Driver*)driver())->untranslate_all();
+}
+
+
+Fl_RGB_Image* Fl_Headless_Image_Surface_Driver::image() {
+  uchar *rgb = new uchar[offscreen->width * offscreen->height * 3];
+  uchar *p = rgb;
+  const uint32_t *q = offscreen->pixels;
+  for (int k = offscreen->width * offscreen->height; k > 0; k--, q++) {
+    *p++ = uchar(*q >> 16);
+    *p++ = uchar(*q >> 8);
+    *p++ = uchar(*q);
+  }
+  Fl_RGB_Image *image = new Fl_RGB_Image(rgb, offscreen->width, offscreen->height, 3);
+  image->alloc_array = 1;
+  return image;
+}
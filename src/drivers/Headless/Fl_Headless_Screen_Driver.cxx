@@ -0,0 +1,218 @@
+//
+// Definition of the headless screen interface for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 1998-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <config.h>
+#include "Fl_Headless_Screen_Driver.H"
+#include "Fl_Headless_Graphics_Driver.H"
+#include "Fl_Headless_Window_Driver.H"
+#include <FL/Fl.H>
+#include <FL/platform.H>
+#include <FL/Fl_RGB_Image.H>
+#include <FL/Fl_Image_Surface.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// these are set by Fl::args() and override any system colors: from Fl_get_system_colors.cxx
+extern const char *fl_fg;
+extern const char *fl_bg;
+extern const char *fl_bg2;
+// end of extern additions workaround
+
+
+Fl_Headless_Screen_Driver::Fl_Headless_Screen_Driver() : Fl_Screen_Driver() {
+  width_ = 1920;
+  height_ = 1080;
+  mouse_x = mouse_y = 0;
+  selection_[0] = selection_[1] = NULL;
+  selection_length_[0] = selection_length_[1] = 0;
+}
+
+
+Fl_Headless_Screen_Driver::~Fl_Headless_Screen_Driver() {
+  free(selection_[0]);
+  free(selection_[1]);
+}
+
+
+void Fl_Headless_Screen_Driver::init() {
+  const char *size = getenv("FLTK_HEADLESS_SCREEN");
+  int w, h;
+  if (size && sscanf(size, "%dx%d", &w, &h) == 2 && w > 0 && h > 0) {
+    width_ = w;
+    height_ = h;
+  }
+  num_screens = 1;
+}
+
+
+void Fl_Headless_Screen_Driver::screen_xywh(int &X, int &Y, int &W, int &H, int n) {
+  if (num_screens < 0) init();
+  X = 0;
+  Y = 0;
+  W = width_;
+  H = height_;
+}
+
+
+void Fl_Headless_Screen_Driver::screen_work_area(int &X, int &Y, int &W, int &H, int n) {
+  screen_xywh(X, Y, W, H, n);
+}
+
+
+void Fl_Headless_Screen_Driver::screen_dpi(float &h, float &v, int n) {
+  h = v = 96;
+}
+
+
+void Fl_Headless_Screen_Driver::beep(int type)
+{
+  fprintf(stderr, "\007");
+}
+
+
+extern void fl_fix_focus(); // in Fl.cxx
+extern void fl_trigger_clipboard_notify(int source); // in Fl.cxx
+
+
+void Fl_Headless_Screen_Driver::grab(Fl_Window* win)
+{
+  if (win) {
+    Fl::grab_ = win;    // FIXME: Fl::grab_ "should be private", but we need
+                        // a way to *set* the variable from the driver!
+  } else {
+    if (Fl::grab()) {
+      Fl::grab_ = 0;    // FIXME: Fl::grab_ "should be private", but we need
+                        // a way to *set* the variable from the driver!
+      fl_fix_focus();
+    }
+  }
+}
+
+
+static void set_selection_color(uchar r, uchar g, uchar b)
+{
+  Fl::set_color(FL_SELECTION_COLOR,r,g,b);
+}
+
+
+static void getsyscolor(const char *arg, const char *defarg, void (*func)(uchar,uchar,uchar))
+{
+  uchar r, g, b;
+  if (!arg) arg = defarg;
+  if (!Fl::screen_driver()->parse_color(arg, r, g, b))
+    Fl::error("Unknown color: %s", arg);
+  else
+    func(r, g, b);
+}
+
+
+void Fl_Headless_Screen_Driver::get_system_colors()
+{
+  if (!bg2_set)
+    getsyscolor(fl_bg2, "#ffffff", Fl::background2);
+  if (!fg_set)
+    getsyscolor(fl_fg,  "#000000", Fl::foreground);
+  if (!bg_set)
+    getsyscolor(fl_bg,  "#c0c0c0", Fl::background);
+  getsyscolor(0, "#000080", set_selection_color);
+}
+
+
+const char *Fl_Headless_Screen_Driver::get_system_scheme()
+{
+  return getenv("FLTK_SCHEME");
+}
+
+
+// There are no input methods: any printable text is inserted as is
+int Fl_Headless_Screen_Driver::compose(int& del) {
+  unsigned char ascii = (unsigned char)Fl::e_text[0];
+  del = 0;
+  if ((Fl::e_state & (FL_ALT | FL_META | FL_CTRL)) && ascii < 128) return 0; // letter+modifier key
+  if (Fl::e_keysym >= FL_Shift_L && Fl::e_keysym <= FL_Alt_R) return 0; // modifier key
+  if (Fl::e_keysym >= FL_Home && Fl::e_keysym <= FL_Help) return 0; // navigation key
+  if (!ascii || ascii <= 31 || ascii == 127) return 0; // empty or non-printable text
+  return 1;
+}
+
+
+Fl_RGB_Image *Fl_Headless_Screen_Driver::read_win_rectangle(int X, int Y, int w, int h, Fl_Window *win,
+                                                            bool ignore, bool *p_ignore) {
+  Window xid = win ? fl_xid(win) : NULL;
+  fl_headless_buffer *buffer = (xid ? xid->buffer :
+                                (Fl_Offscreen)Fl_Surface_Device::surface()->driver()->gc());
+  if (!buffer) return NULL;
+  if (X < 0) { w += X; X = 0; }
+  if (Y < 0) { h += Y; Y = 0; }
+  if (X + w > buffer->width) w = buffer->width - X;
+  if (Y + h > buffer->height) h = buffer->height - Y;
+  if (w <= 0 || h <= 0) return NULL;
+  uchar *data = new uchar[w * h * 3];
+  uchar *p = data;
+  for (int j = 0; j < h; j++) {
+    const uint32_t *q = buffer->pixels + size_t(j + Y) * buffer->width + X;
+    for (int i = 0; i < w; i++, q++) {
+      *p++ = uchar(*q >> 16); // R
+      *p++ = uchar(*q >> 8);  // G
+      *p++ = uchar(*q);       // B
+    }
+  }
+  Fl_RGB_Image *rgb = new Fl_RGB_Image(data, w, h, 3);
+  rgb->alloc_array = 1;
+  return rgb;
+}
+
+
+int Fl_Headless_Screen_Driver::get_mouse(int &x, int &y) {
+  x = mouse_x;
+  y = mouse_y;
+  return 0;
+}
+
+
+void Fl_Headless_Screen_Driver::offscreen_size(Fl_Offscreen off, int &width, int &height)
+{
+  width = off->width;
+  height = off->height;
+}
+
+
+void Fl_Headless_Screen_Driver::copy(const char *stuff, int len, int clipboard, const char *type) {
+  if (!stuff || len < 0) return;
+  if (clipboard >= 2) clipboard = 1;
+  selection_[clipboard] = (char*)realloc(selection_[clipboard], len + 1);
+  memcpy(selection_[clipboard], stuff, len);
+  selection_[clipboard][len] = 0; // needed for direct paste
+  selection_length_[clipboard] = len;
+  fl_trigger_clipboard_notify(clipboard);
+}
+
+
+void Fl_Headless_Screen_Driver::paste(Fl_Widget &receiver, int clipboard, const char *type) {
+  if (clipboard >= 2) clipboard = 1;
+  if (type != Fl::clipboard_plain_text && strcmp(type, Fl::clipboard_plain_text)) return;
+  Fl::e_text = selection_[clipboard] ? selection_[clipboard] : (char *)"";
+  Fl::e_length = selection_length_[clipboard];
+  Fl::e_clipboard_type = Fl::clipboard_plain_text;
+  receiver.handle(FL_PASTE);
+}
+
+
+int Fl_Headless_Screen_Driver::clipboard_contains(const char *type) {
+  return (type == Fl::clipboard_plain_text || strcmp(type, Fl::clipboard_plain_text) == 0) &&
+    selection_length_[1] > 0;
+}
@@ -0,0 +1,196 @@
+//
+// Definition of the headless system driver for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2010-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <config.h>
+#include "Fl_Headless_System_Driver.H"
+#include "Fl_Headless_Screen_Driver.H"
+#include <FL/Fl.H>
+#include <FL/platform.H>
+#include <FL/Fl_Window.H>
+#include <stdlib.h>
+#include <string.h>
+
+
+// A synthetic event waiting for the next Fl::wait()
+struct headless_event {
+  Fl_Widget_Tracker *window;
+  int event;
+  int x, y;   // mouse position relative to the window
+  int button; // mouse button, or vertical amount of FL_MOUSEWHEEL
+  int key;
+  char *text;
+  int state;
+  headless_event *next;
+};
+
+static headless_event *first_event = NULL, *last_event = NULL;
+static int event_count = 0;
+
+
+static void queue_event(Fl_Window *win, int event, int x, int y, int button, int key,
+                        const char *text, int state) {
+  headless_event *e = new headless_event;
+  e->window = new Fl_Widget_Tracker(win);
+  e->event = event;
+  e->x = x;
+  e->y = y;
+  e->button = button;
+  e->key = key;
+  e->text = (text ? strdup(text) : NULL);
+  e->state = state;
+  e->next = NULL;
+  if (last_event) last_event->next = e;
+  else first_event = e;
+  last_event = e;
+  event_count++;
+}
+
+
+void fl_headless_mouse_event(Fl_Window *win, int event, int x, int y, int button, int state) {
+  queue_event(win, event, x, y, button, 0, NULL, state);
+}
+
+
+void fl_headless_key_event(Fl_Window *win, int key, const char *text, int state) {
+  queue_event(win, FL_KEYDOWN, 0, 0, 0, key, text, state);
+  queue_event(win, FL_KEYUP, 0, 0, 0, key, text, state);
+}
+
+
+int fl_headless_pending_events() {
+  return event_count;
+}
+
+
+static int px, py;
+
+// if this is same event as last && is_click, increment click count:
+static inline void checkdouble() {
+  if (Fl::e_is_click == Fl::e_keysym)
+    Fl::e_clicks++;
+  else {
+    Fl::e_clicks = 0;
+    Fl::e_is_click = Fl::e_keysym;
+  }
+  px = Fl::e_x_root;
+  py = Fl::e_y_root;
+}
+
+
+static void dispatch_event(headless_event *e) {
+  Fl_Window *win = (Fl_Window*)e->window->widget();
+  if (!win || !win->shown()) return;
+  int event = e->event;
+  if (event == FL_KEYDOWN || event == FL_KEYUP) {
+    static char text[64];
+    strncpy(text, e->text ? e->text : "", sizeof(text) - 1);
+    Fl::e_keysym = Fl::e_original_keysym = e->key;
+    Fl::e_text = (event == FL_KEYDOWN ? text : (char*)"");
+    Fl::e_length = (event == FL_KEYDOWN ? (int)strlen(text) : 0);
+    Fl::e_state = (Fl::e_state & 0xff000000) | e->state;
+    Fl::e_is_click = 0;
+    Fl::handle(event, win);
+    return;
+  }
+  Fl::e_x = e->x;
+  Fl::e_y = e->y;
+  Fl::e_x_root = win->x_root() + e->x;
+  Fl::e_y_root = win->y_root() + e->y;
+  Fl_Headless_Screen_Driver *scr_driver = (Fl_Headless_Screen_Driver*)Fl::screen_driver();
+  scr_driver->mouse_x = Fl::e_x_root;
+  scr_driver->mouse_y = Fl::e_y_root;
+  Fl::e_state = (Fl::e_state & 0xff000000) | (e->state & 0x00ffffff);
+  // turn off is_click if enough mouse movement has passed:
+  if (abs(Fl::e_x_root - px) + abs(Fl::e_y_root - py) > 3) Fl::e_is_click = 0;
+  int b = (e->button >= 1 && e->button <= 3 ? e->button : 1);
+  switch (event) {
+    case FL_PUSH:
+      Fl::e_keysym = FL_Button + b;
+      checkdouble();
+      Fl::e_state |= (FL_BUTTON1 << (b - 1));
+      break;
+    case FL_RELEASE:
+      Fl::e_keysym = FL_Button + b;
+      Fl::e_state &= ~(FL_BUTTON1 << (b - 1));
+      break;
+    case FL_MOUSEWHEEL:
+      Fl::e_dx = 0;
+      Fl::e_dy = e->button;
+      break;
+    case FL_DRAG:
+    case FL_MOVE:
+      if (Fl::e_state & FL_BUTTONS) event = FL_DRAG;
+      else event = FL_MOVE;
+      break;
+  }
+  Fl::handle(event, win);
+}
+
+
+// Dispatches the events queued so far; events they queue wait for the next call
+static int dispatch_events() {
+  int count = event_count;
+  for (int k = 0; k < count && first_event; k++) {
+    headless_event *e = first_event;
+    first_event = e->next;
+    if (!first_event) last_event = NULL;
+    event_count--;
+    dispatch_event(e);
+    delete e->window;
+    free(e->text);
+    delete e;
+  }
+  return count;
+}
+
+
+int Fl_Headless_System_Driver::poll_or_select_with_delay(double time_to_wait) {
+  if (first_event) {
+    int n = dispatch_events();
+    int fds = Fl_Unix_System_Driver::poll_or_select_with_delay(0.0);
+    return n + (fds > 0 ? fds : 0);
+  }
+  if (time_to_wait >= 2147483.648) {
+    const char *exit_when_idle = getenv("FLTK_HEADLESS_EXIT_WHEN_IDLE");
+    if (exit_when_idle && *exit_when_idle && strcmp(exit_when_idle, "0")) {
+      Fl::flush();
+      while (Fl::first_window()) Fl::first_window()->hide();
+      return 0;
+    }
+  }
+  return Fl_Unix_System_Driver::poll_or_select_with_delay(time_to_wait);
+}
+
+
+int Fl_Headless_System_Driver::poll_or_select() {
+  if (first_event) return event_count;
+  return Fl_Unix_System_Driver::poll_or_select();
+}
+
+
+int Fl_Headless_System_Driver::event_key(int k) {
+  if (k > FL_Button && k <= FL_Button+8)
+    return Fl::event_state(8<<(k-FL_Button));
+  int sym = Fl::event_key();
+  if (sym >= 'a' && sym <= 'z' ) sym -= 32;
+  if (k >= 'a' && k <= 'z' )  k -= 32;
+  return (Fl::event() == FL_KEYDOWN || Fl::event() == FL_SHORTCUT) && sym == k;
+}
+
+
+int Fl_Headless_System_Driver::get_key(int k) {
+  return event_key(k);
+}
@@ -0,0 +1,283 @@
+//
+// Implementation of the headless window driver.
+//
+// Copyright 1998-2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <config.h>
+#include "Fl_Headless_Window_Driver.H"
+#include "Fl_Headless_Graphics_Driver.H"
+#include <FL/Fl.H>
+#include <FL/platform.H>
+#include <FL/Fl_Window.H>
+#include <FL/fl_ask.H>
+#include <FL/fl_utf8.h>
+#include <FL/filename.H> // FL_PATH_MAX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+Window fl_window;
+
+
+static double headless_time() {
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  return t.tv_sec + 0.000001 * t.tv_usec;
+}
+
+
+Fl_X *Fl_Headless_Window_Driver::makeWindow()
+{
+  if (pWindow->parent() && !pWindow->window()->shown()) return NULL;
+  struct fl_headless_window *new_window =
+    (struct fl_headless_window *)calloc(1, sizeof(struct fl_headless_window));
+  new_window->fl_win = pWindow;
+  wait_for_expose_value = 0;
+  if (!pWindow->parent()) pWindow->border(0);
+
+  Fl_X *xp = new Fl_X;
+  xp->xid = new_window;
+  other_xid = 0;
+  xp->w = pWindow;
+  i(xp);
+  xp->region = 0;
+  if (!pWindow->parent()) {
+    xp->next = Fl_X::first;
+    Fl_X::first = xp;
+  } else if (Fl_X::first) {
+    xp->next = Fl_X::first->next;
+    Fl_X::first->next = xp;
+  } else {
+    xp->next = NULL;
+    Fl_X::first = xp;
+  }
+
+  if (pWindow->modal()) Fl::modal_ = pWindow;
+
+  size_range();
+  pWindow->set_visible();
+  int old_event = Fl::e_number;
+  pWindow->handle(Fl::e_number = FL_SHOW); // get child windows to appear
+  Fl::e_number = old_event;
+  pWindow->redraw();
+
+  return xp;
+}
+
+
+void Fl_Headless_Window_Driver::show() {
+  if (!shown()) {
+    fl_open_display();
+    makeWindow();
+  } else {
+    Fl::handle(FL_SHOW, pWindow);
+  }
+}
+
+
+void Fl_Headless_Window_Driver::make_current() {
+  if (!shown()) {
+    static const char err_message[] = "Fl_Window::make_current(), but window is not shown().";
+    fl_alert(err_message);
+    Fl::fatal(err_message);
+  }
+  struct fl_headless_window *window = fl_xid(pWindow);
+  if (!window->buffer) {
+    window->buffer = Fl_Headless_Graphics_Driver::create_buffer(pWindow->w(), pWindow->h());
+  }
+  fl_graphics_driver->clip_region(0);
+  fl_window = window;
+  ((Fl_Headless_Graphics_Driver*)fl_graphics_driver)->set_buffer(window->buffer);
+}
+
+
+// Draws the damaged window and records how long it took
+void Fl_Headless_Window_Driver::flush() {
+  if (!pWindow->damage()) return;
+  struct fl_headless_window *window = fl_xid(pWindow);
+  double start = headless_time();
+  Fl_Window_Driver::flush();
+  if (!window) return;
+  double elapsed = headless_time() - start;
+  window->frames++;
+  window->total_time += elapsed;
+  if (elapsed > window->max_time) window->max_time = elapsed;
+}
+
+
+void Fl_Headless_Window_Driver::resize(int X, int Y, int W, int H) {
+  int is_a_resize = (W != w() || H != h());
+  if (X != x() || Y != y()) force_position(1);
+  else if (!is_a_resize) return;
+  if (is_a_resize) {
+    pWindow->Fl_Group::resize(X, Y, W, H);
+    if (shown()) {
+      struct fl_headless_window *window = fl_xid(pWindow);
+      if (window->buffer) { // the next make_current() creates a buffer of the new size
+        if (fl_window == window) fl_window = NULL;
+        Fl_Headless_Graphics_Driver::delete_buffer(window->buffer);
+        window->buffer = NULL;
+      }
+      pWindow->redraw();
+    }
+  } else {
+    x(X); y(Y);
+    if (pWindow->parent() && shown()) pWindow->window()->redraw();
+  }
+}
+
+
+// Writes the frame statistics and the content of a window when requested
+// by environment variables FLTK_HEADLESS_STATS and FLTK_HEADLESS_DUMP.
+static void report_window(struct fl_headless_window *window) {
+  static int count = 0;
+  Fl_Window *win = window->fl_win;
+  if (win->parent()) return;
+  count++;
+  const char *stats = getenv("FLTK_HEADLESS_STATS");
+  if (stats && *stats && strcmp(stats, "0")) {
+    // machine-readable result: name frames total-seconds max-seconds
+    printf("headless_frames window-%d %d %.6f %.6f\n", count, window->frames,
+           window->total_time, window->max_time);
+    fflush(stdout);
+  }
+  const char *dir = getenv("FLTK_HEADLESS_DUMP");
+  if (dir && *dir && window->buffer) {
+    char filename[FL_PATH_MAX];
+    snprintf(filename, sizeof(filename), "%s/window-%d.ppm", dir, count);
+    if (fl_headless_write_ppm(win, filename))
+      Fl::warning("Cannot write %s", filename);
+  }
+}
+
+
+void Fl_Headless_Window_Driver::hide() {
+  Fl_X* ip = Fl_X::i(pWindow);
+  struct fl_headless_window *window = (ip ? ip->xid : NULL);
+  if (window) report_window(window);
+  if (hide_common()) return;
+  if (ip->region) {
+    Fl_Graphics_Driver::default_driver().XDestroyRegion(ip->region);
+    ip->region = 0;
+  }
+  if (window) {
+    if (fl_window == window) {
+      fl_window = NULL;
+      ((Fl_Headless_Graphics_Driver*)fl_graphics_driver)->set_buffer(NULL);
+    }
+    Fl_Headless_Graphics_Driver::delete_buffer(window->buffer);
+    free(window);
+  }
+  delete ip;
+}
+
+
+int Fl_Headless_Window_Driver::scroll(int src_x, int src_y, int src_w, int src_h, int dest_x, int dest_y,
+                                      void (*draw_area)(void*, int,int,int,int), void* data)
+{
+  struct fl_headless_buffer *buffer = fl_xid(pWindow)->buffer;
+  if (!buffer) return 1;
+  int i, to, step;
+  if (src_y > dest_y) {
+    i = 0; to = src_h; step = 1;
+  } else {
+    i = src_h - 1; to = -1; step = -1;
+  }
+  while (i != to) {
+    memmove(buffer->pixels + size_t(dest_y + i) * buffer->width + dest_x,
+            buffer->pixels + size_t(src_y + i) * buffer->width + src_x, sizeof(uint32_t) * src_w);
+    i += step;
+  }
+  return 0;
+}
+
+
+int fl_headless_frame_stats(Fl_Window *win, int *frames, double *total, double *max) {
+  struct fl_headless_window *window = (win->shown() ? fl_xid(win) : NULL);
+  if (!window) return -1;
+  if (frames) *frames = window->frames;
+  if (total) *total = window->total_time;
+  if (max) *max = window->max_time;
+  return 0;
+}
+
+
+void fl_headless_reset_frame_stats(Fl_Window *win) {
+  struct fl_headless_window *window = (win->shown() ? fl_xid(win) : NULL);
+  if (!window) return;
+  window->frames = 0;
+  window->total_time = window->max_time = 0;
+}
+
+
+const unsigned *fl_headless_pixels(Fl_Window *win, int *width, int *height) {
+  struct fl_headless_window *window = (win->shown() ? fl_xid(win) : NULL);
+  if (!window || !window->buffer) return NULL;
+  if (width) *width = window->buffer->width;
+  if (height) *height = window->buffer->height;
+  return window->buffer->pixels;
+}
+
+
+// Copies the buffers of the shown subwindows of group g, at offset x,y, into the RGB image
+static void composite_subwindows(Fl_Group *g, int x, int y, uchar *rgb, int W, int H) {
+  for (int k = 0; k < g->children(); k++) {
+    Fl_Widget *o = g->child(k);
+    Fl_Window *sub = o->as_window();
+    if (!sub) {
+      if (o->as_group() && o->visible()) composite_subwindows(o->as_group(), x, y, rgb, W, H);
+      continue;
+    }
+    if (!sub->shown() || !sub->visible()) continue;
+    struct fl_headless_window *window = fl_xid(sub);
+    int X = x + sub->x(), Y = y + sub->y();
+    if (window && window->buffer) {
+      struct fl_headless_buffer *b = window->buffer;
+      for (int j = 0; j < b->height; j++) {
+        if (Y + j < 0 || Y + j >= H) continue;
+        for (int i = 0; i < b->width; i++) {
+          if (X + i < 0 || X + i >= W) continue;
+          uint32_t p = b->pixels[size_t(j) * b->width + i];
+          uchar *q = rgb + (size_t(Y + j) * W + X + i) * 3;
+          q[0] = uchar(p >> 16); q[1] = uchar(p >> 8); q[2] = uchar(p);
+        }
+      }
+    }
+    composite_subwindows(sub, X, Y, rgb, W, H);
+  }
+}
+
+
+int fl_headless_write_ppm(Fl_Window *win, const char *filename) {
+  int W, H;
+  const unsigned *pixels = fl_headless_pixels(win, &W, &H);
+  if (!pixels) return -1;
+  uchar *rgb = new uchar[size_t(W) * H * 3];
+  for (size_t k = 0; k < size_t(W) * H; k++) {
+    rgb[3 * k] = uchar(pixels[k] >> 16);
+    rgb[3 * k + 1] = uchar(pixels[k] >> 8);
+    rgb[3 * k + 2] = uchar(pixels[k]);
+  }
+  composite_subwindows(win, 0, 0, rgb, W, H);
+  FILE *out = fl_fopen(filename, "wb");
+  int result = -1;
+  if (out) {
+    fprintf(out, "P6\n%d %d\n255\n", W, H);
+    if (fwrite(rgb, 3, size_t(W) * H, out) == size_t(W) * H) result = 0;
+    if (fclose(out)) result = -1;
+  }
+  delete[] rgb;
+  return result;
+}
@@ -154,6 +154,7 @@ int Fl_GTK_Printer_Driver::begin_job(int pagecount, int *firstpage, int *lastpag
       pjob = NULL;
       FILE *output = fopen(line, "w");
       if (output) {
+        setvbuf(output, NULL, _IOFBF, FL_POSTSCRIPT_BUFFER_SIZE);
         Fl_PostScript_File_Device::begin_job(output, 0, format, layout);
         response_id = GTK_RESPONSE_OK;
       } else {
@@ -169,6 +170,7 @@ int Fl_GTK_Printer_Driver::begin_job(int pagecount, int *firstpage, int *lastpag
       int fd = mkstemp(tmpfilename);
       if (fd >= 0) {
         FILE *output = fdopen(fd, "w");
+        setvbuf(output, NULL, _IOFBF, FL_POSTSCRIPT_BUFFER_SIZE);
         Fl_PostScript_File_Device::begin_job(output, 0, format, layout);
         pjob = CALL_GTK(gtk_print_job_new)("FLTK print job", gprinter, psettings, psetup); //2.10
         response_id = GTK_RESPONSE_OK;
@@ -326,6 +328,7 @@ int Fl_Posix_Printer_Driver::begin_job(int pages, int *firstpage, int *lastpage,
     }
     return 2;
   }
+  setvbuf(ps->output, NULL, _IOFBF, FL_POSTSCRIPT_BUFFER_SIZE);
   ps->close_command(pclose);
   return ps->start_postscript(pages, format, layout); // start printing
 }
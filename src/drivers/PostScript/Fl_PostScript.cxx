@@ -58,6 +58,7 @@ int Fl_PostScript_File_Device::begin_job (int pagecount, enum Fl_Paged_Device::P
   Fl_PostScript_Graphics_Driver *ps = driver();
   ps->output = fl_fopen(fnfc.filename(), "w");
   if(ps->output == NULL) return 2;
+  setvbuf(ps->output, NULL, _IOFBF, FL_POSTSCRIPT_BUFFER_SIZE);
   ps->ps_filename_ = fl_strdup(fnfc.filename());
   ps->start_postscript(pagecount, format, layout);
   return 0;
@@ -131,11 +132,21 @@ Fl_PostScript_Graphics_Driver::Fl_PostScript_Graphics_Driver(void)
   scale_x = scale_y = 1.;
   bg_r = bg_g = bg_b = 255;
   clip_ = NULL;
+#if ! USE_PANGO
+  shared_images_ = NULL;
+  shared_image_count_ = shared_image_alloc_ = shared_image_defs_ = 0;
+  setup_ = job_output_ = NULL;
+#endif
 }
 
 /** \brief The destructor. */
 Fl_PostScript_Graphics_Driver::~Fl_PostScript_Graphics_Driver() {
   if(ps_filename_) free(ps_filename_);
+#if ! USE_PANGO
+  reset_shared_images_();
+  if (setup_) fclose(setup_);
+  if (job_output_) fclose(output); // the job was not ended
+#endif
 }
 
 
@@ -185,6 +196,10 @@ double Fl_PostScript_Graphics_Driver::width(unsigned u) {
   return Fl_Graphics_Driver::default_driver().width(u);
 }
 
+int Fl_PostScript_Graphics_Driver::has_additive_text_width() {
+  return Fl_Graphics_Driver::default_driver().has_additive_text_width();
+}
+
 int Fl_PostScript_Graphics_Driver::height() {
   return Fl_Graphics_Driver::default_driver().height();
 }
@@ -266,6 +281,16 @@ int Fl_PostScript_Graphics_Driver::clocale_printf(const char *format, ...)
   return retval;
 }
 
+// Writes "x y op\n" as clocale_printf("%g %g op\n", x, y) would.
+// Integer coordinates, the most frequent case, don't need protection from the current locale.
+void Fl_PostScript_Graphics_Driver::write_point_(double x, double y, const char *op)
+{
+  if (x > -1e6 && x < 1e6 && y > -1e6 && y < 1e6 && x == int(x) && y == int(y))
+    fprintf(output, "%d %d %s\n", int(x), int(y), op);
+  else
+    clocale_printf("%g %g %s\n", x, y, op);
+}
+
 //  Prolog string
 
 static const char * prolog =
@@ -399,6 +424,16 @@ static const char * prolog =
 
 static const char * prolog_2 =  // prolog relevant only if lang_level >1
 
+"/A85LZW { /ASCII85Decode filter /LZWDecode filter } bind def\n" // ASCII85Decode followed by LZWDecode filters
+
+// data source of CII and GII images: image data follow in the file, or
+// usage: array_of_strings FLsrc, for images defined once with shared_image_()
+"/DS { currentfile A85LZW } def\n"
+"/FLsd 2 dict def\n"
+"/FLsrc { FLsd begin /FLk 0 def /FLa exch def end\n"
+"{ FLsd begin FLk FLa length lt { FLa FLk get /FLk FLk 1 add def } { () } ifelse end }\n"
+"/LZWDecode filter } bind def\n"
+
 // color image dictionaries
 "/CII {GS /inter exch def /py exch def /px exch def /sy exch def /sx exch def \n"
 "translate \n"
@@ -411,7 +446,7 @@ static const char * prolog_2 =  // prolog relevant only if lang_level >1
 "/Height py def\n"
 "/BitsPerComponent 8 def\n"
 "/Interpolate inter def\n"
-"/DataSource currentfile A85RLE def\n"
+"/DataSource DS def\n"
 "/MultipleDataSources false def\n"
 "/ImageMatrix [ px 0 0 py neg 0 py ] def\n"
 "/Decode [ 0 1 0 1 0 1 ] def\n"
@@ -431,7 +466,7 @@ static const char * prolog_2 =  // prolog relevant only if lang_level >1
 "/BitsPerComponent 8 def\n"
 
 "/Interpolate inter def\n"
-"/DataSource currentfile A85RLE def\n"
+"/DataSource DS def\n"
 "/MultipleDataSources false def\n"
 "/ImageMatrix [ px 0 0 py neg 0 py ] def\n"
 "/Decode [ 0 1 ] def\n"
@@ -536,7 +571,7 @@ static const char * prolog_2_pixmap =  // prolog relevant only if lang_level ==
 "pixmap_w pixmap_h scale "
 "pixmap_sx pixmap_sy 8 "
 "pixmap_mat "
-"currentfile A85RLE "
+"currentfile A85LZW "
 "false 3 "
 "colorimage "
 "end "
@@ -554,7 +589,7 @@ static const char * prolog_2_pixmap =  // prolog relevant only if lang_level ==
 "pixmap_sx pixmap_sy\n"
 "true\n"
 "pixmap_mat\n"
-"currentfile A85RLE\n"
+"currentfile A85LZW\n"
 "imagemask\n"
 "GR\n"
 "} bind def\n"
@@ -576,7 +611,7 @@ static const char * prolog_3 = // prolog relevant only if lang_level >2
 "/Height py def\n"
 "/BitsPerComponent 8 def\n"
 "/Interpolate inter def\n"
-"/DataSource currentfile A85RLE def\n"
+"/DataSource currentfile A85LZW def\n"
 "/MultipleDataSources false def\n"
 "/ImageMatrix [ px 0 0 py neg 0 py ] def\n"
 
@@ -617,7 +652,7 @@ static const char * prolog_3 = // prolog relevant only if lang_level >2
 "/Height py def\n"
 "/BitsPerComponent 8 def\n"
 "/Interpolate inter def\n"
-"/DataSource currentfile A85RLE def\n"
+"/DataSource currentfile A85LZW def\n"
 "/MultipleDataSources false def\n"
 "/ImageMatrix [ px 0 0 py neg 0 py ] def\n"
 
@@ -706,14 +741,75 @@ int Fl_PostScript_Graphics_Driver::start_postscript (int pagecount,
 
 
   fputs("%%EndProlog\n",output);
-  if (lang_level_ >= 2)
-    fprintf(output,"<< /Policies << /Pagesize 1 >> >> setpagedevice\n");
 
   reset();
+  reset_shared_images_();
+  buffer_pages_();
   nPages=0;
   return 0;
 }
 
+/* Writes the pages to a temporary file until flush_pages_() is called, so that
+ images drawn several times in the job can be defined once in the document setup,
+ which precedes the first page. Without temporary files, the document setup is
+ written at once and images are shared only within each page.
+ */
+void Fl_PostScript_Graphics_Driver::buffer_pages_() {
+  FILE *pages = NULL;
+  if ( (setup_ = tmpfile()) != NULL && (pages = tmpfile()) == NULL) {
+    fclose(setup_);
+    setup_ = NULL;
+  }
+  if (!pages) {
+    write_setup_();
+    return;
+  }
+  setvbuf(pages, NULL, _IOFBF, FL_POSTSCRIPT_BUFFER_SIZE);
+  job_output_ = output;
+  output = pages;
+}
+
+// appends the content of file from to file to, returns non-zero on error
+static int copy_file(FILE *from, FILE *to) {
+  char buffer[16 * 1024];
+  size_t n;
+  if (fflush(from) || fseek(from, 0, SEEK_SET)) return 1;
+  while ((n = fread(buffer, 1, sizeof(buffer), from)) > 0) {
+    if (fwrite(buffer, 1, n, to) != n) return 1;
+  }
+  return ferror(from);
+}
+
+// writes the document setup section, with the images defined by shared_image_()
+void Fl_PostScript_Graphics_Driver::write_setup_() {
+  fputs("%%BeginSetup\n", output);
+  if (lang_level_ >= 2)
+    fprintf(output,"<< /Policies << /Pagesize 1 >> >> setpagedevice\n");
+  if (setup_) {
+    copy_file(setup_, output);
+    fclose(setup_);
+    setup_ = NULL;
+  }
+  fputs("%%EndSetup\n", output);
+}
+
+/* Writes the document setup and then the pages buffered since start_postscript()
+ to the destination of the job, which becomes the output again.
+ Returns non-zero if the buffered pages could not be read back.
+ */
+int Fl_PostScript_Graphics_Driver::flush_pages_() {
+  if (!job_output_) return 0;
+  FILE *pages = output;
+  output = job_output_;
+  job_output_ = NULL;
+  int error = ferror(setup_) || ferror(pages);
+  write_setup_();
+  if (copy_file(pages, output)) error = 1;
+  fclose(pages);
+  reset_shared_images_();
+  return error;
+}
+
 int Fl_PostScript_Graphics_Driver::start_eps (int width, int height) {
   pw_ = width;
   ph_ = height;
@@ -740,6 +836,7 @@ int Fl_PostScript_Graphics_Driver::start_eps (int width, int height) {
   fputs("/CR { GR } bind def\n", output);
   page_policy_ = 1;
   reset();
+  reset_shared_images_();
   nPages=0;
   fprintf(output, "GS\n");
   clocale_printf( "%g %g TR\n", (double)0, ph_);
@@ -810,6 +907,7 @@ void Fl_PostScript_Graphics_Driver::page(double pw, double ph, int media) {
   reset();
 
   fprintf(output, "save\n");
+  if (!setup_) reset_shared_images_(); // images are defined inside the page's save/restore
   fprintf(output, "GS\n");
   clocale_printf( "%g %g TR\n", (double)0 /*lm_*/ , ph_ /* - tm_*/);
   fprintf(output, "1 -1 SC\n");
@@ -1268,23 +1366,23 @@ void Fl_PostScript_Graphics_Driver::begin_polygon(){
 
 void Fl_PostScript_Graphics_Driver::vertex(double x, double y){
   if(shape_==POINTS){
-    clocale_printf("%g %g MT\n", x , y);
+    write_point_(x, y, "MT");
     gap_=1;
     return;
   }
   if(gap_){
-    clocale_printf("%g %g MT\n", x , y);
+    write_point_(x, y, "MT");
     gap_=0;
   }else
-    clocale_printf("%g %g LT\n", x , y);
+    write_point_(x, y, "LT");
 }
 
 void Fl_PostScript_Graphics_Driver::curve(double x, double y, double x1, double y1, double x2, double y2, double x3, double y3){
   if(shape_==NONE) return;
   if(gap_)
-    clocale_printf("%g %g MT\n", x , y);
+    write_point_(x, y, "MT");
   else
-    clocale_printf("%g %g LT\n", x , y);
+    write_point_(x, y, "LT");
   gap_=0;
 
   clocale_printf("%g %g %g %g %g %g curveto \n", x1 , y1 , x2 , y2 , x3 , y3);
@@ -1382,10 +1480,10 @@ void Fl_PostScript_Graphics_Driver::end_polygon(){
 void Fl_PostScript_Graphics_Driver::transformed_vertex(double x, double y){
   reconcat();
   if(gap_){
-    clocale_printf("%g %g MT\n", x , y);
+    write_point_(x, y, "MT");
     gap_=0;
   }else
-    clocale_printf("%g %g LT\n", x , y);
+    write_point_(x, y, "LT");
   concat();
 }
 
@@ -1672,6 +1770,9 @@ void Fl_PostScript_File_Device::end_job (void)
 #else
   if (ps->nPages) {  // for eps nPages is 0 so it is fine ....
     fprintf(ps->output, "CR\nGR\nGR\nGR\nSP\n restore\n");
+  }
+  error = ps->flush_pages_();
+  if (ps->nPages) {
     if (!ps->pages_){
       fprintf(ps->output, "%%%%Trailer\n");
       fprintf(ps->output, "%%%%Pages: %i\n" , ps->nPages);
@@ -1680,7 +1781,7 @@ void Fl_PostScript_File_Device::end_job (void)
     fprintf(ps->output, "GR\n restore\n");
   fputs("%%EOF",ps->output);
   fflush(ps->output);
-  error = ferror(ps->output);
+  if (!error) error = ferror(ps->output);
   ps->reset();
 #endif
   while (ps->clip_){
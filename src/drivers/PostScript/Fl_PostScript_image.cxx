@@ -344,6 +344,125 @@ void Fl_PostScript_Graphics_Driver::close_rle85(void *data) // stop doing RLE+AS
 // End of implementation of the /RunLengthEncode + /ASCII85Encode PostScript filter
 //
 
+//
+// Implementation of the /LZWEncode + /ASCII85Encode PostScript filter
+// as described in "PostScript LANGUAGE REFERENCE third edition" p. 135
+// (LanguageLevel 2, EarlyChange = 1)
+//
+
+#define LZW_HSIZE 5003  // hash table size, a prime number > 4096
+#define LZW_CLEAR 256   // ClearTable code
+#define LZW_EOD 257     // EOD code
+#define LZW_FIRST 258   // first code of the table
+#define LZW_RESET 4094  // the table is cleared when it reaches that size
+
+struct struct_lzw85 {
+  struct85 *data85;   // aux data for ASCII85 encoding
+  int htab[LZW_HSIZE]; // (byte << 12) + prefix code of each table entry, -1 if empty
+  unsigned short codetab[LZW_HSIZE]; // code of each table entry
+  int prefix;         // code of the current string, -1 if none
+  int next_code;      // next code to enter the table
+  int width;          // current code width in bits
+  unsigned bits;      // pending output bits
+  int nbits;          // # of pending output bits
+  int literal_size;   // if > 0, output is split in ASCII85 string literals of that many bytes
+  int literal_count;  // # of bytes in the current string literal
+};
+
+static void lzw_clear_table(struct_lzw85 *lzw)
+{
+  for (int i = 0; i < LZW_HSIZE; i++) lzw->htab[i] = -1;
+  lzw->next_code = LZW_FIRST;
+  lzw->width = 9;
+}
+
+void *Fl_PostScript_Graphics_Driver::prepare_lzw85(int literal_size) // prepare to produce LZW+ASCII85-encoded output
+{
+  struct_lzw85 *lzw = new struct_lzw85;
+  lzw->data85 = (struct85*)prepare85();
+  lzw->prefix = -1;
+  lzw->bits = 0;
+  lzw->nbits = 0;
+  lzw->literal_size = literal_size;
+  lzw->literal_count = 0;
+  lzw_clear_table(lzw);
+  if (literal_size) fputs("<~", output);
+  emit_lzw85(lzw, LZW_CLEAR); // start with a ClearTable code, as recommended
+  return lzw;
+}
+
+
+void Fl_PostScript_Graphics_Driver::emit_lzw85(void *data, int code) // appends one code to the LZW bit stream
+{
+  struct_lzw85 *lzw = (struct_lzw85 *)data;
+  lzw->bits = (lzw->bits << lzw->width) | code;
+  lzw->nbits += lzw->width;
+  while (lzw->nbits >= 8) {
+    lzw->nbits -= 8;
+    uchar c = uchar(lzw->bits >> lzw->nbits);
+    write85(lzw->data85, &c, 1);
+    if (lzw->literal_size && ++lzw->literal_count >= lzw->literal_size) { // begin a new string literal
+      close85(lzw->data85);
+      fputs("\n<~", output);
+      lzw->data85 = (struct85*)prepare85();
+      lzw->literal_count = 0;
+    }
+  }
+  lzw->bits &= (1U << lzw->nbits) - 1;
+}
+
+
+void Fl_PostScript_Graphics_Driver::write_lzw85(uchar b, void *data) // sends one input byte to LZW+ASCII85 encoding
+{
+  struct_lzw85 *lzw = (struct_lzw85 *)data;
+  if (lzw->prefix < 0) {
+    lzw->prefix = b;
+    return;
+  }
+  int fcode = (b << 12) + lzw->prefix;
+  int i = (b << 4) ^ lzw->prefix; // xor hashing
+  int disp = (i == 0 ? 1 : LZW_HSIZE - i); // secondary hash
+  while (lzw->htab[i] >= 0) {
+    if (lzw->htab[i] == fcode) { // the current string + b is in the table
+      lzw->prefix = lzw->codetab[i];
+      return;
+    }
+    if ((i -= disp) < 0) i += LZW_HSIZE;
+  }
+  emit_lzw85(lzw, lzw->prefix);
+  lzw->htab[i] = fcode;
+  lzw->codetab[i] = (unsigned short)lzw->next_code++;
+  if (lzw->next_code >= LZW_RESET) {
+    emit_lzw85(lzw, LZW_CLEAR);
+    lzw_clear_table(lzw);
+  } else if (lzw->next_code == (1 << lzw->width)) {
+    lzw->width++; // the decoder changes width one code early
+  }
+  lzw->prefix = b;
+}
+
+
+void Fl_PostScript_Graphics_Driver::close_lzw85(void *data) // stop doing LZW+ASCII85 encoding
+{
+  struct_lzw85 *lzw = (struct_lzw85 *)data;
+  if (lzw->prefix >= 0) {
+    emit_lzw85(lzw, lzw->prefix);
+    // the decoder adds a table entry after reading this code
+    if (++lzw->next_code == (1 << lzw->width) && lzw->width < 12) lzw->width++;
+  }
+  emit_lzw85(lzw, LZW_EOD);
+  if (lzw->nbits) { // output remaining bits padded with zeros
+    uchar c = uchar(lzw->bits << (8 - lzw->nbits));
+    write85(lzw->data85, &c, 1);
+  }
+  close85(lzw->data85); // close ASCII85 encoding process
+  delete lzw;
+}
+
+//
+// End of implementation of the /LZWEncode + /ASCII85Encode PostScript filter
+//
+
 
 int Fl_PostScript_Graphics_Driver::alpha_mask(const uchar * data, int w, int h, int D, int LD){
 
@@ -492,6 +611,24 @@ int Fl_PostScript_Graphics_Driver::alpha_mask(const uchar * data, int w, int h,
   return 0;
 }
 
+// With LanguageLevel 2 and above, image data are LZW-compressed; with level 1, they are run-length encoded.
+void *Fl_PostScript_Graphics_Driver::prepare_image_data_()
+{
+  return lang_level_ > 1 ? prepare_lzw85() : prepare_rle85();
+}
+
+void Fl_PostScript_Graphics_Driver::write_image_data_(uchar b, void *data)
+{
+  if (lang_level_ > 1) write_lzw85(b, data);
+  else write_rle85(b, data);
+}
+
+void Fl_PostScript_Graphics_Driver::close_image_data_(void *data)
+{
+  if (lang_level_ > 1) close_lzw85(data);
+  else close_rle85(data);
+}
+
 // bitwise inversion of all 4-bit quantities
 static const unsigned char swapped[16] = {0,8,4,12,2,10,6,14,1,9,5,13,3,11,7,15};
 
@@ -527,24 +664,24 @@ void Fl_PostScript_Graphics_Driver::draw_image(Fl_Draw_Image_Cb call, void *data
   int LD=iw*abs(D);
   uchar *rgbdata=new uchar[LD];
   uchar *curmask=mask;
-  void *big = prepare_rle85();
+  void *big = prepare_image_data_();
 
   if (level2_mask) {
     for (j = ih - 1; j >= 0; j--) { // output full image data
       call(data, 0, j, iw, rgbdata);
       uchar *curdata = rgbdata;
       for (i=0 ; i<iw ; i++) {
-        write_rle85(curdata[0], big); write_rle85(curdata[1], big); write_rle85(curdata[2], big);
+        write_image_data_(curdata[0], big); write_image_data_(curdata[1], big); write_image_data_(curdata[2], big);
         curdata += D;
       }
     }
-    close_rle85(big); fputc('\n', output);
-    big = prepare_rle85();
+    close_image_data_(big); fputc('\n', output);
+    big = prepare_image_data_();
     for (j = ih - 1; j >= 0; j--) { // output mask data
       curmask = mask + j * (my/ih) * ((mx+7)/8);
       for (k=0; k < my/ih; k++) {
         for (i=0; i < ((mx+7)/8); i++) {
-          write_rle85(swap_byte(*curmask), big);
+          write_image_data_(swap_byte(*curmask), big);
           curmask++;
         }
       }
@@ -555,7 +692,7 @@ void Fl_PostScript_Graphics_Driver::draw_image(Fl_Draw_Image_Cb call, void *data
       if (mask && lang_level_ > 2) {  // InterleaveType 2 mask data
         for (k=0; k<my/ih;k++) { //for alpha pseudo-masking
           for (i=0; i<((mx+7)/8);i++) {
-            write_rle85(swap_byte(*curmask), big);
+            write_image_data_(swap_byte(*curmask), big);
             curmask++;
           }
         }
@@ -575,13 +712,13 @@ void Fl_PostScript_Graphics_Driver::draw_image(Fl_Draw_Image_Cb call, void *data
           b = (a2 * b + bg_b * a)/255;
         }
 
-        write_rle85(r, big); write_rle85(g, big); write_rle85(b, big);
+        write_image_data_(r, big); write_image_data_(g, big); write_image_data_(b, big);
         curdata +=D;
       }
 
     }
   }
-  close_rle85(big);
+  close_image_data_(big);
   fprintf(output,"\nrestore\n");
   delete[] rgbdata;
 }
@@ -613,12 +750,12 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(const uchar *data, int ix, i
   int bg = (bg_r + bg_g + bg_b)/3;
 
   uchar *curmask=mask;
-  void *big = prepare_rle85();
+  void *big = prepare_image_data_();
   for (j=0; j<ih;j++){
     if (mask){
       for (k=0;k<my/ih;k++){
         for (i=0; i<((mx+7)/8);i++){
-          write_rle85(swap_byte(*curmask), big);
+          write_image_data_(swap_byte(*curmask), big);
           curmask++;
         }
       }
@@ -632,12 +769,12 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(const uchar *data, int ix, i
         unsigned int a = 255-a2;
         r = (a2 * r + bg * a)/255;
       }
-      write_rle85(r, big);
+      write_image_data_(r, big);
       curdata +=D;
     }
 
   }
-  close_rle85(big);
+  close_image_data_(big);
   fprintf(output,"restore\n");
 }
 
@@ -662,13 +799,13 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(Fl_Draw_Image_Cb call, void
   int LD=iw*D;
   uchar *rgbdata=new uchar[LD];
   uchar *curmask=mask;
-  void *big = prepare_rle85();
+  void *big = prepare_image_data_();
   for (j=0; j<ih;j++){
 
     if (mask && lang_level_>2){  // InterleaveType 2 mask data
       for (k=0; k<my/ih;k++){ //for alpha pseudo-masking
         for (i=0; i<((mx+7)/8);i++){
-          write_rle85(swap_byte(*curmask), big);
+          write_image_data_(swap_byte(*curmask), big);
           curmask++;
         }
       }
@@ -676,11 +813,11 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(Fl_Draw_Image_Cb call, void
     call(data,0,j,iw,rgbdata);
     uchar *curdata=rgbdata;
     for (i=0 ; i<iw ; i++) {
-      write_rle85(curdata[0], big);
+      write_image_data_(curdata[0], big);
       curdata +=D;
     }
   }
-  close_rle85(big);
+  close_image_data_(big);
   fprintf(output,"restore\n");
   delete[] rgbdata;
 }
@@ -688,6 +825,95 @@ void Fl_PostScript_Graphics_Driver::draw_image_mono(Fl_Draw_Image_Cb call, void
 
 ////////////////////////////// Image classes //////////////////////
 
+// Images drawn with draw_rgb() more than once in a job are defined once as
+// an array of strings holding their LZW-compressed data (/FLI<id>), and drawn
+// by reference to this array. While start_postscript() buffers the pages, the
+// definitions go to the document setup, so that each page depends only on the
+// prolog and setup. Otherwise, as for EPS output, they are made inside the
+// save/restore of the page, and only images drawn again on that page are shared.
+struct Fl_PostScript_Graphics_Driver::shared_image {
+  unsigned hash1, hash2; // two distinct hash values of the image data
+  int w, h, d;
+  uchar bg_r, bg_g, bg_b; // background color mixed into image data
+  int id; // number of the definition, 0 while the image was drawn only once
+};
+
+void Fl_PostScript_Graphics_Driver::reset_shared_images_() {
+  free(shared_images_);
+  shared_images_ = NULL;
+  shared_image_count_ = shared_image_alloc_ = shared_image_defs_ = 0;
+}
+
+// returns the id of the definition of an image already drawn in the job (or page),
+// defining it first if necessary, or 0 if the image is drawn for the first time
+int Fl_PostScript_Graphics_Driver::shared_image_(const uchar *data, int w, int h, int D, int LD) {
+  if (!LD) LD = w * D;
+  bool mix = (lang_level_ < 3 && (D == 2 || D == 4)); // alpha is mixed with background color
+  unsigned hash1 = 2166136261U, hash2 = 0; // FNV-1a and sdbm hashes
+  for (int j = 0; j < h; j++) {
+    const uchar *p = data + j * LD, *last = p + w * D;
+    while (p < last) {
+      hash1 = (hash1 ^ *p) * 16777619U;
+      hash2 = *p++ + (hash2 << 6) + (hash2 << 16) - hash2;
+    }
+  }
+  shared_image *si = NULL;
+  for (int i = 0; i < shared_image_count_; i++) {
+    shared_image *s = shared_images_ + i;
+    if (s->hash1 == hash1 && s->hash2 == hash2 && s->w == w && s->h == h && s->d == D &&
+        (!mix || (s->bg_r == bg_r && s->bg_g == bg_g && s->bg_b == bg_b))) {
+      si = s;
+      break;
+    }
+  }
+  if (!si) { // remember the image, which is drawn with its data this time
+    if (shared_image_count_ >= shared_image_alloc_) {
+      shared_image_alloc_ = shared_image_alloc_ ? 2 * shared_image_alloc_ : 16;
+      shared_images_ = (shared_image*)realloc(shared_images_, shared_image_alloc_ * sizeof(shared_image));
+    }
+    si = shared_images_ + shared_image_count_++;
+    si->hash1 = hash1; si->hash2 = hash2;
+    si->w = w; si->h = h; si->d = D;
+    si->bg_r = bg_r; si->bg_g = bg_g; si->bg_b = bg_b;
+    si->id = 0;
+    return 0;
+  }
+  if (si->id) return si->id;
+  si->id = ++shared_image_defs_;
+  FILE *page_output = output;
+  if (setup_) output = setup_; // the definition goes to the document setup
+  fprintf(output, "/FLI%d [\n", si->id);
+  void *big = prepare_lzw85(32000); // each string literal holds less than the 65535-byte string limit
+  int bg = (bg_r + bg_g + bg_b)/3;
+  for (int j = 0; j < h; j++) {
+    const uchar *curdata = data + j * LD;
+    for (int i = 0; i < w; i++, curdata += D) {
+      if (D >= 3) {
+        uchar r = curdata[0], g = curdata[1], b = curdata[2];
+        if (mix) {
+          unsigned int a2 = curdata[3];
+          unsigned int a = 255 - a2;
+          r = (a2 * r + bg_r * a)/255;
+          g = (a2 * g + bg_g * a)/255;
+          b = (a2 * b + bg_b * a)/255;
+        }
+        write_lzw85(r, big); write_lzw85(g, big); write_lzw85(b, big);
+      } else {
+        uchar r = curdata[0];
+        if (mix) {
+          unsigned int a2 = curdata[1];
+          r = (a2 * r + bg * (255 - a2))/255;
+        }
+        write_lzw85(r, big);
+      }
+    }
+  }
+  close_lzw85(big);
+  fputs("\n] def\n", output);
+  output = page_output;
+  return si->id;
+}
+
 void Fl_PostScript_Graphics_Driver::draw_pixmap(Fl_Pixmap * pxm,int XP, int YP, int WP, int HP, int cx, int cy){
   if (scale_for_image_(pxm, XP, YP, WP, HP, cx, cy)) return;
   const char * const * di =pxm->data();
@@ -711,7 +937,13 @@ void Fl_PostScript_Graphics_Driver::draw_rgb(Fl_RGB_Image * rgb,int XP, int YP,
   int h = rgb->data_h();
   mask = 0;
   if (lang_level_ <= 2 || !alpha_mask(di, w, h, rgb->d(),rgb->ld()) ) {
-    draw_image(di, 0, 0, w, h, rgb->d(), rgb->ld());
+    int id = (lang_level_ > 1 && !mask) ? shared_image_(di, w, h, rgb->d(), rgb->ld()) : 0;
+    if (id) { // draw by reference to the image's shared definition
+      fprintf(output, "save\n/DS { FLI%d FLsrc } def\n", id);
+      fprintf(output, "0 %d %d %d %d %d %s %s\nrestore\n", h, w, -h, w, h,
+              interpolate_ ? "true" : "false", rgb->d() < 3 ? "GII" : "CII");
+    } else
+      draw_image(di, 0, 0, w, h, rgb->d(), rgb->ld());
     delete[] mask;
     mask=0;
   }
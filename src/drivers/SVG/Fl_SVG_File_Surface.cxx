@@ -30,6 +30,8 @@
 #include <FL/Fl_Bitmap.H>
 #include <FL/fl_string_functions.h>
 #include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
 
 extern "C" {
 #if defined(HAVE_LIBPNG)
@@ -62,15 +64,25 @@ class Fl_SVG_Graphics_Driver : public Fl_Graphics_Driver {
   };
   Clip * clip_; // top of pile of clips
   int clip_count_; // to generate distinct SVG clip Ids
-  char *last_rgb_name_; // NULL or SVG Id of last defined RGB image
+  struct defined_image; // an image already output in <defs>
+  defined_image *images_; // all images defined so far
+  int image_count_, image_alloc_;
+  enum {NO_PATH = 0, STROKED_PATH, FILLED_PATH};
+  int path_kind_; // kind of the pending path that merges consecutive primitives
+  char *path_; // data of the pending path
+  size_t path_len_, path_alloc_;
   const char *family_;
   const char *bold_;
   const char *style_;
 public:
   Fl_SVG_Graphics_Driver(FILE*);
   ~Fl_SVG_Graphics_Driver();
-  FILE* file() {return out_;}
+  FILE* file() {flush_path_(); return out_;}
 protected:
+  void add_to_path_(int kind, const char *format, ...);
+  void flush_path_();
+  const char *image_id_(Fl_RGB_Image *rgb, bool &is_new);
+  void use_rgb_(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy, bool allow_jpeg);
   void rect(int x, int y, int w, int h);
   void rectf(int x, int y, int w, int h);
   void compute_dasharray(float s, char *dashes=0);
@@ -93,8 +105,8 @@ protected:
   int height() ;
   int descent() ;
   void draw_rgb(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy);
-  void define_rgb_png(Fl_RGB_Image *rgb, const char *name, int x, int y);
-  void define_rgb_jpeg(Fl_RGB_Image *rgb, const char *name, int x, int y);
+  void define_rgb_png(Fl_RGB_Image *rgb, const char *name);
+  void define_rgb_jpeg(Fl_RGB_Image *rgb, const char *name);
   void draw_pixmap(Fl_Pixmap *pxm,int XP, int YP, int WP, int HP, int cx, int cy);
   void draw_bitmap(Fl_Bitmap *bm,int XP, int YP, int WP, int HP, int cx, int cy);
   void draw_image(const uchar* buf, int x, int y, int w, int h, int d, int l);
@@ -137,7 +149,11 @@ Fl_SVG_Graphics_Driver::Fl_SVG_Graphics_Driver(FILE *f) {
   user_dash_array_ = 0;
   dasharray_ = fl_strdup("none");
   p_size = 0;
-  last_rgb_name_ = NULL;
+  images_ = NULL;
+  image_count_ = image_alloc_ = 0;
+  path_kind_ = NO_PATH;
+  path_ = NULL;
+  path_len_ = path_alloc_ = 0;
 }
 
 Fl_SVG_Graphics_Driver::~Fl_SVG_Graphics_Driver()
@@ -149,18 +165,56 @@ Fl_SVG_Graphics_Driver::~Fl_SVG_Graphics_Driver()
     clip_= clip_->prev;
     delete c;
   }
-  if (last_rgb_name_) free(last_rgb_name_);
+  if (images_) free(images_);
+  if (path_) free(path_);
+}
+
+/* Consecutive primitives drawn with the same style are not output as individual
+ SVG elements but are accumulated as sub-paths of a single <path> element.
+ The pending path is output as soon as the style changes or anything else
+ is written to the SVG file.
+ Only stroked primitives and filled rectangles are merged: the union of
+ stroked sub-paths is independent of their orientation, and all filled
+ rectangles have the same orientation, so the nonzero fill rule keeps them filled.
+ */
+void Fl_SVG_Graphics_Driver::add_to_path_(int kind, const char *format, ...) {
+  if (kind != path_kind_) {
+    flush_path_();
+    path_kind_ = kind;
+  }
+  va_list args;
+  while (true) {
+    va_start(args, format);
+    int l = vsnprintf(path_ + path_len_, path_alloc_ - path_len_, format, args);
+    va_end(args);
+    if (l >= 0 && path_len_ + l < path_alloc_) {
+      path_len_ += l;
+      return;
+    }
+    path_alloc_ = path_alloc_ ? 2 * path_alloc_ : 1024;
+    if (l >= 0 && path_alloc_ <= path_len_ + l) path_alloc_ = path_len_ + l + 1;
+    path_ = (char*)realloc(path_, path_alloc_);
+  }
+}
+
+void Fl_SVG_Graphics_Driver::flush_path_() {
+  if (path_kind_ == STROKED_PATH) {
+    fprintf(out_, "<path d=\"%s\" fill=\"none\" stroke=\"rgb(%u,%u,%u)\" stroke-width=\"%d\" "
+            "stroke-dasharray=\"%s\" stroke-linecap=\"%s\" stroke-linejoin=\"%s\"/>\n",
+            path_, red_, green_, blue_, width_, dasharray_, linecap_, linejoin_);
+  } else if (path_kind_ == FILLED_PATH) {
+    fprintf(out_, "<path d=\"%s\" fill=\"rgb(%u,%u,%u)\"/>\n", path_, red_, green_, blue_);
+  }
+  path_kind_ = NO_PATH;
+  path_len_ = 0;
 }
 
 void Fl_SVG_Graphics_Driver::rect(int x, int y, int w, int h) {
-  fprintf(out_, "<rect x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" "
-          "fill=\"none\" stroke=\"rgb(%u,%u,%u)\" stroke-width=\"%d\" stroke-dasharray=\"%s\""
-          " stroke-linecap=\"%s\" stroke-linejoin=\"%s\"/>\n", x, y, w-1, h-1, red_, green_, blue_, width_, dasharray_, linecap_, linejoin_);
+  add_to_path_(STROKED_PATH, "M%d %dh%dv%dh%dz", x, y, w-1, h-1, 1-w);
 }
 
 void Fl_SVG_Graphics_Driver::rectf(int x, int y, int w, int h) {
-  fprintf(out_, "<rect x=\"%.3f\" y=\"%.3f\" width=\"%d\" height=\"%d\" "
-          "fill=\"rgb(%u,%u,%u)\" />\n", x-.5, y-.5, w, h, red_, green_, blue_);
+  add_to_path_(FILLED_PATH, "M%g %gh%dv%dh%dz", x-.5, y-.5, w, h, -w);
 }
 
 void Fl_SVG_Graphics_Driver::point(int x, int y) {
@@ -168,17 +222,11 @@ void Fl_SVG_Graphics_Driver::point(int x, int y) {
 }
 
 void Fl_SVG_Graphics_Driver::line(int x1, int y1, int x2, int y2) {
-  fprintf(out_,
-          "<line x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\" "
-          "style=\"stroke:rgb(%u,%u,%u);stroke-width:%d;stroke-linecap:%s;stroke-linejoin:%s;stroke-dasharray:%s\" />\n",
-          x1,y1,x2,y2, red_, green_, blue_, width_, linecap_, linejoin_, dasharray_);
+  add_to_path_(STROKED_PATH, "M%d %dL%d %d", x1, y1, x2, y2);
 }
 
 void Fl_SVG_Graphics_Driver::line(int x1, int y1, int x2, int y2, int x3, int y3) {
-  fprintf(out_,
-          "<path d=\"M %d %d L %d %d L %d %d \" "
-          "style=\"stroke:rgb(%u,%u,%u);fill:none;stroke-width:%d;stroke-linecap:%s;stroke-linejoin:%s;stroke-dasharray:%s\" />\n",
-  x1, y1, x2, y2, x3, y3, red_, green_, blue_, width_, linecap_, linejoin_, dasharray_);
+  add_to_path_(STROKED_PATH, "M%d %dL%d %dL%d %d", x1, y1, x2, y2, x3, y3);
 }
 
 void Fl_SVG_Graphics_Driver::font_(int ft, int s) {
@@ -236,8 +284,11 @@ void Fl_SVG_Graphics_Driver::compute_dasharray(float s, char *dashes) {
 }
 
 void Fl_SVG_Graphics_Driver::line_style(int style, int width, char *dashes) {
-  line_style_ = style;
   if (width == 0) width = 1;
+  if (style == line_style_ && width == width_ && !(dashes && *dashes) && !user_dash_array_)
+    return; // unchanged line style: a pending stroked path can be continued
+  if (path_kind_ == STROKED_PATH) flush_path_();
+  line_style_ = style;
   width_ = width;
   int cap_part = style & 0xF00;
   if (cap_part == FL_CAP_SQUARE) linecap_ = "square";
@@ -252,6 +303,7 @@ void Fl_SVG_Graphics_Driver::line_style(int style, int width, char *dashes) {
 }
 
 void Fl_SVG_Graphics_Driver::draw(const char *str, int n, int x, int y) {
+  flush_path_();
   // Caution: Internet Explorer ignores the xml:space="preserve" attribute
   // work-around: replace all spaces by no-break space = U+00A0 = 0xC2-0xA0 (UTF-8) before sending to IE
   fprintf(out_, "<text x=\"%d\" y=\"%d\" font-family=\"%s\"%s%s font-size=\"%d\" "
@@ -271,6 +323,7 @@ void Fl_SVG_Graphics_Driver::draw(const char* str, int n, float fx, float fy) {
 }
 
 void Fl_SVG_Graphics_Driver::draw(int angle, const char* str, int n, int x, int y) {
+  flush_path_();
   fprintf(out_, "<g transform=\"translate(%d,%d) rotate(%d)\">", x, y, -angle);
   draw(str, n, 0, 0);
   fputs("</g>\n", out_);
@@ -283,10 +336,13 @@ void Fl_SVG_Graphics_Driver::rtl_draw(const char *str, int n, int x, int y) {
 
 void Fl_SVG_Graphics_Driver::color(Fl_Color c) {
   Fl_Graphics_Driver::color(c);
-  Fl::get_color(c, red_, green_, blue_);
+  uchar r, g, b;
+  Fl::get_color(c, r, g, b);
+  color(r, g, b);
 }
 
 void Fl_SVG_Graphics_Driver::color(uchar r, uchar g, uchar b) {
+  if (path_kind_ != NO_PATH && (r != red_ || g != green_ || b != blue_)) flush_path_();
   red_ = r;
   green_ = g;
   blue_ = b;
@@ -458,7 +514,7 @@ AxhQP6QxgAEM+LYBf9sdYcTRmp6pAAAAAElFTkSuQmCCAAAAAElFTkSuQmCC"/>
  AxhQP6QxgAEM+LYBf9sdYcTRmp6pAAAAAElFTkSuQmCCAAAAAElFTkSuQmCC"/>
  */
 
-void Fl_SVG_Graphics_Driver::define_rgb_png(Fl_RGB_Image *rgb, const char *name, int x, int y) {
+void Fl_SVG_Graphics_Driver::define_rgb_png(Fl_RGB_Image *rgb, const char *name) {
   png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
   if (!png_ptr) return;
   png_infop info_ptr = png_create_info_struct(png_ptr);
@@ -466,13 +522,8 @@ void Fl_SVG_Graphics_Driver::define_rgb_png(Fl_RGB_Image *rgb, const char *name,
     png_destroy_write_struct(&png_ptr, (png_infopp)NULL);
     return;
   }
-  if (name) {
-    if (last_rgb_name_) free(last_rgb_name_);
-    last_rgb_name_ = fl_strdup(name);
-  }
   float f = rgb->data_w() > rgb->data_h() ? float(rgb->w()) / rgb->data_w(): float(rgb->h()) / rgb->data_h();
-  if (name) fprintf(out_, "<defs><image id=\"%s\" ", name);
-  else fprintf(out_, "<image x=\"%d\" y=\"%d\" ", x, y);
+  fprintf(out_, "<defs><image id=\"%s\" ", name);
   fprintf(out_, "width=\"%f\" height=\"%f\" href=\"data:image/png;base64,\n", f*rgb->data_w(), f*rgb->data_h());
   // Transforms the image into a stream of bytes in PNG format,
   // base64-encode this byte stream, and outputs the result to the svg FILE.
@@ -507,8 +558,7 @@ void Fl_SVG_Graphics_Driver::define_rgb_png(Fl_RGB_Image *rgb, const char *name,
   user_flush_data(png_ptr);
   png_destroy_write_struct(&png_ptr, &info_ptr);
   delete[] row_pointers;
-  if (name) fputs("\"/></defs>\n", out_);
-  else fputs("\"/>\n", out_);
+  fputs("\"/></defs>\n", out_);
 }
 
 #endif // HAVE_LIBPNG
@@ -554,14 +604,9 @@ static void term_destination(jpeg_compress_struct *cinfo) {
   }
 }
 
-void Fl_SVG_Graphics_Driver::define_rgb_jpeg(Fl_RGB_Image *rgb, const char *name, int x, int y) {
-  if (name) {
-    if (last_rgb_name_) free(last_rgb_name_);
-    last_rgb_name_ = fl_strdup(name);
-  }
+void Fl_SVG_Graphics_Driver::define_rgb_jpeg(Fl_RGB_Image *rgb, const char *name) {
   float f = rgb->data_w() > rgb->data_h() ? float(rgb->w()) / rgb->data_w(): float(rgb->h()) / rgb->data_h();
-  if (name) fprintf(out_, "<defs><image id=\"%s\" ", name);
-  else fprintf(out_, "<image x=\"%d\" y=\"%d\" ", x, y);
+  fprintf(out_, "<defs><image id=\"%s\" ", name);
   fprintf(out_, "width=\"%f\" height=\"%f\" href=\"data:image/jpeg;base64,\n", f*rgb->data_w(), f*rgb->data_h());
   // Transforms the image into a stream of bytes in JPEG format,
   // base64-encode this byte stream, and outputs the result to the svg FILE.
@@ -594,98 +639,117 @@ void Fl_SVG_Graphics_Driver::define_rgb_jpeg(Fl_RGB_Image *rgb, const char *name
   }
   jpeg_finish_compress(&cinfo);
   jpeg_destroy_compress(&cinfo);
-  if (name) fputs("\"/></defs>\n", out_);
-  else fputs("\"/>\n", out_);
+  fputs("\"/></defs>\n", out_);
 }
 #endif // HAVE_LIBJPEG
 
-void Fl_SVG_Graphics_Driver::draw_rgb(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy) {
+// Identifies an image by its size, depth and a hash of its pixels,
+// so an image drawn several times is output only once in the SVG file.
+struct Fl_SVG_Graphics_Driver::defined_image {
+  int w, h, data_w, data_h, d;
+  unsigned hash1, hash2;
+  char id[12];
+};
+
+// Returns the SVG Id of an image with same content as rgb, and sets is_new
+// to true when rgb was not output before and should be defined with this Id.
+const char *Fl_SVG_Graphics_Driver::image_id_(Fl_RGB_Image *rgb, bool &is_new) {
+  int ld = rgb->ld() ? rgb->ld() : rgb->data_w() * rgb->d();
+  int lw = rgb->data_w() * rgb->d();
+  unsigned hash1 = 2166136261U, hash2 = 0; // FNV-1a and sdbm
+  for (int j = 0; j < rgb->data_h(); j++) {
+    const uchar *p = rgb->array + j * ld;
+    for (int i = 0; i < lw; i++) {
+      hash1 = (hash1 ^ p[i]) * 16777619U;
+      hash2 = p[i] + (hash2 << 6) + (hash2 << 16) - hash2;
+    }
+  }
+  for (int i = 0; i < image_count_; i++) {
+    defined_image *img = images_ + i;
+    if (img->hash1 == hash1 && img->hash2 == hash2 && img->w == rgb->w() && img->h == rgb->h() &&
+        img->data_w == rgb->data_w() && img->data_h == rgb->data_h() && img->d == rgb->d()) {
+      is_new = false;
+      return img->id;
+    }
+  }
+  if (image_count_ >= image_alloc_) {
+    image_alloc_ = image_alloc_ ? 2 * image_alloc_ : 16;
+    images_ = (defined_image*)realloc(images_, image_alloc_ * sizeof(defined_image));
+  }
+  defined_image *img = images_ + image_count_;
+  img->w = rgb->w(); img->h = rgb->h();
+  img->data_w = rgb->data_w(); img->data_h = rgb->data_h();
+  img->d = rgb->d();
+  img->hash1 = hash1; img->hash2 = hash2;
+  sprintf(img->id, "FLimg%d", image_count_++);
+  is_new = true;
+  return img->id;
+}
+
+// Outputs rgb in <defs> unless it was output before, and draws it with <use>.
+void Fl_SVG_Graphics_Driver::use_rgb_(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy, bool allow_jpeg) {
 #if defined(HAVE_LIBPNG)
-  char name[24];
-  bool need_clip = (cx || cy || WP != rgb->w() || HP != rgb->h());
-  void *p = (void*)*Fl_Graphics_Driver::id(rgb);
-  if (p) sprintf(name, "FLrgb%p", p); else name[0] = 0;
-  if (!p || !last_rgb_name_ || strcmp(name, last_rgb_name_) != 0) {
-    if (*name==0 && need_clip) push_clip(XP, YP, WP, HP);
+  flush_path_();
+  bool is_new;
+  const char *name = image_id_(rgb, is_new);
+  if (is_new) {
 #if defined(HAVE_LIBJPEG)
-    if (rgb->d() == 3 || rgb->d() == 1) define_rgb_jpeg(rgb, *name ? name : NULL, XP-cx, YP-cy);
+    if (allow_jpeg && (rgb->d() == 3 || rgb->d() == 1)) define_rgb_jpeg(rgb, name);
     else
 #endif // HAVE_LIBJPEG
-      define_rgb_png(rgb, *name ? name : NULL, XP-cx, YP-cy);
-    if (*name==0 && need_clip) pop_clip();
-  }
-  if (*name) {
-    if (need_clip) push_clip(XP, YP, WP, HP);
-    fprintf(out_, "<use href=\"#%s\" x=\"%d\" y=\"%d\"/>\n", last_rgb_name_, XP-cx, YP-cy);
-    if (need_clip) pop_clip();
+      define_rgb_png(rgb, name);
   }
+  bool need_clip = (cx || cy || WP != rgb->w() || HP != rgb->h());
+  if (need_clip) push_clip(XP, YP, WP, HP);
+  fprintf(out_, "<use href=\"#%s\" x=\"%d\" y=\"%d\"/>\n", name, XP-cx, YP-cy);
+  if (need_clip) pop_clip();
 #endif // HAVE_LIBPNG
 }
 
+void Fl_SVG_Graphics_Driver::draw_rgb(Fl_RGB_Image *rgb, int XP, int YP, int WP, int HP, int cx, int cy) {
+  use_rgb_(rgb, XP, YP, WP, HP, cx, cy, true);
+}
+
 void Fl_SVG_Graphics_Driver::draw_pixmap(Fl_Pixmap *pxm, int XP, int YP, int WP, int HP, int cx, int cy) {
 #if defined(HAVE_LIBPNG)
-  char name[24];
-  bool need_clip = (cx || cy || WP != pxm->w() || HP != pxm->h());
-  void *p = (void*)*Fl_Graphics_Driver::id(pxm);
-  if (p) sprintf(name, "FLpx%p", p); else name[0] = 0;
-  if (!p || !last_rgb_name_ || strcmp(name, last_rgb_name_) != 0) {
-    Fl_RGB_Image *rgb = new Fl_RGB_Image(pxm);
-    if (*name==0 && need_clip) push_clip(XP, YP, WP, HP);
-    define_rgb_png(rgb, *name ? name : NULL, XP-cx, YP-cy);
-    if (*name==0 && need_clip) pop_clip();
-    delete rgb;
-  }
-  if (*name) {
-    if (need_clip) push_clip(XP, YP, WP, HP);
-    fprintf(out_, "<use href=\"#%s\" x=\"%d\" y=\"%d\"/>\n", last_rgb_name_, XP-cx, YP-cy);
-    if (need_clip) pop_clip();
-  }
+  Fl_RGB_Image *rgb = new Fl_RGB_Image(pxm);
+  use_rgb_(rgb, XP, YP, WP, HP, cx, cy, false);
+  delete rgb;
 #endif // HAVE_LIBPNG
 }
 
 void Fl_SVG_Graphics_Driver::draw_bitmap(Fl_Bitmap *bm, int XP, int YP, int WP, int HP, int cx, int cy) {
 #if defined(HAVE_LIBPNG)
-  char name[45];
-  bool need_clip = (cx || cy || WP != bm->w() || HP != bm->h());
-  void *p = (void*)*Fl_Graphics_Driver::id(bm);
-  if (p) sprintf(name, "FLbm%p%X", p, fl_color()); else name[0] = 0;
-  if (!p || !last_rgb_name_ || strcmp(name, last_rgb_name_) != 0) {
-    uchar R, G, B;
-    Fl::get_color(fl_color(), R, G, B);
-    uchar *data = new uchar[bm->data_w() * bm->data_h() * 4];
-    memset(data, 0, bm->data_w() * bm->data_h() * 4);
-    Fl_RGB_Image *rgb = new Fl_RGB_Image(data, bm->data_w(), bm->data_h(), 4);
-    rgb->alloc_array = 1;
-    int rowBytes = (bm->data_w()+7)>>3 ;
-    for (int j = 0; j < bm->data_h(); j++) {
-      const uchar *p = bm->array + j*rowBytes;
-      for (int i = 0; i < rowBytes; i++) {
-        uchar q = *p;
-        int last = bm->data_w() - 8*i; if (last > 8) last = 8;
-        for (int k=0; k < last; k++) {
-          if (q&1) {
-            uchar *r = (uchar*)rgb->array + j*bm->data_w()*4 + i*8*4 + k*4;
-            *r++ = R; *r++ = G; *r++ = B; *r = ~0;
-          }
-          q >>= 1;
+  uchar R, G, B;
+  Fl::get_color(fl_color(), R, G, B);
+  uchar *data = new uchar[bm->data_w() * bm->data_h() * 4];
+  memset(data, 0, bm->data_w() * bm->data_h() * 4);
+  Fl_RGB_Image *rgb = new Fl_RGB_Image(data, bm->data_w(), bm->data_h(), 4);
+  rgb->alloc_array = 1;
+  rgb->scale(bm->w(), bm->h(), 0, 1);
+  int rowBytes = (bm->data_w()+7)>>3 ;
+  for (int j = 0; j < bm->data_h(); j++) {
+    const uchar *p = bm->array + j*rowBytes;
+    for (int i = 0; i < rowBytes; i++) {
+      uchar q = *p;
+      int last = bm->data_w() - 8*i; if (last > 8) last = 8;
+      for (int k=0; k < last; k++) {
+        if (q&1) {
+          uchar *r = (uchar*)rgb->array + j*bm->data_w()*4 + i*8*4 + k*4;
+          *r++ = R; *r++ = G; *r++ = B; *r = ~0;
         }
-        p++;
+        q >>= 1;
       }
+      p++;
     }
-    if (*name==0 && need_clip) push_clip(XP, YP, WP, HP);
-    define_rgb_png(rgb, *name ? name : NULL, XP-cx, YP-cy);
-    if (*name==0 && need_clip) pop_clip();
-    delete rgb;
-  }
-  if (*name) {
-    if (need_clip) push_clip(XP, YP, WP, HP);
-    fprintf(out_, "<use href=\"#%s\" x=\"%d\" y=\"%d\"/>\n", last_rgb_name_, XP-cx, YP-cy);
-    if (need_clip) pop_clip();
   }
+  use_rgb_(rgb, XP, YP, WP, HP, cx, cy, false);
+  delete rgb;
 #endif // HAVE_LIBPNG
 }
 
 void Fl_SVG_Graphics_Driver::draw_image(const uchar* buf, int x, int y, int w, int h, int d, int l) {
+  flush_path_();
   if (d < 0) {
     fprintf(out_, "<g transform=\"translate(%d,%d) scale(-1,1)\">\n", x, y);
     x = -w; y = 0; buf -= (w-1)*abs(d);
@@ -737,6 +801,7 @@ void Fl_SVG_Graphics_Driver::draw_image_mono(Fl_Draw_Image_Cb cb, void* data, in
 }
 
 void Fl_SVG_Graphics_Driver::push_clip(int x, int y, int w, int h) {
+  flush_path_();
   Clip * c=new Clip();
   clip_box(x,y,w,h,c->x,c->y,c->w,c->h);
   c->prev=clip_;
@@ -747,6 +812,7 @@ void Fl_SVG_Graphics_Driver::push_clip(int x, int y, int w, int h) {
 }
 
 void Fl_SVG_Graphics_Driver::push_no_clip() {
+  flush_path_();
   Clip * c=clip_;
   while (c) {
     fprintf(out_, "</g>");
@@ -760,6 +826,7 @@ void Fl_SVG_Graphics_Driver::push_no_clip() {
 }
 
 void Fl_SVG_Graphics_Driver::pop_clip() {
+  flush_path_();
   Clip *c;
   bool was_no_clip = clip_ && (strcmp(clip_->Id, "none") == 0);
   fprintf(out_, "</g>");
@@ -831,28 +898,27 @@ int Fl_SVG_Graphics_Driver::not_clipped(int x, int y, int w, int h) {
 }
 
 void Fl_SVG_Graphics_Driver::polygon(int x0, int y0, int x1, int y1, int x2, int y2) {
+  flush_path_();
   fprintf(out_, "<path d=\"M %d %d L %d %d L %d %d z\" fill=\"rgb(%u,%u,%u)\" />\n",
           x0, y0, x1, y1, x2, y2, red_, green_, blue_);
 }
 
 void Fl_SVG_Graphics_Driver::polygon(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3) {
+  flush_path_();
   fprintf(out_, "<path d=\"M %d %d L %d %d L %d %d L %d %d z\" fill=\"rgb(%u,%u,%u)\" />\n",
           x0, y0, x1, y1, x2, y2, x3, y3, red_, green_, blue_);
 }
 
 void Fl_SVG_Graphics_Driver::loop(int x0, int y0, int x1, int y1, int x2, int y2, int x3, int y3) {
-  fprintf(out_, "<path d=\"M %d %d L %d %d L %d %d L %d %d z\" fill=\"none\" stroke=\"rgb(%u,%u,%u)\" "
-          "stroke-width=\"%d\" stroke-linejoin=\"%s\" stroke-linecap=\"%s\" stroke-dasharray=\"%s\"/>\n",
-          x0, y0, x1, y1, x2, y2, x3, y3, red_, green_, blue_, width_, linejoin_, linecap_, dasharray_);
+  add_to_path_(STROKED_PATH, "M%d %dL%d %dL%d %dL%d %dz", x0, y0, x1, y1, x2, y2, x3, y3);
 }
 
 void Fl_SVG_Graphics_Driver::loop(int x0, int y0, int x1, int y1, int x2, int y2) {
-  fprintf(out_, "<path d=\"M %d %d L %d %d L %d %d z\" fill=\"none\" stroke=\"rgb(%u,%u,%u)\" "
-          "stroke-width=\"%d\" stroke-linejoin=\"%s\" stroke-linecap=\"%s\" stroke-dasharray=\"%s\"/>\n",
-          x0, y0, x1, y1, x2, y2, red_, green_, blue_, width_, linejoin_, linecap_, dasharray_);
+  add_to_path_(STROKED_PATH, "M%d %dL%d %dL%d %dz", x0, y0, x1, y1, x2, y2);
 }
 
 void Fl_SVG_Graphics_Driver::end_points() {
+  flush_path_();
   for (int i=0; i<n; i++) {
     fprintf(out_, "<path d=\"M %f %f L %f %f\" fill=\"none\" stroke=\"rgb(%u,%u,%u)\" stroke-width=\"%d\" />\n",
             xpoint[i].x, xpoint[i].y, xpoint[i].x, xpoint[i].y, red_, green_, blue_, width_);
@@ -860,6 +926,7 @@ void Fl_SVG_Graphics_Driver::end_points() {
 }
 
 void Fl_SVG_Graphics_Driver::end_line() {
+  flush_path_();
   if (n < 2) {
     end_points();
     return;
@@ -873,6 +940,7 @@ void Fl_SVG_Graphics_Driver::end_line() {
 }
 
 void Fl_SVG_Graphics_Driver::end_polygon() {
+  flush_path_();
   fixloop();
   if (n < 3) {
     end_line();
@@ -886,6 +954,7 @@ void Fl_SVG_Graphics_Driver::end_polygon() {
 }
 
 void Fl_SVG_Graphics_Driver::circle(double x, double y, double r) {
+  flush_path_();
   double xt = transform_x(x,y);
   double yt = transform_y(x,y);
   double rx = r * (m.c ? sqrt(m.a*m.a+m.c*m.c) : fabs(m.a));
@@ -903,6 +972,7 @@ void Fl_SVG_Graphics_Driver::circle(double x, double y, double r) {
 }
 
 void Fl_SVG_Graphics_Driver::end_complex_polygon() {
+  flush_path_();
   gap();
   if (n < 3) {
     end_line();
@@ -928,6 +998,7 @@ void Fl_SVG_Graphics_Driver::pie(int x, int y, int w, int h, double a1, double a
 }
 
 void Fl_SVG_Graphics_Driver::arc_pie(char AorP, int x, int y, int w, int h, double a1, double a2) {
+  flush_path_();
   // This implementation was constructed as follows:
   // - follow Fl_Quartz_Graphics_Driver::arc(int x,...).
   // which applies a translation, a scaling, and then calls
@@ -21,6 +21,7 @@
 #include <FL/platform.H>
 #include "../../flstring.h"
 #include "../../Fl_Timeout.h"
+#include "../../Fl_Frame_Scheduler.h"
 
 #include <locale.h>
 #include <time.h>
@@ -841,11 +842,11 @@ double Fl_Unix_System_Driver::wait(double time_to_wait)
   if (time_to_wait <= 0.0) {
     // do flush second so that the results of events are visible:
     int ret = this->poll_or_select_with_delay(0.0);
-    Fl::flush();
+    Fl_Frame_Scheduler::flush();
     return ret;
   } else {
     // do flush first so that user sees the display:
-    Fl::flush();
+    Fl_Frame_Scheduler::flush();
     if (Fl::idle) // 'idle' may have been set within flush()
       time_to_wait = 0.0;
     else {
@@ -20,6 +20,7 @@
 #include "Fl_Wayland_Screen_Driver.H"
 #include "Fl_Wayland_Window_Driver.H"
 #include "text-input-client-protocol.h"
+#include "../../fl_trace.h"
 #include <pango/pangocairo.h>
 #if ! PANGO_VERSION_CHECK(1,22,0)
 #  error "Requires Pango 1.22 or higher"
@@ -79,6 +80,7 @@ struct fl_wld_buffer *Fl_Wayland_Graphics_Driver::create_shm_buffer(int width, i
 
 
 void Fl_Wayland_Graphics_Driver::buffer_commit(struct wld_window *window) {
+  FL_TRACE_START(t);
   cairo_surface_t *surf = cairo_get_target(window->buffer->cairo_);
   cairo_surface_flush(surf);
   memcpy(window->buffer->data, window->buffer->draw_buffer, window->buffer->data_size);
@@ -86,6 +88,7 @@ void Fl_Wayland_Graphics_Driver::buffer_commit(struct wld_window *window) {
   wl_surface_set_buffer_scale(window->wl_surface, window->scale);
   wl_surface_commit(window->wl_surface);
   window->buffer->draw_buffer_needs_commit = false;
+  FL_TRACE(t, "buffer_commit", "commit", "bytes", (int)window->buffer->data_size);
 //fprintf(stderr,"buffer_commit %s\n", window->fl_win->parent()?"child":"top");
 }
 
@@ -113,6 +116,7 @@ void Fl_Wayland_Graphics_Driver::cairo_init(struct fl_wld_buffer *buffer, int wi
 void Fl_Wayland_Graphics_Driver::buffer_release(struct wld_window *window)
 {
   if (window->buffer) {
+    if (window->buffer->cb) wl_callback_destroy(window->buffer->cb);
     wl_buffer_destroy(window->buffer->wl_buffer);
     delete[] window->buffer->draw_buffer;
     window->buffer->draw_buffer = NULL;
@@ -314,7 +314,7 @@ void Fl_Wayland_Window_Driver::capture_titlebar_and_borders(Fl_RGB_Image*& top,
   top->scale(pWindow->w(), htop);
 }
 
-// used only to support progressive drawing
+// used to support progressive drawing and frame_pending()
 static void surface_frame_done(void *data, struct wl_callback *cb, uint32_t time);
 
 static const struct wl_callback_listener surface_frame_listener = {
@@ -422,11 +422,20 @@ void Fl_Wayland_Window_Driver::flush() {
   Fl_Window_Driver::flush();
   Fl_Wayland_Window_Driver::in_flush = false;
 
-  wl_surface_frame(window->wl_surface);
+  if (!window->buffer->cb) { // frame_pending() until the compositor shows the frame
+    window->buffer->cb = wl_surface_frame(window->wl_surface);
+    wl_callback_add_listener(window->buffer->cb, &surface_frame_listener, window);
+  }
   Fl_Wayland_Graphics_Driver::buffer_commit(window);
 }
 
 
+int Fl_Wayland_Window_Driver::frame_pending() {
+  struct wld_window *window = fl_xid(pWindow);
+  return window && window->buffer && window->buffer->cb;
+}
+
+
 void Fl_Wayland_Window_Driver::show() {
   if (!shown()) {
     fl_open_display();
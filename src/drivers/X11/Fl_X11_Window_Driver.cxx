@@ -21,6 +21,7 @@
 #include "../Xlib/Fl_Xlib_Graphics_Driver.H"
 
 #include "../../Fl_Screen_Driver.H"
+#include "../../fl_trace.h"
 #include <FL/Fl_Overlay_Window.H>
 #include <FL/Fl_Menu_Window.H>
 #include <FL/Fl_Tooltip.H>
@@ -166,7 +167,11 @@ void Fl_X11_Window_Driver::flush_double(int erase_overlay)
   if (erase_overlay) fl_clip_region(0);
   int X = 0, Y = 0, W = 0, H = 0;
   fl_clip_box(0, 0, w(), h(), X, Y, W, H);
-  if (other_xid) fl_copy_offscreen(X, Y, W, H, other_xid, X, Y);
+  if (other_xid) {
+    FL_TRACE_START(t);
+    fl_copy_offscreen(X, Y, W, H, other_xid, X, Y);
+    FL_TRACE(t, "fl_copy_offscreen", "commit", "pixels", W * H);
+  }
 }
 
 
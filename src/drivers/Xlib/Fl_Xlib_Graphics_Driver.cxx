@@ -24,6 +24,10 @@
 #include <string.h>
 #include <stdlib.h>
 
+#if USE_PANGO
+#  include "../Cairo/Fl_Pango_Layout_Cache.H"
+#endif
+
 #if !USE_XFT
 extern char *fl_get_font_xfld(int fnum, int size);
 #endif
@@ -119,6 +123,7 @@ void Fl_Xlib_Graphics_Driver::font_name(int num, const char *name) {
   if (pfd_array_length > num && pfd_array[num]) {
     pango_font_description_free(pfd_array[num]);
     pfd_array[num] = NULL;
+    if (layout_cache_) layout_cache_->clear(); // cached layouts are keyed by font description
   }
 #  endif
   Fl_Fontdesc *s = fl_fonts + num;
@@ -1094,6 +1094,7 @@ XFontStruct* Fl_XFont_On_Demand::value() {
 
 #include <pango/pangoxft.h>
 #include <pango/pango.h>
+#include "../Cairo/Fl_Pango_Layout_Cache.H"
 #if ! PANGO_VERSION_CHECK(1,8,0)
 #error "Requires Pango 1.8 or higher"
 #endif
@@ -1101,6 +1102,7 @@ XFontStruct* Fl_XFont_On_Demand::value() {
 PangoFontMap *Fl_Xlib_Graphics_Driver::pfmap_ = 0;
 PangoContext *Fl_Xlib_Graphics_Driver::pctxt_ = 0;
 PangoLayout *Fl_Xlib_Graphics_Driver::playout_ = 0;
+Fl_Pango_Layout_Cache *Fl_Xlib_Graphics_Driver::layout_cache_ = 0;
 
 PangoContext *Fl_Xlib_Graphics_Driver::context() {
   if (fl_display && !pctxt_) {
@@ -1111,11 +1113,18 @@ PangoContext *Fl_Xlib_Graphics_Driver::context() {
     pctxt_ = pango_xft_get_context(fl_display, fl_screen); // deprecated since 1.22
 #endif
     playout_ = pango_layout_new(pctxt_);
+    layout_cache_ = new Fl_Pango_Layout_Cache();
   }
   return pctxt_;
 }
 
 
+// Returns a layout of str in the current font, shaped only once for repeated strings
+PangoLayout *Fl_Xlib_Graphics_Driver::cached_layout_(const char *str, int n) {
+  return layout_cache_->layout(pctxt_, pfd_array[font_], size_unscaled(), str, n);
+}
+
+
 void Fl_Xlib_Graphics_Driver::font_unscaled(Fl_Font fnum, Fl_Fontsize size) {
   if (!size) return;
   if (size < 0) {
@@ -1167,6 +1176,7 @@ void Fl_Xlib_Graphics_Driver::draw_unscaled(int angle, const char *str, int n, i
   double l = width_unscaled(str, n);
   pango_matrix_rotate(&mat, angle); // 1.6
   pango_context_set_matrix(pctxt_, &mat); // 1.6
+  pango_layout_set_font_description(playout_, pfd_array[font_]);
   pango_layout_set_text(playout_, str, n);
   int w, h;
   pango_layout_get_pixel_size(playout_, &w, &h);
@@ -1208,7 +1218,6 @@ void Fl_Xlib_Graphics_Driver::do_draw(int from_right, const char *str, int n, in
     if (--n == 0) return;
     tmpv = NULL;
   }
-  pango_layout_set_font_description(playout_, pfd_array[font_]);
   if (tmpv) { // replace newlines by spaces in a copy of str
     str2 = (char*)malloc(n);
     memcpy(str2, str, n);
@@ -1220,10 +1229,14 @@ void Fl_Xlib_Graphics_Driver::do_draw(int from_right, const char *str, int n, in
     while (tmpv);
     str = str2;
   }
-  const char *old = 0;
-  if (!str2) old = pango_layout_get_text(playout_);
-  if (!old || (int)strlen(old) != n || memcmp(str, old, n)) // do not re-set text if equal to text already in layout
-        pango_layout_set_text(playout_, str, n);
+  PangoLayout *layout;
+  if (pango_context_get_matrix(pctxt_)) { // rotated text is not cached
+    layout = playout_;
+    pango_layout_set_font_description(layout, pfd_array[font_]);
+    pango_layout_set_text(layout, str, n);
+  } else {
+    layout = cached_layout_(str, n);
+  }
   if (str2) free(str2);
 
   XftColor color;
@@ -1241,11 +1254,11 @@ void Fl_Xlib_Graphics_Driver::do_draw(int from_right, const char *str, int n, in
   XftDrawSetClip(draw_, region);
 
   int  dx, dy, w, h, y_correction, desc = descent_unscaled(), lheight = height_unscaled();
-  fl_pango_layout_get_pixel_extents(playout_, dx, dy, w, h, desc, lheight, y_correction);
+  fl_pango_layout_get_pixel_extents(layout, dx, dy, w, h, desc, lheight, y_correction);
   if (from_right) {
     x -= w;
   }
-  pango_xft_render_layout(draw_, &color, playout_, x * PANGO_SCALE,
+  pango_xft_render_layout(draw_, &color, layout, x * PANGO_SCALE,
                           (y - y_correction  - lheight + desc) * PANGO_SCALE ); // 1.8
   }
 
@@ -1292,18 +1305,14 @@ double Fl_Xlib_Graphics_Driver::do_width_unscaled_(const char* str, int n) {
   if (!fl_display || size_ == 0) return -1;
   if (!playout_) context();
   int width, height;
-  pango_layout_set_font_description(playout_, pfd_array[font_]);
-  pango_layout_set_text(playout_, str, n);
-  pango_layout_get_pixel_size(playout_, &width, &height);
+  pango_layout_get_pixel_size(cached_layout_(str, n), &width, &height);
   return (double)width;
 }
 
 void Fl_Xlib_Graphics_Driver::text_extents_unscaled(const char *str, int n, int &dx, int &dy, int &w, int &h) {
   if (!playout_) context();
-  pango_layout_set_font_description(playout_, pfd_array[font_]);
-  pango_layout_set_text(playout_, str, n);
   int y_correction;
-  fl_pango_layout_get_pixel_extents(playout_, dx, dy, w, h, descent_unscaled(), height_unscaled(), y_correction);
+  fl_pango_layout_get_pixel_extents(cached_layout_(str, n), dx, dy, w, h, descent_unscaled(), height_unscaled(), y_correction);
   dy -= y_correction;
   correct_extents(scale(), dx, dy, w, h);
 }
@@ -822,7 +822,7 @@ int Fl_Xlib_Graphics_Driver::scale_and_render_pixmap(Fl_Offscreen pixmap, int de
       { XDoubleToFixed( 0 ),       XDoubleToFixed( 0 ),       XDoubleToFixed( 1 ) }
     }};
     XRenderSetPictureTransform(fl_display, src, &mat);
-    if (Fl_Image::scaling_algorithm() == FL_RGB_SCALING_BILINEAR) {
+    if (Fl_Image::scaling_algorithm() != FL_RGB_SCALING_NEAREST) { // XRender has no area averaging filter
       XRenderSetPictureFilter(fl_display, src, FilterBilinear, 0, 0);
       // A note at  https://www.talisman.org/~erlkonig/misc/x11-composite-tutorial/ :
       // "When you use a filter you'll probably want to use PictOpOver as the render op,
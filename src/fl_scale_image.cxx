@@ -0,0 +1,380 @@
+//
+// RGB image scaling for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+/* Both algorithms scale the image one line of destination pixels at a time,
+ so that the image can be cut in bands of lines scaled by separate threads.
+
+ Bilinear scaling interpolates each line of source pixels it needs at the
+ destination columns, in 16-bit fixed point, and blends the two lines above
+ and below each destination pixel. Lines are reused while enlarging.
+
+ Area averaging sums, with their coverage as weight, all source pixels under
+ each destination pixel. It is meant for reducing images: every source pixel
+ counts, so fine details do not alias as they do with bilinear scaling.
+
+ Colors are weighted by alpha, if any, before they are mixed.
+ */
+
+#include <config.h>
+#include "fl_scale_image.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define FL_SCALE_SSE2 1
+#  include <emmintrin.h>
+#endif
+
+#ifdef _WIN32
+#  include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#  include <pthread.h>
+#  include <unistd.h> // sysconf()
+#endif
+
+
+// A band of destination lines to scale
+struct Fl_Scale_Band {
+  const uchar *src;
+  int sw, sh, d, ld;
+  uchar *dst;
+  int dw, dh;
+  Fl_RGB_Scaling method;
+  int y0, y1;
+};
+
+
+// Returns the index of the alpha channel of images of depth d, or -1
+static inline int alpha_channel(int d) {
+  return (d == 2 || d == 4) ? d - 1 : -1;
+}
+
+
+// ---- bilinear scaling ----
+
+// Interpolates the source line at the destination columns. The results are
+// the channel values times 128, premultiplied by alpha. The depth D and the
+// index A of the alpha channel are constants, so that the loops unroll.
+template <int D, int A>
+static void bilinear_line_(const uchar *line, const int *left, const int *right,
+                           const int *fract, int dw, short *out) {
+  for (int x = 0; x < dw; x++, out += D) {
+    const uchar *p = line + left[x], *q = line + right[x];
+    int f = fract[x], g = 256 - f;
+    int pa = (A < 0) ? 255 : p[A], qa = (A < 0) ? 255 : q[A];
+    for (int c = 0; c < D; c++) {
+      int pc = p[c], qc = q[c];
+      if (A >= 0 && c != A) {
+        pc = (pc * pa + 127) / 255;
+        qc = (qc * qa + 127) / 255;
+      }
+      out[c] = (short)((pc * g + qc * f) >> 1);
+    }
+  }
+}
+
+static void bilinear_line(const uchar *line, const int *left, const int *right,
+                          const int *fract, int dw, int d, short *out) {
+  switch (d) {
+    case 1: bilinear_line_<1, -1>(line, left, right, fract, dw, out); break;
+    case 2: bilinear_line_<2, 1>(line, left, right, fract, dw, out); break;
+    case 3: bilinear_line_<3, -1>(line, left, right, fract, dw, out); break;
+    default: bilinear_line_<4, 3>(line, left, right, fract, dw, out); break;
+  }
+}
+
+// Blends n channel values of two interpolated lines with weight fy/256
+// of the bottom line
+static void bilinear_blend(const short *top, const short *bottom, int fy, int n, uchar *out) {
+  int i = 0;
+  int w = fy << 7; // fy < 256, so that w fits in a short
+#ifdef FL_SCALE_SSE2
+  __m128i vw = _mm_set1_epi16((short)w), half = _mm_set1_epi16(64);
+  for (; i + 8 <= n; i += 8) {
+    __m128i t = _mm_loadu_si128((const __m128i*)(top + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(bottom + i));
+    __m128i v = _mm_add_epi16(t, _mm_slli_epi16(_mm_mulhi_epi16(_mm_sub_epi16(b, t), vw), 1));
+    v = _mm_srli_epi16(_mm_add_epi16(v, half), 7);
+    _mm_storel_epi64((__m128i*)(out + i), _mm_packus_epi16(v, v));
+  }
+#endif
+  for (; i < n; i++) { // same arithmetic as above
+    int diff = bottom[i] - top[i];
+    int v = top[i] + 2 * ((diff * w) >> 16);
+    out[i] = (uchar)((v + 64) >> 7);
+  }
+}
+
+// Removes the alpha weighting of a line of n pixels of depth d
+static void unpremultiply(uchar *p, int n, int d) {
+  int alpha = alpha_channel(d);
+  if (alpha < 0) return;
+  for (int x = 0; x < n; x++, p += d) {
+    int a = p[alpha];
+    if (!a || a == 255) continue;
+    for (int c = 0; c < alpha; c++) {
+      int v = (p[c] * 255 + a / 2) / a;
+      p[c] = (uchar)(v > 255 ? 255 : v);
+    }
+  }
+}
+
+static void bilinear_band(const Fl_Scale_Band &b) {
+  const int d = b.d, n = b.dw * d;
+  // Same mapping of destination to source coordinates as FLTK 1.3
+  const float xscale = (b.sw - 1) / (float)b.dw;
+  const float yscale = (b.sh - 1) / (float)b.dh;
+  int *left = new int[3 * b.dw], *right = left + b.dw, *fract = right + b.dw;
+  for (int x = 0; x < b.dw; x++) {
+    float oldx = x * xscale;
+    if (oldx >= b.sw) oldx = float(b.sw - 1);
+    int l = (int)oldx;
+    left[x] = l * d;
+    right[x] = (l + 1 >= b.sw ? l : l + 1) * d;
+    fract[x] = (int)((oldx - l) * 256);
+  }
+  short *lines = new short[2 * n], *top = lines, *bottom = lines + n;
+  int top_y = -1, bottom_y = -1; // the source lines in top and bottom
+  for (int y = b.y0; y < b.y1; y++) {
+    float oldy = y * yscale;
+    if (oldy >= b.sh) oldy = float(b.sh - 1);
+    int y1 = (int)oldy, y2 = (y1 + 1 >= b.sh ? y1 : y1 + 1);
+    if (top_y != y1) {
+      if (bottom_y == y1) { // move down one line
+        short *t = top; top = bottom; bottom = t;
+        bottom_y = -1;
+      } else {
+        bilinear_line(b.src + (size_t)y1 * b.ld, left, right, fract, b.dw, d, top);
+      }
+      top_y = y1;
+    }
+    if (bottom_y != y2) {
+      bilinear_line(b.src + (size_t)y2 * b.ld, left, right, fract, b.dw, d, bottom);
+      bottom_y = y2;
+    }
+    uchar *out = b.dst + (size_t)y * n;
+    bilinear_blend(top, bottom, (int)((oldy - y1) * 256), n, out);
+    unpremultiply(out, b.dw, d);
+  }
+  delete[] lines;
+  delete[] left;
+}
+
+
+// ---- area averaging ----
+
+// The source pixels under a destination pixel, along one axis
+struct Fl_Scale_Span {
+  int first;        // the first source pixel
+  int count;        // the number of source pixels
+  float first_w;    // coverage of the first pixel
+  float last_w;     // coverage of the last pixel if count > 1
+};
+
+// Computes the spans of the n destination pixels over the sn source pixels,
+// with coverages that add up to 1 in each span
+static void area_spans(int sn, int n, Fl_Scale_Span *spans, float &middle_w) {
+  middle_w = n / (float)sn;
+  for (int i = 0; i < n; i++) {
+    // destination pixel i is [i * sn, (i + 1) * sn), source pixel j is [j * n, (j + 1) * n)
+    long long start = (long long)i * sn, end = start + sn;
+    int first = (int)(start / n), last = (int)((end - 1) / n);
+    long long first_end = (long long)(first + 1) * n;
+    spans[i].first = first;
+    spans[i].count = last - first + 1;
+    spans[i].first_w = float((first_end < end ? first_end : end) - start) / sn;
+    spans[i].last_w = float(end - (long long)last * n) / sn;
+  }
+}
+
+// Averages the source line under each destination column. The results
+// are premultiplied by alpha.
+template <int D, int A>
+static void area_line_(const uchar *line, const Fl_Scale_Span *spans, float middle_w,
+                       int dw, float *out) {
+  for (int x = 0; x < dw; x++, out += D) {
+    const Fl_Scale_Span &s = spans[x];
+    const uchar *p = line + s.first * D;
+    int c;
+    if (A < 0) {
+      unsigned middle[D];
+      for (c = 0; c < D; c++) middle[c] = 0;
+      for (int i = 1; i < s.count - 1; i++)
+        for (c = 0; c < D; c++) middle[c] += p[i * D + c];
+      const uchar *q = p + (s.count - 1) * D;
+      for (c = 0; c < D; c++) {
+        float v = p[c] * s.first_w;
+        if (s.count > 1) v += middle[c] * middle_w + q[c] * s.last_w;
+        out[c] = v;
+      }
+    } else {
+      float sum[D];
+      for (c = 0; c < D; c++) sum[c] = 0;
+      for (int i = 0; i < s.count; i++, p += D) {
+        float w = (i == 0) ? s.first_w : (i == s.count - 1 ? s.last_w : middle_w);
+        float wa = w * p[A];
+        for (c = 0; c < D; c++) sum[c] += (c == A) ? wa : wa * p[c];
+      }
+      for (c = 0; c < D; c++) out[c] = (c == A) ? sum[c] : sum[c] / 255;
+    }
+  }
+}
+
+static void area_line(const uchar *line, const Fl_Scale_Span *spans, float middle_w,
+                      int dw, int d, float *out) {
+  switch (d) {
+    case 1: area_line_<1, -1>(line, spans, middle_w, dw, out); break;
+    case 2: area_line_<2, 1>(line, spans, middle_w, dw, out); break;
+    case 3: area_line_<3, -1>(line, spans, middle_w, dw, out); break;
+    default: area_line_<4, 3>(line, spans, middle_w, dw, out); break;
+  }
+}
+
+// Adds w times the n values of line to sum
+static void area_accumulate(float *sum, const float *line, float w, int n) {
+  int i = 0;
+#ifdef FL_SCALE_SSE2
+  __m128 vw = _mm_set1_ps(w);
+  for (; i + 4 <= n; i += 4)
+    _mm_storeu_ps(sum + i, _mm_add_ps(_mm_loadu_ps(sum + i), _mm_mul_ps(_mm_loadu_ps(line + i), vw)));
+#endif
+  for (; i < n; i++) sum[i] += line[i] * w;
+}
+
+static void area_band(const Fl_Scale_Band &b) {
+  const int d = b.d, n = b.dw * d;
+  Fl_Scale_Span *xspans = new Fl_Scale_Span[b.dw + b.dh], *yspans = xspans + b.dw;
+  float x_middle_w, y_middle_w;
+  area_spans(b.sw, b.dw, xspans, x_middle_w);
+  area_spans(b.sh, b.dh, yspans, y_middle_w);
+  int alpha = alpha_channel(d);
+  float *line = new float[2 * n], *sum = line + n;
+  for (int y = b.y0; y < b.y1; y++) {
+    const Fl_Scale_Span &s = yspans[y];
+    memset(sum, 0, n * sizeof(float));
+    for (int i = 0; i < s.count; i++) {
+      float w = (i == 0) ? s.first_w : (i == s.count - 1 ? s.last_w : y_middle_w);
+      area_line(b.src + (size_t)(s.first + i) * b.ld, xspans, x_middle_w, b.dw, d, line);
+      area_accumulate(sum, line, w, n);
+    }
+    uchar *out = b.dst + (size_t)y * n;
+    for (int i = 0; i < n; i += d) {
+      float a = (alpha < 0) ? 0 : sum[i + alpha];
+      for (int c = 0; c < d; c++) {
+        float v = sum[i + c];
+        if (alpha >= 0 && c != alpha) v = (a > 0 ? v * 255 / a : 0);
+        out[i + c] = (uchar)(v >= 254.5f ? 255 : v + 0.5f);
+      }
+    }
+  }
+  delete[] line;
+  delete[] xspans;
+}
+
+
+// ---- bands and threads ----
+
+static void scale_band(const Fl_Scale_Band &b) {
+  if (b.method == FL_RGB_SCALING_AREA) area_band(b);
+  else bilinear_band(b);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI scale_band_thread(LPVOID data) {
+  scale_band(*(Fl_Scale_Band*)data);
+  return 0;
+}
+#elif defined(HAVE_PTHREAD)
+extern "C" {
+  static void *scale_band_thread(void *data) {
+    scale_band(*(Fl_Scale_Band*)data);
+    return NULL;
+  }
+}
+#endif
+
+// Returns the number of threads to use when Fl_Image::RGB_scaling_threads() is 0
+static int processor_count() {
+  static int count = 0;
+  if (!count) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    count = (int)info.dwNumberOfProcessors;
+#elif defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+    count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (count < 1) count = 1;
+  }
+  return count;
+}
+
+void fl_scale_image(const uchar *src, int sw, int sh, int d, int ld,
+                    uchar *dst, int dw, int dh, Fl_RGB_Scaling method) {
+  // Area averaging of an enlarged image would repeat its pixels
+  if (method == FL_RGB_SCALING_AREA && dw >= sw && dh >= sh) method = FL_RGB_SCALING_BILINEAR;
+  // Use a thread for at least this many pixels read or written
+  const double min_pixels = 256 * 1024;
+  double pixels = (method == FL_RGB_SCALING_AREA ? (double)sw * sh : 0) + (double)dw * dh;
+  int bands = Fl_Image::RGB_scaling_threads();
+  if (bands <= 0) bands = processor_count();
+  if (bands > pixels / min_pixels) bands = (int)(pixels / min_pixels);
+  if (bands > dh) bands = dh;
+#if !defined(_WIN32) && !defined(HAVE_PTHREAD)
+  bands = 1;
+#endif
+  if (bands < 1) bands = 1;
+  Fl_Scale_Band *band = new Fl_Scale_Band[bands];
+  for (int i = 0; i < bands; i++) {
+    Fl_Scale_Band &b = band[i];
+    b.src = src; b.sw = sw; b.sh = sh; b.d = d; b.ld = ld;
+    b.dst = dst; b.dw = dw; b.dh = dh;
+    b.method = method;
+    b.y0 = (int)((long long)dh * i / bands);
+    b.y1 = (int)((long long)dh * (i + 1) / bands);
+  }
+  // This thread scales the last band while the other threads scale the others
+#ifdef _WIN32
+  HANDLE *threads = new HANDLE[bands];
+  for (int i = 0; i < bands - 1; i++) {
+    threads[i] = CreateThread(NULL, 0, scale_band_thread, band + i, 0, NULL);
+    if (!threads[i]) scale_band(band[i]);
+  }
+  scale_band(band[bands - 1]);
+  for (int i = 0; i < bands - 1; i++) {
+    if (!threads[i]) continue;
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+  }
+  delete[] threads;
+#elif defined(HAVE_PTHREAD)
+  pthread_t *threads = new pthread_t[bands];
+  char *started = new char[bands];
+  for (int i = 0; i < bands - 1; i++) {
+    started[i] = (pthread_create(threads + i, NULL, scale_band_thread, band + i) == 0);
+    if (!started[i]) scale_band(band[i]);
+  }
+  scale_band(band[bands - 1]);
+  for (int i = 0; i < bands - 1; i++) {
+    if (started[i]) pthread_join(threads[i], NULL);
+  }
+  delete[] started;
+  delete[] threads;
+#else
+  scale_band(band[0]);
+#endif
+  delete[] band;
+}
@@ -0,0 +1,29 @@
+//
+// Internal RGB image scaling for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#ifndef _src_fl_scale_image_h_
+#define _src_fl_scale_image_h_
+
+#include <FL/Fl_Image.H>
+
+// Scales the sw x sh pixels of depth d at src, whose lines are ld bytes
+// apart, to the dw x dh pixels at dst, whose lines are not padded.
+// Only FL_RGB_SCALING_BILINEAR and FL_RGB_SCALING_AREA are done here.
+// Large images are split in bands of rows scaled by several threads.
+void fl_scale_image(const uchar *src, int sw, int sh, int d, int ld,
+                    uchar *dst, int dw, int dh, Fl_RGB_Scaling method);
+
+#endif // _src_fl_scale_image_h_
@@ -0,0 +1,53 @@
+//
+// Internal tracing macros for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#ifndef _src_fl_trace_h_
+#define _src_fl_trace_h_
+
+#include <config.h>
+#include <FL/Fl_Trace.H>
+
+// Usage, see class Fl_Trace:
+//
+//   FL_TRACE_START(t);
+//   ... the traced phase ...
+//   FL_TRACE(t, "name", "category", "arg name", arg);
+//   FL_TRACE_TYPE(t, *widget, "category", "arg name", arg);
+//
+// FL_TRACE_TYPE() uses the class name of an object as the name of the
+// phase. The arguments are evaluated only while tracing is started.
+// Without FLTK_USE_TRACING all macros expand to nothing.
+
+#if FLTK_USE_TRACING
+
+#  include <typeinfo>
+
+#  define FL_TRACE_START(t) \
+     double t = Fl_Trace::recording() ? Fl_Trace::now() : 0.0
+#  define FL_TRACE(t, name, category, arg_name, arg) \
+     do { if (t) Fl_Trace::record(name, category, t, arg_name, arg); } while (0)
+#  define FL_TRACE_TYPE(t, object, category, arg_name, arg) \
+     do { if (t) Fl_Trace::record_type(typeid(object).name(), category, t, arg_name, arg); } while (0)
+
+#else
+
+#  define FL_TRACE_START(t)
+#  define FL_TRACE(t, name, category, arg_name, arg) do { } while (0)
+#  define FL_TRACE_TYPE(t, object, category, arg_name, arg) do { } while (0)
+
+#endif // FLTK_USE_TRACING
+
+#endif // _src_fl_trace_h_
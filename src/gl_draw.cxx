@@ -311,15 +311,38 @@ int gl_texture_fifo::already_known(const char *str, int n)
 
 static gl_texture_fifo *gl_fifo = NULL; // points to the texture pile class instance
 
+static void gl_glyph_atlas_reset(); // defined below with class gl_texture_atlas
+
 void gl_texture_reset()
 {
   if (gl_fifo) gl_texture_pile_height(gl_texture_pile_height());
+  gl_glyph_atlas_reset();
 }
 
 
 // Cross-platform implementation of the texture mechanism for text rendering
 // using textures with the alpha channel only.
 
+// moves the raster position to window coordinates pos, as obtained from
+// GL_CURRENT_RASTER_POSITION and corrected for gl_start_scale
+static void set_raster_pos(GLfloat pos[4])
+{
+  GLdouble modelmat[16];
+  glGetDoublev (GL_MODELVIEW_MATRIX, modelmat);
+  GLdouble projmat[16];
+  glGetDoublev (GL_PROJECTION_MATRIX, projmat);
+  GLdouble objX, objY, objZ;
+  GLint viewport[4];
+  glGetIntegerv (GL_VIEWPORT, viewport);
+  gluUnProject(pos[0], pos[1], pos[2], modelmat, projmat, viewport, &objX, &objY, &objZ);
+
+  if (gl_start_scale != 1) { // using gl_start() / gl_finish()
+    objX *= gl_start_scale;
+    objY *= gl_start_scale;
+  }
+  glRasterPos2d(objX, objY);
+}
+
 // displays a pre-computed texture on the GL scene
 void gl_texture_fifo::display_texture(int rank)
 {
@@ -378,20 +401,7 @@ void gl_texture_fifo::display_texture(int rank)
 
   //set the raster position to end of string
   pos[0] += width;
-  GLdouble modelmat[16];
-  glGetDoublev (GL_MODELVIEW_MATRIX, modelmat);
-  GLdouble projmat[16];
-  glGetDoublev (GL_PROJECTION_MATRIX, projmat);
-  GLdouble objX, objY, objZ;
-  GLint viewport[4];
-  glGetIntegerv (GL_VIEWPORT, viewport);
-  gluUnProject(pos[0], pos[1], pos[2], modelmat, projmat, viewport, &objX, &objY, &objZ);
-
-  if (gl_start_scale != 1) { // using gl_start() / gl_finish()
-    objX *= gl_start_scale;
-    objY *= gl_start_scale;
-  }
-  glRasterPos2d(objX, objY);
+  set_raster_pos(pos);
 } // display_texture
 
 
@@ -444,6 +454,301 @@ int gl_texture_fifo::compute_texture(const char* str, int n)
   return current;
 }
 
+
+/* Implement the glyph atlas mechanism, an alternative to gl_texture_fifo
+ turned on by gl_glyph_atlas(1):
+ Each glyph is rasterized once, with the same alpha_mask_for_string() used
+ for whole strings, and stored in a large texture shared by all glyphs of a
+ given font and GL scale. Strings are then drawn as a single batch of
+ textured quads, one per glyph, so the cost of drawing a string does not
+ depend on whether that exact string was drawn before. Glyphs are placed
+ one after the other without kerning.
+ Atlases are kept in a most-recently-used list of at most max_atlases elements.
+ An atlas that becomes full is emptied and refilled with the glyphs in use.
+*/
+class gl_texture_atlas {
+private:
+  typedef struct { // position of a glyph in the atlas texture
+    short x, y; // top-left corner in the texture
+    short w, h; // size in the texture, w == 0 means not rasterized yet
+    float advance; // horizontal advance in GL pixels
+  } glyph;
+  typedef struct { // a textured quad vertex
+    GLfloat s, t, x, y;
+  } vertex;
+  enum {
+    tex_size = 1024, // width and height of each atlas texture
+    page_bits = 10, // glyphs are stored in pages of 1024 consecutive code points
+    page_count = 0x110000 >> page_bits,
+    max_atlases = 8
+  };
+  GLuint texName;
+  Fl_Font_Descriptor *fdesc; // font of all glyphs of this atlas
+  float scale; // GL scale of all glyphs of this atlas
+  int glyph_h; // height of all glyphs in GL pixels
+  glyph **pages; // page_count lazily allocated glyph pages
+  int shelf_x, shelf_y, shelf_h; // next free position in the atlas
+  gl_texture_atlas *next;
+  static gl_texture_atlas *first; // most recently used atlas
+  static vertex *vertices; // quad buffer shared by all atlases
+  static int vertices_size;
+  gl_texture_atlas(Fl_Font_Descriptor *fd, float s);
+  void clear();
+  glyph *find(unsigned ucs, const char *str, int len, bool *full);
+  int layout(const char *str, int n, float *width);
+public:
+  ~gl_texture_atlas();
+  static gl_texture_atlas *get(Fl_Font_Descriptor *fd, float s);
+  static void reset();
+  int draw(const char *str, int n);
+};
+
+gl_texture_atlas *gl_texture_atlas::first = NULL;
+gl_texture_atlas::vertex *gl_texture_atlas::vertices = NULL;
+int gl_texture_atlas::vertices_size = 0;
+
+gl_texture_atlas::gl_texture_atlas(Fl_Font_Descriptor *fd, float s)
+{
+  fdesc = fd;
+  scale = s;
+  next = NULL;
+  pages = (glyph**)calloc(page_count, sizeof(glyph*));
+  shelf_x = shelf_y = shelf_h = 0;
+  // measure the glyph height at the font size used in the GL scene
+  Fl_Fontsize fs = fl_size();
+  float gs = fl_graphics_driver->scale();
+  fl_graphics_driver->Fl_Graphics_Driver::scale(1);
+  fl_font(fl_font(), int(fs * scale));
+  glyph_h = fl_height();
+  fl_graphics_driver->Fl_Graphics_Driver::scale(gs);
+  fl_font(fl_font(), fs);
+  // create the atlas texture, fully transparent
+  GLint row_length, alignment;
+  glGetIntegerv(GL_UNPACK_ROW_LENGTH, &row_length);
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  uchar *zero = (uchar*)calloc(tex_size, tex_size);
+  glGenTextures(1, &texName);
+  glPushAttrib(GL_TEXTURE_BIT);
+  glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texName);
+  glTexParameteri(GL_TEXTURE_RECTANGLE_ARB, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, GL_ALPHA8, tex_size, tex_size, 0, GL_ALPHA, GL_UNSIGNED_BYTE, zero);
+  glPopAttrib();
+  free(zero);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
+
+gl_texture_atlas::~gl_texture_atlas()
+{
+  for (int i = 0; i < page_count; i++) if (pages[i]) free(pages[i]);
+  free(pages);
+  glDeleteTextures(1, &texName);
+}
+
+// forgets all glyphs of the atlas. Glyph areas of the texture are
+// re-written before being used again, so the texture need not be cleared.
+void gl_texture_atlas::clear()
+{
+  for (int i = 0; i < page_count; i++) {
+    if (pages[i]) { free(pages[i]); pages[i] = NULL; }
+  }
+  shelf_x = shelf_y = shelf_h = 0;
+}
+
+// returns the atlas for a font and GL scale, creating it if necessary,
+// and makes it the most recently used one
+gl_texture_atlas *gl_texture_atlas::get(Fl_Font_Descriptor *fd, float s)
+{
+  gl_texture_atlas *prev = NULL, *atlas = first;
+  int count = 0;
+  while (atlas) {
+    count++;
+    if (atlas->fdesc == fd && atlas->scale == s) break;
+    if (!atlas->next && count >= max_atlases) { // drop the least recently used atlas
+      if (prev) prev->next = NULL; else first = NULL;
+      delete atlas;
+      atlas = NULL;
+      break;
+    }
+    prev = atlas;
+    atlas = atlas->next;
+  }
+  if (!atlas) {
+    atlas = new gl_texture_atlas(fd, s);
+    prev = NULL;
+  }
+  if (atlas != first) {
+    if (prev) prev->next = atlas->next;
+    atlas->next = first;
+    first = atlas;
+  }
+  return atlas;
+}
+
+void gl_texture_atlas::reset()
+{
+  while (first) {
+    gl_texture_atlas *atlas = first;
+    first = atlas->next;
+    delete atlas;
+  }
+}
+
+static void gl_glyph_atlas_reset()
+{
+  gl_texture_atlas::reset();
+}
+
+// returns the atlas entry of the glyph of code point ucs, rasterizing it if
+// necessary from its len bytes of UTF-8 text at str.
+// Returns NULL and sets *full to true if the glyph does not fit in the atlas.
+gl_texture_atlas::glyph *gl_texture_atlas::find(unsigned ucs, const char *str, int len, bool *full)
+{
+  if (ucs >= (page_count << page_bits)) ucs = 0xFFFD; // invalid code points show as replacement character
+  unsigned r = ucs >> page_bits;
+  if (!pages[r]) pages[r] = (glyph*)calloc(1 << page_bits, sizeof(glyph));
+  glyph *g = pages[r] + (ucs & ((1 << page_bits) - 1));
+  if (g->w) return g;
+  // measure the glyph at the font size used in the GL scene
+  Fl_Fontsize fs = fl_size();
+  float gs = fl_graphics_driver->scale();
+  fl_graphics_driver->Fl_Graphics_Driver::scale(1);
+  fl_font(fl_font(), int(fs * scale));
+  float advance = float(fl_width(str, len));
+  fl_graphics_driver->Fl_Graphics_Driver::scale(gs);
+  fl_font(fl_font(), fs);
+  // leave room for glyphs extending beyond their advance (e.g., italics)
+  int w = (int)ceil(advance) + 2;
+  w = ((w + 3) / 4) * 4; // make w a multiple of 4
+  int h = glyph_h;
+  if (w + 1 > tex_size || h + 1 > tex_size) { *full = true; return NULL; }
+  if (shelf_x + w > tex_size) { // start a new shelf
+    shelf_y += shelf_h + 1;
+    shelf_x = shelf_h = 0;
+  }
+  if (shelf_y + h > tex_size) { *full = true; return NULL; }
+  char *alpha_buf = Fl_Gl_Window_Driver::global()->alpha_mask_for_string(str, len, w, h, int(fs * scale));
+  GLint row_length, alignment;
+  glGetIntegerv(GL_UNPACK_ROW_LENGTH, &row_length);
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+  glPushAttrib(GL_TEXTURE_BIT);
+  glBindTexture(GL_TEXTURE_RECTANGLE_ARB, texName);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, w);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexSubImage2D(GL_TEXTURE_RECTANGLE_ARB, 0, shelf_x, shelf_y, w, h, GL_ALPHA, GL_UNSIGNED_BYTE, alpha_buf);
+  glPopAttrib();
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, row_length);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  delete[] alpha_buf;
+  g->x = shelf_x;
+  g->y = shelf_y;
+  g->w = w;
+  g->h = h;
+  g->advance = advance;
+  shelf_x += w + 1; // keep one transparent pixel between glyphs
+  if (h > shelf_h) shelf_h = h;
+  return g;
+}
+
+// fills the vertices array with one quad per glyph of the string, relative to
+// the left of the baseline, and sets *width to the total advance.
+// Returns the number of quads, or -1 if the string's glyphs don't fit in the atlas.
+int gl_texture_atlas::layout(const char *str, int n, float *width)
+{
+  if (vertices_size < 4 * n) {
+    vertices_size = 4 * n;
+    vertices = (vertex*)realloc(vertices, vertices_size * sizeof(vertex));
+  }
+  const char *end = str + n;
+  bool full = false;
+  int count = 0;
+  float x = 0;
+  for (const char *p = str; p < end; ) {
+    int len;
+    unsigned ucs = fl_utf8decode(p, end, &len);
+    glyph *g = find(ucs, p, len, &full);
+    if (!g) return -1;
+    vertex *v = vertices + 4 * count++;
+    GLfloat s0 = g->x, s1 = GLfloat(g->x + g->w), t0 = g->y, t1 = GLfloat(g->y + g->h);
+    v[0].s = s0; v[0].t = t0; v[0].x = x;        v[0].y = 0;
+    v[1].s = s0; v[1].t = t1; v[1].x = x;        v[1].y = -g->h;
+    v[2].s = s1; v[2].t = t1; v[2].x = x + g->w; v[2].y = -g->h;
+    v[3].s = s1; v[3].t = t0; v[3].x = x + g->w; v[3].y = 0;
+    x += g->advance;
+    p += len;
+  }
+  *width = x;
+  return count;
+}
+
+// draws a string at the current raster position.
+// Returns 0 if the string's glyphs don't all fit in the atlas.
+int gl_texture_atlas::draw(const char *str, int n)
+{
+  float width;
+  int count = layout(str, n, &width);
+  if (count < 0) { // the atlas is full: start a fresh one and retry once
+    clear();
+    count = layout(str, n, &width);
+    if (count < 0) return 0;
+  }
+  //setup matrices
+  GLint matrixMode;
+  glGetIntegerv (GL_MATRIX_MODE, &matrixMode);
+  glMatrixMode (GL_PROJECTION);
+  glPushMatrix();
+  glLoadIdentity ();
+  glMatrixMode (GL_MODELVIEW);
+  glPushMatrix();
+  glLoadIdentity ();
+  float winw = Fl_Gl_Window_Driver::gl_scale * Fl_Window::current()->w();
+  float winh = Fl_Gl_Window_Driver::gl_scale * Fl_Window::current()->h();
+  glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT);
+  glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+  glDisable (GL_DEPTH_TEST); // ensure text is not removed by depth buffer test.
+  glEnable (GL_BLEND); // for text fading
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glDisable(GL_LIGHTING);
+  GLfloat pos[4];
+  glGetFloatv(GL_CURRENT_RASTER_POSITION, pos);
+  if (gl_start_scale != 1) { // using gl_start() / gl_finish()
+    pos[0] /= gl_start_scale;
+    pos[1] /= gl_start_scale;
+  }
+
+  float R = 2;
+  glScalef (R/winw, R/winh, 1.0f);
+  glTranslatef (-winw/R, -winh/R, 0.0f);
+  // move to the top-left corner of the first glyph
+  glTranslatef (pos[0], pos[1] + glyph_h - Fl_Gl_Window_Driver::gl_scale * fl_descent(), 0.0f);
+  glEnable (GL_TEXTURE_RECTANGLE_ARB);
+  glBindTexture (GL_TEXTURE_RECTANGLE_ARB, texName);
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_COLOR_ARRAY);
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glVertexPointer(2, GL_FLOAT, sizeof(vertex), &vertices[0].x);
+  glTexCoordPointer(2, GL_FLOAT, sizeof(vertex), &vertices[0].s);
+  glDrawArrays(GL_QUADS, 0, 4 * count);
+  glPopClientAttrib();
+  glPopAttrib();
+
+  // reset original matrices
+  glPopMatrix(); // GL_MODELVIEW
+  glMatrixMode (GL_PROJECTION);
+  glPopMatrix();
+  glMatrixMode (matrixMode);
+
+  //set the raster position to end of string
+  pos[0] += width;
+  set_raster_pos(pos);
+  return 1;
+}
+
+static int use_glyph_atlas = 0; // true after gl_glyph_atlas(1)
+
 #endif  // ! defined(FL_DOXYGEN)
 
 /**
@@ -472,6 +777,40 @@ void gl_texture_pile_height(int max)
 }
 
 
+/**
+ Turns on or off drawing OpenGL text with a glyph atlas.
+
+ By default, each string drawn with gl_draw() is rendered as a whole in a
+ texture that is kept in the pile of pre-computed string textures (see
+ gl_texture_pile_height(int)). Text that changes often, such as numbers in
+ a frequently updated display, then requires a new texture at each change.
+ When the glyph atlas is on, each glyph is rendered once in a texture shared by
+ all glyphs of the same font and size, and strings are drawn as sequences
+ of glyphs. Drawing any string then costs about the same, whether or not it
+ was drawn before. Glyphs are positioned according to their individual widths,
+ so kerning between glyph pairs is not applied.
+
+ This has no effect if OpenGL text is not drawn with textures.
+ \param on  non-zero to turn on the glyph atlas, zero (the default) to turn it off
+ \see Fl::draw_GL_text_with_textures(int)
+ \version 1.4.0
+ */
+void gl_glyph_atlas(int on)
+{
+  use_glyph_atlas = on;
+}
+
+/**
+ Returns whether OpenGL text is drawn with a glyph atlas.
+ \see gl_glyph_atlas(int)
+ \version 1.4.0
+ */
+int gl_glyph_atlas()
+{
+  return use_glyph_atlas;
+}
+
+
 /**
  \cond DriverDev
  \addtogroup DriverDeveloper
@@ -489,6 +828,7 @@ void Fl_Gl_Window_Driver::draw_string_with_texture(const char* str, int n)
 {
   Fl_Gl_Window *gwin = Fl_Window::current()->as_gl_window();
   gl_scale = (gwin ? gwin->pixels_per_unit() : 1);
+  if (use_glyph_atlas && gl_texture_atlas::get(gl_fontsize, gl_scale)->draw(str, n)) return;
   if (!gl_fifo) gl_fifo = new gl_texture_fifo();
   if (!gl_fifo->textures_generated) {
     if (has_texture_rectangle) for (int i = 0; i < gl_fifo->size_; i++) glGenTextures(1, &(gl_fifo->fifo[i].texName));
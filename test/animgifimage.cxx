@@ -0,0 +1,81 @@
+//
+// Animated GIF image test program for the Fast Light Tool Kit (FLTK).
+//
+// Plays the animated GIF files given on the command line, or chosen with
+// a file chooser. Click an image to stop or restart it.
+//
+// Usage: animgifimage [-s speed] [file.gif ...]
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl.H>
+#include <FL/Fl_Double_Window.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_Anim_GIF_Image.H>
+#include <FL/Fl_File_Chooser.H>
+#include <FL/fl_message.H>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void toggle_cb(Fl_Widget *, void *data) {
+  Fl_Anim_GIF_Image *anim = (Fl_Anim_GIF_Image *)data;
+  if (anim->playing())
+    anim->stop();
+  else
+    anim->start();
+}
+
+static int show_gif(const char *filename, double speed) {
+  Fl_Anim_GIF_Image *anim = new Fl_Anim_GIF_Image(filename);
+  if (anim->fail()) {
+    fl_alert("Could not load %s", filename);
+    delete anim;
+    return 0;
+  }
+  anim->speed(speed);
+  int W = anim->w() < 100 ? 100 : anim->w();
+  int H = anim->h() < 20 ? 20 : anim->h();
+  Fl_Double_Window *win = new Fl_Double_Window(W + 20, H + 20);
+  win->copy_label(filename);
+  Fl_Button *b = new Fl_Button(10, 10, W, H);
+  b->box(FL_FLAT_BOX);
+  b->image(anim);
+  b->callback(toggle_cb, anim);
+  win->end();
+  win->show();
+  anim->widget(b);
+  anim->start();
+  printf("%s: %dx%d, %d frames, loop count %d\n", filename, anim->w(), anim->h(),
+         anim->frames(), anim->loop_count());
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  double speed = 1.0;
+  int shown = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-s") && i + 1 < argc)
+      speed = atof(argv[++i]);
+    else
+      shown += show_gif(argv[i], speed);
+  }
+  if (!shown) {
+    const char *filename = fl_file_chooser("Animated GIF", "*.gif", NULL);
+    if (!filename || !show_gif(filename, speed))
+      return 1;
+  }
+  return Fl::run();
+}
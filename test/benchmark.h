@@ -0,0 +1,81 @@
+//
+// Common code of the benchmark programs for the Fast Light Tool Kit (FLTK).
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H 1
+
+// The benchmarks print each measurement on a line of its own, made of
+// space-separated fields starting with the name of the benchmark, so that
+// scripts can compare runs. Durations are measured with a monotonic clock.
+
+#include <stdio.h>
+#include <stdarg.h>
+
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <time.h>
+#  include <sys/time.h> // gettimeofday()
+#endif
+
+// Returns the time in seconds since an arbitrary origin, for measuring durations
+static inline double benchmark_now() {
+#ifdef _WIN32
+  static LARGE_INTEGER frequency;
+  LARGE_INTEGER t;
+  if (!frequency.QuadPart) QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&t);
+  return double(t.QuadPart) / double(frequency.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + 0.000000001 * t.tv_nsec;
+#else
+  struct timeval t;
+  gettimeofday(&t, NULL);
+  return t.tv_sec + 0.000001 * t.tv_usec;
+#endif
+}
+
+// Prints a measurement line and flushes it, so that it is seen while
+// the next measurements run
+static inline void benchmark_report(const char *format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  vprintf(format, ap);
+  va_end(ap);
+  putchar('\n');
+  fflush(stdout);
+}
+
+// Prints the usage of the program with arguments args, returns 1 for main()
+static inline int benchmark_usage(const char *program, const char *args) {
+  fprintf(stderr, "Usage: %s %s\n", program, args);
+  return 1;
+}
+
+// Returns channel c of pixel (x, y) of a w x h photo-like image of depth d:
+// smooth gradients with a fine stripe pattern that aliases when it is not
+// averaged. Channel 3, or 1 if d is 2, is the alpha channel.
+static inline unsigned char benchmark_pixel(int x, int y, int w, int h, int d, int c) {
+  int stripe = ((x + y) / 3) & 1 ? 40 : 0;
+  int v;
+  if (c == 3 || (d == 2 && c == 1)) v = 255 - 128 * y / h; // alpha
+  else v = (c == 0 ? 255 * x / w : c == 1 ? 255 * y / h : 128) + stripe;
+  return (unsigned char)(v > 255 ? 255 : v);
+}
+
+#endif // BENCHMARK_H
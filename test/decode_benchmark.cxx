@@ -0,0 +1,305 @@
+//
+// BMP and GIF decoding benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Loads large BMP and GIF images from a file and from memory. Without file
+// arguments it writes sample images generated from a photo-like pattern to
+// the current directory, and removes them at the end:
+//
+//   bmp1:  1-bit BMP
+//   bmp8:  8-bit BMP with a 256 color palette
+//   bmp24: 24-bit BMP
+//   bmp32: 32-bit BMP
+//   gif:   GIF with a 256 color palette
+//
+// Usage: decode_benchmark [-i iterations] [-s WxH] [file.bmp|file.gif ...]
+//
+//   WxH:   the size of the sample images (default: 4096x3072)
+//
+// Each measurement is printed on a line of its own:
+//
+//   decode <name> <source> <WxH> <seconds>
+//
+// where source is "file" or "memory".
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl_BMP_Image.H>
+#include <FL/Fl_GIF_Image.H>
+#include <FL/fl_utf8.h>
+#include <FL/filename.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+static void pixel(int x, int y, int w, int h, uchar *rgb) {
+  for (int c = 0; c < 3; c++) rgb[c] = benchmark_pixel(x, y, w, h, 3, c);
+}
+
+// The color of index i in the 3-3-2 palette of the 8-bit images
+static void palette(int i, uchar *rgb) {
+  rgb[0] = (uchar)((i >> 5) * 255 / 7);
+  rgb[1] = (uchar)(((i >> 2) & 7) * 255 / 7);
+  rgb[2] = (uchar)((i & 3) * 255 / 3);
+}
+
+static int index8(const uchar *rgb) {
+  return (rgb[0] & 0xe0) | ((rgb[1] >> 3) & 0x1c) | (rgb[2] >> 6);
+}
+
+static void put16(FILE *f, unsigned v) {
+  putc(v & 255, f);
+  putc((v >> 8) & 255, f);
+}
+
+static void put32(FILE *f, unsigned v) {
+  put16(f, v & 0xffff);
+  put16(f, v >> 16);
+}
+
+static int write_bmp(const char *name, int w, int h, int depth) {
+  FILE *f = fl_fopen(name, "wb");
+  if (!f) return 0;
+  int colors = depth <= 8 ? 1 << depth : 0;
+  unsigned row_bytes = ((w * depth + 31) / 32) * 4;
+  unsigned offset = 14 + 40 + 4 * colors;
+  // file header
+  putc('B', f); putc('M', f);
+  put32(f, offset + row_bytes * h);
+  put32(f, 0);
+  put32(f, offset);
+  // info header
+  put32(f, 40);
+  put32(f, w);
+  put32(f, h);
+  put16(f, 1);
+  put16(f, depth);
+  put32(f, 0);
+  put32(f, row_bytes * h);
+  put32(f, 2835);
+  put32(f, 2835);
+  put32(f, colors);
+  put32(f, 0);
+  for (int i = 0; i < colors; i++) {
+    uchar rgb[3];
+    if (depth == 1) rgb[0] = rgb[1] = rgb[2] = (uchar)(i * 255);
+    else palette(i, rgb);
+    putc(rgb[2], f); putc(rgb[1], f); putc(rgb[0], f); putc(0, f);
+  }
+  uchar *row = new uchar[row_bytes];
+  for (int y = h - 1; y >= 0; y--) { // bottom-up
+    memset(row, 0, row_bytes);
+    for (int x = 0; x < w; x++) {
+      uchar rgb[3];
+      pixel(x, y, w, h, rgb);
+      switch (depth) {
+        case 1:
+          if (rgb[0] + rgb[1] + rgb[2] > 3 * 128) row[x >> 3] |= 0x80 >> (x & 7);
+          break;
+        case 8:
+          row[x] = (uchar)index8(rgb);
+          break;
+        default:
+          row[x * (depth / 8)] = rgb[2];
+          row[x * (depth / 8) + 1] = rgb[1];
+          row[x * (depth / 8) + 2] = rgb[0];
+          if (depth == 32) row[x * 4 + 3] = 255;
+          break;
+      }
+    }
+    fwrite(row, 1, row_bytes, f);
+  }
+  delete[] row;
+  return fclose(f) == 0;
+}
+
+// Writes the LZW codes of a GIF image in data sub-blocks
+class GIF_Writer {
+  FILE *f;
+  uchar block[256];
+  int n;
+  unsigned long bits;
+  int nbits;
+public:
+  GIF_Writer(FILE *file) : f(file), n(0), bits(0), nbits(0) {}
+  void code(int c, int size) {
+    bits |= (unsigned long)c << nbits;
+    nbits += size;
+    while (nbits >= 8) {
+      block[++n] = (uchar)(bits & 255);
+      bits >>= 8;
+      nbits -= 8;
+      if (n == 255) write_block();
+    }
+  }
+  void write_block() {
+    block[0] = (uchar)n;
+    fwrite(block, 1, n + 1, f);
+    n = 0;
+  }
+  void finish() {
+    if (nbits > 0) code(0, 8 - nbits);
+    if (n) write_block();
+  }
+};
+
+static int write_gif(const char *name, int w, int h) {
+  FILE *f = fl_fopen(name, "wb");
+  if (!f) return 0;
+  fwrite("GIF89a", 1, 6, f);
+  put16(f, w);
+  put16(f, h);
+  putc(0xf7, f); // global color table of 256 colors
+  putc(0, f);
+  putc(0, f);
+  for (int i = 0; i < 256; i++) {
+    uchar rgb[3];
+    palette(i, rgb);
+    fwrite(rgb, 1, 3, f);
+  }
+  putc(',', f);
+  put16(f, 0);
+  put16(f, 0);
+  put16(f, w);
+  put16(f, h);
+  putc(0, f);
+  putc(8, f); // minimum code size
+  // LZW compression, with the table of the codes that extend each code by a pixel
+  const int clear = 256, eoi = 257;
+  short *next = new short[4096 * 256];
+  memset(next, 0, 4096 * 256 * sizeof(short));
+  GIF_Writer out(f);
+  int size = 9, avail = eoi + 1, prefix = -1;
+  out.code(clear, size);
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      uchar rgb[3];
+      pixel(x, y, w, h, rgb);
+      int c = index8(rgb);
+      if (prefix < 0) { prefix = c; continue; }
+      if (next[prefix * 256 + c]) { prefix = next[prefix * 256 + c]; continue; }
+      out.code(prefix, size);
+      if (avail < 4096) {
+        next[prefix * 256 + c] = (short)avail++;
+        if (avail > (1 << size) && size < 12) size++;
+      } else { // table full
+        out.code(clear, size);
+        memset(next, 0, 4096 * 256 * sizeof(short));
+        size = 9;
+        avail = eoi + 1;
+      }
+      prefix = c;
+    }
+  }
+  out.code(prefix, size);
+  out.code(eoi, size);
+  out.finish();
+  delete[] next;
+  putc(0, f);
+  putc(';', f);
+  return fclose(f) == 0;
+}
+
+static uchar *read_file(const char *name, size_t &size) {
+  FILE *f = fl_fopen(name, "rb");
+  if (!f) return 0;
+  fseek(f, 0, SEEK_END);
+  size = (size_t)ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uchar *data = new uchar[size];
+  if (fread(data, 1, size, f) != size) { delete[] data; data = 0; }
+  fclose(f);
+  return data;
+}
+
+static Fl_Image *load(const char *name, const uchar *data, size_t size) {
+  const char *ext = strrchr(name, '.');
+  if (ext && !strcmp(ext, ".gif")) {
+    if (data) return new Fl_GIF_Image(name, data, size);
+    return new Fl_GIF_Image(name);
+  }
+  if (data) return new Fl_BMP_Image(name, data, size);
+  return new Fl_BMP_Image(name);
+}
+
+static int benchmark(const char *label, const char *name, int iterations) {
+  size_t size;
+  uchar *data = read_file(name, size);
+  if (!data) {
+    fprintf(stderr, "Cannot read %s\n", name);
+    return 0;
+  }
+  for (int source = 0; source < 2; source++) {
+    int w = 0, h = 0;
+    double start = benchmark_now();
+    for (int i = 0; i < iterations; i++) {
+      Fl_Image *img = load(name, source ? data : 0, size);
+      if (img->fail()) {
+        fprintf(stderr, "Cannot decode %s\n", name);
+        delete img;
+        delete[] data;
+        return 0;
+      }
+      w = img->w();
+      h = img->h();
+      delete img;
+    }
+    benchmark_report("decode %s %s %dx%d %.3f", label, source ? "memory" : "file", w, h,
+                     (benchmark_now() - start) / iterations);
+  }
+  delete[] data;
+  return 1;
+}
+
+static const struct { const char *name; const char *file; int depth; } samples[] = {
+  {"bmp1", "decode_benchmark_1.bmp", 1},
+  {"bmp8", "decode_benchmark_8.bmp", 8},
+  {"bmp24", "decode_benchmark_24.bmp", 24},
+  {"bmp32", "decode_benchmark_32.bmp", 32},
+  {"gif", "decode_benchmark.gif", 0}
+};
+
+int main(int argc, char **argv) {
+  int iterations = 3, w = 4096, h = 3072, files = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-i") && i + 1 < argc) iterations = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+      if (sscanf(argv[++i], "%dx%d", &w, &h) != 2) w = 0;
+    } else if (argv[i][0] != '-') files++;
+    else w = 0;
+    if (iterations < 1 || w < 1 || h < 1 || w > 65535 || h > 65535) {
+      return benchmark_usage(argv[0], "[-i iterations] [-s WxH] [file.bmp|file.gif ...]");
+    }
+  }
+  int ret = 0;
+  if (files) {
+    for (int i = 1; i < argc; i++) {
+      if (!strcmp(argv[i], "-i") || !strcmp(argv[i], "-s")) i++;
+      else if (!benchmark(fl_filename_name(argv[i]), argv[i], iterations)) ret = 1;
+    }
+    return ret;
+  }
+  for (unsigned s = 0; s < sizeof(samples) / sizeof(samples[0]); s++) {
+    int ok = samples[s].depth ? write_bmp(samples[s].file, w, h, samples[s].depth)
+                              : write_gif(samples[s].file, w, h);
+    if (!ok) {
+      fprintf(stderr, "Cannot write %s\n", samples[s].file);
+      ret = 1;
+    } else if (!benchmark(samples[s].name, samples[s].file, iterations))
+      ret = 1;
+    fl_unlink(samples[s].file);
+  }
+  return ret;
+}
@@ -0,0 +1,134 @@
+//
+// FLUID .fl file parsing benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Writes synthetic .fl design files with many widgets into the current
+// directory, then measures how long FLUID takes to read and rewrite them
+// (fluid -u) and to read them and write their code (fluid -c).
+//
+// Usage: fluid_benchmark [-f fluid] [widgets...]
+//
+//   fluid:   the FLUID executable (default: fluid)
+//   widgets: the sizes of the designs (default: 1000 10000 100000)
+//
+// Each measurement is printed on a line of its own:
+//
+//   fluid <mode> <widgets> <bytes> <seconds> <MB/s>
+//
+// The time that FLUID needs to start up and read an empty design is
+// measured first and subtracted from all other measurements.
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/fl_utf8.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+static const char *design = "fluid_benchmark.fl";
+
+// Writes a design with a window holding groups of 100 widgets of assorted
+// types and properties, returns the size of the file
+static long write_design(int widgets) {
+  static const char *types[] = {
+    "Fl_Button", "Fl_Input", "Fl_Box", "Fl_Value_Slider", "Fl_Check_Button",
+    "Fl_Roller", "Fl_Light_Button", "Fl_Output"
+  };
+  FILE *f = fl_fopen(design, "w");
+  if (!f) return -1;
+  fprintf(f, "# data file for the Fltk User Interface Designer (fluid)\n"
+             "version 1.0400\nheader_name {.h}\ncode_name {.cxx}\n"
+             "Function {make_window()} {open\n} {\n"
+             "  Fl_Window {} {open\n    xywh {100 100 800 600} type Double visible\n  } {");
+  for (int n = 0; n < widgets; n++) {
+    if (n % 100 == 0) {
+      if (n) fprintf(f, "\n    }");
+      fprintf(f, "\n    Fl_Group {} {open\n      xywh {0 0 800 600}\n    } {");
+    }
+    int k = n % 100;
+    fprintf(f, "\n      %s w%d {\n"
+               "        label {Widget \\#%d}\n"
+               "        callback {do_something(%d);}\n"
+               "        tooltip {Tip for widget %d} xywh {%d %d 95 20} box UP_BOX"
+               " color 49 labelsize 12 align 20\n"
+               "      }", types[n % 8], n, n, n, n, (k % 8) * 100, (k / 8) * 24);
+  }
+  if (widgets) fprintf(f, "\n    }");
+  fprintf(f, "\n  }\n}\n");
+  long size = ftell(f);
+  fclose(f);
+  return size;
+}
+
+// Runs FLUID on the design, returns the elapsed time or -1 on error
+static double run_fluid(const char *fluid, const char *mode) {
+  char command[1024];
+  snprintf(command, sizeof(command), "\"%s\" %s %s", fluid, mode, design);
+  double start = benchmark_now();
+  if (system(command) != 0) return -1;
+  return benchmark_now() - start;
+}
+
+static void remove_files() {
+  fl_unlink(design);
+  fl_unlink("fluid_benchmark.cxx");
+  fl_unlink("fluid_benchmark.h");
+}
+
+int main(int argc, char **argv) {
+  const char *fluid = "fluid";
+  int sizes[32], count = 0;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+      fluid = argv[++i];
+    } else if (atoi(argv[i]) > 0 && count < 32) {
+      sizes[count++] = atoi(argv[i]);
+    } else {
+      return benchmark_usage(argv[0], "[-f fluid] [widgets...]");
+    }
+  }
+  if (!count) {
+    sizes[count++] = 1000;
+    sizes[count++] = 10000;
+    sizes[count++] = 100000;
+  }
+
+  static const char *modes[] = { "-u", "-c" };
+  double startup[2];
+  write_design(0);
+  for (int m = 0; m < 2; m++) {
+    startup[m] = run_fluid(fluid, modes[m]);
+    if (startup[m] < 0) {
+      fprintf(stderr, "Cannot run %s\n", fluid);
+      remove_files();
+      return 1;
+    }
+  }
+  for (int i = 0; i < count; i++) {
+    for (int m = 0; m < 2; m++) {
+      long size = write_design(sizes[i]); // fluid -u rewrites the design
+      double t = run_fluid(fluid, modes[m]);
+      if (t < 0) {
+        fprintf(stderr, "%s %s failed for %d widgets\n", fluid, modes[m], sizes[i]);
+        continue;
+      }
+      t -= startup[m];
+      if (t < 0.001) t = 0.001;
+      benchmark_report("fluid %s %d %ld %.3f %.1f", modes[m], sizes[i], size, t, size / t / 1e6);
+    }
+  }
+  remove_files();
+  return 0;
+}
@@ -0,0 +1,123 @@
+//
+// Fl_Group children benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Fills groups with many children and empties them again, and measures
+// how long each way of doing so takes:
+//
+//   add:    constructing the children between begin() and end()
+//   bulk:   adding an array of existing children with add(widgets, n)
+//   find:   looking up the index of each child with find()
+//   remove: removing each child with remove(Fl_Widget&), last child first
+//   remove-first: removing each child with remove(Fl_Widget&), first child first
+//   delete: deleting each child, last child first
+//   delete-first: deleting each child, first child first
+//   clear:  deleting all children with clear()
+//
+// Usage: group_benchmark [children...]
+//
+//   children: the numbers of children (default: 1000 10000 100000)
+//
+// Each measurement is printed on a line of its own:
+//
+//   group <mode> <children> <seconds>
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Box.H>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+static double start;
+
+static void report(const char *mode, int n) {
+  benchmark_report("group %s %d %.3f", mode, n, benchmark_now() - start);
+}
+
+// Creates n boxes in a grid, in group g if it is not NULL
+static void make_children(Fl_Group *g, int n, Fl_Widget **widgets) {
+  Fl_Group::current(g);
+  for (int i = 0; i < n; i++)
+    widgets[i] = new Fl_Box((i % 100) * 10, (i / 100) * 10, 10, 10);
+  Fl_Group::current(0);
+}
+
+static void run(int n) {
+  Fl_Widget **widgets = new Fl_Widget*[n];
+  Fl_Group *g = new Fl_Group(0, 0, 1000, 1000);
+  g->end();
+  int i, errors = 0;
+
+  start = benchmark_now();
+  make_children(g, n, widgets);
+  report("add", n);
+
+  start = benchmark_now();
+  for (i = 0; i < n; i++) if (g->find(widgets[i]) != i) errors++;
+  report("find", n);
+
+  start = benchmark_now();
+  for (i = n; i--;) g->remove(*widgets[i]);
+  report("remove", n);
+
+  start = benchmark_now();
+  g->add(widgets, n);
+  report("bulk", n);
+
+  start = benchmark_now();
+  for (i = 0; i < n; i++) g->remove(*widgets[i]);
+  report("remove-first", n);
+  if (g->children()) errors++;
+
+  g->add(widgets, n);
+  start = benchmark_now();
+  for (i = n; i--;) delete widgets[i];
+  report("delete", n);
+
+  make_children(g, n, widgets);
+  start = benchmark_now();
+  for (i = 0; i < n; i++) delete widgets[i];
+  report("delete-first", n);
+  if (g->children()) errors++;
+
+  make_children(g, n, widgets);
+  start = benchmark_now();
+  g->clear();
+  report("clear", n);
+
+  delete g;
+  delete[] widgets;
+  if (errors)
+    fprintf(stderr, "%d children were not found or not removed\n", errors);
+}
+
+int main(int argc, char **argv) {
+  int count = 0;
+  for (int i = 1; i < argc; i++) {
+    int n = atoi(argv[i]);
+    if (n <= 0) {
+      return benchmark_usage(argv[0], "[children...]");
+    }
+    run(n);
+    count++;
+  }
+  if (!count) {
+    run(1000);
+    run(10000);
+    run(100000);
+  }
+  return 0;
+}
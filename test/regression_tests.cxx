@@ -0,0 +1,636 @@
+//
+// Regression tests for the Fast Light Tool Kit (FLTK).
+//
+// Runs non-interactive checks of bugs that were fixed, and prints one line
+// per test. The tests are run by ctest, or by hand:
+//
+// Usage: regression_tests [test...]
+//
+//   test: the names of the tests to run (default: all tests)
+//
+// Run it in the test directory: some tests read the images of the source tree.
+//
+// The exit status is 0 if all tests pass, 77 if all tests were skipped
+// (for instance because they need a display), and 1 otherwise.
+//
+// To add a test, write a function that returns PASS, FAIL or SKIP, add it
+// to the table of tests below, and its name to REGRESSION_TESTS in
+// test/CMakeLists.txt.
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl.H>
+#include <FL/Fl_Group.H>
+#include <FL/Fl_Box.H>
+#include <FL/Fl_Value_Input.H>
+#include <FL/Fl_PNG_Image.H>
+#include <FL/Fl_PNG_Decoder.H>
+#include <FL/Fl_JPEG_Image.H>
+#include <FL/Fl_JPEG_Decoder.H>
+#include <FL/fl_utf8.h>
+#include <FL/Fl_Shared_Image.H>
+#include <FL/Fl_GIF_Image.H>
+#include <FL/Fl_Anim_GIF_Image.H>
+#include "../fluid/undo_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum { PASS = 0, FAIL = 1, SKIP = 77 };
+
+// Prints a failed check of the current test
+#define CHECK(e) do { \
+    if (!(e)) { \
+      printf("  %s:%d: check failed: %s\n", __FILE__, __LINE__, #e); \
+      return FAIL; \
+    } \
+  } while (0)
+
+// A box that records the pointer events it gets
+class Push_Box : public Fl_Box {
+public:
+  int pushed;
+  Push_Box(int X, int Y, int W, int H) : Fl_Box(X, Y, W, H), pushed(0) {}
+  int handle(int event) {
+    if (event == FL_PUSH) { pushed++; return 1; }
+    return Fl_Box::handle(event);
+  }
+};
+
+// Sends a push of the left mouse button at (x, y) to group g
+static int push(Fl_Group &g, int x, int y) {
+  Fl::e_x = Fl::e_x_root = x;
+  Fl::e_y = Fl::e_y_root = y;
+  Fl::e_keysym = FL_Button + FL_LEFT_MOUSE;
+  int ret = g.handle(FL_PUSH);
+  Fl::pushed(0);
+  return ret;
+}
+
+// Fl_Value_Input makes itself the parent of its input field although it
+// is not a group, so Fl_Widget::resize() must not look at the spatial index
+// of that parent. Children moved by resize() must still get the pointer
+// events, also after the group itself is resized.
+static int value_input_resize() {
+  Fl_Group g(0, 0, 400, 400);
+  g.spatial_index(1);
+  for (int y = 0; y < 200; y += 20)
+    for (int x = 0; x < 400; x += 40)
+      new Fl_Box(x, y, 40, 20);
+  Fl_Value_Input vi(0, 200, 100, 20);
+  Push_Box box(0, 240, 40, 20);
+  g.end();
+  CHECK(push(g, 10, 250) && box.pushed == 1);
+  static const int sizes[][4] = {
+    {0, 200, 200, 25}, {100, 300, 50, 10}, {10, 210, 380, 30}, {0, 200, 0, 0}
+  };
+  for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+    const int *s = sizes[i];
+    vi.resize(s[0], s[1], s[2], s[3]);
+    CHECK(vi.x() == s[0] && vi.y() == s[1] && vi.w() == s[2] && vi.h() == s[3]);
+    CHECK(vi.input.x() == s[0] && vi.input.y() == s[1]);
+    CHECK(vi.input.w() == s[2] && vi.input.h() == s[3]);
+  }
+  box.resize(300, 350, 40, 20);
+  CHECK(!push(g, 10, 250) && box.pushed == 1);
+  CHECK(push(g, 310, 360) && box.pushed == 2);
+  g.resize(0, 0, 800, 800);
+  CHECK(box.x() == 600 && box.y() == 700);
+  CHECK(push(g, 620, 720) && box.pushed == 3);
+  g.remove(vi);
+  g.remove(box);
+  return PASS;
+}
+
+// Reads file name into a new[] array, returns NULL if it cannot be read
+static uchar *read_file(const char *name, size_t &size) {
+  FILE *f = fl_fopen(name, "rb");
+  if (!f) return 0;
+  fseek(f, 0, SEEK_END);
+  size = (size_t)ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uchar *data = new uchar[size];
+  if (fread(data, 1, size, f) != size) { delete[] data; data = 0; }
+  fclose(f);
+  return data;
+}
+
+// Ignores warnings the tests expect
+static void quiet(const char *, ...) {
+}
+
+// Writes the first n bytes of data to decoder dec in chunks of the given
+// size, and returns the result of close()
+static int decode(Fl_Image_Decoder &dec, const uchar *data, size_t n, size_t chunk) {
+  for (size_t i = 0; i < n; i += chunk) {
+    int err = dec.write(data + i, n - i < chunk ? n - i : chunk);
+    if (err) return err;
+  }
+  return dec.close();
+}
+
+// Checks that the decoders made by make_decoder() decode file name like
+// image full, whatever the size of the chunks of data they get, and that
+// they fail with truncated data.
+// Returns SKIP if the file cannot be read or the image format is not supported.
+static int check_decoder(const char *name, Fl_RGB_Image &full,
+                         Fl_Image_Decoder *(*make_decoder)()) {
+  size_t size;
+  uchar *data = read_file(name, size);
+  if (!data || full.fail()) {
+    printf("  cannot read %s\n", name);
+    delete[] data;
+    return SKIP;
+  }
+  static const size_t chunks[] = {1, 7, 1000, 1 << 30};
+  for (unsigned i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+    Fl_Image_Decoder *dec = make_decoder();
+    int err = decode(*dec, data, size, chunks[i]);
+    int same = !err && dec->complete() && dec->fail() == 0 &&
+      dec->w() == full.w() && dec->h() == full.h() && dec->d() == full.d() &&
+      !memcmp(dec->array, full.array, (size_t)full.w() * full.h() * full.d());
+    delete dec;
+    if (!same) {
+      printf("  %s: decoded in chunks of %lu bytes, not like the whole file\n",
+             name, (unsigned long)chunks[i]);
+      delete[] data;
+      return FAIL;
+    }
+  }
+  const size_t parts[] = {0, 10, size / 2, size - 16};
+  void (*warning)(const char *, ...) = Fl::warning;
+  Fl::warning = quiet; // the decoders warn about the truncated data
+  int ret = PASS;
+  for (unsigned i = 0; i < sizeof(parts) / sizeof(parts[0]) && ret == PASS; i++) {
+    Fl_Image_Decoder *dec = make_decoder();
+    int err = decode(*dec, data, parts[i], 100);
+    if (err != Fl_Image::ERR_FORMAT || dec->fail() != Fl_Image::ERR_FORMAT ||
+        dec->complete() || dec->array) {
+      printf("  %s: truncated after %lu bytes, but close() returned %d\n",
+             name, (unsigned long)parts[i], err);
+      ret = FAIL;
+    }
+    delete dec;
+  }
+  Fl::warning = warning;
+  delete[] data;
+  return ret;
+}
+
+static Fl_Image_Decoder *make_png_decoder() { return new Fl_PNG_Decoder(); }
+static Fl_Image_Decoder *make_jpeg_decoder() { return new Fl_JPEG_Decoder(); }
+
+// Image files, relative to the test directory
+static const char *png_files[] = {
+  "images/FL200.png",                                     // 8-bit colormap
+  "images/Fl_Value_Input.png",                            // gray + alpha
+  "../documentation/src/cairo_test.png"                   // RGBA
+};
+static const char *jpeg_files[] = {
+  "../documentation/src/fl_color_chooser.jpg",            // baseline
+  "../documentation/src/Fl_File_Chooser.jpg"              // progressive
+};
+
+// Fl_PNG_Decoder must decode like Fl_PNG_Image, and fail on truncated data
+static int png_decoder() {
+  int ret = PASS;
+  for (unsigned i = 0; i < sizeof(png_files) / sizeof(png_files[0]) && ret != FAIL; i++) {
+    Fl_PNG_Image full(png_files[i]);
+    int r = check_decoder(png_files[i], full, make_png_decoder);
+    if (r != PASS) ret = r;
+  }
+  return ret;
+}
+
+// Fl_JPEG_Decoder must decode like Fl_JPEG_Image, and fail on truncated data
+// (where Fl_JPEG_Image keeps the partial image)
+static int jpeg_decoder() {
+  int ret = PASS;
+  for (unsigned i = 0; i < sizeof(jpeg_files) / sizeof(jpeg_files[0]) && ret != FAIL; i++) {
+    Fl_JPEG_Image full(jpeg_files[i]);
+    int r = check_decoder(jpeg_files[i], full, make_jpeg_decoder);
+    if (r != PASS) ret = r;
+  }
+  return ret;
+}
+
+// Returns the text of level k of the undo_history test, allocated with
+// malloc(): 100 lines, of which line k % 100 is changed at each level k
+static char *undo_text(int k, int &length) {
+  char *text = (char*)malloc(100 * 40);
+  length = 0;
+  for (int i = 0; i < 100; i++) {
+    int changed = k - (k + 100 - i) % 100; // last level that changed line i
+    length += sprintf(text + length, "line %d changed at level %d\n", i, changed);
+  }
+  return text;
+}
+
+// Checks that undo history h holds the levels first... of the undo_history test
+static int check_undo_levels(Undo_History &h, int first) {
+  for (int pass = 0; pass < 2; pass++) { // undo all levels, then redo them
+    for (int i = 0; i < h.levels(); i++) {
+      int level = pass ? i : h.levels() - 1 - i;
+      int length;
+      char *text = undo_text(first + level, length);
+      int same = h.go_to(level) && h.text_level() == level &&
+        h.text_length() == length && !memcmp(h.text(), text, length);
+      free(text);
+      if (!same) {
+        printf("  level %d is not the text stored as level %d\n", level, first + level);
+        return FAIL;
+      }
+    }
+  }
+  return PASS;
+}
+
+// The undo history of fluid keeps within its memory budget by forgetting
+// the oldest levels, and restores the texts of the levels it keeps
+static int undo_history() {
+  const size_t budget = 8000;
+  Undo_History h(budget);
+  int first = 0, length; // the first level stored that is kept by h
+  for (int k = 0; k < 500; k++) {
+    char *text = undo_text(k, length);
+    CHECK(h.store(k - first, text, length));
+    first += h.trim();
+    CHECK(h.memory() <= budget);
+  }
+  CHECK(first > 0 && h.levels() == 500 - first && h.levels() > 2);
+  if (check_undo_levels(h, first) != PASS) return FAIL;
+  // storing a level after undo forgets the levels that could be redone
+  CHECK(h.go_to(2));
+  char *text = undo_text(first + 3, length);
+  CHECK(h.store(3, text, length));
+  CHECK(h.levels() == 4 && !h.go_to(4));
+  if (check_undo_levels(h, first) != PASS) return FAIL;
+  // without enough memory, only the last two levels are kept
+  Undo_History small(100);
+  first = 0;
+  for (int k = 0; k < 10; k++) {
+    text = undo_text(k, length);
+    CHECK(small.store(k - first, text, length));
+    int n = small.trim();
+    CHECK(n == (k >= 2 ? 1 : 0));
+    first += n;
+  }
+  CHECK(first == 8 && small.levels() == 2 && small.memory() > 100);
+  if (check_undo_levels(small, first) != PASS) return FAIL;
+  small.clear();
+  CHECK(small.levels() == 0 && small.memory() == 0 && !small.go_to(0));
+  return PASS;
+}
+
+// get_reduced() returns an image of the same name loaded before if it is big
+// enough, the smallest one, and the original image if it is loaded
+static int shared_image_reduced() {
+  const char *name = "../documentation/src/Fl_File_Chooser.jpg"; // 498 x 408
+  fl_register_images();
+  Fl_Shared_Image *a = Fl_Shared_Image::get_reduced(name, 100, 100);
+  if (!a) {
+    printf("  cannot read %s\n", name);
+    return SKIP;
+  }
+  CHECK(!a->original() && a->data_w() == 125 && a->data_h() == 102);
+  Fl_Shared_Image *b = Fl_Shared_Image::get_reduced(name, 50, 50); // not decoded at 1/8
+  CHECK(b == a);
+  Fl_Shared_Image *c = Fl_Shared_Image::get_reduced(name, 200, 0);
+  CHECK(c != a && c->data_w() == 249 && c->data_h() == 204);
+  Fl_Shared_Image *d = Fl_Shared_Image::get_reduced(name, 0, 80);
+  CHECK(d == a);
+  Fl_Shared_Image *full = Fl_Shared_Image::get(name);
+  CHECK(full && full->original() && full->data_w() == 498);
+  Fl_Shared_Image *e = Fl_Shared_Image::get_reduced(name, 10, 10);
+  CHECK(e == full);
+  e->release(); full->release(); d->release(); c->release(); b->release(); a->release();
+  CHECK(!Fl_Shared_Image::find(name));
+  return PASS;
+}
+
+// Builds GIF files in memory for the GIF tests
+class Gif_Writer {
+  uchar *data_;
+  size_t size_, alloc_;
+  uchar block_[255];                    // the data sub-block being written
+  int block_size_;
+  unsigned bits_;                       // LZW code bits not in block_ yet
+  int nbits_;
+  void code(int c, int size) {
+    bits_ |= (unsigned)c << nbits_;
+    for (nbits_ += size; nbits_ >= 8; nbits_ -= 8, bits_ >>= 8) {
+      block_[block_size_++] = (uchar)bits_;
+      if (block_size_ == 255) flush_block();
+    }
+  }
+  void flush_block() {
+    if (!block_size_) return;
+    byte(block_size_);
+    for (int i = 0; i < block_size_; i++) byte(block_[i]);
+    block_size_ = 0;
+  }
+public:
+  Gif_Writer() : data_(0), size_(0), alloc_(0), block_size_(0), bits_(0), nbits_(0) {}
+  ~Gif_Writer() { free(data_); }
+  const uchar *data() const { return data_; }
+  size_t size() const { return size_; }
+  void byte(int c) {
+    if (size_ == alloc_) {
+      alloc_ = alloc_ ? 2 * alloc_ : 4096;
+      data_ = (uchar*)realloc(data_, alloc_);
+    }
+    data_[size_++] = (uchar)c;
+  }
+  void word(int w) { byte(w & 255); byte(w >> 8); }
+  // Writes the header and the logical screen, with a global color table of
+  // 2^bits colors unless bits is 0
+  void screen(int w, int h, const uchar *palette, int bits) {
+    const char *header = "GIF89a";
+    while (*header) byte(*header++);
+    word(w); word(h);
+    byte(bits ? 0x80 | (bits - 1) : 0); byte(0); byte(0);
+    for (int i = 0; i < (bits ? 3 << bits : 0); i++) byte(palette[i]);
+  }
+  // Writes the application extension with the loop count of an animation
+  void loop(int count) {
+    const char *id = "NETSCAPE2.0";
+    byte(0x21); byte(0xff); byte(11);
+    while (*id) byte(*id++);
+    byte(3); byte(1); word(count); byte(0);
+  }
+  // Writes a graphic control extension, transparent is -1 for none
+  void control(int disposal, int delay, int transparent) {
+    byte(0x21); byte(0xf9); byte(4);
+    byte(disposal << 2 | (transparent >= 0));
+    word(delay); byte(transparent >= 0 ? transparent : 0); byte(0);
+  }
+  // Writes an image with pixels of code_size bits, and a local color table
+  // of 2^local colors unless local is 0. After the LZW table is full, the
+  // next clear code is deferred for up to defer codes.
+  void image(int x, int y, int w, int h, const uchar *pixels, int code_size,
+             int interlace, int defer, const uchar *palette = 0, int local = 0) {
+    byte(0x2c); word(x); word(y); word(w); word(h);
+    byte((interlace ? 0x40 : 0) | (local ? 0x80 | (local - 1) : 0));
+    for (int i = 0; i < (local ? 3 << local : 0); i++) byte(palette[i]);
+    byte(code_size);
+    int colors = 1 << code_size, clear = colors;
+    // child[s * colors + c] is the code of string s followed by color c, or 0
+    short *child = new short[4096 * colors];
+    memset(child, 0, 4096 * colors * sizeof(short));
+    int next = clear + 2, size = code_size + 1, deferred = 0, s = -1;
+    code(clear, size);
+    for (int pass = 0; pass < (interlace ? 4 : 1); pass++) {
+      static const int first[] = {0, 4, 2, 1}, step[] = {8, 8, 4, 2};
+      for (int row = interlace ? first[pass] : 0; row < h; row += interlace ? step[pass] : 1) {
+        for (int col = 0; col < w; col++) {
+          int c = pixels[row * w + col];
+          if (s < 0) { s = c; continue; }
+          short &sc = child[s * colors + c];
+          if (sc) { s = sc; continue; }
+          code(s, size);
+          if (next < 4096) {
+            sc = (short)next++;
+            if (next > (1 << size) && size < 12) size++;
+          } else if (++deferred > defer) {
+            code(clear, size);
+            memset(child, 0, 4096 * colors * sizeof(short));
+            next = clear + 2;
+            size = code_size + 1;
+            deferred = 0;
+          }
+          s = c;
+        }
+      }
+    }
+    delete[] child;
+    code(s, size);
+    code(clear + 1, size);
+    if (nbits_) code(0, 8 - nbits_);
+    flush_block();
+    byte(0);
+  }
+  void end() { byte(0x3b); }
+};
+
+// The colors of the GIF tests, all different
+static void gif_palette(uchar *palette) {
+  for (int i = 0; i < 256; i++) {
+    palette[3 * i] = (uchar)i;
+    palette[3 * i + 1] = (uchar)(255 - i);
+    palette[3 * i + 2] = (uchar)(i * 7);
+  }
+}
+
+// Fills pixels with w x h colors below 2^bits: a pattern that compresses
+// well, or noise if noise is set
+static void gif_pixels(uchar *pixels, int w, int h, int bits, int noise) {
+  unsigned random = 12345;
+  for (int y = 0; y < h; y++) {
+    for (int x = 0; x < w; x++) {
+      random = random * 1103515245 + 12345;
+      int c = noise ? (int)(random >> 16) : x / 3 + y / 5;
+      pixels[y * w + x] = (uchar)(c & ((1 << bits) - 1));
+    }
+  }
+}
+
+// Checks that GIF image img has the colors of pixels in palette, where
+// color transparent has alpha 0
+static int check_gif_pixels(Fl_GIF_Image &img, const uchar *pixels,
+                            const uchar *palette, int transparent) {
+  Fl_RGB_Image rgb(&img);
+  CHECK(rgb.d() == 4);
+  const uchar *p = rgb.array;
+  for (int i = 0; i < img.w() * img.h(); i++, p += 4) {
+    int c = pixels[i];
+    if (c == transparent) {
+      CHECK(p[3] == 0);
+    } else if (p[0] != palette[3 * c] || p[1] != palette[3 * c + 1] ||
+               p[2] != palette[3 * c + 2] || p[3] != 255) {
+      printf("  pixel %d is %d %d %d %d, not color %d\n", i, p[0], p[1], p[2], p[3], c);
+      return FAIL;
+    }
+  }
+  return PASS;
+}
+
+// Fl_GIF_Image decodes every pixel of generated GIF files like the decoder
+// it replaced, and fails on the same truncated files
+static int gif_decoder() {
+  static const struct {
+    const char *what;
+    int w, h, bits, code_size, interlace, transparent, defer, noise;
+  } gifs[] = {
+    {"pattern",                     100, 70, 8, 8, 0, -1, 0, 0},
+    {"interlaced, transparent",     123, 77, 8, 8, 1, 5, 0, 1},
+    {"2 bit codes",                  64, 48, 2, 2, 0, -1, 0, 1},
+    {"full table, deferred clear",  300, 200, 8, 8, 0, -1, 5000, 1},
+    {"full table, clear",           300, 200, 8, 8, 0, -1, 0, 1},
+    {"interlaced, 13 rows",         300, 13, 4, 4, 1, -1, 0, 0},
+    {"interlaced, 5 rows, 1 bit",     7, 5, 1, 2, 1, 0, 0, 1},
+    {"single pixel",                  1, 1, 1, 2, 0, -1, 0, 0}
+  };
+  uchar palette[3 * 256];
+  gif_palette(palette);
+  void (*error)(const char *, ...) = Fl::error;
+  void (*warning)(const char *, ...) = Fl::warning;
+  int ret = PASS;
+  for (unsigned i = 0; i < sizeof(gifs) / sizeof(gifs[0]) && ret == PASS; i++) {
+    int w = gifs[i].w, h = gifs[i].h;
+    uchar *pixels = new uchar[w * h];
+    gif_pixels(pixels, w, h, gifs[i].bits, gifs[i].noise);
+    Gif_Writer gif;
+    gif.screen(w, h, palette, gifs[i].bits);
+    if (gifs[i].transparent >= 0) gif.control(0, 0, gifs[i].transparent);
+    gif.image(0, 0, w, h, pixels, gifs[i].code_size, gifs[i].interlace, gifs[i].defer);
+    size_t image_end = gif.size();
+    gif.end();
+    Fl_GIF_Image img(gifs[i].what, gif.data(), gif.size());
+    if (img.fail() || img.w() != w || img.h() != h ||
+        check_gif_pixels(img, pixels, palette, gifs[i].transparent) != PASS) {
+      printf("  %s: not decoded\n", gifs[i].what);
+      ret = FAIL;
+    }
+    // without the trailer, the image is still complete
+    Fl_GIF_Image complete(gifs[i].what, gif.data(), image_end);
+    if (complete.fail() || check_gif_pixels(complete, pixels, palette, gifs[i].transparent) != PASS) {
+      printf("  %s: not decoded without the trailer\n", gifs[i].what);
+      ret = FAIL;
+    }
+    Fl::error = Fl::warning = quiet; // the decoder reports the truncated data
+    const size_t cuts[] = {0, 10, (size_t)13 + (3 << gifs[i].bits), image_end / 2, image_end - 2};
+    for (unsigned k = 0; k < sizeof(cuts) / sizeof(cuts[0]) && ret == PASS; k++) {
+      Fl_GIF_Image cut(gifs[i].what, gif.data(), cuts[k]);
+      if (cut.fail() != Fl_Image::ERR_FORMAT) {
+        printf("  %s: truncated after %lu bytes, but fail() is %d\n",
+               gifs[i].what, (unsigned long)cuts[k], cut.fail());
+        ret = FAIL;
+      }
+    }
+    Fl::error = error;
+    Fl::warning = warning;
+    delete[] pixels;
+  }
+  return ret;
+}
+
+// Fl_Anim_GIF_Image composes each frame with the frames before it following
+// their disposal methods, in any order and without a cache
+static int gif_animation() {
+  static const struct {
+    int x, y, w, h, bits, noise, interlace, local, transparent, dispose, delay;
+  } frames[] = {
+    { 0,  0, 40, 30, 6, 0, 0, 0, -1, 1, 10},   // the background
+    { 5,  5, 10, 10, 2, 1, 0, 0,  0, 1, 20},   // kept
+    {10, 10, 20, 10, 3, 0, 0, 1,  0, 2,  0},   // cleared, shown for 0.1 s
+    { 0, 20, 40, 10, 3, 1, 1, 0, -1, 3,  5},   // replaced by the previous frame
+    {20,  0, 20, 20, 4, 0, 1, 1,  3, 0,  7}
+  };
+  const int n = sizeof(frames) / sizeof(frames[0]), W = 40, H = 30;
+  uchar palette[3 * 256], reversed[3 * 256], pixels[W * H];
+  gif_palette(palette);
+  for (int i = 0; i < 3 * 256; i++) reversed[i] = palette[3 * (255 - i / 3) + i % 3];
+  // write the GIF and compose the frames
+  Gif_Writer gif;
+  gif.screen(W, H, palette, 8);
+  gif.loop(0);
+  uchar screen[W * H * 4], previous[W * H * 4];
+  uchar *composed = new uchar[n * W * H * 4]; // the expected frames
+  memset(screen, 0, sizeof(screen));
+  for (int k = 0; k < n; k++) {
+    int fw = frames[k].w, fh = frames[k].h, bits = frames[k].bits;
+    const uchar *colors = frames[k].local ? reversed : palette;
+    gif_pixels(pixels, fw, fh, bits, frames[k].noise);
+    gif.control(frames[k].dispose, frames[k].delay, frames[k].transparent);
+    gif.image(frames[k].x, frames[k].y, fw, fh, pixels, bits < 2 ? 2 : bits,
+              frames[k].interlace, 0, colors, frames[k].local ? bits : 0);
+    memcpy(previous, screen, sizeof(screen));
+    for (int i = 0; i < fw * fh; i++) {
+      if (pixels[i] == frames[k].transparent) continue;
+      uchar *p = screen + ((frames[k].y + i / fw) * W + frames[k].x + i % fw) * 4;
+      memcpy(p, colors + 3 * pixels[i], 3);
+      p[3] = 255;
+    }
+    memcpy(composed + k * W * H * 4, screen, sizeof(screen));
+    if (frames[k].dispose == 2) {
+      for (int y = frames[k].y; y < frames[k].y + fh; y++)
+        memset(screen + (y * W + frames[k].x) * 4, 0, fw * 4);
+    } else if (frames[k].dispose == 3) {
+      memcpy(screen, previous, sizeof(screen));
+    }
+  }
+  gif.end();
+  size_t cache_size = Fl_Anim_GIF_Image::cache_size();
+  Fl_Anim_GIF_Image::cache_size(0);
+  Fl_Anim_GIF_Image anim("animation", gif.data(), gif.size());
+  int ret = PASS;
+  if (anim.fail() || anim.frames() != n || anim.w() != W || anim.h() != H ||
+      anim.loop_count() != 0) {
+    printf("  animation not loaded\n");
+    ret = FAIL;
+  }
+  static const int order[] = {0, 1, 2, 3, 4, 3, 1, 4, 0, 2};
+  for (unsigned i = 0; i < sizeof(order) / sizeof(order[0]) && ret == PASS; i++) {
+    int k = order[i];
+    anim.frame(k);
+    Fl_RGB_Image *rgb = (Fl_RGB_Image *)anim.copy(W, H);
+    double delay = frames[k].delay < 2 ? 0.1 : frames[k].delay / 100.0;
+    if (anim.delay(k) != delay || rgb->d() != 4 ||
+        memcmp(rgb->array, composed + k * W * H * 4, W * H * 4)) {
+      printf("  frame %d is not composed correctly\n", k);
+      ret = FAIL;
+    }
+    delete rgb;
+  }
+  Fl_Anim_GIF_Image::cache_size(cache_size);
+  delete[] composed;
+  return ret;
+}
+
+static const struct {
+  const char *name;
+  int (*run)();
+} tests[] = {
+  {"value_input_resize", value_input_resize},
+  {"png_decoder", png_decoder},
+  {"jpeg_decoder", jpeg_decoder},
+  {"undo_history", undo_history},
+  {"shared_image_reduced", shared_image_reduced},
+  {"gif_decoder", gif_decoder},
+  {"gif_animation", gif_animation},
+  {0, 0}
+};
+
+int main(int argc, char **argv) {
+  int failed = 0, skipped = 0, run = 0;
+  for (int i = 0; tests[i].name; i++) {
+    if (argc > 1) {
+      int a;
+      for (a = 1; a < argc && strcmp(argv[a], tests[i].name); a++) { }
+      if (a == argc) continue;
+    }
+    int ret = tests[i].run();
+    printf("%s %s\n", tests[i].name, ret == PASS ? "passed" : ret == SKIP ? "skipped" : "FAILED");
+    fflush(stdout);
+    run++;
+    if (ret == SKIP) skipped++;
+    else if (ret != PASS) failed++;
+  }
+  if (!run) {
+    fprintf(stderr, "Usage: %s [test...]\n", argv[0]);
+    return FAIL;
+  }
+  if (failed) return FAIL;
+  return skipped == run ? SKIP : PASS;
+}
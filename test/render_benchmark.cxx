@@ -0,0 +1,387 @@
+//
+// Rendering benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Draws a set of standardized scenes - rectangle fills, lines, text in
+// several fonts, RGB and RGBA image blits, scaled images, complex polygons,
+// a scrolling Fl_Text_Display and a scrolling Fl_Table - a fixed number of
+// times on each available drawing surface and reports the timings.
+//
+// Usage: render_benchmark [-i iterations] [-s surface[,surface...]] [scene...]
+//
+//   surfaces: window, image, svg, postscript (default: all of them)
+//   scenes:   rects, lines, text, images, alpha, scaled, polygons,
+//             textdisplay, table (default: all of them)
+//
+// Each measurement is printed on a line of its own:
+//
+//   render <scene> <surface> <iterations> <seconds> <frames/s>
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl.H>
+#include <FL/Fl_Double_Window.H>
+#include <FL/Fl_Text_Display.H>
+#include <FL/Fl_Table.H>
+#include <FL/Fl_RGB_Image.H>
+#include <FL/Fl_Image_Surface.H>
+#include <FL/Fl_SVG_File_Surface.H>
+#include <FL/Fl_PostScript.H>
+#include <FL/fl_draw.H>
+#include <FL/math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+#define SCENE_W 600
+#define SCENE_H 400
+
+// Deterministic pseudo-random numbers so that all runs draw the same thing
+static unsigned seed;
+static int rnd(int n) {
+  seed = seed * 1103515245 + 12345;
+  return int((seed >> 16) % unsigned(n));
+}
+
+// A scene is a widget of size SCENE_W x SCENE_H; step() changes it between
+// two iterations (e.g., to scroll a text or a table)
+class Scene {
+public:
+  const char *name;
+  Fl_Widget *widget;
+  Scene(const char *n) : name(n), widget(NULL) {}
+  virtual ~Scene() {}
+  virtual void step(int) {}
+};
+
+class Rects_Widget : public Fl_Widget {
+public:
+  Rects_Widget() : Fl_Widget(0, 0, SCENE_W, SCENE_H) {}
+  void draw() {
+    seed = 1;
+    fl_rectf(x(), y(), w(), h(), FL_WHITE);
+    for (int k = 0; k < 2000; k++) {
+      fl_color(fl_rgb_color(uchar(rnd(256)), uchar(rnd(256)), uchar(rnd(256))));
+      int X = rnd(w() - 10), Y = rnd(h() - 10);
+      fl_rectf(x() + X, y() + Y, 1 + rnd(w() - X), 1 + rnd(h() - Y) / 4);
+    }
+  }
+};
+
+class Lines_Widget : public Fl_Widget {
+public:
+  Lines_Widget() : Fl_Widget(0, 0, SCENE_W, SCENE_H) {}
+  void draw() {
+    static const int styles[] = { FL_SOLID, FL_DASH, FL_DOT, FL_SOLID };
+    seed = 2;
+    fl_rectf(x(), y(), w(), h(), FL_WHITE);
+    for (int k = 0; k < 2000; k++) {
+      if (k % 250 == 0) fl_line_style(styles[(k / 250) % 4], (k / 500) % 3);
+      fl_color(Fl_Color(rnd(256)));
+      fl_line(x() + rnd(w()), y() + rnd(h()), x() + rnd(w()), y() + rnd(h()));
+    }
+    fl_line_style(0);
+  }
+};
+
+class Text_Widget : public Fl_Widget {
+public:
+  Text_Widget() : Fl_Widget(0, 0, SCENE_W, SCENE_H) {}
+  void draw() {
+    static const Fl_Font fonts[] = { FL_HELVETICA, FL_TIMES, FL_COURIER, FL_HELVETICA_BOLD_ITALIC };
+    static const Fl_Fontsize sizes[] = { 10, 14, 18 };
+    static const char *texts[] = {
+      "The quick brown fox jumps over the lazy dog 0123456789",
+      "Gr\xc3\xbc\xc3\x9f" "e \xce\x95\xce\xbb\xce\xbb\xce\xb7\xce\xbd\xce\xb9\xce\xba\xce\xac "
+      "\xd0\x9a\xd0\xb8\xd1\x80\xd0\xb8\xd0\xbb\xd0\xbb\xd0\xb8\xd1\x86\xd0\xb0 \xe2\x82\xac"
+    };
+    fl_rectf(x(), y(), w(), h(), FL_WHITE);
+    fl_color(FL_BLACK);
+    int Y = y();
+    for (int k = 0; Y < y() + h(); k++) {
+      fl_font(fonts[k % 4], sizes[(k / 4) % 3]);
+      Y += fl_height();
+      fl_draw(texts[(k / 12) % 2], x() + 4, Y - fl_descent());
+    }
+  }
+};
+
+// Tiles RGB or RGBA images over the scene, or scaled copies of them
+class Images_Widget : public Fl_Widget {
+  Fl_RGB_Image *img;
+public:
+  Images_Widget(int depth, int scaled) : Fl_Widget(0, 0, SCENE_W, SCENE_H) {
+    uchar *array = new uchar[128 * 128 * depth], *p = array;
+    for (int j = 0; j < 128; j++) {
+      for (int i = 0; i < 128; i++) {
+        *p++ = uchar(j << 1);
+        *p++ = uchar(i << 1);
+        *p++ = uchar((127 - i) << 1);
+        if (depth == 4) *p++ = uchar(i + j);
+      }
+    }
+    img = new Fl_RGB_Image(array, 128, 128, depth);
+    img->alloc_array = 1;
+    if (scaled) img->scale(96, 96, 0, 1);
+  }
+  ~Images_Widget() { delete img; }
+  void draw() {
+    fl_rectf(x(), y(), w(), h(), FL_WHITE);
+    for (int Y = 0; Y < h(); Y += img->h() / 2)
+      for (int X = 0; X < w(); X += img->w() / 2)
+        img->draw(x() + X, y() + Y);
+  }
+};
+
+class Polygons_Widget : public Fl_Widget {
+public:
+  Polygons_Widget() : Fl_Widget(0, 0, SCENE_W, SCENE_H) {}
+  void draw() {
+    seed = 3;
+    fl_rectf(x(), y(), w(), h(), FL_WHITE);
+    for (int k = 0; k < 200; k++) {
+      double cx = x() + rnd(w()), cy = y() + rnd(h()), r = 10 + rnd(40);
+      int points = 5 + 2 * rnd(4);
+      fl_color(Fl_Color(rnd(256)));
+      // self-intersecting star polygons
+      fl_begin_complex_polygon();
+      for (int i = 0; i < points; i++) {
+        double a = 2 * M_PI * ((i * (points / 2)) % points) / points;
+        fl_vertex(cx + r * cos(a), cy + r * sin(a));
+      }
+      fl_end_complex_polygon();
+    }
+  }
+};
+
+class Text_Display_Scene : public Scene {
+  Fl_Text_Display *display;
+  Fl_Text_Buffer *buffer;
+public:
+  Text_Display_Scene() : Scene("textdisplay") {
+    buffer = new Fl_Text_Buffer();
+    char line[100];
+    for (int k = 0; k < 5000; k++) {
+      snprintf(line, sizeof(line), "%5d: The quick brown fox jumps over the lazy dog %d\n", k, k * k);
+      buffer->append(line);
+    }
+    widget = display = new Fl_Text_Display(0, 0, SCENE_W, SCENE_H);
+    display->buffer(buffer);
+    display->textfont(FL_COURIER);
+  }
+  ~Text_Display_Scene() {
+    display->buffer(NULL);
+    delete buffer;
+  }
+  void step(int i) {
+    display->scroll(1 + (i * 7) % 4900, 0);
+  }
+};
+
+class Bench_Table : public Fl_Table {
+public:
+  Bench_Table() : Fl_Table(0, 0, SCENE_W, SCENE_H) {
+    rows(1000);
+    cols(20);
+    col_header(1);
+    row_header(1);
+    col_width_all(60);
+    row_height_all(20);
+    end();
+  }
+  void draw_cell(TableContext context, int R, int C, int X, int Y, int W, int H) {
+    char s[40];
+    switch (context) {
+      case CONTEXT_STARTPAGE:
+        fl_font(FL_HELVETICA, 12);
+        return;
+      case CONTEXT_COL_HEADER:
+      case CONTEXT_ROW_HEADER:
+        snprintf(s, sizeof(s), "%d", context == CONTEXT_COL_HEADER ? C : R);
+        fl_draw_box(FL_THIN_UP_BOX, X, Y, W, H, FL_LIGHT2);
+        fl_color(FL_BLACK);
+        fl_draw(s, X, Y, W, H, FL_ALIGN_CENTER);
+        return;
+      case CONTEXT_CELL:
+        snprintf(s, sizeof(s), "%d", R * C);
+        fl_color((R + C) % 2 ? FL_WHITE : fl_rgb_color(230, 235, 255));
+        fl_rectf(X, Y, W, H);
+        fl_color(FL_GRAY0);
+        fl_draw(s, X, Y, W - 4, H, FL_ALIGN_RIGHT);
+        fl_color(FL_LIGHT2);
+        fl_rect(X, Y, W, H);
+        return;
+      default:
+        return;
+    }
+  }
+};
+
+class Table_Scene : public Scene {
+  Bench_Table *table;
+public:
+  Table_Scene() : Scene("table") {
+    widget = table = new Bench_Table();
+  }
+  void step(int i) {
+    table->row_position((i * 3) % 980);
+    table->col_position(i % 10);
+  }
+};
+
+static Scene *make_scene(const char *name, Fl_Widget *w) {
+  Scene *s = new Scene(name);
+  s->widget = w;
+  return s;
+}
+
+// ------------------------------------------------------------------------
+// Surfaces: each draws the scene 'iterations' times
+// ------------------------------------------------------------------------
+
+static Fl_Window *window = NULL;
+
+static void run_window(Scene *s, int iterations) {
+  for (int i = 0; i < iterations; i++) {
+    s->step(i);
+    s->widget->redraw();
+    Fl::flush();
+  }
+  // wait until the display has processed all drawing requests
+  window->make_current();
+  uchar pixel[3];
+  fl_read_image(pixel, 0, 0, 1, 1);
+}
+
+static void run_image(Scene *s, int iterations) {
+  Fl_Image_Surface *surf = new Fl_Image_Surface(SCENE_W, SCENE_H);
+  Fl_Surface_Device::push_current(surf);
+  for (int i = 0; i < iterations; i++) {
+    s->step(i);
+    surf->draw(s->widget);
+  }
+  uchar pixel[3];
+  fl_read_image(pixel, 0, 0, 1, 1);
+  Fl_Surface_Device::pop_current();
+  delete surf;
+}
+
+static void run_svg(Scene *s, int iterations) {
+  for (int i = 0; i < iterations; i++) {
+    FILE *out = tmpfile();
+    if (!out) return;
+    Fl_SVG_File_Surface *svg = new Fl_SVG_File_Surface(SCENE_W, SCENE_H, out);
+    Fl_Surface_Device::push_current(svg);
+    s->step(i);
+    svg->draw(s->widget);
+    Fl_Surface_Device::pop_current();
+    delete svg;
+  }
+}
+
+static void run_postscript(Scene *s, int iterations) {
+  FILE *out = tmpfile();
+  if (!out) return;
+  Fl_PostScript_File_Device *ps = new Fl_PostScript_File_Device();
+  if (ps->begin_job(out, iterations, Fl_Paged_Device::A4, Fl_Paged_Device::LANDSCAPE) == 0) {
+    for (int i = 0; i < iterations; i++) {
+      ps->begin_page();
+      s->step(i);
+      ps->draw(s->widget);
+      ps->end_page();
+    }
+    ps->end_job();
+  }
+  delete ps;
+  fclose(out);
+}
+
+static const struct {
+  const char *name;
+  void (*run)(Scene *, int);
+} surfaces[] = {
+  { "window", run_window },
+  { "image", run_image },
+  { "svg", run_svg },
+  { "postscript", run_postscript }
+};
+
+static const int surface_count = sizeof(surfaces) / sizeof(surfaces[0]);
+
+static int selected(const char *list, const char *name) {
+  if (!list) return 1;
+  size_t l = strlen(name);
+  for (const char *p = list; (p = strstr(p, name)) != NULL; p += l) {
+    if ((p == list || p[-1] == ',') && (p[l] == 0 || p[l] == ',')) return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int iterations = 50;
+  const char *surface_list = NULL;
+  int first_scene = 1;
+  while (first_scene < argc && argv[first_scene][0] == '-') {
+    if (!strcmp(argv[first_scene], "-i") && first_scene + 1 < argc) {
+      iterations = atoi(argv[first_scene + 1]);
+    } else if (!strcmp(argv[first_scene], "-s") && first_scene + 1 < argc) {
+      surface_list = argv[first_scene + 1];
+    } else {
+      return benchmark_usage(argv[0], "[-i iterations] [-s surface[,surface...]] [scene...]");
+    }
+    first_scene += 2;
+  }
+  if (iterations < 1) iterations = 1;
+
+  window = new Fl_Double_Window(SCENE_W, SCENE_H, "Rendering benchmark");
+  Scene *scenes[] = {
+    make_scene("rects", new Rects_Widget()),
+    make_scene("lines", new Lines_Widget()),
+    make_scene("text", new Text_Widget()),
+    make_scene("images", new Images_Widget(3, 0)),
+    make_scene("alpha", new Images_Widget(4, 0)),
+    make_scene("scaled", new Images_Widget(3, 1)),
+    make_scene("polygons", new Polygons_Widget()),
+    new Text_Display_Scene(),
+    new Table_Scene()
+  };
+  const int scene_count = sizeof(scenes) / sizeof(scenes[0]);
+  window->end();
+  for (int k = 0; k < scene_count; k++) scenes[k]->widget->hide();
+  window->show();
+  Fl::wait(0.1);
+
+  for (int k = 0; k < scene_count; k++) {
+    Scene *s = scenes[k];
+    int wanted = (first_scene >= argc);
+    for (int a = first_scene; a < argc && !wanted; a++) wanted = !strcmp(argv[a], s->name);
+    if (!wanted) continue;
+    s->widget->show();
+    for (int j = 0; j < surface_count; j++) {
+      if (!selected(surface_list, surfaces[j].name)) continue;
+      surfaces[j].run(s, 1); // warm up caches of fonts and images
+      double start = benchmark_now();
+      surfaces[j].run(s, iterations);
+      double elapsed = benchmark_now() - start;
+      // machine-readable result: scene surface iterations seconds frames/s
+      benchmark_report("render %s %s %d %.4f %.1f", s->name, surfaces[j].name, iterations, elapsed,
+                       elapsed > 0 ? iterations / elapsed : 0.);
+    }
+    s->widget->hide();
+  }
+  for (int k = 0; k < scene_count; k++) delete scenes[k];
+  delete window;
+  return 0;
+}
@@ -0,0 +1,89 @@
+//
+// RGB image scaling benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Reduces a large generated photo-like image with Fl_RGB_Image::copy()
+// to several sizes, with each scaling method, scaling in one thread and
+// in as many threads as Fl_Image::RGB_scaling_threads() allows:
+//
+//   nearest:  FL_RGB_SCALING_NEAREST
+//   bilinear: FL_RGB_SCALING_BILINEAR
+//   area:     FL_RGB_SCALING_AREA
+//
+// Usage: scale_benchmark [-i iterations] [-d depth] [WxH]
+//
+//   WxH:   the size of the source image (default: 8192x6144, 50 megapixels)
+//   depth: the depth of the source image, 1 to 4 (default: 3)
+//
+// Each measurement is printed on a line of its own:
+//
+//   scale <method> <threads> <source WxH> <destination WxH> <seconds>
+//
+// where threads is 1 or "all".
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl_RGB_Image.H>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark.h"
+
+static Fl_RGB_Image *make_image(int w, int h, int d) {
+  uchar *p = new uchar[(size_t)w * h * d], *q = p;
+  for (int y = 0; y < h; y++)
+    for (int x = 0; x < w; x++)
+      for (int c = 0; c < d; c++)
+        *q++ = benchmark_pixel(x, y, w, h, d, c);
+  Fl_RGB_Image *img = new Fl_RGB_Image(p, w, h, d);
+  img->alloc_array = 1;
+  return img;
+}
+
+static const struct { const char *name; Fl_RGB_Scaling method; } methods[] = {
+  {"nearest", FL_RGB_SCALING_NEAREST},
+  {"bilinear", FL_RGB_SCALING_BILINEAR},
+  {"area", FL_RGB_SCALING_AREA}
+};
+
+int main(int argc, char **argv) {
+  int iterations = 3, depth = 3, w = 8192, h = 6144;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-i") && i + 1 < argc) iterations = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-d") && i + 1 < argc) depth = atoi(argv[++i]);
+    else if (sscanf(argv[i], "%dx%d", &w, &h) != 2) w = 0;
+    if (iterations < 1 || depth < 1 || depth > 4 || w < 1 || h < 1) {
+      return benchmark_usage(argv[0], "[-i iterations] [-d depth] [WxH]");
+    }
+  }
+  Fl_RGB_Image *src = make_image(w, h, depth);
+  // a screen-sized view, a preview and a thumbnail
+  const int sizes[] = {w / 4, w / 16, 128};
+  for (unsigned m = 0; m < sizeof(methods) / sizeof(methods[0]); m++) {
+    Fl_Image::RGB_scaling(methods[m].method);
+    for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      int dw = sizes[s], dh = int(h * double(dw) / w + 0.5);
+      if (dw < 1 || dh < 1) continue;
+      for (int threads = 1; threads >= 0; threads--) {
+        Fl_Image::RGB_scaling_threads(threads);
+        double start = benchmark_now();
+        for (int i = 0; i < iterations; i++) delete src->copy(dw, dh);
+        benchmark_report("scale %s %s %dx%d %dx%d %.3f", methods[m].name, threads ? "1" : "all",
+                         w, h, dw, dh, (benchmark_now() - start) / iterations);
+      }
+    }
+  }
+  delete src;
+  return 0;
+}
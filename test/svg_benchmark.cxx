@@ -0,0 +1,115 @@
+//
+// SVG export benchmark for the Fast Light Tool Kit (FLTK).
+//
+// Exports a widget tree with many repeated icons and boxes with
+// Fl_SVG_File_Surface several times and reports the size of the
+// resulting SVG file and the export throughput.
+//
+// Usage: svg_benchmark [iterations [output.svg]]
+//
+// Copyright 2022 by Bill Spitzak and others.
+//
+// This library is free software. Distribution and use rights are outlined in
+// the file "COPYING" which should have been included with this file.  If this
+// file is missing or damaged, see the license at:
+//
+//     https://www.fltk.org/COPYING.php
+//
+// Please see the following page on how to report bugs and issues:
+//
+//     https://www.fltk.org/bugs.php
+//
+
+#include <FL/Fl.H>
+#include <FL/Fl_Double_Window.H>
+#include <FL/Fl_Button.H>
+#include <FL/Fl_Light_Button.H>
+#include <FL/Fl_Slider.H>
+#include <FL/Fl_Browser.H>
+#include <FL/Fl_Box.H>
+#include <FL/Fl_Pixmap.H>
+#include <FL/Fl_SVG_File_Surface.H>
+#include <FL/fl_utf8.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "benchmark.h"
+
+#include "pixmaps/blue.xpm"
+#include "pixmaps/red.xpm"
+
+static long svg_bytes = 0;
+
+static int close_svg(FILE *f) {
+  svg_bytes = ftell(f);
+  return fclose(f);
+}
+
+// Builds a dashboard-like window: a grid of icon buttons, indicators,
+// sliders and a browser.
+static Fl_Window *make_dashboard(int &count) {
+  static Fl_Pixmap blue(blue_xpm), red(red_xpm);
+  Fl_Window *win = new Fl_Double_Window(820, 620, "SVG export benchmark");
+  count = 1;
+  for (int j = 0; j < 12; j++) {
+    for (int i = 0; i < 16; i++) {
+      Fl_Button *b = new Fl_Button(10 + i * 40, 10 + j * 40, 36, 36);
+      b->image((i + j) % 3 ? &blue : &red);
+      b->box(FL_UP_BOX);
+      count++;
+    }
+  }
+  for (int j = 0; j < 20; j++) {
+    Fl_Light_Button *l = new Fl_Light_Button(660, 10 + j * 24, 150, 22, "indicator");
+    l->value(j % 2);
+    count++;
+  }
+  for (int i = 0; i < 16; i++) {
+    Fl_Slider *s = new Fl_Slider(10 + i * 40, 500, 20, 110);
+    s->value((i % 10) / 10.);
+    count++;
+  }
+  Fl_Browser *br = new Fl_Browser(660, 500, 150, 110);
+  for (int i = 0; i < 100; i++) {
+    char line[40];
+    snprintf(line, sizeof(line), "@B%d\tline %d", i % 16, i);
+    br->add(line);
+  }
+  count++;
+  for (int i = 0; i < 40; i++) {
+    Fl_Box *b = new Fl_Box(FL_BORDER_BOX, 10 + (i % 20) * 32, 490 - (i / 20) * 10, 30, 8, 0);
+    b->color(fl_rgb_color(i * 6, 128, 255 - i * 6));
+    count++;
+  }
+  win->end();
+  return win;
+}
+
+int main(int argc, char **argv) {
+  int iterations = (argc > 1 ? atoi(argv[1]) : 20);
+  const char *filename = (argc > 2 ? argv[2] : "svg_benchmark.svg");
+  if (iterations < 1) iterations = 1;
+  int count;
+  Fl_Window *win = make_dashboard(count);
+  win->show();
+  Fl::wait(0.1);
+  double start = benchmark_now();
+  for (int i = 0; i < iterations; i++) {
+    FILE *out = fl_fopen(filename, "w");
+    if (!out) {
+      fprintf(stderr, "cannot write %s\n", filename);
+      return 1;
+    }
+    Fl_SVG_File_Surface *svg = new Fl_SVG_File_Surface(win->w(), win->h(), out, close_svg);
+    Fl_Surface_Device::push_current(svg);
+    svg->draw(win);
+    Fl_Surface_Device::pop_current();
+    delete svg;
+  }
+  double elapsed = benchmark_now() - start;
+  // machine-readable result: name iterations seconds bytes widgets/s
+  benchmark_report("svg_export %d %.4f %ld %.0f", iterations, elapsed, svg_bytes,
+                   elapsed > 0 ? count * iterations / elapsed : 0.);
+  delete win;
+  return 0;
+}